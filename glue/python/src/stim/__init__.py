@@ -10,11 +10,11 @@ import stim._detect_machine_architecture as _tmp
 
 _tmp = _tmp._UNSTABLE_detect_march()
 try:
-    # NOTE: avx2 disabled until https://github.com/quantumlib/Stim/issues/432 is fixed
+    # NOTE: avx2 (and so avx512) disabled until https://github.com/quantumlib/Stim/issues/432 is fixed
     # if _tmp == 'avx2':
     #     from stim._stim_avx2 import _UNSTABLE_raw_format_data, __version__
     #     from stim._stim_avx2 import *
-    if _tmp == 'avx2' or _tmp == 'sse2':
+    if _tmp == 'avx512' or _tmp == 'avx2' or _tmp == 'sse2':
         from stim._stim_sse2 import _UNSTABLE_raw_format_data, __version__
         from stim._stim_sse2 import *
     else:
@@ -490,6 +490,7 @@ class Circuit:
         self,
         *,
         seed: object = None,
+        parameters: object = None,
     ) -> stim.CompiledDetectorSampler:
         """Returns an object that can batch sample detection events from the circuit.
 
@@ -518,6 +519,11 @@ class Circuit:
                 CAUTION: simulation results *MAY NOT* be consistent if you vary how many
                 shots are taken. For example, taking 10 shots and then 90 shots will
                 give different results from taking 100 shots in one call.
+            parameters: Defaults to None. The values of named parameters used as
+                noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as
+                a dictionary from parameter name to value. The values are substituted
+                into a copy of the circuit when the sampler is compiled. Every named
+                parameter in the circuit must be given a value.
 
         Examples:
             >>> import stim
@@ -581,6 +587,7 @@ class Circuit:
         skip_reference_sample: bool = False,
         seed: Optional[int] = None,
         reference_sample: Optional[np.ndarray] = None,
+        parameters: Optional[Dict[str, float]] = None,
     ) -> stim.CompiledMeasurementSampler:
         """Returns an object that can quickly batch sample measurements from the circuit.
 
@@ -633,6 +640,11 @@ class Circuit:
                 provided, the reference sample will be set to
                 `circuit.reference_sample()`, unless `skip_reference_sample=True`
                 is used, in which case it will be set to all-zeros.
+            parameters: Defaults to None. The values of named parameters used as
+                noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as
+                a dictionary from parameter name to value. The values are substituted
+                into a copy of the circuit when the sampler is compiled. Every named
+                parameter in the circuit must be given a value.
 
         Raises:
             ValueError: skip_reference_sample is True and reference_sample is not None.
@@ -961,6 +973,8 @@ class Circuit:
         approximate_disjoint_errors: float = False,
         ignore_decomposition_failures: bool = False,
         block_decomposition_from_introducing_remnant_edges: bool = False,
+        num_threads: int = 1,
+        parameters: Optional[Dict[str, float]] = None,
     ) -> stim.DetectorErrorModel:
         """Returns a stim.DetectorErrorModel describing the error processes in the circuit.
 
@@ -1029,6 +1043,19 @@ class Circuit:
                 decoding).
 
                 Irrelevant unless decompose_errors=True.
+            num_threads: Defaults to 1. The number of threads to use when collecting
+                the error mechanisms of the circuit. The circuit is split into time
+                slices at its TICKs and the slices are analyzed concurrently. The
+                resulting model is the same, up to floating point rounding of the
+                combined error probabilities.
+                The starting state of each slice comes from a sequential pass over
+                the circuit, so the speedup is limited to about 2x regardless of the
+                number of threads.
+            parameters: Defaults to None. The values of named parameters used as
+                noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as a
+                dictionary from parameter name to value. The values are substituted
+                during the analysis, without copying the circuit. Every named
+                parameter in the circuit must be given a value.
 
         Examples:
             >>> import stim
@@ -1046,6 +1073,15 @@ class Circuit:
                 error(0.375) D0 D1
                 error(0.25) D1
             ''')
+
+            >>> stim.Circuit('''
+            ...     X_ERROR(p) 0
+            ...     M(q) 0
+            ...     DETECTOR rec[-1]
+            ... ''').detector_error_model(parameters={'p': 0.125, 'q': 0})
+            stim.DetectorErrorModel('''
+                error(0.125) D0
+            ''')
         """
     def diagram(
         self,
@@ -1587,13 +1623,6 @@ class Circuit:
             ...     stim.Flow('Z -> X'),
             ... ], unsigned=True)
             True
-
-        Caveats:
-            Currently, the unsigned=False version of this method is implemented by
-            performing 256 randomized tests. Each test has a 50% chance of a false
-            positive, and a 0% chance of a false negative. So, when the method returns
-            True, there is technically still a 2^-256 chance the circuit doesn't have
-            the flow. This is lower than the chance of a cosmic ray flipping the result.
         """
     def has_flow(
         self,
@@ -1707,13 +1736,6 @@ class Circuit:
             ...     unsigned=False,
             ... )
             False
-
-        Caveats:
-            Currently, the unsigned=False version of this method is implemented by
-            performing 256 randomized tests. Each test has a 50% chance of a false
-            positive, and a 0% chance of a false negative. So, when the method returns
-            True, there is technically still a 2^-256 chance the circuit doesn't have
-            the flow. This is lower than the chance of a cosmic ray flipping the result.
         """
     def insert(
         self,
@@ -2212,6 +2234,7 @@ class Circuit:
         dont_explore_edges_with_degree_above: int,
         dont_explore_edges_increasing_symptom_degree: bool,
         canonicalize_circuit_errors: bool = False,
+        max_search_memory_bytes: Optional[int] = None,
     ) -> List[stim.ExplainedError]:
         """Searches for small sets of errors that form an undetectable logical error.
 
@@ -2276,6 +2299,11 @@ class Circuit:
                     errors that are simpler (e.g. apply Paulis to fewer qubits). This
                     discards mostly-redundant information about different ways to
                     produce the same symptoms in order to give a succinct result.
+            max_search_memory_bytes: Defaults to None (unlimited). Caps the memory used
+                to remember the intermediate states of the search. Once the cap is
+                reached, the search stops recording new intermediate states, but keeps
+                looking for a logical error among the states it already has. If the
+                search then fails, its error message says that the limit was reached.
 
         Returns:
             A list of error mechanisms that cause an undetected logical error.
@@ -2370,6 +2398,7 @@ class Circuit:
         *,
         ignore_ungraphlike_errors: bool = True,
         canonicalize_circuit_errors: bool = False,
+        num_threads: int = 1,
     ) -> List[stim.ExplainedError]:
         """Finds a minimum set of graphlike errors to produce an undetected logical error.
 
@@ -2416,6 +2445,9 @@ class Circuit:
                     errors that are simpler (e.g. apply Paulis to fewer qubits). This
                     discards mostly-redundant information about different ways to
                     produce the same symptoms in order to give a succinct result.
+            num_threads: Defaults to 1. The number of threads used to expand each
+                level of the breadth first search for the logical error. The result
+                doesn't depend on the number of threads.
 
         Returns:
             A list of error mechanisms that cause an undetected logical error.
@@ -4482,6 +4514,10 @@ class CompiledDemSampler:
     ) -> Tuple[np.ndarray, np.ndarray, Optional[np.ndarray]]:
         """Samples the detector error model's error mechanisms to produce sample data.
 
+        The shots are sampled on the calling thread. Use `sample_write`, which takes
+        a `num_threads` argument, to spread the sampling over several threads.
+        Calls on the same sampler from different python threads run one at a time.
+
         Args:
             shots: The number of times to sample from the model.
             bit_packed: Defaults to false.
@@ -4627,13 +4663,14 @@ class CompiledDemSampler:
         shots: int,
         *,
         det_out_file: Union[None, str, pathlib.Path],
-        det_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        det_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
         obs_out_file: Union[None, str, pathlib.Path],
-        obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
         err_out_file: Union[None, str, pathlib.Path] = None,
-        err_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        err_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
         replay_err_in_file: Union[None, str, pathlib.Path] = None,
-        replay_err_in_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        replay_err_in_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
+        num_threads: int = 1,
     ) -> None:
         """Samples the detector error model and writes the results to disk.
 
@@ -4666,6 +4703,9 @@ class CompiledDemSampler:
                 - io.IOBase: NOT IMPLEMENTED
             replay_err_in_format: The format to write the errors-that-occurred data in
                 (e.g. "01" or "b8").
+            num_threads: Defaults to 1. The number of threads to spread the sampling
+                over. Batches of shots are sampled concurrently and written in order.
+                The sampled results don't depend on the number of threads.
 
         Returns:
             Nothing. Results are written to disk.
@@ -4708,6 +4748,7 @@ class CompiledDetectorSampler:
         circuit: stim.Circuit,
         *,
         seed: object = None,
+        parameters: object = None,
     ) -> None:
         """Creates an object that can sample the detection events from a circuit.
 
@@ -4737,6 +4778,11 @@ class CompiledDetectorSampler:
                 CAUTION: simulation results *MAY NOT* be consistent if you vary how many
                 shots are taken. For example, taking 10 shots and then 90 shots will
                 give different results from taking 100 shots in one call.
+            parameters: Defaults to None. The values of named parameters used as
+                noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as
+                a dictionary from parameter name to value. The values are substituted
+                into a copy of the circuit when the sampler is compiled. Every named
+                parameter in the circuit must be given a value.
 
         Returns:
             An initialized stim.CompiledDetectorSampler.
@@ -4759,6 +4805,60 @@ class CompiledDetectorSampler:
     ) -> str:
         """Returns valid python code evaluating to an equivalent `stim.CompiledDetectorSampler`.
         """
+    def iter_batches(
+        self,
+        shots: int,
+        batch_size: int,
+        *,
+        prepend_observables: bool = False,
+        append_observables: bool = False,
+        separate_observables: bool = False,
+        bit_packed: bool = False,
+    ) -> stim.DetectionEventBatchIterator:
+        """Returns an iterator that samples detection events one batch at a time.
+
+        The batches are simulated on a background thread, one batch ahead of the
+        consumer, so the memory used doesn't grow with the number of shots. Each
+        batch is written into the same preallocated numpy arrays, which means a
+        batch's data is overwritten when the iterator advances. Copy it if you
+        need to keep it.
+
+        Args:
+            shots: The total number of shots to sample.
+            batch_size: The number of shots in each batch. The last batch has fewer
+                shots when `shots` isn't a multiple of `batch_size`.
+            prepend_observables: Defaults to false. When set, observables are included
+                with the detectors and are placed at the start of the results.
+            append_observables: Defaults to false. When set, observables are included
+                with the detectors and are placed at the end of the results.
+            separate_observables: Defaults to False. When set to True, each batch is a
+                (detection_events, observable_flips) tuple instead of a flat
+                detection_events array.
+            bit_packed: Defaults to False. Produces uint8 numpy arrays with 8 bits per
+                byte, instead of bool_ numpy arrays with 1 bit per byte. Uses little
+                endian packing.
+
+        Returns:
+            A stim.DetectionEventBatchIterator. Each batch it yields has the same
+            layout as the result of `sample` called with the same arguments and
+            `shots` set to the number of shots in the batch.
+
+        Examples:
+            >>> import stim
+            >>> c = stim.Circuit('''
+            ...    X_ERROR(1) 0
+            ...    M 0 1
+            ...    DETECTOR rec[-2]
+            ...    DETECTOR rec[-1]
+            ... ''')
+            >>> s = c.compile_detector_sampler()
+            >>> total = 0
+            >>> for batch in s.iter_batches(1000, batch_size=256, bit_packed=True):
+            ...     total += len(batch)
+            ...     assert (batch == 1).all()
+            >>> total
+            1000
+        """
     def sample(
         self,
         shots: int,
@@ -4772,6 +4872,10 @@ class CompiledDetectorSampler:
     ) -> Union[np.ndarray, Tuple[np.ndarray, np.ndarray]]:
         """Returns a numpy array containing a batch of detector samples from the circuit.
 
+        The shots are sampled on the calling thread. Use `sample_write`, which takes
+        a `num_threads` argument, to spread the sampling over several threads.
+        Calls on the same sampler from different python threads run one at a time.
+
         The circuit must define the detectors using DETECTOR instructions. Observables
         defined by OBSERVABLE_INCLUDE instructions can also be included in the results
         as honorary detectors.
@@ -4882,16 +4986,73 @@ class CompiledDetectorSampler:
             The bit for detection event `m` in shot `s` is at
             `result[s, (m // 8)] & 2**(m % 8)`.
         """
+    def sample_sparse(
+        self,
+        shots: int,
+        *,
+        append_observables: bool = False,
+        separate_observables: bool = False,
+    ) -> Union[Tuple[np.ndarray, np.ndarray], Tuple[np.ndarray, np.ndarray, np.ndarray]]:
+        """Samples detection events, returning the fired detectors of each shot.
+
+        The result is in compressed sparse row (CSR) form, which is cheaper to
+        produce than dense data when detection events are rare (e.g. circuits
+        with low noise). The fired detectors are found by skipping over the
+        shots without detection events, instead of transposing the sampled data.
+
+        Args:
+            shots: The number of times to sample every detector in the circuit.
+            append_observables: Defaults to False. When set, observables are treated
+                as honorary detectors placed after the real detectors. A flipped
+                observable `k` is listed as index `num_detectors + k`.
+            separate_observables: Defaults to False. When set to True, a dense array
+                of observable flips is also returned.
+
+        Returns:
+            An (indices, indptr) tuple, or an (indices, indptr, obs) tuple if
+            separate_observables=True.
+
+            indices: A numpy array with dtype=int64 listing the fired detectors
+                of every shot, shot by shot, in increasing order within each shot.
+            indptr: A numpy array with dtype=int64 and shape=(shots + 1,). The
+                fired detectors of shot `s` are `indices[indptr[s]:indptr[s+1]]`.
+            obs: A numpy array with dtype=bool_ and shape=(shots, num_observables).
+                The bit for observable `m` in shot `s` is at `obs[s, m]`.
+
+            The arrays can be given to `scipy.sparse.csr_matrix` as
+            `csr_matrix((np.ones(len(indices), dtype=np.bool_), indices, indptr))`.
+
+        Examples:
+            >>> import stim
+            >>> c = stim.Circuit('''
+            ...    X_ERROR(1) 1
+            ...    M 0 1 2
+            ...    DETECTOR rec[-3]
+            ...    DETECTOR rec[-2]
+            ...    DETECTOR rec[-1]
+            ...    OBSERVABLE_INCLUDE(0) rec[-2]
+            ... ''')
+            >>> s = c.compile_detector_sampler()
+            >>> indices, indptr = s.sample_sparse(shots=2)
+            >>> indices
+            array([1, 1])
+            >>> indptr
+            array([0, 1, 2])
+            >>> indices, indptr = s.sample_sparse(shots=2, append_observables=True)
+            >>> indices
+            array([1, 3, 1, 3])
+        """
     def sample_write(
         self,
         shots: int,
         *,
         filepath: Union[str, pathlib.Path],
-        format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
         obs_out_filepath: Optional[Union[str, pathlib.Path]] = None,
-        obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
         prepend_observables: bool = False,
         append_observables: bool = False,
+        num_threads: int = 1,
     ) -> None:
         """Samples detection events from the circuit and writes them to a file.
 
@@ -4899,7 +5060,7 @@ class CompiledDetectorSampler:
             shots: The number of times to sample every measurement in the circuit.
             filepath: The file to write the results to.
             format: The output format to write the results with.
-                Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                 Defaults to "01".
             obs_out_filepath: Sample observables as part of each shot, and write them to
                 this file. This keeps the observable data separate from the detector
@@ -4907,12 +5068,15 @@ class CompiledDetectorSampler:
             obs_out_format: If writing the observables to a file, this is the format to
                 write them in.
 
-                Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                 Defaults to "01".
             prepend_observables: Sample observables as part of each shot, and put them
                 at the start of the detector data.
             append_observables: Sample observables as part of each shot, and put them at
                 the end of the detector data.
+            num_threads: Defaults to 1. The number of threads to spread the sampling
+                over. Batches of shots are simulated concurrently and written in order.
+                The sampled results don't depend on the number of threads.
 
         Returns:
             None.
@@ -4948,6 +5112,7 @@ class CompiledMeasurementSampler:
         skip_reference_sample: bool = False,
         seed: object = None,
         reference_sample: object = None,
+        parameters: object = None,
     ) -> None:
         """Creates a measurement sampler for the given circuit.
 
@@ -5005,6 +5170,11 @@ class CompiledMeasurementSampler:
                 provided, the reference sample will be set to
                 `circuit.reference_sample()`, unless `skip_reference_sample=True`
                 is used, in which case it will be set to all-zeros.
+            parameters: Defaults to None. The values of named parameters used as
+                noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as
+                a dictionary from parameter name to value. The values are substituted
+                into a copy of the circuit when the sampler is compiled. Every named
+                parameter in the circuit must be given a value.
 
         Returns:
             An initialized stim.CompiledMeasurementSampler.
@@ -5032,6 +5202,10 @@ class CompiledMeasurementSampler:
     ) -> np.ndarray:
         """Samples a batch of measurement samples from the circuit.
 
+        The shots are sampled on the calling thread. Use `sample_write`, which takes
+        a `num_threads` argument, to spread the sampling over several threads.
+        Calls on the same sampler from different python threads run one at a time.
+
         Args:
             shots: The number of times to sample every measurement in the circuit.
             bit_packed: Returns a uint8 numpy array with 8 bits per byte, instead of
@@ -5094,7 +5268,8 @@ class CompiledMeasurementSampler:
         shots: int,
         *,
         filepath: Union[str, pathlib.Path],
-        format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
+        num_threads: int = 1,
     ) -> None:
         """Samples measurements from the circuit and writes them to a file.
 
@@ -5120,8 +5295,11 @@ class CompiledMeasurementSampler:
             shots: The number of times to sample every measurement in the circuit.
             filepath: The file to write the results to.
             format: The output format to write the results with.
-                Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                 Defaults to "01".
+            num_threads: Defaults to 1. The number of threads to spread the sampling
+                over. Batches of shots are simulated concurrently and written in order.
+                The sampled results don't depend on the number of threads.
 
         Returns:
             None.
@@ -5185,6 +5363,7 @@ class CompiledMeasurementsToDetectionEventsConverter:
         sweep_bits: Optional[np.ndarray] = None,
         append_observables: bool = False,
         bit_packed: bool = False,
+        num_threads: int = 1,
     ) -> np.ndarray:
         pass
     @overload
@@ -5196,6 +5375,7 @@ class CompiledMeasurementsToDetectionEventsConverter:
         separate_observables: Literal[True],
         append_observables: bool = False,
         bit_packed: bool = False,
+        num_threads: int = 1,
     ) -> Tuple[np.ndarray, np.ndarray]:
         pass
     def convert(
@@ -5206,6 +5386,7 @@ class CompiledMeasurementsToDetectionEventsConverter:
         separate_observables: bool = False,
         append_observables: bool = False,
         bit_packed: bool = False,
+        num_threads: int = 1,
     ) -> Union[np.ndarray, Tuple[np.ndarray, np.ndarray]]:
         """Converts measurement data into detection event data.
 
@@ -5234,6 +5415,9 @@ class CompiledMeasurementsToDetectionEventsConverter:
             bit_packed: Defaults to False. When set to True, the returned numpy
                 array contains bit packed data (dtype=np.uint8 with 8 bits per item)
                 instead of unpacked data (dtype=np.bool_).
+            num_threads: Defaults to 1. The number of threads to spread the conversion
+                over. Large inputs are split into ranges of shots that are converted
+                concurrently. The result doesn't depend on the number of threads.
 
         Returns:
             The detection event data and (optionally) observable data. The result is a
@@ -5286,25 +5470,26 @@ class CompiledMeasurementsToDetectionEventsConverter:
         self,
         *,
         measurements_filepath: Union[str, pathlib.Path],
-        measurements_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        measurements_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
         sweep_bits_filepath: Optional[Union[str, pathlib.Path]] = None,
-        sweep_bits_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        sweep_bits_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
         detection_events_filepath: Union[str, pathlib.Path],
-        detection_events_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        detection_events_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
         append_observables: bool = False,
         obs_out_filepath: Optional[Union[str, pathlib.Path]] = None,
-        obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01',
+        obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01',
+        num_threads: int = 1,
     ) -> None:
         """Reads measurement data from a file and writes detection events to another file.
 
         Args:
             measurements_filepath: A file containing measurement data to be converted.
             measurements_format: The format the measurement data is stored in.
-                Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                 Defaults to "01".
             detection_events_filepath: Where to save detection event data to.
             detection_events_format: The format to save the detection event data in.
-                Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                 Defaults to "01".
             sweep_bits_filepath: Defaults to None. A file containing sweep data, or
                 None. When specified, sweep data (used for `sweep[k]` controls in the
@@ -5312,19 +5497,23 @@ class CompiledMeasurementsToDetectionEventsConverter:
                 file. When not specified, all sweep bits default to False and no
                 sweep-controlled operations occur.
             sweep_bits_format: The format the sweep data is stored in.
-                Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                 Defaults to "01".
             obs_out_filepath: Sample observables as part of each shot, and write them to
                 this file. This keeps the observable data separate from the detector
                 data.
             obs_out_format: If writing the observables to a file, this is the format to
                 write them in.
-                Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                 Defaults to "01".
             append_observables: When True, the observables in the circuit are included
                 as part of the detection event data. Specifically, they are treated as
                 if they were additional detectors at the end of the circuit. When False,
                 observable data is not output.
+            num_threads: Defaults to 1. The number of threads to spread the conversion
+                over. Batches of shots are converted concurrently, while the files are
+                still read and written in order. The output doesn't depend on the number
+                of threads.
 
         Examples:
             >>> import stim
@@ -5869,6 +6058,207 @@ class DemTargetWithCoords:
             >>> err[0].dem_error_terms[0].dem_target
             stim.DemTarget('D0')
         """
+class DemTemplate:
+    """A circuit's detector error model, ready to be recomputed for new noise strengths.
+
+    Creating a template analyzes the circuit once, recording which detectors and
+    observables each noisy instruction can flip. Instantiating the template with
+    new noise arguments then produces the circuit's detector error model without
+    analyzing the circuit again, which is much faster than calling
+    `stim.Circuit.detector_error_model` on an edited copy of the circuit.
+
+    The noise arguments are numbered in the order they appear in the circuit's
+    text. Instructions inside of a loop body share their arguments across the
+    iterations of the loop. Noise arguments can also be named parameters (e.g.
+    the `p` in `X_ERROR(p) 0`), which are given values by instantiating with a
+    dictionary.
+
+    Examples:
+        >>> import stim
+        >>> circuit = stim.Circuit('''
+        ...     X_ERROR(0.125) 0
+        ...     M(0.25) 0
+        ...     DETECTOR rec[-1]
+        ... ''')
+        >>> template = stim.DemTemplate(circuit)
+        >>> template.default_params
+        [0.125, 0.25]
+        >>> template.instantiate([0.25, 0])
+        stim.DetectorErrorModel('''
+            error(0.25) D0
+        ''')
+    """
+    def __init__(
+        self,
+        circuit: stim.Circuit,
+        *,
+        decompose_errors: bool = False,
+        approximate_disjoint_errors: float = False,
+        ignore_decomposition_failures: bool = False,
+        block_decomposition_from_introducing_remnant_edges: bool = False,
+    ) -> None:
+        """Analyzes a circuit's noise, so its error model can be recomputed quickly.
+
+        The options have the same meaning as the options of
+        `stim.Circuit.detector_error_model`. Loops are always flattened, and gauge
+        detectors aren't allowed, because both of those features produce error
+        models whose structure depends on the noise strengths.
+
+        Args:
+            circuit: The circuit to analyze.
+            decompose_errors: Defaults to false. When set to true, the error analysis
+                attempts to decompose the components of composite error mechanisms
+                into graphlike errors.
+            approximate_disjoint_errors: Defaults to false. When set to true, the
+                probabilities of disjoint error mechanisms (like PAULI_CHANNEL_1) are
+                approximated as being independent. Can also be set to a probability
+                threshold, above which the approximation isn't allowed. The threshold
+                is checked against the arguments given to each instantiation.
+            ignore_decomposition_failures: Defaults to False. When set to True,
+                errors that fail to decompose are inserted into the output
+                undecomposed instead of raising an exception.
+            block_decomposition_from_introducing_remnant_edges: Defaults to False.
+                Requires that both A B and C D be present elsewhere in the detector
+                error model in order to decompose A B C D into A B ^ C D.
+
+        Examples:
+            >>> import stim
+            >>> template = stim.DemTemplate(stim.Circuit('''
+            ...     DEPOLARIZE1(0.1) 0
+            ...     M 0
+            ...     DETECTOR rec[-1]
+            ... '''))
+            >>> template.num_params
+            1
+        """
+    @property
+    def default_params(
+        self,
+    ) -> List[Union[float, str]]:
+        """Returns the noise arguments of the circuit the template was made from.
+
+        Instantiating the template with these parameters reproduces the circuit's
+        own detector error model. Noise arguments that are named parameters are
+        returned as their names.
+
+        Examples:
+            >>> import stim
+            >>> template = stim.DemTemplate(stim.Circuit('''
+            ...     X_ERROR(0.1) 0
+            ...     REPEAT 5 {
+            ...         DEPOLARIZE1(0.2) 0
+            ...     }
+            ...     M(0.3) 0
+            ... '''))
+            >>> template.default_params
+            [0.1, 0.2, 0.3]
+
+            >>> stim.DemTemplate(stim.Circuit('''
+            ...     PAULI_CHANNEL_1(px, 0, pz) 0
+            ...     M 0
+            ... '''), approximate_disjoint_errors=True).default_params
+            ['px', 0.0, 'pz']
+        """
+    def instantiate(
+        self,
+        params: Union[Iterable[float], Dict[str, float]],
+    ) -> stim.DetectorErrorModel:
+        """Returns the detector error model for the given noise arguments.
+
+        The result is the same as the detector error model of a copy of the circuit
+        with its noise arguments replaced by the given parameters (computed with
+        `flatten_loops=True`), up to floating point rounding.
+
+        Args:
+            params: Either the noise arguments to use, in the same order as
+                `default_params`, or a dictionary giving a value to each named
+                parameter in the circuit (with the circuit's numeric noise arguments
+                kept as they are). Each value must be a probability.
+
+        Returns:
+            The detector error model.
+
+        Raises:
+            ValueError:
+                The wrong number of parameters was given, a named parameter wasn't
+                given a value, or a value isn't a valid probability for its noise
+                channel.
+
+        Examples:
+            >>> import stim
+            >>> template = stim.DemTemplate(stim.Circuit('''
+            ...     X_ERROR(0.1) 0
+            ...     CX 0 1
+            ...     M(0.2) 0 1
+            ...     DETECTOR rec[-1]
+            ...     DETECTOR rec[-2]
+            ... '''))
+            >>> template.instantiate([0.125, 0])
+            stim.DetectorErrorModel('''
+                error(0.125) D0 D1
+            ''')
+
+            >>> template = stim.DemTemplate(stim.Circuit('''
+            ...     X_ERROR(p) 0
+            ...     M(0.25) 0
+            ...     DETECTOR rec[-1]
+            ... '''))
+            >>> template.instantiate({'p': 0.5})
+            stim.DetectorErrorModel('''
+                error(0.5) D0
+            ''')
+        """
+    @property
+    def num_params(
+        self,
+    ) -> int:
+        """Returns the number of noise arguments that instantiating the template takes.
+
+        Examples:
+            >>> import stim
+            >>> template = stim.DemTemplate(stim.Circuit('''
+            ...     X_ERROR(0.1) 0
+            ...     PAULI_CHANNEL_1(0.01, 0.02, 0.03) 1
+            ...     M 0 1
+            ... '''), approximate_disjoint_errors=True)
+            >>> template.num_params
+            4
+        """
+class DetectionEventBatchIterator:
+    """Iterates over batches of detection event samples from a circuit.
+
+    Created by `stim.CompiledDetectorSampler.iter_batches`. The next batch is
+    simulated on a background thread while the current batch is being used, and
+    every batch is written into the same numpy arrays. Copy a batch if you need
+    to keep it after advancing the iterator.
+
+    Examples:
+        >>> import stim
+        >>> c = stim.Circuit('''
+        ...    X_ERROR(1) 0
+        ...    M 0
+        ...    DETECTOR rec[-1]
+        ... ''')
+        >>> s = c.compile_detector_sampler()
+        >>> for batch in s.iter_batches(5, batch_size=2):
+        ...     print(batch.shape)
+        (2, 1)
+        (2, 1)
+        (1, 1)
+    """
+    def __iter__(
+        self,
+    ) -> stim.DetectionEventBatchIterator:
+        """Returns the iterator itself.
+        """
+    def __next__(
+        self,
+    ) -> Union[np.ndarray, Tuple[np.ndarray, np.ndarray]]:
+        """Returns the next batch of samples.
+
+        The returned arrays are reused by later batches, so their contents are
+        overwritten when the iterator advances.
+        """
 class DetectorErrorModel:
     """An error model built out of independent error mechanics.
 
@@ -6659,6 +7049,8 @@ class DetectorErrorModel:
     def shortest_graphlike_error(
         self,
         ignore_ungraphlike_errors: bool = True,
+        *,
+        num_threads: int = 1,
     ) -> stim.DetectorErrorModel:
         """Finds a minimum set of graphlike errors to produce an undetected logical error.
 
@@ -6699,6 +7091,9 @@ class DetectorErrorModel:
                 not graphlike, not decomposed into graphlike components:
                     error(0.1) D0 D1 D2
                     error(0.1) D0 D1 D2 ^ D3
+            num_threads: Defaults to 1. The number of threads used to expand each
+                level of the breadth first search. The result doesn't depend on the
+                number of threads.
 
         Returns:
             A detector error model containing just the error instructions corresponding
@@ -7236,6 +7631,8 @@ class FlipSimulator:
     def do(
         self,
         obj: Union[stim.Circuit, stim.CircuitInstruction, stim.CircuitRepeatBlock],
+        *,
+        parameters: Optional[Dict[str, float]] = None,
     ) -> None:
         """Applies a circuit or circuit instruction to the simulator's state.
 
@@ -7244,6 +7641,11 @@ class FlipSimulator:
 
         Args:
             obj: The circuit or instruction to apply to the simulator's state.
+            parameters: Defaults to None. The values of named parameters used as
+                noise arguments (e.g. the `p` in `X_ERROR(p) 0`), as a dictionary
+                from parameter name to value. The values are substituted as the
+                instructions are applied, without copying the circuit. Every named
+                parameter that is reached must be given a value.
 
         Examples:
             >>> import stim
@@ -14038,7 +14440,7 @@ def main(
 def read_shot_data_file(
     *,
     path: Union[str, pathlib.Path],
-    format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"],
+    format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"],
     bit_packed: bool = False,
     num_measurements: int = 0,
     num_detectors: int = 0,
@@ -14049,7 +14451,7 @@ def read_shot_data_file(
 def read_shot_data_file(
     *,
     path: Union[str, pathlib.Path],
-    format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"],
+    format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"],
     bit_packed: bool = False,
     num_measurements: int = 0,
     num_detectors: int = 0,
@@ -14060,7 +14462,7 @@ def read_shot_data_file(
 def read_shot_data_file(
     *,
     path: Union[str, pathlib.Path],
-    format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"],
+    format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"],
     bit_packed: bool = False,
     num_measurements: int = 0,
     num_detectors: int = 0,
@@ -14431,7 +14833,7 @@ def write_shot_data_file(
     *,
     data: np.ndarray,
     path: Union[str, pathlib.Path],
-    format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"],
+    format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"],
     num_measurements: int = 0,
     num_detectors: int = 0,
     num_observables: int = 0,
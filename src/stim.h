@@ -5,6 +5,7 @@
 /// If you need a stable API, use stim's Python API.
 #include "stim/circuit/circuit.h"
 #include "stim/circuit/circuit_instruction.h"
+#include "stim/circuit/circuit_parameters.h"
 #include "stim/circuit/gate_decomposition.h"
 #include "stim/circuit/gate_target.h"
 #include "stim/cmd/command_analyze_errors.h"
@@ -45,6 +46,7 @@
 #include "stim/gen/gen_color_code.h"
 #include "stim/gen/gen_rep_code.h"
 #include "stim/gen/gen_surface_code.h"
+#include "stim/io/buffered_file_input.h"
 #include "stim/io/measure_record.h"
 #include "stim/io/measure_record_batch.h"
 #include "stim/io/measure_record_batch_writer.h"
@@ -52,12 +54,14 @@
 #include "stim/io/measure_record_writer.h"
 #include "stim/io/raii_file.h"
 #include "stim/io/sparse_shot.h"
+#include "stim/io/stbc_format.h"
 #include "stim/io/stim_data_formats.h"
 #include "stim/main_namespaced.h"
 #include "stim/mem/bit_ref.h"
 #include "stim/mem/bitword.h"
 #include "stim/mem/bitword_128_sse.h"
 #include "stim/mem/bitword_256_avx.h"
+#include "stim/mem/bitword_512_avx512.h"
 #include "stim/mem/bitword_64.h"
 #include "stim/mem/fixed_cap_vector.h"
 #include "stim/mem/monotonic_buffer.h"
@@ -78,13 +82,17 @@
 #include "stim/search/hyper/graph.h"
 #include "stim/search/hyper/node.h"
 #include "stim/search/hyper/search_state.h"
+#include "stim/search/hyper/search_state_table.h"
 #include "stim/search/sat/wcnf.h"
 #include "stim/search/search.h"
 #include "stim/simulators/dem_sampler.h"
+#include "stim/simulators/dem_template.h"
+#include "stim/simulators/detection_event_batch_stream.h"
 #include "stim/simulators/error_analyzer.h"
 #include "stim/simulators/error_matcher.h"
 #include "stim/simulators/force_streaming.h"
 #include "stim/simulators/frame_simulator.h"
+#include "stim/simulators/frame_simulator_program.h"
 #include "stim/simulators/frame_simulator_util.h"
 #include "stim/simulators/graph_simulator.h"
 #include "stim/simulators/matched_error.h"
@@ -102,7 +110,11 @@
 #include "stim/stabilizers/tableau_iter.h"
 #include "stim/stabilizers/tableau_transposed_raii.h"
 #include "stim/util_bot/arg_parse.h"
+#include "stim/util_bot/cpu_check.h"
+#include "stim/util_bot/cpu_features.h"
 #include "stim/util_bot/error_decomp.h"
+#include "stim/util_bot/parallel_batches.h"
+#include "stim/util_bot/philox_rng.h"
 #include "stim/util_bot/probability_util.h"
 #include "stim/util_bot/str_util.h"
 #include "stim/util_bot/twiddle.h"
@@ -210,7 +210,7 @@ void circuit_read_single_operation(Circuit &circuit, char lead_char, SOURCE read
             tail_tag = std::string_view(circuit.tag_buf.tail.ptr_start, circuit.tag_buf.tail.size());
         }
 
-        read_parens_arguments(c, gate.name, read_char, circuit.arg_buf);
+        read_parens_arguments(c, gate.name, read_char, circuit.arg_buf, true);
         if (gate.flags & GATE_IS_BLOCK) {
             read_result_targets64_into(c, read_char, circuit);
             if (c != '{') {
@@ -819,6 +819,34 @@ Circuit Circuit::without_tags() const {
     return result;
 }
 
+Circuit Circuit::with_parameters_bound(const CircuitParameterBinding &binding) const {
+    Circuit result;
+    std::vector<double> arg_buf;
+    for (const auto &inst : operations) {
+        if (inst.gate_type == GateType::REPEAT) {
+            result.append_repeat_block(
+                inst.repeat_block_rep_count(), inst.repeat_block_body(*this).with_parameters_bound(binding), inst.tag);
+        } else {
+            result.safe_append(binding.bind(inst, arg_buf), true);
+        }
+    }
+    return result;
+}
+
+bool Circuit::has_parameter_args() const {
+    for (const auto &inst : operations) {
+        if (has_circuit_parameter_args(inst.args)) {
+            return true;
+        }
+    }
+    for (const auto &block : blocks) {
+        if (block.has_parameter_args()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 Circuit Circuit::without_noise() const {
     Circuit result;
     for (const auto &op : operations) {
@@ -28,6 +28,7 @@
 #include <vector>
 
 #include "stim/circuit/circuit_instruction.h"
+#include "stim/circuit/circuit_parameters.h"
 #include "stim/circuit/gate_target.h"
 #include "stim/gates/gates.h"
 #include "stim/mem/monotonic_buffer.h"
@@ -156,6 +157,12 @@ struct Circuit {
     Circuit without_noise() const;
     /// Returns a copy of the circuit with all tags removed.
     Circuit without_tags() const;
+    /// Returns a copy of the circuit with its named parameters replaced by their values from the binding.
+    Circuit with_parameters_bound(const CircuitParameterBinding &binding) const;
+    /// Determines if any instruction of the circuit, including inside loops, has a named parameter argument.
+    ///
+    /// This visits each instruction once, regardless of how many times loops repeat it.
+    bool has_parameter_args() const;
 
     /// Returns an equivalent circuit without REPEAT or SHIFT_COORDS instructions.
     Circuit flattened() const;
@@ -420,7 +427,22 @@ void read_tag(int &c, std::string_view name, SOURCE read_char, MonotonicBuffer<c
 }
 
 template <typename SOURCE>
-void read_parens_arguments(int &c, std::string_view name, SOURCE read_char, MonotonicBuffer<double> &out) {
+double read_parameter_arg(int &c, SOURCE read_char) {
+    std::string name;
+    while ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_') {
+        name.push_back((char)c);
+        c = read_char();
+    }
+    return circuit_parameter_arg(name);
+}
+
+/// Reads parens arguments like `(0.1, 2)` into the tail of the given buffer.
+///
+/// When `allow_parameters` is set, arguments can also be parameter names like `(p1)`, which are stored as the
+/// values returned by `circuit_parameter_arg`.
+template <typename SOURCE>
+void read_parens_arguments(
+    int &c, std::string_view name, SOURCE read_char, MonotonicBuffer<double> &out, bool allow_parameters = false) {
     if (c != '(') {
         return;
     }
@@ -428,7 +450,11 @@ void read_parens_arguments(int &c, std::string_view name, SOURCE read_char, Mono
 
     read_past_within_line_whitespace(c, read_char);
     while (true) {
-        out.append_tail(read_normal_double(c, read_char));
+        if (allow_parameters && ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_')) {
+            out.append_tail(read_parameter_arg(c, read_char));
+        } else {
+            out.append_tail(read_normal_double(c, read_char));
+        }
         read_past_within_line_whitespace(c, read_char);
         if (c != ',') {
             break;
@@ -53,10 +53,14 @@ std::string circuit_repr(const Circuit &self) {
 }
 
 std::vector<ExplainedError> circuit_shortest_graphlike_error(
-    const Circuit &self, bool ignore_ungraphlike_errors, bool reduce_to_representative) {
+    const Circuit &self, bool ignore_ungraphlike_errors, bool reduce_to_representative, size_t num_threads) {
+    if (num_threads == 0) {
+        throw std::invalid_argument("num_threads must be at least 1.");
+    }
     DetectorErrorModel dem =
         ErrorAnalyzer::circuit_to_detector_error_model(self, !ignore_ungraphlike_errors, true, false, 1, false, false);
-    DetectorErrorModel filter = shortest_graphlike_undetectable_logical_error(dem, ignore_ungraphlike_errors);
+    DetectorErrorModel filter =
+        shortest_graphlike_undetectable_logical_error(dem, ignore_ungraphlike_errors, num_threads);
     return ErrorMatcher::explain_errors_from_circuit(self, &filter, reduce_to_representative);
 }
 
@@ -65,13 +69,15 @@ std::vector<ExplainedError> py_find_undetectable_logical_error(
     size_t dont_explore_detection_event_sets_with_size_above,
     size_t dont_explore_edges_with_degree_above,
     bool dont_explore_edges_increasing_symptom_degree,
-    bool reduce_to_representative) {
+    bool reduce_to_representative,
+    std::optional<size_t> max_search_memory_bytes) {
     DetectorErrorModel dem = ErrorAnalyzer::circuit_to_detector_error_model(self, false, true, false, 1, false, false);
     DetectorErrorModel filter = stim::find_undetectable_logical_error(
         dem,
         dont_explore_detection_event_sets_with_size_above,
         dont_explore_edges_with_degree_above,
-        dont_explore_edges_increasing_symptom_degree);
+        dont_explore_edges_increasing_symptom_degree,
+        max_search_memory_bytes.value_or(SIZE_MAX));
     return ErrorMatcher::explain_errors_from_circuit(self, &filter, reduce_to_representative);
 }
 
@@ -388,6 +394,14 @@ uint64_t obj_to_abs_detector_id(const pybind11::handle &obj, bool fail) {
     throw std::invalid_argument(ss.str());
 }
 
+CircuitParameterBinding py_dict_to_circuit_parameter_binding(const pybind11::dict &values) {
+    CircuitParameterBinding result;
+    for (const auto &item : values) {
+        result.set(pybind11::cast<std::string>(item.first), pybind11::cast<double>(item.second));
+    }
+    return result;
+}
+
 std::set<uint64_t> obj_to_abs_detector_id_set(
     const pybind11::object &obj, const std::function<size_t(void)> &get_num_detectors) {
     std::set<uint64_t> filter;
@@ -592,8 +606,9 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
         pybind11::arg("skip_reference_sample") = false,
         pybind11::arg("seed") = pybind11::none(),
         pybind11::arg("reference_sample") = pybind11::none(),
+        pybind11::arg("parameters") = pybind11::none(),
         clean_doc_string(R"DOC(
-            @signature def compile_sampler(self, *, skip_reference_sample: bool = False, seed: Optional[int] = None, reference_sample: Optional[np.ndarray] = None) -> stim.CompiledMeasurementSampler:
+            @signature def compile_sampler(self, *, skip_reference_sample: bool = False, seed: Optional[int] = None, reference_sample: Optional[np.ndarray] = None, parameters: Optional[Dict[str, float]] = None) -> stim.CompiledMeasurementSampler:
             Returns an object that can quickly batch sample measurements from the circuit.
 
             Args:
@@ -645,6 +660,11 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
                     provided, the reference sample will be set to
                     `circuit.reference_sample()`, unless `skip_reference_sample=True`
                     is used, in which case it will be set to all-zeros.
+                parameters: Defaults to None. The values of named parameters used as
+                    noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as
+                    a dictionary from parameter name to value. The values are substituted
+                    into a copy of the circuit when the sampler is compiled. Every named
+                    parameter in the circuit must be given a value.
 
             Raises:
                 ValueError: skip_reference_sample is True and reference_sample is not None.
@@ -829,6 +849,7 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
         &py_init_compiled_detector_sampler,
         pybind11::kw_only(),
         pybind11::arg("seed") = pybind11::none(),
+        pybind11::arg("parameters") = pybind11::none(),
         clean_doc_string(R"DOC(
             Returns an object that can batch sample detection events from the circuit.
 
@@ -857,6 +878,11 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
                     CAUTION: simulation results *MAY NOT* be consistent if you vary how many
                     shots are taken. For example, taking 10 shots and then 90 shots will
                     give different results from taking 100 shots in one call.
+                parameters: Defaults to None. The values of named parameters used as
+                    noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as
+                    a dictionary from parameter name to value. The values are substituted
+                    into a copy of the circuit when the sampler is compiled. Every named
+                    parameter in the circuit must be given a value.
 
             Examples:
                 >>> import stim
@@ -1699,7 +1725,17 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
            bool allow_gauge_detectors,
            double approximate_disjoint_errors,
            bool ignore_decomposition_failures,
-           bool block_decomposition_from_introducing_remnant_edges) -> DetectorErrorModel {
+           bool block_decomposition_from_introducing_remnant_edges,
+           size_t num_threads,
+           const pybind11::object &parameters) -> DetectorErrorModel {
+            if (num_threads == 0) {
+                throw std::invalid_argument("num_threads must be at least 1.");
+            }
+            CircuitParameterBinding binding;
+            if (!parameters.is_none()) {
+                binding = py_dict_to_circuit_parameter_binding(pybind11::cast<pybind11::dict>(parameters));
+            }
+            pybind11::gil_scoped_release release;
             return ErrorAnalyzer::circuit_to_detector_error_model(
                 self,
                 decompose_errors,
@@ -1707,7 +1743,9 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
                 allow_gauge_detectors,
                 approximate_disjoint_errors,
                 ignore_decomposition_failures,
-                block_decomposition_from_introducing_remnant_edges);
+                block_decomposition_from_introducing_remnant_edges,
+                num_threads,
+                &binding);
         },
         pybind11::kw_only(),
         pybind11::arg("decompose_errors") = false,
@@ -1716,7 +1754,10 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
         pybind11::arg("approximate_disjoint_errors") = false,
         pybind11::arg("ignore_decomposition_failures") = false,
         pybind11::arg("block_decomposition_from_introducing_remnant_edges") = false,
+        pybind11::arg("num_threads") = 1,
+        pybind11::arg("parameters") = pybind11::none(),
         clean_doc_string(R"DOC(
+            @signature def detector_error_model(self, *, decompose_errors: bool = False, flatten_loops: bool = False, allow_gauge_detectors: bool = False, approximate_disjoint_errors: float = False, ignore_decomposition_failures: bool = False, block_decomposition_from_introducing_remnant_edges: bool = False, num_threads: int = 1, parameters: Optional[Dict[str, float]] = None) -> stim.DetectorErrorModel:
             Returns a stim.DetectorErrorModel describing the error processes in the circuit.
 
             Args:
@@ -1784,6 +1825,19 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
                     decoding).
 
                     Irrelevant unless decompose_errors=True.
+                num_threads: Defaults to 1. The number of threads to use when collecting
+                    the error mechanisms of the circuit. The circuit is split into time
+                    slices at its TICKs and the slices are analyzed concurrently. The
+                    resulting model is the same, up to floating point rounding of the
+                    combined error probabilities.
+                    The starting state of each slice comes from a sequential pass over
+                    the circuit, so the speedup is limited to about 2x regardless of the
+                    number of threads.
+                parameters: Defaults to None. The values of named parameters used as
+                    noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as a
+                    dictionary from parameter name to value. The values are substituted
+                    during the analysis, without copying the circuit. Every named
+                    parameter in the circuit must be given a value.
 
             Examples:
                 >>> import stim
@@ -1801,6 +1855,15 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
                     error(0.375) D0 D1
                     error(0.25) D1
                 ''')
+
+                >>> stim.Circuit('''
+                ...     X_ERROR(p) 0
+                ...     M(q) 0
+                ...     DETECTOR rec[-1]
+                ... ''').detector_error_model(parameters={'p': 0.125, 'q': 0})
+                stim.DetectorErrorModel('''
+                    error(0.125) D0
+                ''')
         )DOC")
             .data());
 
@@ -1950,6 +2013,7 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
         pybind11::kw_only(),
         pybind11::arg("ignore_ungraphlike_errors") = true,
         pybind11::arg("canonicalize_circuit_errors") = false,
+        pybind11::arg("num_threads") = 1,
         clean_doc_string(R"DOC(
             Finds a minimum set of graphlike errors to produce an undetected logical error.
 
@@ -1996,6 +2060,9 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
                         errors that are simpler (e.g. apply Paulis to fewer qubits). This
                         discards mostly-redundant information about different ways to
                         produce the same symptoms in order to give a succinct result.
+                num_threads: Defaults to 1. The number of threads used to expand each
+                    level of the breadth first search for the logical error. The result
+                    doesn't depend on the number of threads.
 
             Returns:
                 A list of error mechanisms that cause an undetected logical error.
@@ -2025,6 +2092,7 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
         pybind11::arg("dont_explore_edges_with_degree_above"),
         pybind11::arg("dont_explore_edges_increasing_symptom_degree"),
         pybind11::arg("canonicalize_circuit_errors") = false,
+        pybind11::arg("max_search_memory_bytes") = pybind11::none(),
         clean_doc_string(R"DOC(
             Searches for small sets of errors that form an undetectable logical error.
 
@@ -2089,6 +2157,11 @@ void stim_pybind::pybind_circuit_methods(pybind11::module &, pybind11::class_<Ci
                         errors that are simpler (e.g. apply Paulis to fewer qubits). This
                         discards mostly-redundant information about different ways to
                         produce the same symptoms in order to give a succinct result.
+                max_search_memory_bytes: Defaults to None (unlimited). Caps the memory used
+                    to remember the intermediate states of the search. Once the cap is
+                    reached, the search stops recording new intermediate states, but keeps
+                    looking for a logical error among the states it already has. If the
+                    search then fails, its error message says that the limit was reached.
 
             Returns:
                 A list of error mechanisms that cause an undetected logical error.
@@ -30,5 +30,6 @@ void pybind_circuit_methods_extra(pybind11::module &m, pybind11::class_<stim::Ci
 std::set<uint64_t> obj_to_abs_detector_id_set(
     const pybind11::object &obj, const std::function<size_t(void)> &get_num_detectors);
 std::string circuit_repr(const stim::Circuit &self);
+stim::CircuitParameterBinding py_dict_to_circuit_parameter_binding(const pybind11::dict &values);
 
 #endif
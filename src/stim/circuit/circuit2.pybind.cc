@@ -571,8 +571,7 @@ void stim_pybind::pybind_circuit_methods_extra(pybind11::module &, pybind11::cla
             if (unsigned_only) {
                 return check_if_circuit_has_unsigned_stabilizer_flows<MAX_BITWORD_WIDTH>(self, flows)[0];
             } else {
-                auto rng = externally_seeded_rng();
-                return sample_if_circuit_has_stabilizer_flows<MAX_BITWORD_WIDTH>(256, rng, self, flows)[0];
+                return check_if_circuit_has_stabilizer_flows<MAX_BITWORD_WIDTH>(self, flows)[0];
             }
         },
         pybind11::arg("flow"),
@@ -686,13 +685,6 @@ void stim_pybind::pybind_circuit_methods_extra(pybind11::module &, pybind11::cla
                 ...     unsigned=False,
                 ... )
                 False
-
-            Caveats:
-                Currently, the unsigned=False version of this method is implemented by
-                performing 256 randomized tests. Each test has a 50% chance of a false
-                positive, and a 0% chance of a false negative. So, when the method returns
-                True, there is technically still a 2^-256 chance the circuit doesn't have
-                the flow. This is lower than the chance of a cosmic ray flipping the result.
         )DOC")
             .data());
 
@@ -703,8 +695,7 @@ void stim_pybind::pybind_circuit_methods_extra(pybind11::module &, pybind11::cla
             if (unsigned_only) {
                 results = check_if_circuit_has_unsigned_stabilizer_flows<MAX_BITWORD_WIDTH>(self, flows);
             } else {
-                auto rng = externally_seeded_rng();
-                results = sample_if_circuit_has_stabilizer_flows<MAX_BITWORD_WIDTH>(256, rng, self, flows);
+                results = check_if_circuit_has_stabilizer_flows<MAX_BITWORD_WIDTH>(self, flows);
             }
             for (bool b : results) {
                 if (!b) {
@@ -759,13 +750,6 @@ void stim_pybind::pybind_circuit_methods_extra(pybind11::module &, pybind11::cla
                 ...     stim.Flow('Z -> X'),
                 ... ], unsigned=True)
                 True
-
-            Caveats:
-                Currently, the unsigned=False version of this method is implemented by
-                performing 256 randomized tests. Each test has a 50% chance of a false
-                positive, and a 0% chance of a false negative. So, when the method returns
-                True, there is technically still a 2^-256 chance the circuit doesn't have
-                the flow. This is lower than the chance of a cosmic ray flipping the result.
         )DOC")
             .data());
 
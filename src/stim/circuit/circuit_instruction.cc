@@ -15,6 +15,7 @@
 #include "stim/circuit/circuit_instruction.h"
 
 #include "stim/circuit/circuit.h"
+#include "stim/circuit/circuit_parameters.h"
 #include "stim/circuit/gate_target.h"
 #include "stim/gates/gates.h"
 #include "stim/util_bot/str_util.h"
@@ -168,9 +169,19 @@ void CircuitInstruction::validate() const {
             "Gate " + std::string(gate.name) + " takes no targets but was given targets" + targets_str(targets) + ".");
     }
 
+    if (!(gate.flags & GATE_ARGS_ARE_DISJOINT_PROBABILITIES) && has_circuit_parameter_args(args)) {
+        throw std::invalid_argument(
+            "Gate " + std::string(gate.name) +
+            " was given a named parameter, but only probability arguments can be named parameters.");
+    }
+
     if (gate.flags & GATE_ARGS_ARE_DISJOINT_PROBABILITIES) {
+        // Named parameters are checked once they have a value (see `CircuitParameterBinding::bind`).
         double total = 0;
         for (const auto p : args) {
+            if (is_circuit_parameter_arg(p)) {
+                continue;
+            }
             if (!(p >= 0 && p <= 1)) {
                 throw std::invalid_argument(
                     "Gate " + std::string(gate.name) + " only takes probability arguments, but one of its arguments (" +
@@ -304,13 +315,28 @@ uint64_t CircuitInstruction::count_measurement_results() const {
     return n;
 }
 
+/// Compares arguments by value, except for named parameters which are compared by name.
+static bool args_equal(SpanRef<const double> a, SpanRef<const double> b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t k = 0; k < a.size(); k++) {
+        if (a[k] != b[k] && !(is_circuit_parameter_arg(a[k]) && memcmp(&a[k], &b[k], sizeof(double)) == 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool CircuitInstruction::can_fuse(const CircuitInstruction &other) const {
     auto flags = GATE_DATA[gate_type].flags;
-    return gate_type == other.gate_type && args == other.args && !(flags & GATE_IS_NOT_FUSABLE) && tag == other.tag;
+    return gate_type == other.gate_type && args_equal(args, other.args) && !(flags & GATE_IS_NOT_FUSABLE) &&
+           tag == other.tag;
 }
 
 bool CircuitInstruction::operator==(const CircuitInstruction &other) const {
-    return gate_type == other.gate_type && args == other.args && targets == other.targets && tag == other.tag;
+    return gate_type == other.gate_type && args_equal(args, other.args) && targets == other.targets &&
+           tag == other.tag;
 }
 bool CircuitInstruction::approx_equals(const CircuitInstruction &other, double atol) const {
     if (gate_type != other.gate_type || targets != other.targets || args.size() != other.args.size() ||
@@ -318,7 +344,11 @@ bool CircuitInstruction::approx_equals(const CircuitInstruction &other, double a
         return false;
     }
     for (size_t k = 0; k < args.size(); k++) {
-        if (fabs(args[k] - other.args[k]) > atol) {
+        if (is_circuit_parameter_arg(args[k]) || is_circuit_parameter_arg(other.args[k])) {
+            if (memcmp(&args[k], &other.args[k], sizeof(double)) != 0) {
+                return false;
+            }
+        } else if (fabs(args[k] - other.args[k]) > atol) {
             return false;
         }
     }
@@ -345,7 +375,9 @@ std::ostream &stim::operator<<(std::ostream &out, const CircuitInstruction &inst
             } else {
                 out << ", ";
             }
-            if (e > (double)INT64_MIN && e < (double)INT64_MAX && (int64_t)e == e) {
+            if (is_circuit_parameter_arg(e)) {
+                out << circuit_parameter_name(e);
+            } else if (e > (double)INT64_MIN && e < (double)INT64_MAX && (int64_t)e == e) {
                 out << (int64_t)e;
             } else {
                 out << e;
@@ -0,0 +1,141 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/circuit/circuit_parameters.h"
+
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+using namespace stim;
+
+/// The names of parameters, numbered in the order they were first used. Shared by all circuits, so that parameter
+/// arguments keep their meaning when instructions are copied from one circuit to another.
+struct CircuitParameterNames {
+    std::mutex mut;
+    /// A deque, because growing it doesn't move the strings that `ids` refers to.
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, uint32_t> ids;
+};
+
+static CircuitParameterNames &parameter_names() {
+    static CircuitParameterNames result;
+    return result;
+}
+
+static bool is_reserved_parameter_name(std::string_view name) {
+    std::string lower;
+    for (char c : name) {
+        lower.push_back((char)tolower(c));
+    }
+    return lower == "nan" || lower == "inf" || lower == "infinity";
+}
+
+static bool is_valid_parameter_name(std::string_view name) {
+    if (name.empty() || (name[0] >= '0' && name[0] <= '9')) {
+        return false;
+    }
+    for (char c : name) {
+        if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_')) {
+            return false;
+        }
+    }
+    return !is_reserved_parameter_name(name);
+}
+
+static uint32_t parameter_id(double arg) {
+    uint64_t bits;
+    memcpy(&bits, &arg, sizeof(bits));
+    return (uint32_t)bits;
+}
+
+double stim::circuit_parameter_arg(std::string_view name) {
+    if (!is_valid_parameter_name(name)) {
+        throw std::invalid_argument(
+            "'" + std::string(name) +
+            "' isn't a valid parameter name. Parameter names start with a letter or underscore, contain only "
+            "letters, digits, and underscores, and can't be 'nan' or 'inf'.");
+    }
+
+    auto &table = parameter_names();
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(table.mut);
+        auto p = table.ids.find(name);
+        if (p == table.ids.end()) {
+            if (table.names.size() > UINT32_MAX) {
+                throw std::invalid_argument("Too many distinct parameter names were used.");
+            }
+            id = (uint32_t)table.names.size();
+            table.names.emplace_back(name);
+            table.ids.emplace(table.names.back(), id);
+        } else {
+            id = p->second;
+        }
+    }
+
+    uint64_t bits = CIRCUIT_PARAMETER_ARG_MARKER | id;
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+std::string_view stim::circuit_parameter_name(double arg) {
+    if (!is_circuit_parameter_arg(arg)) {
+        throw std::invalid_argument("Not a parameter argument: " + std::to_string(arg));
+    }
+    auto &table = parameter_names();
+    std::lock_guard<std::mutex> lock(table.mut);
+    return table.names[parameter_id(arg)];
+}
+
+void CircuitParameterBinding::set(std::string_view name, double value) {
+    if (std::isnan(value) || std::isinf(value)) {
+        throw std::invalid_argument(
+            "The value of parameter '" + std::string(name) + "' isn't a real number: " + std::to_string(value));
+    }
+    uint32_t id = parameter_id(circuit_parameter_arg(name));
+    if (id >= values.size()) {
+        values.resize(id + 1, NAN);
+    }
+    values[id] = value;
+}
+
+double CircuitParameterBinding::resolve(double arg) const {
+    if (!is_circuit_parameter_arg(arg)) {
+        return arg;
+    }
+    uint32_t id = parameter_id(arg);
+    if (id >= values.size() || std::isnan(values[id])) {
+        throw std::invalid_argument(
+            "No value was given for the parameter '" + std::string(circuit_parameter_name(arg)) + "'.");
+    }
+    return values[id];
+}
+
+CircuitInstruction CircuitParameterBinding::bind(const CircuitInstruction &inst, std::vector<double> &arg_buf) const {
+    if (!has_circuit_parameter_args(inst.args)) {
+        return inst;
+    }
+    arg_buf.clear();
+    for (double arg : inst.args) {
+        arg_buf.push_back(resolve(arg));
+    }
+    CircuitInstruction result(inst.gate_type, arg_buf, inst.targets, inst.tag);
+    result.validate();
+    return result;
+}
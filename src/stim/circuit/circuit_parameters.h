@@ -0,0 +1,106 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_CIRCUIT_CIRCUIT_PARAMETERS_H
+#define _STIM_CIRCUIT_CIRCUIT_PARAMETERS_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "stim/circuit/circuit_instruction.h"
+#include "stim/mem/span_ref.h"
+
+namespace stim {
+
+/// The high bits of the arguments that stand in for named parameters. The bits make a quiet NaN with a payload that
+/// arithmetic never produces, and the low 32 bits hold the id of the parameter's name.
+constexpr uint64_t CIRCUIT_PARAMETER_ARG_MARKER = 0x7FFD5EED00000000ULL;
+
+/// Returns the argument that stands in for a named parameter, such as the `p1` in `DEPOLARIZE1(p1) 0`.
+///
+/// The argument can be stored in an instruction's argument list and copied between circuits like any other
+/// argument. Every call with the same name returns the same value.
+///
+/// The names are kept in a process-global table, so that arguments keep their meaning across circuits. Names are
+/// never removed from it, so the table grows with each distinct name used during the life of the process (and
+/// there can be at most 2^32 of them). Parse circuits with a fixed vocabulary of names, rather than generating new
+/// names per circuit.
+///
+/// Args:
+///     name: The parameter's name. Must start with a letter or underscore, and contain only letters, digits, and
+///         underscores. The names "nan", "inf", and "infinity" (in any case) are reserved.
+///
+/// Returns:
+///     A NaN whose payload identifies the name.
+double circuit_parameter_arg(std::string_view name);
+
+/// Determines if an argument stands in for a named parameter, as opposed to being a number.
+inline bool is_circuit_parameter_arg(double arg) {
+    uint64_t bits;
+    memcpy(&bits, &arg, sizeof(bits));
+    return (bits & 0xFFFFFFFF00000000ULL) == CIRCUIT_PARAMETER_ARG_MARKER;
+}
+
+/// Determines if any of the given arguments stand in for named parameters.
+inline bool has_circuit_parameter_args(SpanRef<const double> args) {
+    for (double arg : args) {
+        if (is_circuit_parameter_arg(arg)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Returns the name of the parameter that an argument stands in for.
+std::string_view circuit_parameter_name(double arg);
+
+/// Values for the named parameters used by a circuit's instructions.
+///
+/// Simulators and analyzers that accept a binding substitute the values into each instruction as they reach it, so
+/// the same circuit can be evaluated at many noise strengths without regenerating, reparsing, or copying it.
+struct CircuitParameterBinding {
+    /// The value of each parameter, indexed by the id of its name. NaN marks a parameter without a value.
+    std::vector<double> values;
+
+    /// Sets the value of a named parameter.
+    void set(std::string_view name, double value);
+
+    /// Returns the value of an argument, looking it up if it stands in for a named parameter.
+    ///
+    /// Throws:
+    ///     std::invalid_argument: The argument is a parameter without a value.
+    double resolve(double arg) const;
+
+    /// Returns the instruction with its parameter arguments replaced by their values.
+    ///
+    /// Instructions without parameter arguments are returned as is. Otherwise the result's arguments point into the
+    /// given buffer, so the result is only valid until the buffer is next modified, and it is checked to be valid
+    /// with the substituted values.
+    ///
+    /// Args:
+    ///     inst: The instruction to bind.
+    ///     arg_buf: Storage for the substituted arguments.
+    ///
+    /// Returns:
+    ///     An instruction without parameter arguments.
+    CircuitInstruction bind(const CircuitInstruction &inst, std::vector<double> &arg_buf) const;
+};
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,140 @@
+#include "stim/circuit/circuit_parameters.h"
+
+#include "gtest/gtest.h"
+
+#include "stim/circuit/circuit.h"
+#include "stim/dem/detector_error_model.h"
+
+using namespace stim;
+
+static bool same_bits(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+TEST(circuit_parameters, parameter_arg) {
+    double p1 = circuit_parameter_arg("p1");
+    ASSERT_TRUE(std::isnan(p1));
+    ASSERT_TRUE(is_circuit_parameter_arg(p1));
+    ASSERT_TRUE(same_bits(p1, circuit_parameter_arg("p1")));
+    ASSERT_FALSE(same_bits(p1, circuit_parameter_arg("p2")));
+    ASSERT_EQ(circuit_parameter_name(p1), "p1");
+    ASSERT_EQ(circuit_parameter_name(circuit_parameter_arg("_Noise_2")), "_Noise_2");
+
+    ASSERT_FALSE(is_circuit_parameter_arg(0.5));
+    ASSERT_FALSE(is_circuit_parameter_arg(NAN));
+    ASSERT_FALSE(is_circuit_parameter_arg(INFINITY));
+    ASSERT_THROW({ circuit_parameter_name(0.5); }, std::invalid_argument);
+
+    ASSERT_THROW({ circuit_parameter_arg(""); }, std::invalid_argument);
+    ASSERT_THROW({ circuit_parameter_arg("2p"); }, std::invalid_argument);
+    ASSERT_THROW({ circuit_parameter_arg("p-q"); }, std::invalid_argument);
+    ASSERT_THROW({ circuit_parameter_arg("nan"); }, std::invalid_argument);
+    ASSERT_THROW({ circuit_parameter_arg("Inf"); }, std::invalid_argument);
+}
+
+TEST(circuit_parameters, binding_resolve) {
+    CircuitParameterBinding binding;
+    binding.set("a", 0.25);
+    ASSERT_EQ(binding.resolve(circuit_parameter_arg("a")), 0.25);
+    ASSERT_EQ(binding.resolve(0.5), 0.5);
+    ASSERT_THROW({ binding.resolve(circuit_parameter_arg("b")); }, std::invalid_argument);
+
+    binding.set("a", 0.125);
+    ASSERT_EQ(binding.resolve(circuit_parameter_arg("a")), 0.125);
+    ASSERT_THROW({ binding.set("a", NAN); }, std::invalid_argument);
+    ASSERT_THROW({ binding.set("5", 0.1); }, std::invalid_argument);
+}
+
+TEST(circuit_parameters, binding_bind) {
+    Circuit circuit("PAULI_CHANNEL_1(px, 0.125, pz) 0 1\nX_ERROR(0.25) 2");
+    CircuitParameterBinding binding;
+    binding.set("px", 0.5);
+    binding.set("pz", 0.375);
+
+    std::vector<double> arg_buf;
+    auto bound = binding.bind(circuit.operations[0], arg_buf);
+    ASSERT_EQ(bound.gate_type, GateType::PAULI_CHANNEL_1);
+    ASSERT_EQ(std::vector<double>(bound.args.begin(), bound.args.end()), (std::vector<double>{0.5, 0.125, 0.375}));
+    ASSERT_EQ(bound.targets, circuit.operations[0].targets);
+    ASSERT_EQ(bound.args.ptr_start, arg_buf.data());
+
+    auto unchanged = binding.bind(circuit.operations[1], arg_buf);
+    ASSERT_EQ(unchanged.args.ptr_start, circuit.operations[1].args.ptr_start);
+
+    // The bound values must make a valid instruction.
+    binding.set("pz", 0.5);
+    ASSERT_THROW({ binding.bind(circuit.operations[0], arg_buf); }, std::invalid_argument);
+    binding.set("px", -0.5);
+    ASSERT_THROW({ binding.bind(circuit.operations[0], arg_buf); }, std::invalid_argument);
+    ASSERT_THROW({ CircuitParameterBinding().bind(circuit.operations[0], arg_buf); }, std::invalid_argument);
+}
+
+TEST(circuit_parameters, with_parameters_bound) {
+    Circuit circuit(R"CIRCUIT(
+        X_ERROR(p) 0
+        REPEAT 3 {
+            DEPOLARIZE1(q) 1
+            M 0 1
+        }
+    )CIRCUIT");
+    ASSERT_TRUE(circuit.has_parameter_args());
+    ASSERT_FALSE(Circuit("X_ERROR(0.25) 0\nREPEAT 2 {\n M 0\n}").has_parameter_args());
+    ASSERT_FALSE(Circuit().has_parameter_args());
+
+    CircuitParameterBinding binding;
+    binding.set("p", 0.25);
+    binding.set("q", 0.125);
+    Circuit bound = circuit.with_parameters_bound(binding);
+    ASSERT_EQ(bound, Circuit(R"CIRCUIT(
+        X_ERROR(0.25) 0
+        REPEAT 3 {
+            DEPOLARIZE1(0.125) 1
+            M 0 1
+        }
+    )CIRCUIT"));
+    ASSERT_FALSE(bound.has_parameter_args());
+    ASSERT_TRUE(circuit.has_parameter_args());
+
+    binding = CircuitParameterBinding();
+    binding.set("p", 0.25);
+    ASSERT_THROW({ circuit.with_parameters_bound(binding); }, std::invalid_argument);
+}
+
+TEST(circuit_parameters, parse_and_print) {
+    Circuit circuit(R"CIRCUIT(
+        DEPOLARIZE1(p1) 0
+        DEPOLARIZE1(p1) 1
+        DEPOLARIZE1(p2) 2
+        PAULI_CHANNEL_1( px , 0.1,pz) 0
+        M(p_m) 0
+        MPP(p_m) X0*X1
+        HERALDED_ERASE(e) 3
+    )CIRCUIT");
+    ASSERT_EQ(circuit.operations.size(), 6);
+    ASSERT_EQ(circuit.str(), R"CIRCUIT(DEPOLARIZE1(p1) 0 1
+DEPOLARIZE1(p2) 2
+PAULI_CHANNEL_1(px, 0.1, pz) 0
+M(p_m) 0
+MPP(p_m) X0*X1
+HERALDED_ERASE(e) 3)CIRCUIT");
+    ASSERT_EQ(Circuit(circuit.str()), circuit);
+    ASSERT_EQ(circuit, circuit);
+    ASSERT_NE(Circuit("X_ERROR(p) 0"), Circuit("X_ERROR(q) 0"));
+    ASSERT_NE(Circuit("X_ERROR(p) 0"), Circuit("X_ERROR(0.1) 0"));
+    ASSERT_TRUE(Circuit("X_ERROR(p) 0").approx_equals(Circuit("X_ERROR(p) 0"), 1e-5));
+    ASSERT_FALSE(Circuit("X_ERROR(p) 0").approx_equals(Circuit("X_ERROR(q) 0"), 1e-5));
+    ASSERT_FALSE(Circuit("X_ERROR(p) 0").approx_equals(Circuit("X_ERROR(0.1) 0"), 1e-5));
+
+    // Copies keep their parameters.
+    Circuit copy;
+    copy.safe_append(circuit.operations[0]);
+    ASSERT_EQ(copy, Circuit("DEPOLARIZE1(p1) 0 1"));
+
+    // Only probabilities can be parameters.
+    ASSERT_THROW({ Circuit("DETECTOR(x) rec[-1]"); }, std::invalid_argument);
+    ASSERT_THROW({ Circuit("OBSERVABLE_INCLUDE(k) rec[-1]"); }, std::invalid_argument);
+    ASSERT_THROW({ Circuit("QUBIT_COORDS(x, 1) 0"); }, std::invalid_argument);
+    ASSERT_THROW({ Circuit("X_ERROR(nan) 0"); }, std::invalid_argument);
+    ASSERT_THROW({ Circuit("X_ERROR(p q) 0"); }, std::invalid_argument);
+    ASSERT_THROW({ DetectorErrorModel("error(p) D0"); }, std::invalid_argument);
+}
@@ -714,6 +714,19 @@ def test_shortest_graphlike_error_empty():
         stim.Circuit().shortest_graphlike_error()
 
 
+def test_shortest_graphlike_error_num_threads():
+    c = stim.Circuit.generated(
+        "repetition_code:memory",
+        rounds=10,
+        distance=7,
+        before_round_data_depolarization=0.01)
+    expected = c.shortest_graphlike_error()
+    assert len(expected) == 7
+    assert c.shortest_graphlike_error(num_threads=3) == expected
+    with pytest.raises(ValueError, match="num_threads"):
+        c.shortest_graphlike_error(num_threads=0)
+
+
 def test_shortest_graphlike_error_msgs():
     with pytest.raises(
             ValueError,
@@ -771,6 +784,28 @@ def test_search_for_undetectable_logical_errors_empty():
         )
 
 
+def test_search_for_undetectable_logical_errors_max_search_memory_bytes():
+    circuit = stim.Circuit.generated(
+        "surface_code:rotated_memory_x",
+        rounds=5,
+        distance=5,
+        after_clifford_depolarization=0.001)
+    assert len(circuit.search_for_undetectable_logical_errors(
+        dont_explore_detection_event_sets_with_size_above=4,
+        dont_explore_edges_with_degree_above=4,
+        dont_explore_edges_increasing_symptom_degree=True,
+        max_search_memory_bytes=2**30,
+    )) == 5
+
+    with pytest.raises(ValueError, match="MEMORY LIMIT REACHED"):
+        circuit.search_for_undetectable_logical_errors(
+            dont_explore_detection_event_sets_with_size_above=4,
+            dont_explore_edges_with_degree_above=4,
+            dont_explore_edges_increasing_symptom_degree=True,
+            max_search_memory_bytes=1000,
+        )
+
+
 def test_search_for_undetectable_logical_errors_msgs():
     with pytest.raises(ValueError, match=r"NO OBSERVABLES(.|\n)*NO DETECTORS"):
         stim.Circuit().search_for_undetectable_logical_errors(
@@ -1733,6 +1768,28 @@ def test_has_flow_shorthands():
         stim.Flow("iX_ -> XX")
 
 
+def test_has_all_flows_many_flows():
+    c = stim.Circuit.generated(
+        "surface_code:rotated_memory_x",
+        distance=5,
+        rounds=5,
+        after_clifford_depolarization=0.001,
+    )
+    flows = c.flow_generators()
+    assert c.has_all_flows(flows)
+    for f in flows[::7]:
+        assert c.has_flow(f)
+        flipped = stim.Flow(
+            input=f.input_copy(),
+            output=-f.output_copy(),
+            measurements=f.measurements_copy(),
+            included_observables=f.included_observables_copy(),
+        )
+        assert not c.has_flow(flipped)
+        assert c.has_flow(flipped, unsigned=True)
+        assert not c.has_all_flows(flows + [flipped])
+
+
 def test_decomposed():
     assert stim.Circuit("""
         ISWAP 0 1 2 1
@@ -2435,3 +2492,63 @@ def test_append_odd_types():
         CX rec[-1] 3
         MPP X0*Y1*Z2 X0*X1
     """)
+
+
+def test_named_parameters():
+    circuit = stim.Circuit("""
+        R 0 1
+        X_ERROR(p) 0
+        REPEAT 2 {
+            DEPOLARIZE2(p2) 0 1
+            M(q) 0 1
+            DETECTOR rec[-1]
+            DETECTOR rec[-2]
+        }
+    """)
+    assert "X_ERROR(p) 0" in str(circuit)
+    assert circuit == stim.Circuit(str(circuit))
+
+    literal = stim.Circuit("""
+        R 0 1
+        X_ERROR(0.125) 0
+        REPEAT 2 {
+            DEPOLARIZE2(0.01) 0 1
+            M(0.0625) 0 1
+            DETECTOR rec[-1]
+            DETECTOR rec[-2]
+        }
+    """)
+    parameters = {'p': 0.125, 'p2': 0.01, 'q': 0.0625}
+    assert circuit.detector_error_model(parameters=parameters) == literal.detector_error_model()
+    with pytest.raises(ValueError, match="'q'"):
+        circuit.detector_error_model(parameters={'p': 0.125, 'p2': 0.01})
+    with pytest.raises(ValueError, match="No value was given"):
+        circuit.detector_error_model()
+    with pytest.raises(ValueError, match="named parameter"):
+        stim.Circuit("DETECTOR(x) rec[-1]")
+
+
+def test_named_parameters_sampling():
+    circuit = stim.Circuit("""
+        X_ERROR(p) 0
+        M 0
+        DETECTOR rec[-1]
+    """)
+    m = circuit.compile_sampler(parameters={'p': 1}).sample(shots=3)
+    np.testing.assert_array_equal(m, [[True]] * 3)
+    m = stim.CompiledMeasurementSampler(circuit, parameters={'p': 0}).sample(shots=3)
+    np.testing.assert_array_equal(m, [[False]] * 3)
+    d = circuit.compile_detector_sampler(parameters={'p': 1}).sample(shots=3)
+    np.testing.assert_array_equal(d, [[True]] * 3)
+    d = stim.CompiledDetectorSampler(circuit, parameters={'p': 0}).sample(shots=3)
+    np.testing.assert_array_equal(d, [[False]] * 3)
+    with pytest.raises(ValueError, match="'p'"):
+        circuit.compile_detector_sampler(parameters={'q': 1})
+
+    sim = stim.FlipSimulator(batch_size=2, disable_stabilizer_randomization=True)
+    sim.do(circuit, parameters={'p': 1})
+    sim.do(circuit[0], parameters={'p': 1})
+    sim.do(circuit, parameters={'p': 0})
+    np.testing.assert_array_equal(sim.get_measurement_flips(), [[True, True], [False, False]])
+    with pytest.raises(ValueError, match="'p'"):
+        sim.do(circuit)
@@ -31,6 +31,7 @@ int stim::command_analyze_errors(int argc, const char **argv) {
             "--ignore_decomposition_failures",
             "--in",
             "--out",
+            "--threads",
         },
         {"--analyze_errors", "--detector_hypergraph"},
         "analyze_errors",
@@ -42,6 +43,7 @@ int stim::command_analyze_errors(int argc, const char **argv) {
     bool ignore_decomposition_failures = find_bool_argument("--ignore_decomposition_failures", argc, argv);
     bool block_decompose_from_introducing_remnant_edges =
         find_bool_argument("--block_decompose_from_introducing_remnant_edges", argc, argv);
+    size_t num_threads = (size_t)find_int64_argument("--threads", 1, 1, 4096, argc, argv);
 
     const char *approximate_disjoint_errors_arg = find_argument("--approximate_disjoint_errors", argc, argv);
     float approximate_disjoint_errors_threshold;
@@ -66,7 +68,8 @@ int stim::command_analyze_errors(int argc, const char **argv) {
                allow_gauge_detectors,
                approximate_disjoint_errors_threshold,
                ignore_decomposition_failures,
-               block_decompose_from_introducing_remnant_edges)
+               block_decompose_from_introducing_remnant_edges,
+               num_threads)
         << "\n";
     return EXIT_SUCCESS;
 }
@@ -435,5 +438,33 @@ SubCommandHelp stim::command_analyze_errors_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--threads",
+            "int",
+            "1",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Specifies how many threads to use when analyzing the circuit.
+
+            Defaults to 1.
+
+            The circuit is cut at its TICK instructions into time slices. A
+            quick backwards pass computes which detectors each qubit is
+            sensitive to at the end of every slice, and then the error
+            mechanisms inside the slices are collected in parallel. Loops are
+            still solved one at a time, but the instructions inside and between
+            them are split into slices.
+
+            The output is the same as when using a single thread, except that
+            the probabilities of error mechanisms that occur in several slices
+            can differ in the last few digits due to floating point rounding.
+
+            The backwards pass is sequential, and each slice is walked again by
+            the thread collecting its errors, so the speedup is limited to about
+            2x regardless of the number of threads.
+        )PARAGRAPH"),
+        });
+
     return result;
 }
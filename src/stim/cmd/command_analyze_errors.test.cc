@@ -181,3 +181,27 @@ Circuit stack trace:
             R"OUTPUT([0m]
 )OUTPUT"));
 }
+
+TEST(command_analyze_errors, analyze_errors_threads) {
+    const char *circuit = R"input(
+R 0 1
+X_ERROR(0.125) 0
+TICK
+CX 0 1
+X_ERROR(0.125) 0
+TICK
+REPEAT 10 {
+    X_ERROR(0.25) 1
+    TICK
+    M 1
+    DETECTOR rec[-1]
+}
+M(0.25) 0
+DETECTOR rec[-1]
+            )input";
+    auto expected = run_captured_stim_main({"analyze_errors", "--fold_loops"}, circuit);
+    ASSERT_EQ(run_captured_stim_main({"analyze_errors", "--fold_loops", "--threads", "3"}, circuit), expected);
+    ASSERT_EQ(
+        run_captured_stim_main({"analyze_errors", "--threads", "3"}, circuit),
+        run_captured_stim_main({"analyze_errors"}, circuit));
+}
@@ -349,7 +349,7 @@ SubCommandHelp stim::command_convert_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--in_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -363,6 +363,7 @@ SubCommandHelp stim::command_convert_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -373,7 +374,7 @@ SubCommandHelp stim::command_convert_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -387,6 +388,7 @@ SubCommandHelp stim::command_convert_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -397,7 +399,7 @@ SubCommandHelp stim::command_convert_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--obs_out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -413,6 +415,7 @@ SubCommandHelp stim::command_convert_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -25,7 +25,15 @@ using namespace stim;
 
 int stim::command_detect(int argc, const char **argv) {
     check_for_unknown_arguments(
-        {"--seed", "--shots", "--append_observables", "--out_format", "--out", "--in", "--obs_out", "--obs_out_format"},
+        {"--seed",
+         "--shots",
+         "--append_observables",
+         "--out_format",
+         "--out",
+         "--in",
+         "--obs_out",
+         "--obs_out_format",
+         "--threads"},
         {"--detect", "--prepend_observables"},
         "detect",
         argc,
@@ -42,6 +50,7 @@ int stim::command_detect(int argc, const char **argv) {
         find_argument("--shots", argc, argv)    ? (uint64_t)find_int64_argument("--shots", 1, 0, INT64_MAX, argc, argv)
         : find_argument("--detect", argc, argv) ? (uint64_t)find_int64_argument("--detect", 1, 0, INT64_MAX, argc, argv)
                                                 : 1;
+    size_t num_threads = (size_t)find_int64_argument("--threads", 1, 1, 4096, argc, argv);
     if (out_format.id == SampleFormat::SAMPLE_FORMAT_DETS && !append_observables) {
         prepend_observables = true;
     }
@@ -74,7 +83,8 @@ int stim::command_detect(int argc, const char **argv) {
         out_format.id,
         rng,
         obs_out.f,
-        obs_out_format.id);
+        obs_out_format.id,
+        num_threads);
     return EXIT_SUCCESS;
 }
 
@@ -132,7 +142,7 @@ SubCommandHelp stim::command_detect_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -146,6 +156,7 @@ SubCommandHelp stim::command_detect_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -210,6 +221,27 @@ SubCommandHelp stim::command_detect_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--threads",
+            "int",
+            "1",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Specifies how many threads to use when sampling.
+
+            Defaults to 1.
+
+            Each thread gets its own frame simulator and works on its own
+            batches of shots, while sharing the parsed circuit. Batches are
+            written to the output in order, so the output file has the same
+            layout as when sampling with a single thread.
+
+            When `--seed` is specified, the output depends on the seed but not
+            on the number of threads.
+        )PARAGRAPH"),
+        });
+
     result.flags.push_back(
         SubCommandHelpFlag{
             "--append_observables",
@@ -265,7 +297,7 @@ SubCommandHelp stim::command_detect_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--obs_out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -281,6 +313,7 @@ SubCommandHelp stim::command_detect_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
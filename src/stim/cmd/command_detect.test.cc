@@ -232,3 +232,40 @@ TEST(command_detect, seeded_detecting) {
                 DETECTOR rec[-1]
             )input"));
 }
+
+TEST(command_detect, threads) {
+    const char *circuit = R"input(
+        X_ERROR(0.1) 0 1 2
+        M 0 1 2
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+        OBSERVABLE_INCLUDE(0) rec[-3]
+    )input";
+    auto out1 = run_captured_stim_main({"detect", "--shots=5000", "--seed=5", "--append_observables"}, circuit);
+    auto out2 =
+        run_captured_stim_main({"detect", "--shots=5000", "--seed=5", "--threads=2", "--append_observables"}, circuit);
+    auto out3 =
+        run_captured_stim_main({"detect", "--shots=5000", "--seed=5", "--threads=3", "--append_observables"}, circuit);
+    ASSERT_EQ(out1, out2);
+    ASSERT_EQ(out2, out3);
+    ASSERT_EQ(out2.size(), 5000 * 4);
+    size_t ones = 0;
+    for (size_t k = 0; k < out2.size(); k += 4) {
+        ASSERT_EQ(out2[k + 3], '\n');
+        ones += (out2[k] == '1') + (out2[k + 1] == '1') + (out2[k + 2] == '1');
+    }
+    ASSERT_TRUE(1200 < ones && ones < 1800) << ones;
+
+    std::string expected;
+    for (size_t k = 0; k < 1500; k++) {
+        expected += "1\n";
+    }
+    ASSERT_EQ(
+        run_captured_stim_main({"detect", "--shots=1500", "--threads=4", "--out_format=hits"}, R"input(
+            X_ERROR(1) 0
+            M 0 1
+            DETECTOR rec[-1]
+            DETECTOR rec[-2]
+        )input"),
+        expected);
+}
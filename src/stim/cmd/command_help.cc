@@ -527,6 +527,9 @@ or even self-identifying information like a header with magic bytes.
 They produce *raw* data.
 Even details about which bits are measurements, which are detection events,
 and which are observable frame changes must be determined from context.
+The exception is the '`stbc`' format, a container whose chunk headers
+record the number of shots, the number of each kind of bit in each shot,
+and checksums of the data.
 
 The major driver for having multiple formats is context-dependent preferences for
 binary-vs-human-readable and dense-vs-sparse.
@@ -22,6 +22,7 @@ int stim::command_m2d(int argc, const char **argv) {
             "--sweep_format",
             "--obs_out",
             "--obs_out_format",
+            "--threads",
             "--ran_without_feedback",
         },
         {
@@ -37,6 +38,7 @@ int stim::command_m2d(int argc, const char **argv) {
     bool append_observables = find_bool_argument("--append_observables", argc, argv);
     bool skip_reference_sample = find_bool_argument("--skip_reference_sample", argc, argv);
     bool ran_without_feedback = find_bool_argument("--ran_without_feedback", argc, argv);
+    size_t num_threads = (size_t)find_int64_argument("--threads", 1, 1, 4096, argc, argv);
     FILE *circuit_file = find_open_file_argument("--circuit", nullptr, "rb", argc, argv);
     auto circuit = Circuit::from_file(circuit_file);
     fclose(circuit_file);
@@ -66,7 +68,8 @@ int stim::command_m2d(int argc, const char **argv) {
         append_observables,
         skip_reference_sample,
         obs_out,
-        obs_out_format.id);
+        obs_out_format.id,
+        num_threads);
     if (in != stdin) {
         fclose(in);
     }
@@ -131,7 +134,7 @@ SubCommandHelp stim::command_m2d_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -145,6 +148,7 @@ SubCommandHelp stim::command_m2d_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -177,7 +181,7 @@ SubCommandHelp stim::command_m2d_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--obs_out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -193,6 +197,7 @@ SubCommandHelp stim::command_m2d_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -203,7 +208,7 @@ SubCommandHelp stim::command_m2d_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--in_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -217,6 +222,7 @@ SubCommandHelp stim::command_m2d_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -251,7 +257,7 @@ SubCommandHelp stim::command_m2d_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--sweep_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -265,6 +271,7 @@ SubCommandHelp stim::command_m2d_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -397,5 +404,23 @@ SubCommandHelp stim::command_m2d_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--threads",
+            "int",
+            "1",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Specifies how many threads to use when converting.
+
+            Defaults to 1.
+
+            Measurement data is read in batches of shots. Each thread converts
+            one batch at a time, while reading the input and writing the output
+            stay sequential and in order. The output is identical regardless of
+            the number of threads.
+        )PARAGRAPH"),
+        });
+
     return result;
 }
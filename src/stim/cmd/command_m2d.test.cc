@@ -181,3 +181,34 @@ TEST(command_m2d, unphysical_observable_annotations) {
         trim("000\n000\n011\n"));
     ASSERT_EQ(tmp_obs.read_contents(), "00\n00\n00\n");
 }
+
+TEST(command_m2d, threads) {
+    RaiiTempNamedFile tmp(R"CIRCUIT(
+        X 0
+        M 0 1
+        DETECTOR rec[-2]
+        DETECTOR rec[-1]
+        OBSERVABLE_INCLUDE(2) rec[-1]
+    )CIRCUIT");
+
+    std::string input;
+    std::string expected;
+    for (size_t k = 0; k < 5000; k++) {
+        input += k % 3 ? "01\n" : "10\n";
+        expected += k % 3 ? "shot D0 D1 L2\n" : "shot\n";
+    }
+    for (const char *threads : {"--threads=1", "--threads=2", "--threads=3"}) {
+        ASSERT_EQ(
+            run_captured_stim_main(
+                {"m2d",
+                 "--in_format=01",
+                 "--out_format=dets",
+                 "--circuit",
+                 tmp.path.c_str(),
+                 "--append_observables",
+                 threads},
+                input),
+            expected)
+            << threads;
+    }
+}
@@ -27,7 +27,14 @@ using namespace stim;
 
 int stim::command_sample(int argc, const char **argv) {
     check_for_unknown_arguments(
-        {"--seed", "--skip_reference_sample", "--skip_loop_folding", "--out_format", "--out", "--in", "--shots"},
+        {"--seed",
+         "--skip_reference_sample",
+         "--skip_loop_folding",
+         "--out_format",
+         "--out",
+         "--in",
+         "--shots",
+         "--threads"},
         {"--sample", "--frame0"},
         "sample",
         argc,
@@ -39,6 +46,7 @@ int stim::command_sample(int argc, const char **argv) {
         find_argument("--shots", argc, argv)    ? (uint64_t)find_int64_argument("--shots", 1, 0, INT64_MAX, argc, argv)
         : find_argument("--sample", argc, argv) ? (uint64_t)find_int64_argument("--sample", 1, 0, INT64_MAX, argc, argv)
                                                 : 1;
+    size_t num_threads = (size_t)find_int64_argument("--threads", 1, 1, 4096, argc, argv);
     if (num_shots == 0) {
         return EXIT_SUCCESS;
     }
@@ -66,7 +74,8 @@ int stim::command_sample(int argc, const char **argv) {
                 reference_sample_measurement_bits.decompress_into(ref);
             }
         }
-        sample_batch_measurements_writing_results_to_disk(circuit, ref, num_shots, out, out_format.id, rng);
+        sample_batch_measurements_writing_results_to_disk(
+            circuit, ref, num_shots, out, out_format.id, rng, num_threads);
     }
 
     if (in != stdin) {
@@ -170,7 +179,7 @@ SubCommandHelp stim::command_sample_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -184,6 +193,7 @@ SubCommandHelp stim::command_sample_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -248,6 +258,28 @@ SubCommandHelp stim::command_sample_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--threads",
+            "int",
+            "1",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Specifies how many threads to use when sampling.
+
+            Defaults to 1.
+
+            Each thread gets its own frame simulator and works on its own
+            batches of shots, while sharing the parsed circuit and the
+            reference sample. Batches are written to the output in order, so
+            the output file has the same layout as when sampling with a single
+            thread.
+
+            When `--seed` is specified, the output depends on the seed but not
+            on the number of threads.
+        )PARAGRAPH"),
+        });
+
     result.flags.push_back(
         SubCommandHelpFlag{
             "--in",
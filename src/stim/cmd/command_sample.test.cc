@@ -416,3 +416,24 @@ TEST(command_sample, seeded_sampling) {
                 M 0
             )input"));
 }
+
+TEST(command_sample, threads) {
+    const char *circuit = R"input(
+        X 1
+        X_ERROR(0.25) 0
+        M 0 1
+    )input";
+    auto out1 = run_captured_stim_main({"sample", "--shots=5000", "--seed=5"}, circuit);
+    auto out2 = run_captured_stim_main({"sample", "--shots=5000", "--seed=5", "--threads=2"}, circuit);
+    auto out3 = run_captured_stim_main({"sample", "--shots=5000", "--seed=5", "--threads=3"}, circuit);
+    ASSERT_EQ(out1, out2);
+    ASSERT_EQ(out2, out3);
+    ASSERT_EQ(out2.size(), 5000 * 3);
+    size_t ones = 0;
+    for (size_t k = 0; k < out2.size(); k += 3) {
+        ASSERT_EQ(out2[k + 1], '1');
+        ASSERT_EQ(out2[k + 2], '\n');
+        ones += out2[k] == '1';
+    }
+    ASSERT_TRUE(1000 < ones && ones < 1500) << ones;
+}
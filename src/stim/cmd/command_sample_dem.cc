@@ -36,6 +36,7 @@ int stim::command_sample_dem(int argc, const char **argv) {
             "--err_out_format",
             "--replay_err_in",
             "--replay_err_in_format",
+            "--threads",
         },
         {},
         "sample_dem",
@@ -47,6 +48,7 @@ int stim::command_sample_dem(int argc, const char **argv) {
     const auto &err_in_format =
         find_enum_argument("--replay_err_in_format", "01", format_name_to_enum_map(), argc, argv);
     uint64_t num_shots = find_int64_argument("--shots", 1, 0, INT64_MAX, argc, argv);
+    size_t num_threads = (size_t)find_int64_argument("--threads", 1, 1, 4096, argc, argv);
 
     RaiiFile in(find_open_file_argument("--in", stdin, "rb", argc, argv));
     RaiiFile out(find_open_file_argument("--out", stdout, "wb", argc, argv));
@@ -85,7 +87,8 @@ int stim::command_sample_dem(int argc, const char **argv) {
         err_out.f,
         err_out_format.id,
         err_in.f,
-        err_in_format.id);
+        err_in_format.id,
+        num_threads);
 
     return EXIT_SUCCESS;
 }
@@ -150,7 +153,7 @@ SubCommandHelp stim::command_sample_dem_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--replay_err_in_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -166,6 +169,7 @@ SubCommandHelp stim::command_sample_dem_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -193,7 +197,7 @@ SubCommandHelp stim::command_sample_dem_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--err_out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -209,6 +213,7 @@ SubCommandHelp stim::command_sample_dem_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -241,7 +246,7 @@ SubCommandHelp stim::command_sample_dem_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--obs_out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -257,6 +262,7 @@ SubCommandHelp stim::command_sample_dem_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -267,7 +273,7 @@ SubCommandHelp stim::command_sample_dem_help() {
     result.flags.push_back(
         SubCommandHelpFlag{
             "--out_format",
-            "01|b8|r8|ptb64|hits|dets",
+            "01|b8|r8|ptb64|hits|dets|stbc",
             "01",
             {"[none]", "format"},
             clean_doc_string(R"PARAGRAPH(
@@ -281,6 +287,7 @@ SubCommandHelp stim::command_sample_dem_help() {
                 ptb64: partially transposed bit packed binary for SIMD
                 hits: sparse human readable
                 dets: sparse human readable with type hints
+                stbc: checksummed binary chunks with metadata
 
             For a detailed description of each result format, see the result
             format reference:
@@ -345,6 +352,27 @@ SubCommandHelp stim::command_sample_dem_help() {
         )PARAGRAPH"),
         });
 
+    result.flags.push_back(
+        SubCommandHelpFlag{
+            "--threads",
+            "int",
+            "1",
+            {"[none]", "int"},
+            clean_doc_string(R"PARAGRAPH(
+            Specifies how many threads to use when sampling.
+
+            Defaults to 1.
+
+            Each thread gets its own sample buffers and works on its own
+            batches of shots, while sharing the parsed detector error model.
+            Batches are written to the outputs in order, so the output files
+            have the same layout as when sampling with a single thread.
+
+            When `--seed` is specified, the output depends on the seed but not
+            on the number of threads.
+        )PARAGRAPH"),
+        });
+
     result.flags.push_back(
         SubCommandHelpFlag{
             "--in",
@@ -52,3 +52,23 @@ TEST(main, sample_dem) {
             )output"));
     ASSERT_EQ(obs_out.read_contents(), "001\n001\n001\n001\n001\n");
 }
+
+TEST(command_sample_dem, threads) {
+    const char *dem = R"input(
+        error(0.1) D0 D1
+        error(0.25) D2 L0
+    )input";
+    auto out1 = run_captured_stim_main({"sample_dem", "--shots=5000", "--seed=5"}, dem);
+    auto out2 = run_captured_stim_main({"sample_dem", "--shots=5000", "--seed=5", "--threads=2"}, dem);
+    auto out3 = run_captured_stim_main({"sample_dem", "--shots=5000", "--seed=5", "--threads=3"}, dem);
+    ASSERT_EQ(out1, out2);
+    ASSERT_EQ(out2, out3);
+    ASSERT_EQ(out2.size(), 5000 * 4);
+    size_t hits = 0;
+    for (size_t k = 0; k < out2.size(); k += 4) {
+        ASSERT_EQ(out2[k], out2[k + 1]);
+        ASSERT_EQ(out2[k + 3], '\n');
+        hits += out2[k + 2] == '1';
+    }
+    ASSERT_TRUE(1000 < hits && hits < 1500) << hits;
+}
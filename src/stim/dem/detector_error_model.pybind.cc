@@ -782,8 +782,15 @@ void stim_pybind::pybind_detector_error_model_methods(
 
     c.def(
         "shortest_graphlike_error",
-        &shortest_graphlike_undetectable_logical_error,
+        [](const DetectorErrorModel &self, bool ignore_ungraphlike_errors, size_t num_threads) {
+            if (num_threads == 0) {
+                throw std::invalid_argument("num_threads must be at least 1.");
+            }
+            return shortest_graphlike_undetectable_logical_error(self, ignore_ungraphlike_errors, num_threads);
+        },
         pybind11::arg("ignore_ungraphlike_errors") = true,
+        pybind11::kw_only(),
+        pybind11::arg("num_threads") = 1,
         clean_doc_string(R"DOC(
             Finds a minimum set of graphlike errors to produce an undetected logical error.
 
@@ -824,6 +831,9 @@ void stim_pybind::pybind_detector_error_model_methods(
                     not graphlike, not decomposed into graphlike components:
                         error(0.1) D0 D1 D2
                         error(0.1) D0 D1 D2 ^ D3
+                num_threads: Defaults to 1. The number of threads used to expand each
+                    level of the breadth first search. The result doesn't depend on the
+                    number of threads.
 
             Returns:
                 A detector error model containing just the error instructions corresponding
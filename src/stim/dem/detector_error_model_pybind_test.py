@@ -274,6 +274,19 @@ def test_shortest_graphlike_error_rep_code():
     assert len(model.shortest_graphlike_error()) == 7
 
 
+def test_shortest_graphlike_error_num_threads():
+    circuit = stim.Circuit.generated("surface_code:rotated_memory_x",
+                                     rounds=5,
+                                     distance=5,
+                                     after_clifford_depolarization=0.001)
+    model = circuit.detector_error_model(decompose_errors=True)
+    expected = model.shortest_graphlike_error()
+    assert len(expected) == 5
+    assert model.shortest_graphlike_error(num_threads=4) == expected
+    with pytest.raises(ValueError, match="num_threads"):
+        model.shortest_graphlike_error(num_threads=0)
+
+
 def test_shortest_graphlike_error_msgs():
     with pytest.raises(ValueError, match=r"NO OBSERVABLES(.|\n)*NO DETECTORS(.|\n)*NO ERRORS"):
         stim.Circuit().detector_error_model(decompose_errors=True).shortest_graphlike_error()
@@ -0,0 +1,59 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/io/buffered_file_input.h"
+
+#include <cstring>
+
+using namespace stim;
+
+BufferedFileInput::BufferedFileInput(FILE *file, size_t block_size) : file(file), buf(block_size), start(0), end(0) {
+}
+
+BufferedFileInput::~BufferedFileInput() {
+    if (file != nullptr && start < end) {
+        fseek(file, -(long)(end - start), SEEK_CUR);
+    }
+}
+
+bool BufferedFileInput::refill(size_t num_bytes) {
+    if (end - start >= num_bytes) {
+        return true;
+    }
+
+    // Move the unconsumed bytes to the front of the buffer, making room behind them.
+    size_t kept = end - start;
+    if (start > 0) {
+        memmove(buf.data(), buf.data() + start, kept);
+        start = 0;
+        end = kept;
+    }
+    if (buf.size() < num_bytes) {
+        buf.resize(num_bytes);
+    }
+
+    while (end < num_bytes) {
+        size_t n = fread(buf.data() + end, 1, buf.size() - end, file);
+        if (n == 0) {
+            return false;
+        }
+        end += n;
+    }
+    return true;
+}
+
+void BufferedFileInput::discard_buffer() {
+    start = 0;
+    end = 0;
+}
@@ -0,0 +1,89 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _STIM_IO_BUFFERED_FILE_INPUT_H
+#define _STIM_IO_BUFFERED_FILE_INPUT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace stim {
+
+/// Reads bytes from a FILE* in large blocks, instead of with one library call per byte.
+///
+/// Bytes that were read ahead, but not consumed, are handed back to the file when this
+/// object is destroyed (by seeking backwards). This allows another reader to continue
+/// from where this one stopped, as long as the file is seekable. Bytes read ahead from
+/// a non-seekable stream (e.g. a pipe) are lost when this object is destroyed, so a
+/// single reader should be used to consume such streams.
+///
+/// If the underlying file is repositioned by other code (e.g. using `rewind`), any
+/// buffered bytes are still returned first. Call `discard_buffer` to avoid this.
+struct BufferedFileInput {
+    FILE *file;
+    std::vector<uint8_t> buf;
+    size_t start;
+    size_t end;
+
+    explicit BufferedFileInput(FILE *file, size_t block_size = size_t{1} << 16);
+    BufferedFileInput(const BufferedFileInput &other) = delete;
+    BufferedFileInput &operator=(const BufferedFileInput &other) = delete;
+    ~BufferedFileInput();
+
+    /// Returns the next byte, or EOF, and advances past it. Same semantics as `getc`.
+    inline int get() {
+        if (start == end && !refill(1)) {
+            return EOF;
+        }
+        return buf[start++];
+    }
+
+    /// Returns the next byte, or EOF, without advancing.
+    inline int peek() {
+        if (start == end && !refill(1)) {
+            return EOF;
+        }
+        return buf[start];
+    }
+
+    /// Returns a pointer to the unconsumed buffered bytes.
+    inline const uint8_t *data() const {
+        return buf.data() + start;
+    }
+
+    /// Returns the number of unconsumed buffered bytes.
+    inline size_t available() const {
+        return end - start;
+    }
+
+    /// Marks the given number of buffered bytes as consumed.
+    inline void consume(size_t num_bytes) {
+        start += num_bytes;
+    }
+
+    /// Tries to make at least the given number of bytes contiguously available.
+    ///
+    /// Returns:
+    ///     True: `available() >= num_bytes`.
+    ///     False: The file ended before that many bytes could be buffered.
+    bool refill(size_t num_bytes);
+
+    /// Forgets any buffered bytes, without returning them to the file.
+    void discard_buffer();
+};
+
+}  // namespace stim
+
+#endif
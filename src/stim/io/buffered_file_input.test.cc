@@ -0,0 +1,75 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/io/buffered_file_input.h"
+
+#include "gtest/gtest.h"
+
+using namespace stim;
+
+static FILE *file_with_contents(std::string_view contents) {
+    FILE *f = tmpfile();
+    fwrite(contents.data(), 1, contents.size(), f);
+    rewind(f);
+    return f;
+}
+
+TEST(BufferedFileInput, get_and_peek) {
+    FILE *f = file_with_contents("abc");
+    BufferedFileInput in(f, 2);
+    ASSERT_EQ(in.peek(), 'a');
+    ASSERT_EQ(in.get(), 'a');
+    ASSERT_EQ(in.get(), 'b');
+    ASSERT_EQ(in.peek(), 'c');
+    ASSERT_EQ(in.get(), 'c');
+    ASSERT_EQ(in.peek(), EOF);
+    ASSERT_EQ(in.get(), EOF);
+    ASSERT_EQ(in.get(), EOF);
+    fclose(f);
+}
+
+TEST(BufferedFileInput, refill) {
+    FILE *f = file_with_contents("abcdefgh");
+    BufferedFileInput in(f, 3);
+    ASSERT_TRUE(in.refill(2));
+    ASSERT_EQ(in.get(), 'a');
+
+    // Growing past the block size keeps the unconsumed bytes.
+    ASSERT_TRUE(in.refill(6));
+    ASSERT_GE(in.available(), 6);
+    ASSERT_EQ(std::string((const char *)in.data(), 6), "bcdefg");
+    in.consume(6);
+
+    ASSERT_FALSE(in.refill(2));
+    ASSERT_EQ(in.available(), 1);
+    ASSERT_EQ(in.get(), 'h');
+    fclose(f);
+}
+
+TEST(BufferedFileInput, returns_unconsumed_bytes_to_file) {
+    FILE *f = file_with_contents("abcdef");
+    {
+        BufferedFileInput in(f);
+        ASSERT_EQ(in.get(), 'a');
+        ASSERT_EQ(in.get(), 'b');
+    }
+    ASSERT_EQ(getc(f), 'c');
+    {
+        BufferedFileInput in(f);
+        ASSERT_EQ(in.get(), 'd');
+        in.discard_buffer();
+    }
+    ASSERT_EQ(getc(f), EOF);
+    fclose(f);
+}
@@ -46,7 +46,8 @@ void MeasureRecordBatch<W>::reserve_space_for_results(size_t count) {
 }
 
 template <size_t W>
-void MeasureRecordBatch<W>::reserve_noisy_space_for_results(const CircuitInstruction &inst, std::mt19937_64 &rng) {
+template <typename RNG>
+void MeasureRecordBatch<W>::reserve_noisy_space_for_results(const CircuitInstruction &inst, RNG &rng) {
     size_t count = inst.targets.size();
     reserve_space_for_results(count);
     float p = inst.args.empty() ? 0 : inst.args[0];
@@ -150,6 +151,7 @@ template <size_t W>
 void MeasureRecordBatch<W>::clear() {
     stored = 0;
     unwritten = 0;
+    written = 0;
 }
 
 template <size_t W>
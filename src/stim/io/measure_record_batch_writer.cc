@@ -20,7 +20,8 @@
 
 using namespace stim;
 
-MeasureRecordBatchWriter::MeasureRecordBatchWriter(FILE *out, size_t num_shots, SampleFormat output_format)
+MeasureRecordBatchWriter::MeasureRecordBatchWriter(
+    FILE *out, size_t num_shots, SampleFormat output_format, size_t max_held_bytes)
     : output_format(output_format), out(out) {
     if (num_shots > 768) {
         throw std::out_of_range("num_shots > 768 (safety check to ensure staying away from linux file handle limit)");
@@ -38,23 +39,13 @@ MeasureRecordBatchWriter::MeasureRecordBatchWriter(FILE *out, size_t num_shots,
     if (s) {
         writers.push_back(MeasureRecordWriter::make(out, f));
     }
+    size_t spill_threshold = std::max(max_held_bytes / std::max(s, size_t{1}), size_t{1} << 12);
     for (size_t k = 1; k < s; k++) {
-        FILE *file = tmpfile();
-        if (file == nullptr) {
-            throw std::out_of_range("Failed to open a temp file.");
-        }
-        writers.push_back(MeasureRecordWriter::make(file, f));
-        temporary_files.push_back(file);
+        writers.push_back(MeasureRecordWriter::make(nullptr, f));
+        writers.back()->out.spill_threshold = spill_threshold;
     }
 }
 
-MeasureRecordBatchWriter::~MeasureRecordBatchWriter() {
-    for (auto &e : temporary_files) {
-        fclose(e);
-    }
-    temporary_files.clear();
-}
-
 void MeasureRecordBatchWriter::begin_result_type(char result_type) {
     for (auto &e : writers) {
         e->begin_result_type(result_type);
@@ -64,18 +55,9 @@ void MeasureRecordBatchWriter::begin_result_type(char result_type) {
 void MeasureRecordBatchWriter::write_end() {
     for (auto &writer : writers) {
         writer->write_end();
+        writer->flush();
     }
-
-    for (FILE *file : temporary_files) {
-        rewind(file);
-        while (true) {
-            int c = getc(file);
-            if (c == EOF) {
-                break;
-            }
-            putc(c, out);
-        }
-        fclose(file);
+    for (size_t k = 1; k < writers.size(); k++) {
+        writers[k]->out.move_to(out);
     }
-    temporary_files.clear();
 }
@@ -26,15 +26,19 @@ namespace stim {
 struct MeasureRecordBatchWriter {
     SampleFormat output_format;
     FILE *out;
-    /// Temporary files used to hold data that will eventually be concatenated onto the main stream.
-    std::vector<FILE *> temporary_files;
     /// The individual writers for each incoming stream of measurement results.
-    /// The first writer will go directly to `out`, whereas the others go into temporary files.
+    /// The first writer will go directly to `out`, whereas the others hold their data in memory
+    /// (spilling into temporary files if it gets too large) until it's concatenated onto `out`.
     std::vector<std::unique_ptr<MeasureRecordWriter>> writers;
 
-    MeasureRecordBatchWriter(FILE *out, size_t num_shots, SampleFormat output_format);
-    /// Cleans up temporary files.
-    ~MeasureRecordBatchWriter();
+    /// Args:
+    ///     out: Where to write the concatenated data.
+    ///     num_shots: The number of streams of measurement results.
+    ///     output_format: The format to write the data in.
+    ///     max_held_bytes: Roughly how many bytes the writers that aren't going directly to `out` may
+    ///         hold in memory, in total, before they start spilling into temporary files.
+    MeasureRecordBatchWriter(
+        FILE *out, size_t num_shots, SampleFormat output_format, size_t max_held_bytes = size_t{1} << 26);
     /// See MeasureRecordWriter::begin_result_type.
     void begin_result_type(char result_type);
 
@@ -73,8 +77,8 @@ struct MeasureRecordBatchWriter {
     void batch_write_bytes(const simd_bit_table<W> &table, size_t num_major_u64) {
         if (output_format == SampleFormat::SAMPLE_FORMAT_PTB64) {
             for (size_t k = 0; k < writers.size(); k++) {
-                for (size_t w = 0; w < num_major_u64; w++) {
-                    uint8_t *p = table.data.u8 + (k * 8) + table.num_minor_u8_padded() * w;
+                for (size_t m = 0; m < num_major_u64 * 64; m++) {
+                    uint8_t *p = table.data.u8 + (k * 8) + table.num_minor_u8_padded() * m;
                     writers[k]->write_bytes({p, p + 8});
                 }
             }
@@ -42,3 +42,28 @@ TEST_EACH_WORD_SIZE_W(MeasureRecordBatchWriter, basic_usage, {
     ASSERT_EQ(getc(tmp), '0');
     ASSERT_EQ(getc(tmp), '\n');
 })
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordBatchWriter, spills_large_shots_to_temporary_files, {
+    for (auto format :
+         {SampleFormat::SAMPLE_FORMAT_01, SampleFormat::SAMPLE_FORMAT_B8, SampleFormat::SAMPLE_FORMAT_PTB64}) {
+        size_t num_shots = 128;
+        size_t num_measurements = 1 << 16;
+        auto rng = INDEPENDENT_TEST_RNG();
+        auto table = simd_bit_table<W>::random(num_measurements, num_shots, rng);
+
+        auto write_with_held_limit = [&](size_t max_held_bytes) {
+            RaiiTempNamedFile tmp;
+            FILE *f = fopen(tmp.path.c_str(), "wb");
+            MeasureRecordBatchWriter w(f, num_shots, format, max_held_bytes);
+            w.batch_write_bytes<W>(table, num_measurements >> 6);
+            w.write_end();
+            fclose(f);
+            return tmp.read_contents();
+        };
+
+        auto in_memory = write_with_held_limit(size_t{1} << 30);
+        auto spilled = write_with_held_limit(1);
+        ASSERT_EQ(in_memory, spilled);
+        ASSERT_GE(in_memory.size(), num_shots * num_measurements / 8);
+    }
+})
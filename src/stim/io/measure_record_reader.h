@@ -19,7 +19,9 @@
 
 #include <memory>
 
+#include "stim/io/buffered_file_input.h"
 #include "stim/io/sparse_shot.h"
+#include "stim/io/stbc_format.h"
 #include "stim/io/stim_data_formats.h"
 #include "stim/mem/simd_bit_table.h"
 #include "stim/mem/span_ref.h"
@@ -50,11 +52,33 @@ inline bool read_uint64(FILE *in, uint64_t &value, int &next, bool include_next
     return true;
 }
 
+// Same as the FILE* overload, but reading from a buffered input.
+inline bool read_uint64(BufferedFileInput &in, uint64_t &value, int &next, bool include_next = false) {
+    if (!include_next) {
+        next = in.get();
+    }
+    if (!isdigit(next)) {
+        return false;
+    }
+
+    value = 0;
+    while (isdigit(next)) {
+        uint64_t prev_value = value;
+        value *= 10;
+        value += next - '0';
+        if (value < prev_value) {
+            throw std::runtime_error("Integer value read from file was too big");
+        }
+        next = in.get();
+    }
+    return true;
+}
+
 /// Handles reading measurement data from the outside world.
 ///
 /// Child classes implement the various input formats. Each file format encodes a certain number of records.
 /// Each record is a sequence of 0s and 1s. File formats B8 and R8 encode a single record. File formats 01,
-/// HITS and DETS encode any number of records. Record size in bits is fixed for each file and the client
+/// HITS, DETS and STBC encode any number of records. Record size in bits is fixed for each file and the client
 /// must specify it upfront.
 ///
 /// The template parameter, W, represents the SIMD width.
@@ -172,6 +196,18 @@ struct MeasureRecordReader {
 
    protected:
     void move_obs_in_shots_to_mask_assuming_sorted(SparseShot &shot);
+
+    /// Writes a group of up to 64 records into a table with a minor shot index, 64x64 bits at a time.
+    ///
+    /// Args:
+    ///     rows: The records. Record s starts at `rows + s * row_stride`. Bits past the end of a record are ignored.
+    ///     row_stride: The number of words from the start of one record to the start of the next.
+    ///     num_rows: The number of records in the group. At most 64.
+    ///     out_table: The table to write into. The group covers whole words of each minor axis, so shots
+    ///         past the end of the group (but inside its words) are zero'd.
+    ///     shot_offset: Where the group starts along the minor axis. Must be a multiple of 64.
+    void write_record_group_into_table_with_minor_shot_index(
+        const uint64_t *rows, size_t row_stride, size_t num_rows, simd_bit_table<W> &out_table, size_t shot_offset);
 };
 
 template <size_t W>
@@ -181,6 +217,8 @@ struct MeasureRecordReaderFormatPTB64 : MeasureRecordReader<W> {
     // The uint64_t for index k of shot s is stored in the buffer at offset k*64 + s.
     simd_bits<W> buf;
     size_t num_unread_shots_in_buf;
+    // This buffer stores a group of 64 shots, exactly as encoded, for bulk reads into tables.
+    simd_bits<W> group_buf;
 
     MeasureRecordReaderFormatPTB64(FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables);
 
@@ -192,11 +230,15 @@ struct MeasureRecordReaderFormatPTB64 : MeasureRecordReader<W> {
 
    private:
     bool load_cache();
+    /// Reads the next group of 64 shots into `group_buf`, returning false at the end of the data.
+    bool read_group();
 };
 
 template <size_t W>
 struct MeasureRecordReaderFormat01 : MeasureRecordReader<W> {
-    FILE *in;
+    BufferedFileInput in;
+    // Scratch space holding up to 64 records, each padded to a multiple of 64 bits.
+    simd_bits<W> record_buf;
 
     MeasureRecordReaderFormat01(FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables);
 
@@ -206,6 +248,7 @@ struct MeasureRecordReaderFormat01 : MeasureRecordReader<W> {
     size_t read_into_table_with_minor_shot_index(simd_bit_table<W> &out_table, size_t max_shots) override;
 
    private:
+    bool read_record_bytes(uint8_t *out);
     template <typename SAW0, typename SAW1>
     bool start_and_read_entire_record_helper(SAW0 saw0, SAW1 saw1);
 };
@@ -213,6 +256,8 @@ struct MeasureRecordReaderFormat01 : MeasureRecordReader<W> {
 template <size_t W>
 struct MeasureRecordReaderFormatB8 : MeasureRecordReader<W> {
     FILE *in;
+    // Scratch space holding up to 64 records, each padded to a multiple of 64 bits.
+    simd_bits<W> record_buf;
 
     MeasureRecordReaderFormatB8(FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables);
 
@@ -224,7 +269,7 @@ struct MeasureRecordReaderFormatB8 : MeasureRecordReader<W> {
 
 template <size_t W>
 struct MeasureRecordReaderFormatHits : MeasureRecordReader<W> {
-    FILE *in;
+    BufferedFileInput in;
 
     MeasureRecordReaderFormatHits(FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables);
 
@@ -240,7 +285,7 @@ struct MeasureRecordReaderFormatHits : MeasureRecordReader<W> {
 
 template <size_t W>
 struct MeasureRecordReaderFormatR8 : MeasureRecordReader<W> {
-    FILE *in;
+    BufferedFileInput in;
 
     MeasureRecordReaderFormatR8(FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables);
 
@@ -256,7 +301,7 @@ struct MeasureRecordReaderFormatR8 : MeasureRecordReader<W> {
 
 template <size_t W>
 struct MeasureRecordReaderFormatDets : MeasureRecordReader<W> {
-    FILE *in;
+    BufferedFileInput in;
 
     MeasureRecordReaderFormatDets(
         FILE *in, size_t num_measurements, size_t num_detectors = 0, size_t num_observables = 0);
@@ -271,6 +316,35 @@ struct MeasureRecordReaderFormatDets : MeasureRecordReader<W> {
     bool start_and_read_entire_record_helper(HANDLE_HIT handle_hit);
 };
 
+/// Reads the stbc format (see stim/io/stbc_format.h).
+///
+/// Chunks are decoded one at a time into a buffer of bit packed records, and records are served from
+/// that buffer. Only the total number of bits in each record has to match the reader's expectations;
+/// the split between measurements, detectors, and observables stated by the chunk headers is not checked.
+template <size_t W>
+struct MeasureRecordReaderFormatSTBC : MeasureRecordReader<W> {
+    FILE *in;
+    // The raw payload of the current chunk.
+    std::vector<uint8_t> payload;
+    // The records of the current chunk, each bit packed into whole bytes.
+    std::vector<uint8_t> chunk_records;
+    size_t num_chunk_records;
+    size_t next_chunk_record;
+    // Scratch space holding up to 64 records, each padded to a multiple of 64 bits.
+    simd_bits<W> record_buf;
+
+    MeasureRecordReaderFormatSTBC(FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables);
+
+    bool start_and_read_entire_record(simd_bits_range_ref<W> dirty_out_buffer) override;
+    bool start_and_read_entire_record(SparseShot &cleared_out) override;
+    bool expects_empty_serialized_data_for_each_shot() const override;
+    size_t read_into_table_with_minor_shot_index(simd_bit_table<W> &out_table, size_t max_shots) override;
+
+   private:
+    /// Makes sure there's an unread record in `chunk_records`, returning false at the end of the data.
+    bool load_chunk_if_needed();
+};
+
 template <size_t W>
 size_t read_file_data_into_shot_table(
     FILE *in,
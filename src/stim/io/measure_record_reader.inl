@@ -15,6 +15,8 @@
  */
 
 #include <algorithm>
+#include <bit>
+#include <cstring>
 
 #include "stim/io/measure_record_reader.h"
 
@@ -29,6 +31,11 @@ template <size_t W>
 size_t MeasureRecordReader<W>::read_records_into(
     simd_bit_table<W> &out, bool major_index_is_shot_index, size_t max_shots) {
     if (!major_index_is_shot_index) {
+        max_shots = std::min(max_shots, out.num_minor_bits_padded());
+        if (max_shots % 64 == 0) {
+            // Every format can fill whole 64 shot words directly, so there's no need to transpose.
+            return read_into_table_with_minor_shot_index(out, max_shots);
+        }
         simd_bit_table<W> buf(out.num_minor_bits_padded(), out.num_major_bits_padded());
         size_t r = read_records_into(buf, true, max_shots);
         buf.transpose_into(out);
@@ -65,6 +72,9 @@ std::unique_ptr<MeasureRecordReader<W>> MeasureRecordReader<W>::make(
         case SampleFormat::SAMPLE_FORMAT_R8:
             return std::make_unique<MeasureRecordReaderFormatR8<W>>(
                 in, num_measurements, num_detectors, num_observables);
+        case SampleFormat::SAMPLE_FORMAT_STBC:
+            return std::make_unique<MeasureRecordReaderFormatSTBC<W>>(
+                in, num_measurements, num_detectors, num_observables);
         default:
             throw std::invalid_argument("Sample format not recognized by MeasurementRecordReader");
     }
@@ -97,6 +107,22 @@ void MeasureRecordReader<W>::move_obs_in_shots_to_mask_assuming_sorted(SparseSho
     }
 }
 
+template <size_t W>
+void MeasureRecordReader<W>::write_record_group_into_table_with_minor_shot_index(
+    const uint64_t *rows, size_t row_stride, size_t num_rows, simd_bit_table<W> &out_table, size_t shot_offset) {
+    size_t n = bits_per_record();
+    uint64_t block[64];
+    for (size_t b = 0; b * 64 < n; b++) {
+        for (size_t s = 0; s < 64; s++) {
+            block[s] = s < num_rows ? rows[s * row_stride + b] : 0;
+        }
+        inplace_transpose_64x64(block, 1);
+        for (size_t k = 0; k < 64 && b * 64 + k < n; k++) {
+            out_table[b * 64 + k].u64[shot_offset >> 6] = block[k];
+        }
+    }
+}
+
 template <size_t W>
 size_t MeasureRecordReader<W>::read_into_table_with_major_shot_index(simd_bit_table<W> &out_table, size_t max_shots) {
     size_t read_shots = 0;
@@ -111,18 +137,12 @@ size_t MeasureRecordReader<W>::read_into_table_with_major_shot_index(simd_bit_ta
 template <size_t W>
 MeasureRecordReaderFormat01<W>::MeasureRecordReaderFormat01(
     FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables)
-    : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables), in(in) {
+    : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables), in(in), record_buf(0) {
 }
 
 template <size_t W>
 bool MeasureRecordReaderFormat01<W>::start_and_read_entire_record(simd_bits_range_ref<W> dirty_out_buffer) {
-    return start_and_read_entire_record_helper(
-        [&](size_t k) {
-            dirty_out_buffer[k] = false;
-        },
-        [&](size_t k) {
-            dirty_out_buffer[k] = true;
-        });
+    return read_record_bytes(dirty_out_buffer.u8);
 }
 
 template <size_t W>
@@ -130,12 +150,23 @@ bool MeasureRecordReaderFormat01<W>::start_and_read_entire_record(SparseShot &cl
     if (cleared_out.obs_mask.num_bits_padded() < this->num_observables) {
         cleared_out.obs_mask = simd_bits<64>(this->num_observables);
     }
-    bool result = start_and_read_entire_record_helper(
-        [&](size_t k) {
-        },
-        [&](size_t k) {
-            cleared_out.hits.push_back((uint64_t)k);
-        });
+    size_t n = this->bits_per_record();
+    size_t n64 = (n + 63) >> 6;
+    if (record_buf.num_u64_padded() < n64) {
+        record_buf = simd_bits<W>(n64 << 6);
+    }
+    record_buf.clear();
+    bool result = read_record_bytes(record_buf.u8);
+    for (size_t k = 0; k < n64; k++) {
+        uint64_t v = record_buf.u64[k];
+        while (v) {
+            size_t bit = (k << 6) + std::countr_zero(v);
+            if (bit < n) {
+                cleared_out.hits.push_back((uint64_t)bit);
+            }
+            v &= v - 1;
+        }
+    }
     this->move_obs_in_shots_to_mask_assuming_sorted(cleared_out);
     return result;
 }
@@ -148,29 +179,93 @@ bool MeasureRecordReaderFormat01<W>::expects_empty_serialized_data_for_each_shot
 template <size_t W>
 size_t MeasureRecordReaderFormat01<W>::read_into_table_with_minor_shot_index(
     simd_bit_table<W> &out_table, size_t max_shots) {
+    // Records are parsed 64 at a time into rows, then transposed 64x64 bits at a time into the table.
+    size_t n = this->bits_per_record();
+    size_t n64 = (n + 63) >> 6;
+    if (record_buf.num_u64_padded() < n64 * 64) {
+        record_buf = simd_bits<W>(n64 * 64 * 64);
+    }
+
     size_t read_shots = 0;
     while (read_shots < max_shots) {
-        bool more = start_and_read_entire_record_helper(
-            [&](size_t k) {
-                out_table[k][read_shots] &= 0;
-            },
-            [&](size_t k) {
-                out_table[k][read_shots] |= 1;
-            });
-        if (!more) {
+        size_t group_size = std::min(max_shots - read_shots, size_t{64});
+        size_t num_read = 0;
+        while (num_read < group_size && read_record_bytes(record_buf.u8 + num_read * n64 * 8)) {
+            num_read++;
+        }
+        if (num_read == 0) {
+            break;
+        }
+        this->write_record_group_into_table_with_minor_shot_index(
+            record_buf.u64, n64, num_read, out_table, read_shots);
+
+        read_shots += num_read;
+        if (num_read < group_size) {
             break;
         }
-        read_shots++;
     }
     return read_shots;
 }
 
+template <size_t W>
+bool MeasureRecordReaderFormat01<W>::read_record_bytes(uint8_t *out) {
+    size_t n = this->bits_per_record();
+
+    // Fast path: the whole record is in the buffer, so it can be decoded 8 characters at a time.
+    if (in.refill(n + 1)) {
+        const uint8_t *p = in.data();
+        size_t n8 = n >> 3;
+        bool ok = true;
+        for (size_t k = 0; k < n8; k++) {
+            uint64_t chars;
+            memcpy(&chars, p + k * 8, 8);
+            chars ^= 0x3030303030303030ULL;  // '0' -> 0 and '1' -> 1.
+            if (chars & ~0x0101010101010101ULL) {
+                ok = false;
+                break;
+            }
+            // Gathers the low bit of each of the 8 bytes into the top byte.
+            out[k] = (uint8_t)((chars * 0x0102040810204080ULL) >> 56);
+        }
+        if (ok && (n & 7)) {
+            uint8_t last = 0;
+            for (size_t k = n8 << 3; k < n; k++) {
+                uint8_t c = p[k] ^ '0';
+                if (c > 1) {
+                    ok = false;
+                    break;
+                }
+                last |= c << (k & 7);
+            }
+            uint8_t mask = (1 << (n & 7)) - 1;
+            out[n8] = (out[n8] & ~mask) | last;
+        }
+        if (ok && p[n] == '\n') {
+            in.consume(n + 1);
+            return true;
+        }
+        if (ok && p[n] == '\r' && in.refill(n + 2) && in.data()[n + 1] == '\n') {
+            in.consume(n + 2);
+            return true;
+        }
+    }
+
+    // Slow path: go character by character, to handle the end of the data and produce good error messages.
+    return start_and_read_entire_record_helper(
+        [&](size_t k) {
+            out[k >> 3] &= ~(1 << (k & 7));
+        },
+        [&](size_t k) {
+            out[k >> 3] |= 1 << (k & 7);
+        });
+}
+
 template <size_t W>
 template <typename SAW0, typename SAW1>
 bool MeasureRecordReaderFormat01<W>::start_and_read_entire_record_helper(SAW0 saw0, SAW1 saw1) {
     size_t n = this->bits_per_record();
     for (size_t k = 0; k < n; k++) {
-        int b = getc(in);
+        int b = in.get();
         switch (b) {
             case '0':
                 saw0(k);
@@ -193,12 +288,12 @@ bool MeasureRecordReaderFormat01<W>::start_and_read_entire_record_helper(SAW0 sa
                 throw std::invalid_argument("Unexpected character in 01 format data: '" + std::to_string(b) + "'.");
         }
     }
-    int last = getc(in);
+    int last = in.get();
     if (n == 0 && last == EOF) {
         return false;
     }
     if (last == '\r') {
-        last = getc(in);
+        last = in.get();
     }
     if (last != '\n') {
         throw std::invalid_argument(
@@ -212,7 +307,7 @@ bool MeasureRecordReaderFormat01<W>::start_and_read_entire_record_helper(SAW0 sa
 template <size_t W>
 MeasureRecordReaderFormatB8<W>::MeasureRecordReaderFormatB8(
     FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables)
-    : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables), in(in) {
+    : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables), in(in), record_buf(0) {
 }
 
 template <size_t W>
@@ -240,21 +335,40 @@ size_t MeasureRecordReaderFormatB8<W>::read_into_table_with_minor_shot_index(
     if (n == 0) {
         return 0;  // Ambiguous when the data ends. Stop as early as possible.
     }
-    for (size_t read_shots = 0; read_shots < max_shots; read_shots++) {
-        for (size_t bit = 0; bit < n; bit += 8) {
-            int c = getc(in);
-            if (c == EOF) {
-                if (bit == 0) {
-                    return read_shots;
-                }
-                throw std::invalid_argument("b8 data ended in middle of record.");
-            }
-            for (size_t b = 0; b < 8 && bit + b < n; b++) {
-                out_table[bit + b][read_shots] = ((c >> b) & 1) != 0;
-            }
+    size_t nb = (n + 7) >> 3;
+    size_t n64 = (n + 63) >> 6;
+    if (record_buf.num_u64_padded() < n64 * 64) {
+        record_buf = simd_bits<W>(n64 * 64 * 64);
+    }
+
+    // Records are read 64 at a time with one bulk read, then transposed 64x64 bits at a time into the table.
+    size_t read_shots = 0;
+    while (read_shots < max_shots) {
+        size_t group_size = std::min(max_shots - read_shots, size_t{64});
+        uint8_t *packed = record_buf.u8 + (n64 * 8 * 64 - nb * group_size);
+        size_t num_bytes = fread(packed, 1, nb * group_size, in);
+        if (num_bytes % nb != 0) {
+            throw std::invalid_argument("b8 data ended in middle of record.");
+        }
+        size_t num_read = num_bytes / nb;
+        if (num_read == 0) {
+            break;
+        }
+
+        // Spread the records out to word-aligned rows. Each row starts at or before its packed data, so
+        // going forward never overwrites data that hasn't been moved yet.
+        for (size_t s = 0; s < num_read; s++) {
+            memmove(record_buf.u8 + s * n64 * 8, packed + s * nb, nb);
+        }
+        this->write_record_group_into_table_with_minor_shot_index(
+            record_buf.u64, n64, num_read, out_table, read_shots);
+
+        read_shots += num_read;
+        if (num_read < group_size) {
+            break;
         }
     }
-    return max_shots;
+    return read_shots;
 }
 
 template <size_t W>
@@ -263,28 +377,22 @@ bool MeasureRecordReaderFormatB8<W>::start_and_read_entire_record(SparseShot &cl
         cleared_out.obs_mask = simd_bits<64>(this->num_observables);
     }
     size_t n = this->bits_per_record();
-    size_t nb = (n + 7) >> 3;
     if (n == 0) {
         return 0;  // Ambiguous when the data ends. Stop as early as possible.
     }
-    for (size_t k = 0; k < nb; k++) {
-        int b = getc(in);
-        if (b == EOF) {
-            if (k == 0) {
-                return false;
-            }
-            throw std::invalid_argument(
-                "b8 data ended in middle of record at byte position " + std::to_string(k) +
-                ".\n"
-                "Expected bytes per record was " +
-                std::to_string(nb) + " (" + std::to_string(n) + " bits padded).");
-        }
-
-        size_t bit_offset = k << 3;
-        for (size_t r = 0; r < 8; r++) {
-            if (b & (1 << r)) {
-                cleared_out.hits.push_back(bit_offset + r);
-            }
+    size_t n64 = (n + 63) >> 6;
+    if (record_buf.num_u64_padded() < n64) {
+        record_buf = simd_bits<W>(n64 * 64);
+    }
+    record_buf.clear();
+    if (!start_and_read_entire_record(record_buf)) {
+        return false;
+    }
+    for (size_t k = 0; k < n64; k++) {
+        uint64_t v = record_buf.u64[k];
+        while (v) {
+            cleared_out.hits.push_back((k << 6) + std::countr_zero(v));
+            v &= v - 1;
         }
     }
     this->move_obs_in_shots_to_mask_assuming_sorted(cleared_out);
@@ -343,10 +451,14 @@ bool MeasureRecordReaderFormatHits<W>::expects_empty_serialized_data_for_each_sh
 template <size_t W>
 size_t MeasureRecordReaderFormatHits<W>::read_into_table_with_minor_shot_index(
     simd_bit_table<W> &out_table, size_t max_shots) {
+    size_t m = this->bits_per_record();
     size_t read_shots = 0;
     out_table.clear();
     while (read_shots < max_shots) {
         bool more = start_and_read_entire_record_helper([&](size_t bit_index) {
+            if (bit_index >= m) {
+                throw std::invalid_argument("hit index is too large.");
+            }
             out_table[bit_index][read_shots] |= 1;
         });
         if (!more) {
@@ -369,7 +481,7 @@ bool MeasureRecordReaderFormatHits<W>::start_and_read_entire_record_helper(HANDL
                 return false;
             }
             if (first && next_char == '\r') {
-                next_char = getc(in);
+                next_char = in.get();
             }
             if (first && next_char == '\n') {
                 return true;
@@ -379,7 +491,7 @@ bool MeasureRecordReaderFormatHits<W>::start_and_read_entire_record_helper(HANDL
         handle_hit((size_t)value);
         first = false;
         if (next_char == '\r') {
-            next_char = getc(in);
+            next_char = in.get();
             if (next_char == '\n') {
                 return true;
             }
@@ -445,7 +557,7 @@ size_t MeasureRecordReaderFormatR8<W>::read_into_table_with_minor_shot_index(
 template <size_t W>
 template <typename HANDLE_HIT>
 bool MeasureRecordReaderFormatR8<W>::start_and_read_entire_record_helper(HANDLE_HIT handle_hit) {
-    int next_char = getc(in);
+    int next_char = in.get();
     if (next_char == EOF) {
         return false;
     }
@@ -466,7 +578,7 @@ bool MeasureRecordReaderFormatR8<W>::start_and_read_entire_record_helper(HANDLE_
                     std::to_string(this->bits_per_record()) + " bits.");
             }
         }
-        next_char = getc(in);
+        next_char = in.get();
         if (next_char == EOF) {
             throw std::invalid_argument(
                 "End of file before end of r8 data. Expected to decode " + std::to_string(this->bits_per_record()) +
@@ -533,24 +645,24 @@ template <typename HANDLE_HIT>
 bool MeasureRecordReaderFormatDets<W>::start_and_read_entire_record_helper(HANDLE_HIT handle_hit) {
     // Read "shot" prefix, or notice end of data. Ignore indentation and spacing.
     while (true) {
-        int next_char = getc(in);
+        int next_char = in.get();
         if (next_char == ' ' || next_char == '\n' || next_char == '\r' || next_char == '\t') {
             continue;
         }
         if (next_char == EOF) {
             return false;
         }
-        if (next_char != 's' || getc(in) != 'h' || getc(in) != 'o' || getc(in) != 't') {
+        if (next_char != 's' || in.get() != 'h' || in.get() != 'o' || in.get() != 't') {
             throw std::invalid_argument("DETS data didn't start with 'shot'");
         }
         break;
     }
 
     // Read prefixed integers until end of line.
-    int next_char = getc(in);
+    int next_char = in.get();
     while (true) {
         if (next_char == '\r') {
-            next_char = getc(in);
+            next_char = in.get();
         }
         if (next_char == '\n' || next_char == EOF) {
             return true;
@@ -558,7 +670,7 @@ bool MeasureRecordReaderFormatDets<W>::start_and_read_entire_record_helper(HANDL
         if (next_char != ' ') {
             throw std::invalid_argument("DETS data wasn't single-space-separated with no trailing spaces.");
         }
-        next_char = getc(in);
+        next_char = in.get();
         uint64_t offset;
         uint64_t length;
         if (next_char == 'M') {
@@ -599,7 +711,8 @@ MeasureRecordReaderFormatPTB64<W>::MeasureRecordReaderFormatPTB64(
     : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables),
       in(in),
       buf(0),
-      num_unread_shots_in_buf(0) {
+      num_unread_shots_in_buf(0),
+      group_buf(0) {
 }
 
 template <size_t W>
@@ -633,6 +746,25 @@ bool MeasureRecordReaderFormatPTB64<W>::load_cache() {
     return true;
 }
 
+template <size_t W>
+bool MeasureRecordReaderFormatPTB64<W>::read_group() {
+    size_t n = this->bits_per_record();
+    if (group_buf.num_u64_padded() < n) {
+        group_buf = simd_bits<W>(n * 64);
+    }
+    size_t nb = n * sizeof(uint64_t);
+    size_t nr = fread(group_buf.u8, 1, nb, in);
+    if (nr == 0) {
+        // End of file at a shot boundary.
+        return false;
+    }
+    if (nr != nb) {
+        // Fragmented file.
+        throw std::invalid_argument("File ended in the middle of a ptb64 record.");
+    }
+    return true;
+}
+
 template <size_t W>
 bool MeasureRecordReaderFormatPTB64<W>::start_and_read_entire_record(simd_bits_range_ref<W> dirty_out_buffer) {
     if (num_unread_shots_in_buf == 0) {
@@ -706,17 +838,11 @@ size_t MeasureRecordReaderFormatPTB64<W>::read_into_table_with_minor_shot_index(
         throw std::invalid_argument("max_shots must be a multiple of 64 when using PTB64 format");
     }
     for (size_t shots_read = 0; shots_read < max_shots; shots_read += 64) {
+        if (!read_group()) {
+            return shots_read;
+        }
         for (size_t bit = 0; bit < n; bit++) {
-            size_t read = fread(&out_table[bit].u64[shots_read >> 6], 1, sizeof(uint64_t), in);
-            if (read != sizeof(uint64_t)) {
-                if (read == 0 && bit == 0) {
-                    // End of file at a shot boundary.
-                    return shots_read;
-                } else {
-                    // Fragmented file.
-                    throw std::invalid_argument("File ended in the middle of a ptb64 record.");
-                }
-            }
+            out_table[bit].u64[shots_read >> 6] = group_buf.u64[bit];
         }
     }
     return max_shots;
@@ -732,22 +858,12 @@ size_t MeasureRecordReaderFormatPTB64<W>::read_into_table_with_major_shot_index(
     uint64_t buffer[64];
     assert(max_shots % 64 == 0);
     for (size_t shot = 0; shot < max_shots; shot += 64) {
+        if (!read_group()) {
+            return shot;
+        }
         for (size_t bit = 0; bit < n; bit += 64) {
             for (size_t b = 0; b < 64; b++) {
-                if (bit + b >= n) {
-                    buffer[b] = 0;
-                } else {
-                    size_t read = fread(&buffer[b], 1, sizeof(uint64_t), in);
-                    if (read != sizeof(uint64_t)) {
-                        if (read == 0 && bit == 0 && b == 0) {
-                            // End of file at a shot boundary.
-                            return shot;
-                        } else {
-                            // Fragmented file.
-                            throw std::invalid_argument("File ended in the middle of a ptb64 record.");
-                        }
-                    }
-                }
+                buffer[b] = bit + b < n ? group_buf.u64[bit + b] : 0;
             }
             inplace_transpose_64x64(buffer, 1);
             for (size_t s = 0; s < 64; s++) {
@@ -758,6 +874,119 @@ size_t MeasureRecordReaderFormatPTB64<W>::read_into_table_with_major_shot_index(
     return max_shots;
 }
 
+/// STBC format
+
+template <size_t W>
+MeasureRecordReaderFormatSTBC<W>::MeasureRecordReaderFormatSTBC(
+    FILE *in, size_t num_measurements, size_t num_detectors, size_t num_observables)
+    : MeasureRecordReader<W>(num_measurements, num_detectors, num_observables),
+      in(in),
+      num_chunk_records(0),
+      next_chunk_record(0),
+      record_buf(0) {
+}
+
+template <size_t W>
+bool MeasureRecordReaderFormatSTBC<W>::load_chunk_if_needed() {
+    while (next_chunk_record == num_chunk_records) {
+        StbcChunkHeader header;
+        if (!StbcChunkHeader::read(in, header)) {
+            return false;
+        }
+        if (header.bits_per_shot() != this->bits_per_record()) {
+            throw std::invalid_argument(
+                "stbc chunk has " + std::to_string(header.bits_per_shot()) + " bits per shot, but expected " +
+                std::to_string(this->bits_per_record()) + " bits per shot.");
+        }
+        if (header.payload_bytes > (size_t{1} << 40)) {
+            throw std::invalid_argument("stbc chunk payload is implausibly large.");
+        }
+        payload.resize(header.payload_bytes);
+        if (fread(payload.data(), 1, payload.size(), in) != payload.size()) {
+            throw std::invalid_argument("stbc data ended in the middle of a chunk payload.");
+        }
+        decode_stbc_payload(header, payload, chunk_records);
+        num_chunk_records = header.num_shots;
+        next_chunk_record = 0;
+    }
+    return true;
+}
+
+template <size_t W>
+bool MeasureRecordReaderFormatSTBC<W>::start_and_read_entire_record(simd_bits_range_ref<W> dirty_out_buffer) {
+    if (!load_chunk_if_needed()) {
+        return false;
+    }
+    size_t nb = (this->bits_per_record() + 7) >> 3;
+    memcpy(dirty_out_buffer.u8, chunk_records.data() + next_chunk_record * nb, nb);
+    next_chunk_record++;
+    return true;
+}
+
+template <size_t W>
+bool MeasureRecordReaderFormatSTBC<W>::start_and_read_entire_record(SparseShot &cleared_out) {
+    if (cleared_out.obs_mask.num_bits_padded() < this->num_observables) {
+        cleared_out.obs_mask = simd_bits<64>(this->num_observables);
+    }
+    if (!load_chunk_if_needed()) {
+        return false;
+    }
+    size_t nb = (this->bits_per_record() + 7) >> 3;
+    const uint8_t *record = chunk_records.data() + next_chunk_record * nb;
+    for (size_t k = 0; k < nb; k += 8) {
+        uint64_t v = 0;
+        memcpy(&v, record + k, std::min(nb - k, size_t{8}));
+        while (v) {
+            cleared_out.hits.push_back((k << 3) + std::countr_zero(v));
+            v &= v - 1;
+        }
+    }
+    next_chunk_record++;
+    this->move_obs_in_shots_to_mask_assuming_sorted(cleared_out);
+    return true;
+}
+
+template <size_t W>
+bool MeasureRecordReaderFormatSTBC<W>::expects_empty_serialized_data_for_each_shot() const {
+    // Chunk headers state how many records there are, so even empty records take up space.
+    return false;
+}
+
+template <size_t W>
+size_t MeasureRecordReaderFormatSTBC<W>::read_into_table_with_minor_shot_index(
+    simd_bit_table<W> &out_table, size_t max_shots) {
+    size_t n = this->bits_per_record();
+    size_t nb = (n + 7) >> 3;
+    size_t n64 = (n + 63) >> 6;
+    if (record_buf.num_u64_padded() < n64 * 64) {
+        record_buf = simd_bits<W>(n64 * 64 * 64);
+    }
+
+    // Records are gathered 64 at a time into word-aligned rows, then transposed 64x64 bits at a time into the table.
+    size_t read_shots = 0;
+    while (read_shots < max_shots) {
+        size_t group_size = std::min(max_shots - read_shots, size_t{64});
+        size_t num_read = 0;
+        while (num_read < group_size && load_chunk_if_needed()) {
+            uint8_t *row = record_buf.u8 + num_read * n64 * 8;
+            memset(row, 0, n64 * 8);
+            memcpy(row, chunk_records.data() + next_chunk_record * nb, nb);
+            next_chunk_record++;
+            num_read++;
+        }
+        if (num_read == 0) {
+            break;
+        }
+        this->write_record_group_into_table_with_minor_shot_index(
+            record_buf.u64, n64, num_read, out_table, read_shots);
+        read_shots += num_read;
+        if (num_read < group_size) {
+            break;
+        }
+    }
+    return read_shots;
+}
+
 template <size_t W>
 size_t read_file_data_into_shot_table(
     FILE *in,
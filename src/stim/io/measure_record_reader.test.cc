@@ -818,3 +818,155 @@ TEST_EACH_WORD_SIZE_W(MeasureRecordReader, read_windows_newlines_dets, {
     ASSERT_EQ(read[3][1], false);
     fclose(f);
 })
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordReader, read_into_table_with_minor_shot_index_many_shots, {
+    size_t n_shots = 150;
+    size_t n_results = 77;
+
+    auto rng = INDEPENDENT_TEST_RNG();
+    auto shot_maj_data = simd_bit_table<W>::random(n_shots, n_results, rng);
+    for (SampleFormat format : {
+             SampleFormat::SAMPLE_FORMAT_01,
+             SampleFormat::SAMPLE_FORMAT_B8,
+             SampleFormat::SAMPLE_FORMAT_HITS,
+             SampleFormat::SAMPLE_FORMAT_DETS,
+             SampleFormat::SAMPLE_FORMAT_R8,
+             SampleFormat::SAMPLE_FORMAT_STBC}) {
+        FILE *f = tmpfile();
+        {
+            auto writer = MeasureRecordWriter::make(f, format);
+            for (size_t k = 0; k < n_shots; k++) {
+                writer->write_bits(shot_maj_data[k].u8, n_results);
+                writer->write_end();
+            }
+        }
+        rewind(f);
+
+        auto reader = MeasureRecordReader<W>::make(f, format, n_results, 0, 0);
+        simd_bit_table<W> table(n_results, 256);
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 100), 100);
+        for (size_t s = 0; s < 100; s++) {
+            for (size_t m = 0; m < n_results; m++) {
+                ASSERT_EQ(table[m][s], shot_maj_data[s][m]) << (int)format << " " << s << " " << m;
+            }
+        }
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 100), 50);
+        for (size_t s = 0; s < 50; s++) {
+            for (size_t m = 0; m < n_results; m++) {
+                ASSERT_EQ(table[m][s], shot_maj_data[s + 100][m]) << (int)format << " " << s << " " << m;
+            }
+        }
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 100), 0);
+        fclose(f);
+    }
+})
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordReader, Format01_crlf_and_errors, {
+    FILE *tmp = tmpfile_with_contents("0000000011\r\n1000000001\n");
+    auto reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_01, 10);
+    SparseShot shot;
+    ASSERT_TRUE(reader->start_and_read_entire_record(shot));
+    ASSERT_EQ(shot.hits, (std::vector<uint64_t>{8, 9}));
+    shot.clear();
+    ASSERT_TRUE(reader->start_and_read_entire_record(shot));
+    ASSERT_EQ(shot.hits, (std::vector<uint64_t>{0, 9}));
+    ASSERT_FALSE(reader->start_and_read_entire_record(shot));
+    fclose(tmp);
+
+    simd_bits<W> buf(10);
+    tmp = tmpfile_with_contents("00000000x1\n");
+    reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_01, 10);
+    ASSERT_THROW({ reader->start_and_read_entire_record(buf); }, std::invalid_argument);
+    fclose(tmp);
+
+    tmp = tmpfile_with_contents("0000000011111\n");
+    reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_01, 10);
+    ASSERT_THROW({ reader->start_and_read_entire_record(buf); }, std::invalid_argument);
+    fclose(tmp);
+
+    tmp = tmpfile_with_contents("000000001\n");
+    reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_01, 10);
+    ASSERT_THROW({ reader->start_and_read_entire_record(buf); }, std::invalid_argument);
+    fclose(tmp);
+})
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordReader, returns_unread_data_to_file, {
+    FILE *tmp = tmpfile_with_contents("1,2\n3\n\n0\n");
+    simd_bit_table<W> table(4, 64);
+    for (size_t expected_hit : {2, 3}) {
+        auto reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_HITS, 4);
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 1), 1);
+        ASSERT_TRUE(table[expected_hit][0]);
+    }
+    {
+        auto reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_HITS, 4);
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 1), 1);
+        ASSERT_FALSE(table[0][0] || table[1][0] || table[2][0] || table[3][0]);
+    }
+    auto reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_HITS, 4);
+    ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 1), 1);
+    ASSERT_TRUE(table[0][0]);
+    ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 1), 0);
+    fclose(tmp);
+})
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordReader, ptb64_bulk_table_reads, {
+    size_t n_shots = 192;
+    size_t n_results = 100;
+    auto rng = INDEPENDENT_TEST_RNG();
+    auto shot_min_data = simd_bit_table<W>::random(n_results, n_shots, rng);
+
+    FILE *f = tmpfile();
+    for (size_t g = 0; g < n_shots / 64; g++) {
+        for (size_t m = 0; m < n_results; m++) {
+            fwrite(&shot_min_data[m].u64[g], 1, sizeof(uint64_t), f);
+        }
+    }
+
+    rewind(f);
+    {
+        auto reader = MeasureRecordReader<W>::make(f, SampleFormat::SAMPLE_FORMAT_PTB64, n_results);
+        simd_bit_table<W> table(n_results, 128);
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 128), 128);
+        for (size_t m = 0; m < n_results; m++) {
+            ASSERT_EQ(table[m].u64[0], shot_min_data[m].u64[0]);
+            ASSERT_EQ(table[m].u64[1], shot_min_data[m].u64[1]);
+        }
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 128), 64);
+        for (size_t m = 0; m < n_results; m++) {
+            ASSERT_EQ(table[m].u64[0], shot_min_data[m].u64[2]);
+        }
+        ASSERT_EQ(reader->read_into_table_with_minor_shot_index(table, 128), 0);
+    }
+
+    rewind(f);
+    {
+        auto reader = MeasureRecordReader<W>::make(f, SampleFormat::SAMPLE_FORMAT_PTB64, n_results);
+        simd_bit_table<W> table(256, n_results);
+        ASSERT_EQ(reader->read_into_table_with_major_shot_index(table, 256), 192);
+        for (size_t s = 0; s < n_shots; s++) {
+            for (size_t m = 0; m < n_results; m++) {
+                ASSERT_EQ(table[s][m], shot_min_data[m][s]);
+            }
+        }
+    }
+
+    // A truncated group of shots is an error.
+    uint64_t extra = 0;
+    fwrite(&extra, 1, sizeof(uint64_t), f);
+    rewind(f);
+    {
+        auto reader = MeasureRecordReader<W>::make(f, SampleFormat::SAMPLE_FORMAT_PTB64, n_results);
+        simd_bit_table<W> table(n_results, 256);
+        ASSERT_THROW({ reader->read_into_table_with_minor_shot_index(table, 256); }, std::invalid_argument);
+    }
+    fclose(f);
+})
+
+TEST_EACH_WORD_SIZE_W(MeasureRecordReader, b8_bulk_table_read_truncated, {
+    FILE *f = tmpfile_with_contents("\x01\x02\x03");
+    auto reader = MeasureRecordReader<W>::make(f, SampleFormat::SAMPLE_FORMAT_B8, 16);
+    simd_bit_table<W> table(16, 64);
+    ASSERT_THROW({ reader->read_into_table_with_minor_shot_index(table, 64); }, std::invalid_argument);
+    fclose(f);
+})
@@ -17,9 +17,40 @@
 #include "stim/io/measure_record_writer.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+#include "stim/io/stbc_format.h"
 
 using namespace stim;
 
+/// Calls `callback(k)` for each set bit k of the given little-endian bit data, in increasing order.
+///
+/// Works a 64 bit word at a time, so that runs of zeros are skipped quickly.
+template <typename CALLBACK>
+static inline void for_each_set_bit(SpanRef<const uint8_t> data, const CALLBACK &callback) {
+    size_t n = data.size();
+    size_t k = 0;
+    auto handle_word = [&](uint64_t word) {
+        while (word) {
+            callback(k * 8 + std::countr_zero(word));
+            word &= word - 1;
+        }
+    };
+    for (; k + 8 <= n; k += 8) {
+        uint64_t word;
+        memcpy(&word, data.ptr_start + k, 8);
+        handle_word(word);
+    }
+    if (k < n) {
+        uint64_t word = 0;
+        memcpy(&word, data.ptr_start + k, n - k);
+        handle_word(word);
+    }
+}
+
 std::unique_ptr<MeasureRecordWriter> MeasureRecordWriter::make(FILE *out, SampleFormat output_format) {
     switch (output_format) {
         case SampleFormat::SAMPLE_FORMAT_01:
@@ -34,14 +65,68 @@ std::unique_ptr<MeasureRecordWriter> MeasureRecordWriter::make(FILE *out, Sample
             throw std::invalid_argument("SAMPLE_FORMAT_PTB64 incompatible with SingleMeasurementRecord");
         case SampleFormat::SAMPLE_FORMAT_R8:
             return std::make_unique<MeasureRecordWriterFormatR8>(out);
+        case SampleFormat::SAMPLE_FORMAT_STBC:
+            return std::make_unique<MeasureRecordWriterFormatSTBC>(out);
         default:
             throw std::invalid_argument("Sample format not recognized by SingleMeasurementRecord");
     }
 }
 
+MeasureRecordSink::MeasureRecordSink(FILE *out, size_t spill_threshold)
+    : out(out), spill_threshold(spill_threshold) {
+}
+
+MeasureRecordSink::~MeasureRecordSink() {
+    if (spill_file != nullptr) {
+        fclose(spill_file);
+        spill_file = nullptr;
+    }
+}
+
+void MeasureRecordSink::write_decimal(uint64_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    write_text({buf, result.ptr});
+}
+
+void MeasureRecordSink::spill() {
+    if (spill_file == nullptr) {
+        spill_file = tmpfile();
+        if (spill_file == nullptr) {
+            throw std::out_of_range("Failed to open a temp file.");
+        }
+    }
+    fwrite(held.data(), sizeof(uint8_t), held.size(), spill_file);
+    held.clear();
+}
+
+void MeasureRecordSink::move_to(FILE *destination) {
+    if (spill_file != nullptr) {
+        rewind(spill_file);
+        std::vector<uint8_t> chunk(size_t{1} << 16);
+        while (true) {
+            size_t n = fread(chunk.data(), sizeof(uint8_t), chunk.size(), spill_file);
+            if (n == 0) {
+                break;
+            }
+            fwrite(chunk.data(), sizeof(uint8_t), n, destination);
+        }
+        fclose(spill_file);
+        spill_file = nullptr;
+    }
+    fwrite(held.data(), sizeof(uint8_t), held.size(), destination);
+    held.clear();
+}
+
+MeasureRecordWriter::MeasureRecordWriter(FILE *out) : out(out) {
+}
+
 void MeasureRecordWriter::begin_result_type(char result_type) {
 }
 
+void MeasureRecordWriter::flush() {
+}
+
 void MeasureRecordWriter::write_bits(uint8_t *data, size_t num_bits) {
     size_t num_bytes = num_bits >> 3;
     write_bytes({data, data + num_bytes});
@@ -50,6 +135,22 @@ void MeasureRecordWriter::write_bits(uint8_t *data, size_t num_bits) {
     }
 }
 
+void MeasureRecordWriter::write_bit_positions(SpanRef<const uint64_t> positions, size_t num_bits) {
+    size_t next = 0;
+    for (uint64_t p : positions) {
+        while (next < p) {
+            write_bit(false);
+            next++;
+        }
+        write_bit(true);
+        next++;
+    }
+    while (next < num_bits) {
+        write_bit(false);
+        next++;
+    }
+}
+
 void MeasureRecordWriter::write_bytes(SpanRef<const uint8_t> data) {
     for (uint8_t b : data) {
         for (size_t k = 0; k < 8; k++) {
@@ -58,23 +159,50 @@ void MeasureRecordWriter::write_bytes(SpanRef<const uint8_t> data) {
     }
 }
 
-MeasureRecordWriterFormat01::MeasureRecordWriterFormat01(FILE *out) : out(out) {
+MeasureRecordWriterFormat01::MeasureRecordWriterFormat01(FILE *out) : MeasureRecordWriter(out) {
+}
+
+void MeasureRecordWriterFormat01::write_bytes(SpanRef<const uint8_t> data) {
+    // Each byte expands into 8 characters at once, by looking up the 8 characters as a little-endian word.
+    static const std::array<uint64_t, 256> expansions = []() {
+        std::array<uint64_t, 256> result;
+        for (size_t b = 0; b < 256; b++) {
+            uint64_t v = 0;
+            for (size_t k = 0; k < 8; k++) {
+                v |= uint64_t('0' + ((b >> k) & 1)) << (k * 8);
+            }
+            result[b] = v;
+        }
+        return result;
+    }();
+
+    std::array<uint8_t, 4096> buf;
+    size_t n = 0;
+    for (uint8_t b : data) {
+        memcpy(buf.data() + n, &expansions[b], 8);
+        n += 8;
+        if (n == buf.size()) {
+            out.write({buf.data(), buf.data() + n});
+            n = 0;
+        }
+    }
+    out.write({buf.data(), buf.data() + n});
 }
 
 void MeasureRecordWriterFormat01::write_bit(bool b) {
-    putc('0' + b, out);
+    out.put('0' + b);
 }
 
 void MeasureRecordWriterFormat01::write_end() {
-    putc('\n', out);
+    out.put('\n');
 }
 
-MeasureRecordWriterFormatB8::MeasureRecordWriterFormatB8(FILE *out) : out(out) {
+MeasureRecordWriterFormatB8::MeasureRecordWriterFormatB8(FILE *out) : MeasureRecordWriter(out) {
 }
 
 void MeasureRecordWriterFormatB8::write_bytes(SpanRef<const uint8_t> data) {
     if (count == 0) {
-        fwrite(data.ptr_start, sizeof(uint8_t), data.ptr_end - data.ptr_start, out);
+        out.write(data);
     } else {
         MeasureRecordWriter::write_bytes(data);
     }
@@ -84,7 +212,7 @@ void MeasureRecordWriterFormatB8::write_bit(bool b) {
     payload |= uint8_t{b} << count;
     count++;
     if (count == 8) {
-        putc(payload, out);
+        out.put(payload);
         count = 0;
         payload = 0;
     }
@@ -92,25 +220,37 @@ void MeasureRecordWriterFormatB8::write_bit(bool b) {
 
 void MeasureRecordWriterFormatB8::write_end() {
     if (count > 0) {
-        putc(payload, out);
+        out.put(payload);
         count = 0;
         payload = 0;
     }
 }
 
-MeasureRecordWriterFormatHits::MeasureRecordWriterFormatHits(FILE *out) : out(out) {
+MeasureRecordWriterFormatHits::MeasureRecordWriterFormatHits(FILE *out) : MeasureRecordWriter(out) {
 }
 
 void MeasureRecordWriterFormatHits::write_bytes(SpanRef<const uint8_t> data) {
-    for (uint8_t b : data) {
-        if (!b) {
-            position += 8;
+    for_each_set_bit(data, [&](size_t k) {
+        if (first) {
+            first = false;
         } else {
-            for (size_t k = 0; k < 8; k++) {
-                write_bit((b >> k) & 1);
-            }
+            out.put(',');
         }
+        out.write_decimal(position + k);
+    });
+    position += data.size() * 8;
+}
+
+void MeasureRecordWriterFormatHits::write_bit_positions(SpanRef<const uint64_t> positions, size_t num_bits) {
+    for (uint64_t p : positions) {
+        if (first) {
+            first = false;
+        } else {
+            out.put(',');
+        }
+        out.write_decimal(position + p);
     }
+    position += num_bits;
 }
 
 void MeasureRecordWriterFormatHits::write_bit(bool b) {
@@ -118,57 +258,60 @@ void MeasureRecordWriterFormatHits::write_bit(bool b) {
         if (first) {
             first = false;
         } else {
-            putc(',', out);
+            out.put(',');
         }
-        fprintf(out, "%lld", (unsigned long long)(position));
+        out.write_decimal(position);
     }
     position++;
 }
 
 void MeasureRecordWriterFormatHits::write_end() {
-    putc('\n', out);
+    out.put('\n');
     position = 0;
     first = true;
 }
 
-MeasureRecordWriterFormatR8::MeasureRecordWriterFormatR8(FILE *out) : out(out) {
+MeasureRecordWriterFormatR8::MeasureRecordWriterFormatR8(FILE *out) : MeasureRecordWriter(out) {
 }
 
 void MeasureRecordWriterFormatR8::write_bytes(SpanRef<const uint8_t> data) {
-    for (uint8_t b : data) {
-        if (!b) {
-            run_length += 8;
-            if (run_length >= 0xFF) {
-                putc(0xFF, out);
-                run_length -= 0xFF;
-            }
-        } else {
-            for (size_t k = 0; k < 8; k++) {
-                write_bit((b >> k) & 1);
-            }
+    size_t next = 0;
+    auto skip_zeros = [&](size_t num_zeros) {
+        size_t total = run_length + num_zeros;
+        while (total >= 0xFF) {
+            out.put(0xFF);
+            total -= 0xFF;
         }
-    }
+        run_length = (uint16_t)total;
+    };
+    for_each_set_bit(data, [&](size_t k) {
+        skip_zeros(k - next);
+        out.put(run_length);
+        run_length = 0;
+        next = k + 1;
+    });
+    skip_zeros(data.size() * 8 - next);
 }
 
 void MeasureRecordWriterFormatR8::write_bit(bool b) {
     if (b) {
-        putc(run_length, out);
+        out.put(run_length);
         run_length = 0;
     } else {
         run_length++;
         if (run_length == 255) {
-            putc(run_length, out);
+            out.put(run_length);
             run_length = 0;
         }
     }
 }
 
 void MeasureRecordWriterFormatR8::write_end() {
-    putc(run_length, out);
+    out.put(run_length);
     run_length = 0;
 }
 
-MeasureRecordWriterFormatDets::MeasureRecordWriterFormatDets(FILE *out) : out(out) {
+MeasureRecordWriterFormatDets::MeasureRecordWriterFormatDets(FILE *out) : MeasureRecordWriter(out) {
 }
 
 void MeasureRecordWriterFormatDets::begin_result_type(char new_result_type) {
@@ -177,35 +320,105 @@ void MeasureRecordWriterFormatDets::begin_result_type(char new_result_type) {
 }
 
 void MeasureRecordWriterFormatDets::write_bytes(SpanRef<const uint8_t> data) {
-    for (uint8_t b : data) {
-        if (!b) {
-            position += 8;
-        } else {
-            for (size_t k = 0; k < 8; k++) {
-                write_bit((b >> k) & 1);
-            }
+    for_each_set_bit(data, [&](size_t k) {
+        if (first) {
+            out.write_text("shot");
+            first = false;
         }
+        out.put(' ');
+        out.put(result_type);
+        out.write_decimal(position + k);
+    });
+    position += data.size() * 8;
+}
+
+void MeasureRecordWriterFormatDets::write_bit_positions(SpanRef<const uint64_t> positions, size_t num_bits) {
+    for (uint64_t p : positions) {
+        if (first) {
+            out.write_text("shot");
+            first = false;
+        }
+        out.put(' ');
+        out.put(result_type);
+        out.write_decimal(position + p);
     }
+    position += num_bits;
 }
 
 void MeasureRecordWriterFormatDets::write_bit(bool b) {
     if (b) {
         if (first) {
-            fprintf(out, "shot");
+            out.write_text("shot");
             first = false;
         }
-        putc(' ', out);
-        putc(result_type, out);
-        fprintf(out, "%lld", (unsigned long long)(position));
+        out.put(' ');
+        out.put(result_type);
+        out.write_decimal(position);
     }
     position++;
 }
 
 void MeasureRecordWriterFormatDets::write_end() {
     if (first) {
-        fprintf(out, "shot");
+        out.write_text("shot");
     }
-    putc('\n', out);
+    out.put('\n');
     position = 0;
     first = true;
 }
+
+MeasureRecordWriterFormatSTBC::MeasureRecordWriterFormatSTBC(FILE *out) : MeasureRecordWriter(out) {
+}
+
+MeasureRecordWriterFormatSTBC::~MeasureRecordWriterFormatSTBC() {
+    flush();
+}
+
+void MeasureRecordWriterFormatSTBC::begin_result_type(char new_result_type) {
+    result_type = new_result_type;
+}
+
+void MeasureRecordWriterFormatSTBC::write_bytes(SpanRef<const uint8_t> data) {
+    if (record_bits % 8 != 0) {
+        MeasureRecordWriter::write_bytes(data);
+        return;
+    }
+    record_data.insert(record_data.end(), data.begin(), data.end());
+    record_bits += data.size() * 8;
+    record_counts[result_type == 'D' ? 1 : result_type == 'L' ? 2 : 0] += data.size() * 8;
+}
+
+void MeasureRecordWriterFormatSTBC::write_bit(bool b) {
+    if (record_bits % 8 == 0) {
+        record_data.push_back(0);
+    }
+    record_data.back() |= uint8_t{b} << (record_bits % 8);
+    record_bits++;
+    record_counts[result_type == 'D' ? 1 : result_type == 'L' ? 2 : 0]++;
+}
+
+void MeasureRecordWriterFormatSTBC::write_end() {
+    if (chunk_records > 0 && record_counts != chunk_counts) {
+        flush();
+    }
+    chunk_counts = record_counts;
+    chunk_data.insert(chunk_data.end(), record_data.begin(), record_data.end());
+    chunk_records++;
+    record_data.clear();
+    record_bits = 0;
+    record_counts = {};
+    if (chunk_data.size() >= STBC_CHUNK_TARGET_SIZE || chunk_records >= STBC_CHUNK_TARGET_SIZE) {
+        flush();
+    }
+}
+
+void MeasureRecordWriterFormatSTBC::flush() {
+    if (chunk_records == 0) {
+        return;
+    }
+    std::vector<uint8_t> chunk;
+    append_stbc_chunk(chunk_data, chunk_records, chunk_counts[0], chunk_counts[1], chunk_counts[2], chunk);
+    out.write(chunk);
+    chunk_data.clear();
+    chunk_records = 0;
+}
@@ -17,20 +17,90 @@
 #ifndef _STIM_IO_MEASURE_RECORD_WRITER_H
 #define _STIM_IO_MEASURE_RECORD_WRITER_H
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
 #include <memory>
+#include <string_view>
+#include <vector>
 
+#include "stim/io/sparse_shot.h"
 #include "stim/io/stim_data_formats.h"
 #include "stim/mem/simd_bit_table.h"
 #include "stim/mem/span_ref.h"
 
 namespace stim {
 
+/// The destination of the bytes produced by a MeasureRecordWriter.
+///
+/// Normally bytes go straight into a FILE*. When there is no file, bytes are instead held in memory
+/// until `move_to` is called. This is how MeasureRecordBatchWriter collects the shots that have to be
+/// concatenated after the first one. Once more than `spill_threshold` bytes are held, they are moved
+/// into a temporary file, so that memory usage stays bounded.
+struct MeasureRecordSink {
+    /// Where bytes are written, or nullptr to hold them.
+    FILE *out;
+    /// The number of held bytes that triggers spilling them into `spill_file`.
+    size_t spill_threshold;
+    /// Bytes waiting for `move_to`, after the ones in `spill_file`.
+    std::vector<uint8_t> held;
+    /// Created on demand when the held bytes exceed the spill threshold.
+    FILE *spill_file = nullptr;
+
+    explicit MeasureRecordSink(FILE *out, size_t spill_threshold = size_t{1} << 20);
+    ~MeasureRecordSink();
+    MeasureRecordSink(const MeasureRecordSink &) = delete;
+    MeasureRecordSink &operator=(const MeasureRecordSink &) = delete;
+
+    inline void put(uint8_t byte) {
+        if (out != nullptr) {
+            putc(byte, out);
+        } else {
+            held.push_back(byte);
+            if (held.size() > spill_threshold) {
+                spill();
+            }
+        }
+    }
+
+    inline void write(SpanRef<const uint8_t> data) {
+        if (out != nullptr) {
+            fwrite(data.ptr_start, sizeof(uint8_t), data.size(), out);
+        } else {
+            held.insert(held.end(), data.begin(), data.end());
+            if (held.size() > spill_threshold) {
+                spill();
+            }
+        }
+    }
+
+    inline void write_text(std::string_view text) {
+        write({(const uint8_t *)text.data(), (const uint8_t *)text.data() + text.size()});
+    }
+
+    /// Writes the decimal representation of the given integer.
+    void write_decimal(uint64_t value);
+
+    /// Writes all held (and spilled) bytes into the given file, and then forgets them.
+    void move_to(FILE *destination);
+
+   private:
+    void spill();
+};
+
 /// Handles writing measurement data to the outside world.
 ///
 /// Child classes implement the various output formats.
 struct MeasureRecordWriter {
+    /// Where the formatted data goes.
+    MeasureRecordSink out;
+
     /// Creates a MeasureRecordWriter that writes the given format into the given FILE*.
+    ///
+    /// If `out` is nullptr, the data is held in memory by the writer's sink instead.
     static std::unique_ptr<MeasureRecordWriter> make(FILE *out, SampleFormat output_format);
+    explicit MeasureRecordWriter(FILE *out);
     virtual ~MeasureRecordWriter() = default;
     /// Writes (or buffers) one measurement result.
     virtual void write_bit(bool b) = 0;
@@ -40,22 +110,31 @@ struct MeasureRecordWriter {
     virtual void write_end() = 0;
     /// Writes (or buffers) multiple measurement results.
     virtual void write_bits(uint8_t *data, size_t num_bits);
+    /// Writes (or buffers) `num_bits` measurement results that are all 0 except at the given positions.
+    ///
+    /// The positions must be sorted, less than `num_bits`, and are relative to the first result being written. Sparse
+    /// formats (e.g. hits and dets) write the positions directly, instead of scanning for them.
+    virtual void write_bit_positions(SpanRef<const uint64_t> positions, size_t num_bits);
     /// Used to control the DETS format prefix character (M for measurement, D for detector, L for logical observable).
     ///
     /// Setting this is understood to reset the "result index" back to 0 so that e.g. listing logical observables after
     /// detectors results in the first logical observable being L0 instead of L[number-of-detectors].
     virtual void begin_result_type(char result_type);
+    /// Writes out any complete records that the format is still buffering.
+    ///
+    /// Most formats write records as they go, so this does nothing. Formats that group records into
+    /// blocks (e.g. stbc) write out their current block. Writers also flush when they are destroyed.
+    virtual void flush();
 };
 
 struct MeasureRecordWriterFormat01 : MeasureRecordWriter {
-    FILE *out;
     MeasureRecordWriterFormat01(FILE *out);
+    void write_bytes(SpanRef<const uint8_t> data) override;
     void write_bit(bool b) override;
     void write_end() override;
 };
 
 struct MeasureRecordWriterFormatB8 : MeasureRecordWriter {
-    FILE *out;
     uint8_t payload = 0;
     uint8_t count = 0;
     MeasureRecordWriterFormatB8(FILE *out);
@@ -65,18 +144,17 @@ struct MeasureRecordWriterFormatB8 : MeasureRecordWriter {
 };
 
 struct MeasureRecordWriterFormatHits : MeasureRecordWriter {
-    FILE *out;
     uint64_t position = 0;
     bool first = true;
 
     MeasureRecordWriterFormatHits(FILE *out);
     void write_bytes(SpanRef<const uint8_t> data) override;
+    void write_bit_positions(SpanRef<const uint64_t> positions, size_t num_bits) override;
     void write_bit(bool b) override;
     void write_end() override;
 };
 
 struct MeasureRecordWriterFormatR8 : MeasureRecordWriter {
-    FILE *out;
     uint16_t run_length = 0;
 
     MeasureRecordWriterFormatR8(FILE *out);
@@ -86,7 +164,6 @@ struct MeasureRecordWriterFormatR8 : MeasureRecordWriter {
 };
 
 struct MeasureRecordWriterFormatDets : MeasureRecordWriter {
-    FILE *out;
     uint64_t position = 0;
     char result_type = 'M';
     bool first = true;
@@ -94,10 +171,37 @@ struct MeasureRecordWriterFormatDets : MeasureRecordWriter {
     MeasureRecordWriterFormatDets(FILE *out);
     void begin_result_type(char result_type) override;
     void write_bytes(SpanRef<const uint8_t> data) override;
+    void write_bit_positions(SpanRef<const uint64_t> positions, size_t num_bits) override;
     void write_bit(bool b) override;
     void write_end() override;
 };
 
+/// Writes the stbc format, which groups records into self-describing chunks (see stim/io/stbc_format.h).
+///
+/// Records are buffered until a chunk fills up, or until the record layout (the number of measurement
+/// results, detection events, and observable flips) changes, and then written as one chunk.
+struct MeasureRecordWriterFormatSTBC : MeasureRecordWriter {
+    char result_type = 'M';
+    /// The number of measurement results, detection events, and observable flips in the current record.
+    std::array<uint64_t, 3> record_counts{};
+    /// The current record, bit packed.
+    std::vector<uint8_t> record_data;
+    uint64_t record_bits = 0;
+    /// The layout shared by the records in the current chunk.
+    std::array<uint64_t, 3> chunk_counts{};
+    /// The records in the current chunk, each bit packed into whole bytes.
+    std::vector<uint8_t> chunk_data;
+    uint64_t chunk_records = 0;
+
+    MeasureRecordWriterFormatSTBC(FILE *out);
+    ~MeasureRecordWriterFormatSTBC() override;
+    void begin_result_type(char result_type) override;
+    void write_bytes(SpanRef<const uint8_t> data) override;
+    void write_bit(bool b) override;
+    void write_end() override;
+    void flush() override;
+};
+
 template <size_t W>
 simd_bit_table<W> transposed_vs_ref(
     size_t num_samples_raw, const simd_bit_table<W> &table, const simd_bits<W> &reference_sample) {
@@ -133,35 +237,63 @@ void write_table_data(
                 fwrite(&v, 1, 64 >> 3, out);
             }
         }
-    } else {
-        auto result = transposed_vs_ref(num_shots, table, reference_sample);
-        if (dets_prefix_transition == 0) {
-            dets_prefix_transition = num_measurements;
-            dets_prefix_1 = dets_prefix_2;
-        } else if (dets_prefix_1 == dets_prefix_2 || dets_prefix_transition >= num_measurements) {
-            dets_prefix_transition = num_measurements;
-        }
-        for (size_t shot = 0; shot < num_shots; shot++) {
-            auto w = MeasureRecordWriter::make(out, format);
+        return;
+    }
+
+    if (dets_prefix_transition == 0) {
+        dets_prefix_transition = num_measurements;
+        dets_prefix_1 = dets_prefix_2;
+    } else if (dets_prefix_1 == dets_prefix_2 || dets_prefix_transition >= num_measurements) {
+        dets_prefix_transition = num_measurements;
+    }
+    // Writers return to their initial state after `write_end`, so one writer can encode every shot.
+    auto w = MeasureRecordWriter::make(out, format);
 
+    if ((format == SampleFormat::SAMPLE_FORMAT_DETS || format == SampleFormat::SAMPLE_FORMAT_HITS) &&
+        !reference_sample.not_zero()) {
+        // Sparse formats only need the positions of the set bits, which can be found without transposing the table.
+        std::vector<uint64_t> shot_starts;
+        std::vector<uint64_t> hits;
+        shot_minor_table_to_csr(table, num_measurements, num_shots, shot_starts, hits);
+        std::vector<uint64_t> shifted;
+        for (size_t shot = 0; shot < num_shots; shot++) {
+            const uint64_t *start = hits.data() + shot_starts[shot];
+            const uint64_t *end = hits.data() + shot_starts[shot + 1];
+            const uint64_t *transition = std::lower_bound(start, end, (uint64_t)dets_prefix_transition);
             w->begin_result_type(dets_prefix_1);
-            size_t n8 = dets_prefix_transition >> 3;
-            uint8_t *p = result[shot].u8;
-            w->write_bytes({p, p + n8});
-            size_t m = n8 << 3;
-            while (m < dets_prefix_transition) {
-                w->write_bit(result[shot][m]);
-                m++;
-            }
+            w->write_bit_positions({start, transition}, dets_prefix_transition);
 
-            w->begin_result_type(dets_prefix_2);
-            while (m < num_measurements) {
-                w->write_bit(result[shot][m]);
-                m++;
+            shifted.clear();
+            for (const uint64_t *p = transition; p != end; p++) {
+                shifted.push_back(*p - dets_prefix_transition);
             }
+            w->begin_result_type(dets_prefix_2);
+            w->write_bit_positions(shifted, num_measurements - dets_prefix_transition);
 
             w->write_end();
         }
+        return;
+    }
+
+    auto result = transposed_vs_ref(num_shots, table, reference_sample);
+    for (size_t shot = 0; shot < num_shots; shot++) {
+        w->begin_result_type(dets_prefix_1);
+        size_t n8 = dets_prefix_transition >> 3;
+        uint8_t *p = result[shot].u8;
+        w->write_bytes({p, p + n8});
+        size_t m = n8 << 3;
+        while (m < dets_prefix_transition) {
+            w->write_bit(result[shot][m]);
+            m++;
+        }
+
+        w->begin_result_type(dets_prefix_2);
+        while (m < num_measurements) {
+            w->write_bit(result[shot][m]);
+            m++;
+        }
+
+        w->write_end();
     }
 }
 
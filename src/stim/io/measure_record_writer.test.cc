@@ -35,6 +35,25 @@ TEST(MeasureRecordWriter, Format01) {
     ASSERT_EQ(rewind_read_close(tmp), "000111110000111111\n");
 }
 
+TEST(MeasureRecordWriter, held_output) {
+    auto writer = MeasureRecordWriter::make(nullptr, SampleFormat::SAMPLE_FORMAT_DETS);
+    writer->begin_result_type('D');
+    uint8_t bytes[]{0x00, 0x81};
+    writer->write_bytes({bytes, bytes + 2});
+    writer->write_end();
+    ASSERT_EQ(std::string(writer->out.held.begin(), writer->out.held.end()), "shot D8 D15\n");
+
+    writer->out.spill_threshold = 4;
+    writer->write_bit(true);
+    writer->write_end();
+    ASSERT_NE(writer->out.spill_file, nullptr);
+
+    FILE *tmp = tmpfile();
+    writer->out.move_to(tmp);
+    ASSERT_EQ(writer->out.spill_file, nullptr);
+    ASSERT_EQ(rewind_read_close(tmp), "shot D8 D15\nshot D0\n");
+}
+
 TEST(MeasureRecordWriter, FormatB8) {
     FILE *tmp = tmpfile();
     auto writer = MeasureRecordWriter::make(tmp, SampleFormat::SAMPLE_FORMAT_B8);
@@ -387,6 +406,46 @@ TEST_EACH_WORD_SIZE_W(MeasureRecordWriter, write_table_data_large, {
             8 * 100));
 })
 
+TEST_EACH_WORD_SIZE_W(MeasureRecordWriter, write_table_data_sparse_formats, {
+    auto rng = INDEPENDENT_TEST_RNG();
+    size_t num_shots = 1000;
+    size_t num_bits = 70;
+    simd_bit_table<W> results(num_bits, num_shots);
+    for (size_t k = 0; k < 300; k++) {
+        results[rng() % num_bits][rng() % num_shots] = true;
+    }
+    // Bits past the last shot are padding and must be ignored.
+    results[3].u64[results.num_simd_words_minor * (W / 64) - 1] = UINT64_MAX;
+
+    std::string expected_hits;
+    std::string expected_dets;
+    for (size_t s = 0; s < num_shots; s++) {
+        std::string hits_line;
+        expected_dets += "shot";
+        for (size_t m = 0; m < num_bits; m++) {
+            if (results[m][s]) {
+                if (!hits_line.empty()) {
+                    hits_line += ",";
+                }
+                hits_line += std::to_string(m);
+                expected_dets += m < 60 ? " D" + std::to_string(m) : " L" + std::to_string(m - 60);
+            }
+        }
+        expected_hits += hits_line + "\n";
+        expected_dets += "\n";
+    }
+
+    FILE *tmp = tmpfile();
+    write_table_data<W>(
+        tmp, num_shots, num_bits, simd_bits<W>(0), results, SampleFormat::SAMPLE_FORMAT_HITS, 'M', 'M', 0);
+    ASSERT_EQ(rewind_read_close(tmp), expected_hits);
+
+    tmp = tmpfile();
+    write_table_data<W>(
+        tmp, num_shots, num_bits, simd_bits<W>(0), results, SampleFormat::SAMPLE_FORMAT_DETS, 'D', 'L', 60);
+    ASSERT_EQ(rewind_read_close(tmp), expected_dets);
+})
+
 TEST(MeasureRecordWriter, write_bits_01_a) {
     FILE *f = tmpfile();
     uint8_t data[]{0x0, 0xFF};
@@ -440,3 +499,87 @@ TEST(MeasureRecordWriter, write_bits_r8_b) {
     writer->write_end();
     ASSERT_EQ(rewind_read_close(f), std::string("\x00\x00\x00\x00\x00\x00\x00\x00\x03", 9));
 }
+
+TEST(MeasureRecordWriter, write_bytes_matches_write_bit) {
+    auto rng = INDEPENDENT_TEST_RNG();
+    for (SampleFormat format : {
+             SampleFormat::SAMPLE_FORMAT_01,
+             SampleFormat::SAMPLE_FORMAT_B8,
+             SampleFormat::SAMPLE_FORMAT_HITS,
+             SampleFormat::SAMPLE_FORMAT_R8,
+             SampleFormat::SAMPLE_FORMAT_DETS}) {
+        for (size_t n : {0, 1, 7, 8, 9, 63, 64, 65, 1000, 5000}) {
+            std::vector<uint8_t> data(n);
+            for (size_t k = 0; k < n; k++) {
+                // Mix dense bytes with long runs of zeros, so long gaps are covered.
+                data[k] = (rng() % 4 == 0) ? (uint8_t)rng() : 0;
+            }
+            if (n > 100) {
+                std::fill(data.begin() + 10, data.begin() + 100, 0);
+            }
+
+            auto bulk = MeasureRecordWriter::make(nullptr, format);
+            auto bitwise = MeasureRecordWriter::make(nullptr, format);
+            for (size_t shot = 0; shot < 2; shot++) {
+                bulk->begin_result_type('D');
+                bitwise->begin_result_type('D');
+                bulk->write_bit(true);
+                bitwise->write_bit(true);
+                bulk->write_bytes({data.data(), data.data() + n});
+                for (size_t k = 0; k < n * 8; k++) {
+                    bitwise->write_bit((data[k >> 3] >> (k & 7)) & 1);
+                }
+                bulk->write_end();
+                bitwise->write_end();
+            }
+            ASSERT_EQ(bulk->out.held, bitwise->out.held) << "format=" << (int)format << ", n=" << n;
+        }
+    }
+}
+
+TEST(MeasureRecordWriter, write_bit_positions_matches_write_bit) {
+    auto rng = INDEPENDENT_TEST_RNG();
+    for (SampleFormat format : {
+             SampleFormat::SAMPLE_FORMAT_01,
+             SampleFormat::SAMPLE_FORMAT_B8,
+             SampleFormat::SAMPLE_FORMAT_HITS,
+             SampleFormat::SAMPLE_FORMAT_R8,
+             SampleFormat::SAMPLE_FORMAT_DETS}) {
+        for (size_t n : {0, 1, 7, 8, 9, 63, 64, 65, 1000}) {
+            std::vector<uint64_t> positions;
+            for (size_t k = 0; k < n; k++) {
+                if (rng() % 8 == 0) {
+                    positions.push_back(k);
+                }
+            }
+
+            auto sparse = MeasureRecordWriter::make(nullptr, format);
+            auto bitwise = MeasureRecordWriter::make(nullptr, format);
+            for (size_t shot = 0; shot < 2; shot++) {
+                sparse->begin_result_type('D');
+                bitwise->begin_result_type('D');
+                sparse->write_bit(true);
+                bitwise->write_bit(true);
+                sparse->write_bit_positions(positions, n);
+                size_t next = 0;
+                for (size_t k = 0; k < n; k++) {
+                    bool hit = next < positions.size() && positions[next] == k;
+                    next += hit;
+                    bitwise->write_bit(hit);
+                }
+                sparse->begin_result_type('L');
+                bitwise->begin_result_type('L');
+                sparse->write_bit_positions(positions, n);
+                next = 0;
+                for (size_t k = 0; k < n; k++) {
+                    bool hit = next < positions.size() && positions[next] == k;
+                    next += hit;
+                    bitwise->write_bit(hit);
+                }
+                sparse->write_end();
+                bitwise->write_end();
+            }
+            ASSERT_EQ(sparse->out.held, bitwise->out.held) << "format=" << (int)format << ", n=" << n;
+        }
+    }
+}
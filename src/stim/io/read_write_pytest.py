@@ -273,7 +273,7 @@ def test_read_01_shots():
 
 
 @pytest.mark.parametrize("data_format,bit_packed,path_type", itertools.product(
-    ["01", "b8", "r8", "ptb64", "hits", "dets"],
+    ["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"],
     [False, True],
     ["str", "path"]))
 def test_read_write_shots_fuzzing(data_format: str, bit_packed: bool, path_type: str):
@@ -309,7 +309,7 @@ def test_read_write_shots_fuzzing(data_format: str, bit_packed: bool, path_type:
 
 
 @pytest.mark.parametrize("data_format,num_bits_per_shot", itertools.product(
-    ["01", "b8", "r8", "ptb64", "hits", "dets"],
+    ["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"],
     [11, 511, 512, 513],
 ))
 def test_read_write_shots_fuzzing_vs_python_references(data_format: str, num_bits_per_shot: int):
@@ -329,6 +329,8 @@ def test_read_write_shots_fuzzing_vs_python_references(data_format: str, num_bit
         save_method = g[f'save_{data_format}']
         if data_format == 'dets':
             reference_written_data = save_method(data, num_detectors=num_bits_per_shot, num_observables=0)
+        elif data_format == 'stbc':
+            reference_written_data = save_method(data, num_detectors=num_bits_per_shot)
         else:
             reference_written_data = save_method(data)
 
@@ -343,6 +345,8 @@ def test_read_write_shots_fuzzing_vs_python_references(data_format: str, num_bit
             reference_read_data = read_method(actual_written_data)
         elif data_format == "dets":
             reference_read_data = read_method(actual_written_data, num_detectors=num_bits_per_shot, num_observables=0)
+        elif data_format == "stbc":
+            reference_read_data = read_method(actual_written_data)
         else:
             reference_read_data = read_method(actual_written_data, bits_per_shot=num_bits_per_shot)
         actual_read_data = stim.read_shot_data_file(
@@ -17,9 +17,11 @@
 #ifndef _STIM_IO_SPARSE_SHOT_H
 #define _STIM_IO_SPARSE_SHOT_H
 
+#include <bit>
 #include <string>
 #include <vector>
 
+#include "stim/mem/simd_bit_table.h"
 #include "stim/mem/simd_bits.h"
 
 namespace stim {
@@ -52,6 +54,106 @@ struct SparseShot {
 };
 std::ostream &operator<<(std::ostream &out, const SparseShot &v);
 
+/// Calls `callback(shot)` for each set bit in the first `num_shots` bits of a row of a shot-minor table.
+///
+/// The row is scanned 64 shots at a time, so runs of shots without any set bits are cheap to skip.
+template <typename CALLBACK>
+inline void for_each_shot_with_set_bit(const uint64_t *row, size_t num_shots, CALLBACK callback) {
+    size_t num_words = (num_shots + 63) >> 6;
+    for (size_t w = 0; w < num_words; w++) {
+        uint64_t v = row[w];
+        if ((w + 1) << 6 > num_shots) {
+            v &= (uint64_t{1} << (num_shots & 63)) - 1;
+        }
+        while (v) {
+            callback((w << 6) + std::countr_zero(v));
+            v &= v - 1;
+        }
+    }
+}
+
+/// Lists the set bits of each shot in a table whose minor axis is the shot index, without transposing it.
+///
+/// The result is in compressed sparse row form. The set bits of shot k are `hits[shot_starts[k]]` up to (but not
+/// including) `hits[shot_starts[k + 1]]`, in increasing order.
+///
+/// Args:
+///     table: The data to convert. Major axis is the bit index within a shot, minor axis is the shot index.
+///     num_bits_per_shot: The number of major rows of the table to look at.
+///     num_shots: The number of minor columns of the table to look at. Any padding bits are ignored.
+///     shot_starts: Overwritten with the `num_shots + 1` offsets of the shots into `hits`.
+///     hits: Overwritten with the positions of the set bits, grouped by shot.
+template <size_t W>
+void shot_minor_table_to_csr(
+    const simd_bit_table<W> &table,
+    size_t num_bits_per_shot,
+    size_t num_shots,
+    std::vector<uint64_t> &shot_starts,
+    std::vector<uint64_t> &hits) {
+    // Count the hits of shot k into shot_starts[k + 1], then accumulate the counts into offsets.
+    shot_starts.assign(num_shots + 1, 0);
+    for (size_t m = 0; m < num_bits_per_shot; m++) {
+        for_each_shot_with_set_bit(table[m].u64, num_shots, [&](size_t shot) {
+            shot_starts[shot + 1]++;
+        });
+    }
+    for (size_t k = 0; k < num_shots; k++) {
+        shot_starts[k + 1] += shot_starts[k];
+    }
+
+    // Fill in the hits, using shot_starts[k] as the write cursor of shot k. Rows are visited in increasing order, so
+    // each shot's hits come out sorted. Afterwards each cursor has advanced to the start of the next shot.
+    hits.resize(shot_starts[num_shots]);
+    for (size_t m = 0; m < num_bits_per_shot; m++) {
+        for_each_shot_with_set_bit(table[m].u64, num_shots, [&](size_t shot) {
+            hits[shot_starts[shot]++] = m;
+        });
+    }
+    for (size_t k = num_shots; k > 0; k--) {
+        shot_starts[k] = shot_starts[k - 1];
+    }
+    shot_starts[0] = 0;
+}
+
+/// Converts shot-minor detection event and observable tables into a list of sparse shots.
+///
+/// The detection events are scanned without transposing the table (see `shot_minor_table_to_csr`).
+///
+/// Args:
+///     det_table: Detection event data. Major axis is detector index, minor axis is shot index.
+///     num_detectors: The number of detectors.
+///     obs_table: Observable data. Major axis is observable index, minor axis is shot index.
+///     num_observables: The number of observables.
+///     num_shots: The number of shots to convert.
+///
+/// Returns:
+///     One SparseShot per shot, listing the shot's detection events and storing its observables in the obs_mask.
+template <size_t W>
+std::vector<SparseShot> shot_minor_tables_to_sparse_shots(
+    const simd_bit_table<W> &det_table,
+    size_t num_detectors,
+    const simd_bit_table<W> &obs_table,
+    size_t num_observables,
+    size_t num_shots) {
+    std::vector<uint64_t> shot_starts;
+    std::vector<uint64_t> hits;
+    shot_minor_table_to_csr(det_table, num_detectors, num_shots, shot_starts, hits);
+
+    std::vector<SparseShot> result;
+    result.reserve(num_shots);
+    for (size_t k = 0; k < num_shots; k++) {
+        result.emplace_back(
+            std::vector<uint64_t>(hits.begin() + shot_starts[k], hits.begin() + shot_starts[k + 1]),
+            simd_bits<64>(num_observables));
+    }
+    for (size_t obs = 0; obs < num_observables; obs++) {
+        for_each_shot_with_set_bit(obs_table[obs].u64, num_shots, [&](size_t shot) {
+            result[shot].obs_mask[obs] = true;
+        });
+    }
+    return result;
+}
+
 }  // namespace stim
 
 #endif
@@ -18,6 +18,9 @@
 
 #include "gtest/gtest.h"
 
+#include "stim/mem/simd_word.test.h"
+#include "stim/util_bot/test_util.test.h"
+
 using namespace stim;
 
 static simd_bits<64> obs_mask(uint64_t v) {
@@ -60,3 +63,55 @@ TEST(spares_shot, obs_mask_as_u64) {
     s.obs_mask[64] = true;
     ASSERT_EQ(s.obs_mask_as_u64(), 2);
 }
+
+TEST_EACH_WORD_SIZE_W(sparse_shot, shot_minor_table_to_csr, {
+    auto rng = INDEPENDENT_TEST_RNG();
+    for (size_t num_shots : {0, 1, 63, 64, 65, 1000}) {
+        size_t num_bits = 50;
+        auto table = simd_bit_table<W>::random(num_bits, num_shots, rng);
+        for (size_t m = 0; m < num_bits; m += 3) {
+            table[m].clear();
+        }
+        if (num_shots % 64) {
+            // Bits past the last shot are padding and must be ignored.
+            table[1].u64[num_shots / 64] |= UINT64_MAX << (num_shots % 64);
+        }
+
+        std::vector<uint64_t> shot_starts;
+        std::vector<uint64_t> hits;
+        shot_minor_table_to_csr(table, num_bits, num_shots, shot_starts, hits);
+
+        std::vector<uint64_t> expected_shot_starts{0};
+        std::vector<uint64_t> expected_hits;
+        for (size_t s = 0; s < num_shots; s++) {
+            for (size_t m = 0; m < num_bits; m++) {
+                if (table[m][s]) {
+                    expected_hits.push_back(m);
+                }
+            }
+            expected_shot_starts.push_back(expected_hits.size());
+        }
+        ASSERT_EQ(shot_starts, expected_shot_starts) << num_shots;
+        ASSERT_EQ(hits, expected_hits) << num_shots;
+    }
+})
+
+TEST_EACH_WORD_SIZE_W(sparse_shot, shot_minor_tables_to_sparse_shots, {
+    simd_bit_table<W> dets(5, 3);
+    simd_bit_table<W> obs(2, 3);
+    dets[1][0] = true;
+    dets[4][0] = true;
+    dets[2][2] = true;
+    obs[1][0] = true;
+    obs[0][1] = true;
+    obs[1][1] = true;
+
+    auto shots = shot_minor_tables_to_sparse_shots(dets, 5, obs, 2, 3);
+    ASSERT_EQ(shots.size(), 3);
+    ASSERT_EQ(shots[0].hits, (std::vector<uint64_t>{1, 4}));
+    ASSERT_EQ(shots[0].obs_mask_as_u64(), 2);
+    ASSERT_EQ(shots[1].hits, (std::vector<uint64_t>{}));
+    ASSERT_EQ(shots[1].obs_mask_as_u64(), 3);
+    ASSERT_EQ(shots[2].hits, (std::vector<uint64_t>{2}));
+    ASSERT_EQ(shots[2].obs_mask_as_u64(), 0);
+})
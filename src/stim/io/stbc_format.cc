@@ -0,0 +1,258 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/io/stbc_format.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace stim;
+
+static constexpr uint8_t STBC_VERSION = 1;
+
+static void write_u32_le(uint8_t *out, uint32_t value) {
+    for (size_t k = 0; k < 4; k++) {
+        out[k] = (uint8_t)(value >> (8 * k));
+    }
+}
+
+static void write_u64_le(uint8_t *out, uint64_t value) {
+    for (size_t k = 0; k < 8; k++) {
+        out[k] = (uint8_t)(value >> (8 * k));
+    }
+}
+
+static uint32_t read_u32_le(const uint8_t *in) {
+    uint32_t result = 0;
+    for (size_t k = 0; k < 4; k++) {
+        result |= (uint32_t)in[k] << (8 * k);
+    }
+    return result;
+}
+
+static uint64_t read_u64_le(const uint8_t *in) {
+    uint64_t result = 0;
+    for (size_t k = 0; k < 8; k++) {
+        result |= (uint64_t)in[k] << (8 * k);
+    }
+    return result;
+}
+
+uint32_t stim::crc32_checksum(SpanRef<const uint8_t> data) {
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> result;
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t c = b;
+            for (size_t k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            result[b] = c;
+        }
+        return result;
+    }();
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint8_t b : data) {
+        crc = table[(crc ^ b) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+uint64_t StbcChunkHeader::bits_per_shot() const {
+    return num_measurements + num_detectors + num_observables;
+}
+
+std::array<uint8_t, STBC_CHUNK_HEADER_BYTES> StbcChunkHeader::encode() const {
+    std::array<uint8_t, STBC_CHUNK_HEADER_BYTES> result{};
+    memcpy(result.data(), "STBC", 4);
+    result[4] = STBC_VERSION;
+    result[5] = (uint8_t)encoding;
+    write_u64_le(result.data() + 8, num_shots);
+    write_u64_le(result.data() + 16, num_measurements);
+    write_u64_le(result.data() + 24, num_detectors);
+    write_u64_le(result.data() + 32, num_observables);
+    write_u64_le(result.data() + 40, payload_bytes);
+    write_u32_le(result.data() + 48, payload_checksum);
+    write_u32_le(result.data() + 52, crc32_checksum({result.data(), result.data() + 52}));
+    return result;
+}
+
+StbcChunkHeader StbcChunkHeader::decode(const uint8_t *bytes) {
+    if (memcmp(bytes, "STBC", 4) != 0) {
+        throw std::invalid_argument("stbc data doesn't start with the magic bytes 'STBC'.");
+    }
+    if (bytes[4] != STBC_VERSION) {
+        throw std::invalid_argument("Unsupported stbc format version: " + std::to_string(bytes[4]) + ".");
+    }
+    if (read_u32_le(bytes + 52) != crc32_checksum({bytes, bytes + 52})) {
+        throw std::invalid_argument("stbc chunk header doesn't match its checksum.");
+    }
+    if (bytes[5] > (uint8_t)StbcEncoding::R8 || bytes[6] != 0 || bytes[7] != 0) {
+        throw std::invalid_argument("stbc chunk header has an unknown encoding or non-zero reserved bytes.");
+    }
+
+    StbcChunkHeader result;
+    result.encoding = (StbcEncoding)bytes[5];
+    result.num_shots = read_u64_le(bytes + 8);
+    result.num_measurements = read_u64_le(bytes + 16);
+    result.num_detectors = read_u64_le(bytes + 24);
+    result.num_observables = read_u64_le(bytes + 32);
+    result.payload_bytes = read_u64_le(bytes + 40);
+    result.payload_checksum = read_u32_le(bytes + 48);
+    return result;
+}
+
+bool StbcChunkHeader::read(FILE *in, StbcChunkHeader &out) {
+    std::array<uint8_t, STBC_CHUNK_HEADER_BYTES> bytes;
+    size_t n = fread(bytes.data(), 1, bytes.size(), in);
+    if (n == 0) {
+        return false;
+    }
+    if (n != bytes.size()) {
+        throw std::invalid_argument("stbc data ended in the middle of a chunk header.");
+    }
+    out = decode(bytes.data());
+    return true;
+}
+
+void stim::append_stbc_chunk(
+    SpanRef<const uint8_t> b8_shots,
+    uint64_t num_shots,
+    uint64_t num_measurements,
+    uint64_t num_detectors,
+    uint64_t num_observables,
+    std::vector<uint8_t> &out) {
+    StbcChunkHeader header;
+    header.num_shots = num_shots;
+    header.num_measurements = num_measurements;
+    header.num_detectors = num_detectors;
+    header.num_observables = num_observables;
+    uint64_t bits_per_shot = header.bits_per_shot();
+    size_t bytes_per_shot = (bits_per_shot + 7) / 8;
+    if (b8_shots.size() != num_shots * bytes_per_shot) {
+        throw std::invalid_argument("b8_shots.size() != num_shots * bytes_per_shot");
+    }
+
+    // Run length encode the shots, giving up as soon as it stops being smaller than the bit packed data.
+    std::vector<uint8_t> r8;
+    for (size_t s = 0; s < num_shots && r8.size() < b8_shots.size(); s++) {
+        const uint8_t *shot = b8_shots.ptr_start + s * bytes_per_shot;
+        uint64_t run_length = 0;
+        for (size_t k = 0; k < bits_per_shot; k++) {
+            if ((shot[k >> 3] >> (k & 7)) & 1) {
+                r8.push_back((uint8_t)run_length);
+                run_length = 0;
+            } else {
+                run_length++;
+                if (run_length == 0xFF) {
+                    r8.push_back(0xFF);
+                    run_length = 0;
+                }
+            }
+        }
+        r8.push_back((uint8_t)run_length);
+    }
+
+    SpanRef<const uint8_t> payload = b8_shots;
+    header.encoding = StbcEncoding::B8;
+    if (r8.size() < b8_shots.size()) {
+        payload = r8;
+        header.encoding = StbcEncoding::R8;
+    }
+    header.payload_bytes = payload.size();
+    header.payload_checksum = crc32_checksum(payload);
+
+    auto header_bytes = header.encode();
+    out.insert(out.end(), header_bytes.begin(), header_bytes.end());
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+void stim::decode_stbc_payload(
+    const StbcChunkHeader &header, SpanRef<const uint8_t> payload, std::vector<uint8_t> &b8_out) {
+    if (payload.size() != header.payload_bytes || crc32_checksum(payload) != header.payload_checksum) {
+        throw std::invalid_argument("stbc chunk payload doesn't match its checksum.");
+    }
+    uint64_t bits_per_shot = header.bits_per_shot();
+    size_t bytes_per_shot = (bits_per_shot + 7) / 8;
+    if (bytes_per_shot && header.num_shots > SIZE_MAX / bytes_per_shot) {
+        throw std::invalid_argument("stbc chunk is too large to decode.");
+    }
+
+    if (header.encoding == StbcEncoding::B8) {
+        if (payload.size() != header.num_shots * bytes_per_shot) {
+            throw std::invalid_argument("stbc chunk payload size doesn't match its shot count.");
+        }
+        b8_out.assign(payload.begin(), payload.end());
+        return;
+    }
+
+    // Each r8 shot ends with a run that reaches one past its last bit, as if there were an extra set bit there.
+    if (header.num_shots > payload.size()) {
+        throw std::invalid_argument("stbc chunk payload is too short for its shot count.");
+    }
+    b8_out.assign(header.num_shots * bytes_per_shot, 0);
+    size_t pos = 0;
+    for (size_t s = 0; s < header.num_shots; s++) {
+        uint8_t *shot = b8_out.data() + s * bytes_per_shot;
+        uint64_t k = 0;
+        while (true) {
+            if (pos == payload.size()) {
+                throw std::invalid_argument("stbc chunk payload ended in the middle of a shot.");
+            }
+            uint8_t run = payload.ptr_start[pos++];
+            k += run;
+            if (run == 0xFF) {
+                continue;
+            }
+            if (k > bits_per_shot) {
+                throw std::invalid_argument("stbc chunk payload has a run that goes past the end of a shot.");
+            }
+            if (k == bits_per_shot) {
+                break;
+            }
+            shot[k >> 3] |= uint8_t{1} << (k & 7);
+            k++;
+        }
+    }
+    if (pos != payload.size()) {
+        throw std::invalid_argument("stbc chunk payload has data past the end of its last shot.");
+    }
+}
+
+std::vector<StbcChunkLocation> stim::index_stbc_chunks(FILE *in) {
+    long start = ftell(in);
+    if (start < 0 || fseek(in, 0, SEEK_END) != 0) {
+        throw std::invalid_argument("Indexing stbc data requires a seekable file.");
+    }
+    uint64_t end = (uint64_t)ftell(in);
+
+    std::vector<StbcChunkLocation> result;
+    uint64_t offset = (uint64_t)start;
+    uint64_t next_shot = 0;
+    while (offset < end) {
+        fseek(in, (long)offset, SEEK_SET);
+        StbcChunkHeader header;
+        StbcChunkHeader::read(in, header);
+        uint64_t payload_start = offset + STBC_CHUNK_HEADER_BYTES;
+        if (header.payload_bytes > end - payload_start) {
+            throw std::invalid_argument("stbc data ended in the middle of a chunk payload.");
+        }
+        result.push_back({offset, next_shot, header});
+        next_shot += header.num_shots;
+        offset = payload_start + header.payload_bytes;
+    }
+    fseek(in, start, SEEK_SET);
+    return result;
+}
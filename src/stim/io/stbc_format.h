@@ -0,0 +1,145 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _STIM_IO_STBC_FORMAT_H
+#define _STIM_IO_STBC_FORMAT_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "stim/mem/span_ref.h"
+
+namespace stim {
+
+/// The number of bytes in the header at the start of each chunk of an stbc file.
+constexpr size_t STBC_CHUNK_HEADER_BYTES = 56;
+
+/// Writers end a chunk once it holds this many bytes of bit packed shot data, or this many shots.
+constexpr size_t STBC_CHUNK_TARGET_SIZE = size_t{1} << 16;
+
+/// How the shots in an stbc chunk's payload are encoded.
+enum class StbcEncoding : uint8_t {
+    /// Each shot is bit packed into a whole number of bytes, like the b8 format.
+    B8 = 0,
+    /// Each shot is a list of run lengths, like the r8 format.
+    R8 = 1,
+};
+
+/// The header at the start of each chunk of an stbc file.
+///
+/// An stbc file is a sequence of chunks, and each chunk describes itself completely. This
+/// means that concatenating stbc files produces a valid stbc file, and that a chunk can be
+/// decoded without looking at any other part of the file.
+///
+/// Header layout (integers are little endian):
+///     bytes 0-3: the magic bytes "STBC".
+///     byte 4: the format version (1).
+///     byte 5: the payload encoding (a StbcEncoding).
+///     bytes 6-7: reserved (0).
+///     bytes 8-15: the number of shots in the chunk.
+///     bytes 16-23: the number of measurement results in each shot.
+///     bytes 24-31: the number of detection events in each shot.
+///     bytes 32-39: the number of observable flips in each shot.
+///     bytes 40-47: the number of bytes in the payload that follows the header.
+///     bytes 48-51: the CRC-32 of the payload.
+///     bytes 52-55: the CRC-32 of header bytes 0-51.
+struct StbcChunkHeader {
+    uint64_t num_shots;
+    uint64_t num_measurements;
+    uint64_t num_detectors;
+    uint64_t num_observables;
+    uint64_t payload_bytes;
+    uint32_t payload_checksum;
+    StbcEncoding encoding;
+
+    /// The number of bits in each shot of the chunk.
+    uint64_t bits_per_shot() const;
+    /// Serializes the header, including its own checksum.
+    std::array<uint8_t, STBC_CHUNK_HEADER_BYTES> encode() const;
+    /// Parses a serialized header, after checking its magic bytes, version and checksum.
+    ///
+    /// Throws:
+    ///     std::invalid_argument: The bytes aren't a valid stbc chunk header.
+    static StbcChunkHeader decode(const uint8_t *bytes);
+    /// Reads a header from the current position of a file.
+    ///
+    /// Returns:
+    ///     True if a header was read. False if the file was already at its end.
+    ///
+    /// Throws:
+    ///     std::invalid_argument: The file ended partway through the header, or the header is invalid.
+    static bool read(FILE *in, StbcChunkHeader &out);
+};
+
+/// Computes the CRC-32 checksum (as used by zlib and PNG) of some bytes.
+uint32_t crc32_checksum(SpanRef<const uint8_t> data);
+
+/// Encodes shots into a complete stbc chunk (header and payload), and appends it to `out`.
+///
+/// The payload uses whichever of the supported encodings is smallest.
+///
+/// Args:
+///     b8_shots: The shots, each bit packed into whole bytes, one after another.
+///     num_shots: The number of shots in `b8_shots`.
+///     num_measurements: The number of measurement results in each shot.
+///     num_detectors: The number of detection events in each shot.
+///     num_observables: The number of observable flips in each shot.
+///     out: The buffer to append the chunk to.
+void append_stbc_chunk(
+    SpanRef<const uint8_t> b8_shots,
+    uint64_t num_shots,
+    uint64_t num_measurements,
+    uint64_t num_detectors,
+    uint64_t num_observables,
+    std::vector<uint8_t> &out);
+
+/// Checks and decodes the payload of an stbc chunk into bit packed shots.
+///
+/// Args:
+///     header: The chunk's header.
+///     payload: The chunk's payload.
+///     b8_out: Overwritten with the shots, each bit packed into whole bytes, one after another.
+///
+/// Throws:
+///     std::invalid_argument: The payload doesn't match its checksum, or doesn't decode into the
+///         number of shots stated by the header.
+void decode_stbc_payload(const StbcChunkHeader &header, SpanRef<const uint8_t> payload, std::vector<uint8_t> &b8_out);
+
+/// Where a chunk is within an stbc file.
+struct StbcChunkLocation {
+    /// The file position of the chunk's header.
+    uint64_t file_offset;
+    /// The index of the chunk's first shot, counting from the first indexed chunk.
+    uint64_t first_shot;
+    StbcChunkHeader header;
+};
+
+/// Lists the chunks of an stbc file, from the current position to the end of the file.
+///
+/// Only the chunk headers are read. Payloads are skipped by seeking over them, so the file
+/// must be seekable. The file is left positioned at the first indexed chunk.
+///
+/// To start reading at a given shot, find the chunk containing it, seek to that chunk's
+/// offset, and skip the shots in the chunk before the wanted one. Chunks can also be handed
+/// to separate workers, since each one can be decoded on its own.
+///
+/// Throws:
+///     std::invalid_argument: A chunk header is invalid or the file ends partway through a chunk.
+std::vector<StbcChunkLocation> index_stbc_chunks(FILE *in);
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,270 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/io/stbc_format.h"
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "stim/io/measure_record_batch_writer.h"
+#include "stim/io/measure_record_reader.h"
+#include "stim/io/measure_record_writer.h"
+#include "stim/mem/simd_word.test.h"
+#include "stim/util_bot/test_util.test.h"
+
+using namespace stim;
+
+static std::vector<uint8_t> read_all(FILE *f) {
+    auto s = rewind_read_close(f);
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+TEST(stbc_format, crc32_checksum) {
+    std::string_view check = "123456789";
+    const uint8_t *p = (const uint8_t *)check.data();
+    ASSERT_EQ(crc32_checksum({p, p + check.size()}), 0xCBF43926);
+    ASSERT_EQ(crc32_checksum({}), 0);
+}
+
+TEST(stbc_format, header_round_trip) {
+    StbcChunkHeader header{5, 6, 7, 8, 9, 0x12345678, StbcEncoding::R8};
+    auto bytes = header.encode();
+    ASSERT_EQ(bytes[0], 'S');
+    ASSERT_EQ(bytes[3], 'C');
+    ASSERT_EQ(bytes[4], 1);
+    ASSERT_EQ(bytes[5], 1);
+    ASSERT_EQ(bytes[8], 5);
+    ASSERT_EQ(bytes[16], 6);
+    ASSERT_EQ(bytes[24], 7);
+    ASSERT_EQ(bytes[32], 8);
+    ASSERT_EQ(bytes[40], 9);
+    ASSERT_EQ(bytes[48], 0x78);
+
+    auto decoded = StbcChunkHeader::decode(bytes.data());
+    ASSERT_EQ(decoded.num_shots, 5);
+    ASSERT_EQ(decoded.num_measurements, 6);
+    ASSERT_EQ(decoded.num_detectors, 7);
+    ASSERT_EQ(decoded.num_observables, 8);
+    ASSERT_EQ(decoded.payload_bytes, 9);
+    ASSERT_EQ(decoded.payload_checksum, 0x12345678);
+    ASSERT_EQ(decoded.encoding, StbcEncoding::R8);
+    ASSERT_EQ(decoded.bits_per_shot(), 21);
+
+    bytes[8] ^= 1;
+    ASSERT_THROW({ StbcChunkHeader::decode(bytes.data()); }, std::invalid_argument);
+    bytes[8] ^= 1;
+    bytes[0] = 'X';
+    ASSERT_THROW({ StbcChunkHeader::decode(bytes.data()); }, std::invalid_argument);
+}
+
+TEST(stbc_format, append_chunk_picks_smaller_encoding) {
+    std::vector<uint8_t> dense{0xFF, 0x03, 0xAA, 0x01};
+    std::vector<uint8_t> out;
+    append_stbc_chunk(dense, 2, 10, 0, 0, out);
+    ASSERT_EQ(out.size(), STBC_CHUNK_HEADER_BYTES + 4);
+    auto header = StbcChunkHeader::decode(out.data());
+    ASSERT_EQ(header.encoding, StbcEncoding::B8);
+    std::vector<uint8_t> decoded;
+    decode_stbc_payload(header, {out.data() + STBC_CHUNK_HEADER_BYTES, out.data() + out.size()}, decoded);
+    ASSERT_EQ(decoded, dense);
+
+    std::vector<uint8_t> sparse(2 * 125);
+    sparse[3] = 0x10;
+    sparse[125 + 124] = 0x80;
+    out.clear();
+    append_stbc_chunk(sparse, 2, 0, 999, 1, out);
+    header = StbcChunkHeader::decode(out.data());
+    ASSERT_EQ(header.encoding, StbcEncoding::R8);
+    ASSERT_EQ(header.num_detectors, 999);
+    ASSERT_EQ(header.num_observables, 1);
+    ASSERT_LT(header.payload_bytes, 20);
+    decode_stbc_payload(header, {out.data() + STBC_CHUNK_HEADER_BYTES, out.data() + out.size()}, decoded);
+    ASSERT_EQ(decoded, sparse);
+
+    ASSERT_THROW({ append_stbc_chunk(sparse, 3, 0, 999, 1, out); }, std::invalid_argument);
+}
+
+TEST(stbc_format, decode_detects_corruption) {
+    std::vector<uint8_t> shots(2 * 125);
+    shots[7] = 0x21;
+    std::vector<uint8_t> out;
+    append_stbc_chunk(shots, 2, 1000, 0, 0, out);
+    auto header = StbcChunkHeader::decode(out.data());
+    std::vector<uint8_t> decoded;
+
+    out.back() ^= 4;
+    ASSERT_THROW(
+        { decode_stbc_payload(header, {out.data() + STBC_CHUNK_HEADER_BYTES, out.data() + out.size()}, decoded); },
+        std::invalid_argument);
+    out.back() ^= 4;
+    ASSERT_THROW(
+        { decode_stbc_payload(header, {out.data() + STBC_CHUNK_HEADER_BYTES, out.data() + out.size() - 1}, decoded); },
+        std::invalid_argument);
+
+    // A payload with a correct checksum that doesn't decode into the stated shots.
+    header.num_shots = 3;
+    ASSERT_THROW(
+        { decode_stbc_payload(header, {out.data() + STBC_CHUNK_HEADER_BYTES, out.data() + out.size()}, decoded); },
+        std::invalid_argument);
+}
+
+TEST(stbc_format, writer_chunks_by_layout_and_size) {
+    FILE *tmp = tmpfile();
+    {
+        auto writer = MeasureRecordWriter::make(tmp, SampleFormat::SAMPLE_FORMAT_STBC);
+        uint8_t bytes[]{0xF8};
+        for (size_t k = 0; k < 3; k++) {
+            writer->begin_result_type('D');
+            writer->write_bytes({bytes});
+            writer->write_bit(true);
+            writer->begin_result_type('L');
+            writer->write_bit(k == 1);
+            writer->write_end();
+        }
+        writer->begin_result_type('M');
+        writer->write_bytes({bytes});
+        writer->write_end();
+    }
+    auto data = read_all(tmp);
+
+    auto h1 = StbcChunkHeader::decode(data.data());
+    ASSERT_EQ(h1.num_shots, 3);
+    ASSERT_EQ(h1.num_measurements, 0);
+    ASSERT_EQ(h1.num_detectors, 9);
+    ASSERT_EQ(h1.num_observables, 1);
+    ASSERT_EQ(h1.encoding, StbcEncoding::B8);
+    ASSERT_EQ(h1.payload_bytes, 6);
+    std::vector<uint8_t> expected{0xF8, 0x01, 0xF8, 0x03, 0xF8, 0x01};
+    ASSERT_EQ(std::vector<uint8_t>(data.begin() + 56, data.begin() + 62), expected);
+
+    auto h2 = StbcChunkHeader::decode(data.data() + 62);
+    ASSERT_EQ(h2.num_shots, 1);
+    ASSERT_EQ(h2.num_measurements, 8);
+    ASSERT_EQ(h2.num_detectors, 0);
+    ASSERT_EQ(data.size(), 62 + 56 + 1);
+
+    // Enough shots to need several chunks.
+    tmp = tmpfile();
+    {
+        auto writer = MeasureRecordWriter::make(tmp, SampleFormat::SAMPLE_FORMAT_STBC);
+        std::vector<uint8_t> shot(1000, 0x55);
+        for (size_t k = 0; k < 200; k++) {
+            writer->write_bytes(shot);
+            writer->write_end();
+        }
+    }
+    data = read_all(tmp);
+    ASSERT_EQ(StbcChunkHeader::decode(data.data()).num_shots, 66);
+}
+
+TEST(stbc_format, index_chunks_of_concatenated_files) {
+    FILE *tmp = tmpfile();
+    for (size_t n : {3, 0, 5}) {
+        std::vector<uint8_t> shots(n * 2, 0x17);
+        std::vector<uint8_t> chunk;
+        append_stbc_chunk(shots, n, 16, 0, 0, chunk);
+        fwrite(chunk.data(), 1, chunk.size(), tmp);
+    }
+    rewind(tmp);
+
+    auto index = index_stbc_chunks(tmp);
+    ASSERT_EQ(index.size(), 3);
+    ASSERT_EQ(index[0].file_offset, 0);
+    ASSERT_EQ(index[0].first_shot, 0);
+    ASSERT_EQ(index[1].file_offset, 56 + 6);
+    ASSERT_EQ(index[1].first_shot, 3);
+    ASSERT_EQ(index[2].file_offset, 56 + 6 + 56);
+    ASSERT_EQ(index[2].first_shot, 3);
+    ASSERT_EQ(index[2].header.num_shots, 5);
+    ASSERT_EQ(ftell(tmp), 0);
+
+    // Jump straight to the last chunk.
+    fseek(tmp, (long)index[2].file_offset, SEEK_SET);
+    auto reader = MeasureRecordReader<MAX_BITWORD_WIDTH>::make(tmp, SampleFormat::SAMPLE_FORMAT_STBC, 16);
+    simd_bits<MAX_BITWORD_WIDTH> buf(16);
+    for (size_t k = 0; k < 5; k++) {
+        ASSERT_TRUE(reader->start_and_read_entire_record(buf));
+        ASSERT_EQ(buf.u8[0], 0x17);
+    }
+    ASSERT_FALSE(reader->start_and_read_entire_record(buf));
+
+    // A truncated file is reported instead of silently losing shots.
+    fseek(tmp, -1, SEEK_END);
+    auto end = ftell(tmp);
+    ASSERT_EQ(ftruncate(fileno(tmp), end), 0);
+    rewind(tmp);
+    ASSERT_THROW({ index_stbc_chunks(tmp); }, std::invalid_argument);
+    rewind(tmp);
+    reader = MeasureRecordReader<MAX_BITWORD_WIDTH>::make(tmp, SampleFormat::SAMPLE_FORMAT_STBC, 16);
+    ASSERT_THROW(
+        {
+            while (reader->start_and_read_entire_record(buf)) {
+            }
+        },
+        std::invalid_argument);
+    fclose(tmp);
+}
+
+TEST_EACH_WORD_SIZE_W(stbc_format, reader_sparse_shots_and_layout_checks, {
+    FILE *tmp = tmpfile();
+    {
+        auto writer = MeasureRecordWriter::make(tmp, SampleFormat::SAMPLE_FORMAT_STBC);
+        std::vector<uint8_t> dets(50);
+        dets[1] = 0x04;
+        writer->begin_result_type('D');
+        writer->write_bytes(dets);
+        writer->begin_result_type('L');
+        writer->write_bit(false);
+        writer->write_bit(true);
+        writer->write_end();
+    }
+    rewind(tmp);
+
+    auto reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_STBC, 0, 400, 2);
+    ASSERT_FALSE(reader->expects_empty_serialized_data_for_each_shot());
+    SparseShot shot;
+    ASSERT_TRUE(reader->start_and_read_entire_record(shot));
+    ASSERT_EQ(shot.hits, (std::vector<uint64_t>{10}));
+    ASSERT_EQ(shot.obs_mask_as_u64(), 2);
+    shot.clear();
+    ASSERT_FALSE(reader->start_and_read_entire_record(shot));
+
+    rewind(tmp);
+    reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_STBC, 0, 400, 1);
+    ASSERT_THROW({ reader->start_and_read_entire_record(shot); }, std::invalid_argument);
+    fclose(tmp);
+})
+
+TEST_EACH_WORD_SIZE_W(stbc_format, batch_writer_concatenates_chunks_in_order, {
+    FILE *tmp = tmpfile();
+    {
+        MeasureRecordBatchWriter writer(tmp, 5, SampleFormat::SAMPLE_FORMAT_STBC);
+        simd_bits<W> bits(W);
+        for (size_t s = 0; s < 5; s++) {
+            bits[s] = s % 2 == 1;
+        }
+        writer.batch_write_bit<W>(bits);
+        writer.write_end();
+    }
+    rewind(tmp);
+    auto reader = MeasureRecordReader<W>::make(tmp, SampleFormat::SAMPLE_FORMAT_STBC, 1);
+    simd_bits<W> buf(W);
+    for (size_t s = 0; s < 5; s++) {
+        ASSERT_TRUE(reader->start_and_read_entire_record(buf));
+        ASSERT_EQ(buf[0], s % 2 == 1);
+    }
+    ASSERT_FALSE(reader->start_and_read_entire_record(buf));
+    fclose(tmp);
+})
@@ -459,6 +459,158 @@ def parse_dets(data: str, num_detectors: int, num_observables: int) -> List[List
                     raise NotImplementedError(c)
         shots.append(shot)
     return shots
+)PYTHON",
+            },
+        },
+
+        {
+            "stbc",
+            FileFormatData{
+                "stbc",
+                SampleFormat::SAMPLE_FORMAT_STBC,
+                R"HELP(
+The stbc format is a self-describing binary container that stores shots in checksummed chunks.
+
+An stbc file is a sequence of chunks. Each chunk is a 56 byte header followed by a payload. The header states how many
+shots are in the chunk, how many measurements, detectors, and observables are in each shot, how the payload is
+encoded, and checksums for both the header and the payload. Because every chunk describes itself, concatenating stbc
+files produces a valid stbc file, and a reader can hop from header to header to find a particular shot without
+decoding the payloads in between.
+
+The header layout is (all integers are little endian):
+
+- bytes 0-3: the magic bytes `STBC`.
+- byte 4: the format version (currently 1).
+- byte 5: the payload encoding. 0 means the shots are stored as in the b8 format. 1 means the shots are stored as in
+    the r8 format.
+- bytes 6-7: reserved (must be 0).
+- bytes 8-15: the number of shots in the chunk.
+- bytes 16-23: the number of measurement results in each shot.
+- bytes 24-31: the number of detection events in each shot.
+- bytes 32-39: the number of observable flips in each shot (stored after the other bits of the shot).
+- bytes 40-47: the number of bytes in the payload.
+- bytes 48-51: the CRC-32 checksum (as used by zlib) of the payload.
+- bytes 52-55: the CRC-32 checksum of header bytes 0-51.
+
+Writers pick whichever encoding is smaller for each chunk, and end a chunk once it holds at least 65536 bytes of b8 data
+or 65536 shots (or when the layout of the shots changes). Readers must accept any chunk sizes.
+
+This format doesn't require the reader to know the number of bits in each shot, though stim still checks that it
+matches what was expected.
+
+This format is useful for storing large amounts of data, where it's important to catch corruption and truncation, or to
+be able to jump to the middle of the data.
+
+*Example of producing stbc format data using stim's python API:*
+
+    >>> import pathlib
+    >>> import stim
+    >>> import tempfile
+    >>> with tempfile.TemporaryDirectory() as d:
+    ...     path = str(pathlib.Path(d) / "tmp.dat")
+    ...     stim.Circuit("""
+    ...         X 1
+    ...         M 0 0 0 0 1 1 1 1 0 0 1 1 0 1
+    ...     """).compile_sampler().sample_write(shots=3, filepath=path, format="stbc")
+    ...     with open(path, 'rb') as f:
+    ...         data = f.read()
+    >>> data[:4]
+    b'STBC'
+    >>> int.from_bytes(data[8:16], 'little')  # shots
+    3
+    >>> int.from_bytes(data[16:24], 'little')  # measurements per shot
+    14
+    >>> ' '.join(hex(e)[2:] for e in data[56:])
+    'f0 2c f0 2c f0 2c'
+)HELP",
+                R"PYTHON(
+import zlib
+from typing import List
+
+def _encode_b8(shot: List[bool]) -> bytes:
+    output = bytearray((len(shot) + 7) // 8)
+    for k, b in enumerate(shot):
+        if b:
+            output[k // 8] |= 1 << (k % 8)
+    return bytes(output)
+
+def _encode_r8(shot: List[bool]) -> bytes:
+    output = bytearray()
+    gap = 0
+    for b in list(shot) + [True]:
+        if b:
+            while gap >= 255:
+                gap -= 255
+                output.append(255)
+            output.append(gap)
+            gap = 0
+        else:
+            gap += 1
+    return bytes(output)
+
+def _save_stbc_chunk(shots: List[List[bool]], num_measurements: int, num_detectors: int, num_observables: int) -> bytes:
+    b8 = b''.join(_encode_b8(shot) for shot in shots)
+    r8 = b''.join(_encode_r8(shot) for shot in shots)
+    encoding, payload = (1, r8) if len(r8) < len(b8) else (0, b8)
+    header = b'STBC' + bytes([1, encoding, 0, 0])
+    for v in [len(shots), num_measurements, num_detectors, num_observables, len(payload)]:
+        header += v.to_bytes(8, 'little')
+    header += zlib.crc32(payload).to_bytes(4, 'little')
+    header += zlib.crc32(header).to_bytes(4, 'little')
+    return header + payload
+
+def save_stbc(shots: List[List[bool]], num_measurements: int = 0, num_detectors: int = 0, num_observables: int = 0) -> bytes:
+    output = []
+    chunk = []
+    for shot in shots:
+        assert len(shot) == num_measurements + num_detectors + num_observables
+        chunk.append(shot)
+        if len(chunk) * ((len(shot) + 7) // 8) >= 65536 or len(chunk) >= 65536:
+            output.append(_save_stbc_chunk(chunk, num_measurements, num_detectors, num_observables))
+            chunk = []
+    if chunk:
+        output.append(_save_stbc_chunk(chunk, num_measurements, num_detectors, num_observables))
+    return b''.join(output)
+)PYTHON",
+                R"PYTHON(
+import zlib
+from typing import List
+
+def parse_stbc(data: bytes) -> List[List[bool]]:
+    shots = []
+    pos = 0
+    while pos < len(data):
+        header = data[pos:pos + 56]
+        assert len(header) == 56 and header[:5] == b'STBC\x01'
+        assert zlib.crc32(header[:52]) == int.from_bytes(header[52:56], 'little')
+        encoding = header[5]
+        num_shots, nm, nd, no, payload_bytes = [int.from_bytes(header[8 + 8*k:16 + 8*k], 'little') for k in range(5)]
+        bits_per_shot = nm + nd + no
+        payload = data[pos + 56:pos + 56 + payload_bytes]
+        assert len(payload) == payload_bytes
+        assert zlib.crc32(payload) == int.from_bytes(header[48:52], 'little')
+        pos += 56 + payload_bytes
+
+        if encoding == 0:
+            bytes_per_shot = (bits_per_shot + 7) // 8
+            assert len(payload) == num_shots * bytes_per_shot
+            for s in range(num_shots):
+                shot = payload[s * bytes_per_shot:(s + 1) * bytes_per_shot]
+                shots.append([bool((shot[k // 8] >> (k % 8)) & 1) for k in range(bits_per_shot)])
+        else:
+            assert encoding == 1
+            shot = []
+            for byte in payload:
+                shot += [False] * byte
+                if byte != 255:
+                    shot.append(True)
+                if len(shot) > bits_per_shot:
+                    assert len(shot) == bits_per_shot + 1 and shot[-1]
+                    shot.pop()
+                    shots.append(shot)
+                    shot = []
+            assert len(shot) == 0
+    return shots
 )PYTHON",
             },
         },
@@ -13,6 +13,7 @@ enum class SampleFormat {
     SAMPLE_FORMAT_HITS,
     SAMPLE_FORMAT_R8,
     SAMPLE_FORMAT_DETS,
+    SAMPLE_FORMAT_STBC,
 };
 
 struct FileFormatData {
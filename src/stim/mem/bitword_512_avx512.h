@@ -0,0 +1,268 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_MEM_SIMD_WORD_512_AVX512_H
+#define _STIM_MEM_SIMD_WORD_512_AVX512_H
+#if __AVX512F__
+
+#include <array>
+#include <bit>
+#include <immintrin.h>
+#include <sstream>
+#include <stdexcept>
+
+#include "stim/mem/bitword.h"
+
+namespace stim {
+
+/// Implements a 512 bit bitword using AVX-512 instructions.
+template <>
+struct bitword<512> {
+    constexpr static size_t BIT_SIZE = 512;
+    constexpr static size_t BIT_POW = 9;
+
+    /// Full lane mask for the `_mm512_maskz_*` forms of intrinsics. GCC expands several unmasked forms (e.g.
+    /// andnot, slli, srli, and reduce_add on GCC 12) with `_mm512_undefined_epi32()` as the pass-through operand,
+    /// which triggers spurious -Wuninitialized warnings (GCC bug 105593) in every file that includes this header.
+    constexpr static __mmask8 ALL_LANES = 0xFF;
+
+    union {
+        __m512i val;
+        uint8_t u8[64];
+        uint64_t u64[8];
+    };
+
+    static void *aligned_malloc(size_t bytes) {
+        return _mm_malloc(bytes, sizeof(__m512i));
+    }
+    static void aligned_free(void *ptr) {
+        _mm_free(ptr);
+    }
+
+    inline bitword() : val(_mm512_setzero_si512()) {
+    }
+    inline bitword(__m512i val) : val(val) {
+    }
+    inline bitword(std::array<uint64_t, 8> val)
+        : val{_mm512_set_epi64(val[7], val[6], val[5], val[4], val[3], val[2], val[1], val[0])} {
+    }
+    inline bitword(uint64_t val) : val{_mm512_set_epi64(0, 0, 0, 0, 0, 0, 0, val)} {
+    }
+    inline bitword(int64_t val) : val{_mm512_set_epi64(0, 0, 0, 0, 0, 0, 0, val)} {
+        if (val < 0) {
+            this->val = _mm512_mask_set1_epi64(this->val, 0xFE, -1);
+        }
+    }
+    inline bitword(int val) : bitword((int64_t)val) {
+    }
+
+    inline static bitword<512> tile8(uint8_t pattern) {
+        return {_mm512_set1_epi8(pattern)};
+    }
+
+    inline static bitword<512> tile16(uint16_t pattern) {
+        return {_mm512_set1_epi16(pattern)};
+    }
+
+    inline static bitword<512> tile32(uint32_t pattern) {
+        return {_mm512_set1_epi32(pattern)};
+    }
+
+    inline static bitword<512> tile64(uint64_t pattern) {
+        return {_mm512_set1_epi64(pattern)};
+    }
+
+    inline std::array<uint64_t, 8> to_u64_array() const {
+        std::array<uint64_t, 8> result;
+        _mm512_storeu_si512(result.data(), val);
+        return result;
+    }
+
+    inline operator bool() const {  // NOLINT(hicpp-explicit-conversions)
+        return _mm512_test_epi64_mask(val, val) != 0;
+    }
+    inline operator int() const {  // NOLINT(hicpp-explicit-conversions)
+        return (int64_t)*this;
+    }
+    inline operator uint64_t() const {  // NOLINT(hicpp-explicit-conversions)
+        auto words = to_u64_array();
+        for (size_t k = 1; k < 8; k++) {
+            if (words[k]) {
+                throw std::invalid_argument("Too large for uint64_t");
+            }
+        }
+        return words[0];
+    }
+    inline operator int64_t() const {  // NOLINT(hicpp-explicit-conversions)
+        auto words = to_u64_array();
+        int64_t result = (int64_t)words[0];
+        uint64_t expected = result < 0 ? (uint64_t)-1 : (uint64_t)0;
+        for (size_t k = 1; k < 8; k++) {
+            if (words[k] != expected) {
+                throw std::invalid_argument("Out of bounds of int64_t");
+            }
+        }
+        return result;
+    }
+
+    inline bitword<512> &operator^=(const bitword<512> &other) {
+        val = _mm512_maskz_xor_epi64(ALL_LANES, val, other.val);
+        return *this;
+    }
+
+    inline bitword<512> &operator&=(const bitword<512> &other) {
+        val = _mm512_maskz_and_epi64(ALL_LANES, val, other.val);
+        return *this;
+    }
+
+    inline bitword<512> &operator|=(const bitword<512> &other) {
+        val = _mm512_maskz_or_epi64(ALL_LANES, val, other.val);
+        return *this;
+    }
+
+    inline bitword<512> operator^(const bitword<512> &other) const {
+        return {_mm512_maskz_xor_epi64(ALL_LANES, val, other.val)};
+    }
+
+    inline bitword<512> operator&(const bitword<512> &other) const {
+        return {_mm512_maskz_and_epi64(ALL_LANES, val, other.val)};
+    }
+
+    inline bitword<512> operator|(const bitword<512> &other) const {
+        return {_mm512_maskz_or_epi64(ALL_LANES, val, other.val)};
+    }
+
+    inline bitword<512> andnot(const bitword<512> &other) const {
+        return {_mm512_maskz_andnot_epi64(ALL_LANES, val, other.val)};
+    }
+
+    inline bitword<512> operator~() const {
+        // Truth table 0x55 is "not C", so this is a single instruction without a constant load.
+        return {_mm512_ternarylogic_epi64(val, val, val, 0x55)};
+    }
+
+    inline uint16_t popcount() const {
+#if __AVX512VPOPCNTDQ__
+        auto counts = bitword<512>{_mm512_popcnt_epi64(val)}.to_u64_array();
+        uint16_t result = 0;
+        for (auto e : counts) {
+            result += (uint16_t)e;
+        }
+        return result;
+#else
+        auto v = to_u64_array();
+        uint16_t result = 0;
+        for (auto e : v) {
+            result += std::popcount(e);
+        }
+        return result;
+#endif
+    }
+
+    inline bitword<512> shifted(int offset) const {
+        auto w = to_u64_array();
+        std::array<uint64_t, 8> r{};
+        int word_offset = offset >= 0 ? offset / 64 : -((-offset + 63) / 64);
+        int bit_offset = offset - word_offset * 64;
+        for (int k = 0; k < 8; k++) {
+            int src = k - word_offset;
+            uint64_t v = 0;
+            if (src >= 0 && src < 8) {
+                v = w[src] << bit_offset;
+            }
+            if (bit_offset && src - 1 >= 0 && src - 1 < 8) {
+                v |= w[src - 1] >> (64 - bit_offset);
+            }
+            r[k] = v;
+        }
+        return r;
+    }
+
+    inline std::string str() const {
+        std::stringstream out;
+        out << *this;
+        return out.str();
+    }
+
+    inline bool operator==(const bitword<512> &other) const {
+        return _mm512_cmpneq_epi64_mask(val, other.val) == 0;
+    }
+    inline bool operator!=(const bitword<512> &other) const {
+        return !(*this == other);
+    }
+    inline bool operator==(int other) const {
+        return *this == (bitword<512>)other;
+    }
+    inline bool operator!=(int other) const {
+        return *this != (bitword<512>)other;
+    }
+    inline bool operator==(uint64_t other) const {
+        return *this == (bitword<512>)other;
+    }
+    inline bool operator!=(uint64_t other) const {
+        return *this != (bitword<512>)other;
+    }
+    inline bool operator==(int64_t other) const {
+        return *this == (bitword<512>)other;
+    }
+    inline bool operator!=(int64_t other) const {
+        return *this != (bitword<512>)other;
+    }
+
+    template <uint64_t shift>
+    static void inplace_transpose_block_pass(bitword<512> *data, size_t stride, __m512i mask) {
+        // Truth table 0xCA is "A ? B : C", so each half of the exchange is one ternary-logic instruction.
+        for (size_t k = 0; k < 512; k++) {
+            if (k & shift) {
+                continue;
+            }
+            __m512i &x = data[stride * k].val;
+            __m512i &y = data[stride * (k + shift)].val;
+            __m512i new_x = _mm512_ternarylogic_epi64(mask, x, _mm512_maskz_slli_epi64(ALL_LANES, y, shift), 0xCA);
+            __m512i new_y = _mm512_ternarylogic_epi64(mask, _mm512_maskz_srli_epi64(ALL_LANES, x, shift), y, 0xCA);
+            x = new_x;
+            y = new_y;
+        }
+    }
+
+    static void inplace_transpose_block_pass_64_and_128_and_256(bitword<512> *data, size_t stride) {
+        uint64_t *ptr = (uint64_t *)data;
+        stride <<= 3;
+
+        for (size_t k = 0; k < 64; k++) {
+            for (size_t i = 0; i < 8; i++) {
+                for (size_t j = i + 1; j < 8; j++) {
+                    std::swap(ptr[stride * (k + 64 * i) + j], ptr[stride * (k + 64 * j) + i]);
+                }
+            }
+        }
+    }
+
+    static void inplace_transpose_square(bitword<512> *data, size_t stride) {
+        inplace_transpose_block_pass<1>(data, stride, _mm512_set1_epi8(0x55));
+        inplace_transpose_block_pass<2>(data, stride, _mm512_set1_epi8(0x33));
+        inplace_transpose_block_pass<4>(data, stride, _mm512_set1_epi8(0xF));
+        inplace_transpose_block_pass<8>(data, stride, _mm512_set1_epi16(0xFF));
+        inplace_transpose_block_pass<16>(data, stride, _mm512_set1_epi32(0xFFFF));
+        inplace_transpose_block_pass<32>(data, stride, _mm512_set1_epi64(0xFFFFFFFF));
+        inplace_transpose_block_pass_64_and_128_and_256(data, stride);
+    }
+};
+
+}  // namespace stim
+
+#endif
+#endif
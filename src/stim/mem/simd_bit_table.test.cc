@@ -70,7 +70,7 @@ TEST_EACH_WORD_SIZE_W(simd_bit_table, creation, {
         ".....");
 
     simd_bit_table<W> t = simd_bit_table<W>::from_text("", 512, 256);
-    ASSERT_EQ(t.num_minor_bits_padded(), 256);
+    ASSERT_EQ(t.num_minor_bits_padded(), min_bits_to_num_bits_padded<W>(256));
     ASSERT_EQ(t.num_major_bits_padded(), 512);
 })
 
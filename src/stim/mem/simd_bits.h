@@ -122,7 +122,9 @@ struct simd_bits {
     /// Sets all bits in the range to zero.
     void clear();
     /// Randomizes the contents of this simd_bits using the given random number generator, up to the given bit position.
-    void randomize(size_t num_bits, std::mt19937_64 &rng);
+    /// The generator is either std::mt19937_64 or PhiloxRng.
+    template <typename RNG>
+    void randomize(size_t num_bits, RNG &rng);
     /// Returns a simd_bits with at least the given number of bits, with bits up to the given number of bits randomized.
     /// Padding bits beyond the minimum number of bits are not randomized.
     static simd_bits<W> random(size_t min_bits, std::mt19937_64 &rng);
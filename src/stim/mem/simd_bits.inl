@@ -126,7 +126,8 @@ simd_bits<W> simd_bits<W>::random(size_t min_bits, std::mt19937_64 &rng) {
 }
 
 template <size_t W>
-void simd_bits<W>::randomize(size_t num_bits, std::mt19937_64 &rng) {
+template <typename RNG>
+void simd_bits<W>::randomize(size_t num_bits, RNG &rng) {
     simd_bits_range_ref<W>(*this).randomize(num_bits, rng);
 }
 
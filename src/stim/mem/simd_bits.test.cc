@@ -68,7 +68,17 @@ TEST_EACH_WORD_SIZE_W(simd_bits, aliased_editing_and_bit_refs, {
 
 TEST_EACH_WORD_SIZE_W(simd_bits, min_bits_to_num_bits_padded, {
     const auto &f = &min_bits_to_num_bits_padded<W>;
-    if (W == 256) {
+    if (W == 512) {
+        ASSERT_EQ(f(0), 0);
+        ASSERT_EQ(f(1), 512);
+        ASSERT_EQ(f(100), 512);
+        ASSERT_EQ(f(511), 512);
+        ASSERT_EQ(f(512), 512);
+        ASSERT_EQ(f(513), 1024);
+        ASSERT_EQ(f((1 << 30) - 1), 1 << 30);
+        ASSERT_EQ(f(1 << 30), 1 << 30);
+        ASSERT_EQ(f((1 << 30) + 1), (1 << 30) + 512);
+    } else if (W == 256) {
         ASSERT_EQ(f(0), 0);
         ASSERT_EQ(f(1), 256);
         ASSERT_EQ(f(100), 256);
@@ -105,19 +115,22 @@ TEST_EACH_WORD_SIZE_W(simd_bits, min_bits_to_num_bits_padded, {
 
 TEST_EACH_WORD_SIZE_W(simd_bits, str, {
     simd_bits<W> d(256);
+    std::string padding(min_bits_to_num_bits_padded<W>(256) - 256, '_');
     ASSERT_EQ(
         d.str(),
         "________________________________________________________________"
         "________________________________________________________________"
         "________________________________________________________________"
-        "________________________________________________________________");
+        "________________________________________________________________" +
+            padding);
     d[5] = true;
     ASSERT_EQ(
         d.str(),
         "_____1__________________________________________________________"
         "________________________________________________________________"
         "________________________________________________________________"
-        "________________________________________________________________");
+        "________________________________________________________________" +
+            padding);
 })
 
 TEST_EACH_WORD_SIZE_W(simd_bits, randomize, {
@@ -241,7 +254,7 @@ TEST_EACH_WORD_SIZE_W(simd_bits, add_assignment, {
     size_t num_bits = 193;
     simd_bits<W> add(num_bits);
     simd_bits<W> one(num_bits);
-    for (size_t word = 0; word < add.num_u64_padded() - 1; word++) {
+    for (size_t word = 0; word < (num_bits - 1) / 64; word++) {
         for (size_t k = 0; k < 64; k++) {
             add[word * 64 + k] = 1;
         }
@@ -578,7 +591,7 @@ TEST_EACH_WORD_SIZE_W(simd_bits, not_zero, {
 })
 
 TEST_EACH_WORD_SIZE_W(simd_bits, word_range_ref, {
-    simd_bits<W> d(1024);
+    simd_bits<W> d(2048);
     const simd_bits<W> &cref = d;
     auto r1 = d.word_range_ref(1, 2);
     auto r2 = d.word_range_ref(2, 2);
@@ -687,14 +700,14 @@ TEST_EACH_WORD_SIZE_W(simd_bits, out_of_place_bit_masking, {
 })
 
 TEST_EACH_WORD_SIZE_W(simd_bits, destructive_resize, {
-    simd_bits<W> m0(512);
+    simd_bits<W> m0(1024);
     m0[0] = true;
     ASSERT_TRUE(m0.not_zero());
     m0.destructive_resize(256);
     ASSERT_FALSE(m0.not_zero());
     m0[0] = true;
     ASSERT_TRUE(m0.not_zero());
-    m0.destructive_resize(512);
+    m0.destructive_resize(1024);
     ASSERT_FALSE(m0.not_zero());
 })
 
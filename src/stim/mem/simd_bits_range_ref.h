@@ -24,6 +24,7 @@
 
 #include "stim/mem/bit_ref.h"
 #include "stim/mem/simd_word.h"
+#include "stim/util_bot/probability_util.h"
 
 namespace stim {
 
@@ -111,7 +112,9 @@ struct simd_bits_range_ref {
     /// Sets all bits in the referenced range to zero.
     void clear();
     /// Randomizes the bits in the referenced range, up to the given bit count. Leaves further bits unchanged.
-    void randomize(size_t num_bits, std::mt19937_64 &rng);
+    /// The generator is either std::mt19937_64 or PhiloxRng.
+    template <typename RNG>
+    void randomize(size_t num_bits, RNG &rng);
     /// Returns the number of bits that are 1 in the bit range.
     size_t popcnt() const;
     /// Returns the power-of-two-ness of the number, or SIZE_MAX if the number has no 1s.
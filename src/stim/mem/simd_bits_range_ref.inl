@@ -187,11 +187,10 @@ std::string simd_bits_range_ref<W>::str() const {
 }
 
 template <size_t W>
-void simd_bits_range_ref<W>::randomize(size_t num_bits, std::mt19937_64 &rng) {
+template <typename RNG>
+void simd_bits_range_ref<W>::randomize(size_t num_bits, RNG &rng) {
     auto n = num_bits >> 6;
-    for (size_t k = 0; k < n; k++) {
-        u64[k] = rng();
-    }
+    fill_random_words(rng, u64, n);
     auto leftover = num_bits & 63;
     if (leftover) {
         uint64_t mask = ((uint64_t)1 << leftover) - 1;
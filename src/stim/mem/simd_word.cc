@@ -13,3 +13,7 @@
 // limitations under the License.
 
 #include "stim/mem/simd_word.h"
+
+#include "stim/util_bot/cpu_check.h"
+
+const size_t stim::COMPILED_MAX_BITWORD_WIDTH = stim::MAX_BITWORD_WIDTH;
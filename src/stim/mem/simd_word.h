@@ -22,10 +22,13 @@
 
 #include "stim/mem/bitword_128_sse.h"
 #include "stim/mem/bitword_256_avx.h"
+#include "stim/mem/bitword_512_avx512.h"
 #include "stim/mem/bitword_64.h"
 
 namespace stim {
-#if __AVX2__
+#if __AVX512F__
+constexpr size_t MAX_BITWORD_WIDTH = 512;
+#elif __AVX2__
 constexpr size_t MAX_BITWORD_WIDTH = 256;
 #elif __SSE2__
 constexpr size_t MAX_BITWORD_WIDTH = 128;
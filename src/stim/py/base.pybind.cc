@@ -14,6 +14,8 @@
 
 #include "stim/py/base.pybind.h"
 
+#include <array>
+#include <functional>
 #include <memory>
 
 #include "stim/util_bot/probability_util.h"
@@ -33,6 +35,16 @@ std::mt19937_64 stim_pybind::make_py_seeded_rng(const pybind11::object &seed) {
     }
 }
 
+std::unique_lock<std::mutex> stim_pybind::lock_py_object(const void *obj) {
+    static std::array<std::mutex, 64> mutexes;
+    std::mutex &m = mutexes[(std::hash<const void *>{}(obj) >> 4) % mutexes.size()];
+    if (m.try_lock()) {
+        return std::unique_lock<std::mutex>(m, std::adopt_lock);
+    }
+    pybind11::gil_scoped_release release;
+    return std::unique_lock<std::mutex>(m);
+}
+
 bool stim_pybind::normalize_index_or_slice(
     const pybind11::object &index_or_slice,
     size_t length,
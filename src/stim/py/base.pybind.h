@@ -20,6 +20,7 @@
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <mutex>
 #include <random>
 
 #include "stim/circuit/circuit.h"
@@ -31,6 +32,23 @@ namespace stim_pybind {
 std::mt19937_64 make_py_seeded_rng(const pybind11::object &seed);
 stim::SampleFormat format_to_enum(std::string_view format);
 
+/// Locks the mutex guarding a python-owned object against concurrent use.
+///
+/// Methods that release the GIL while working on an object's state have to hold this lock
+/// (as do the methods that touch the same state while holding the GIL), because other python
+/// threads can call into the object as soon as the GIL is released. If the lock is busy, the
+/// GIL is released while waiting for it, so the holder can reacquire the GIL and finish.
+///
+/// Objects share a fixed pool of mutexes, picked by address. A call must hold at most one
+/// of these locks at a time.
+///
+/// Args:
+///     obj: The address of the object to lock.
+///
+/// Returns:
+///     The held lock. Keep it until the method is done reading the object's state.
+std::unique_lock<std::mutex> lock_py_object(const void *obj);
+
 /// Converts a python index or slice into a form that's easier to consume.
 ///
 /// In particular, replaces negative indices with non-negative indices.
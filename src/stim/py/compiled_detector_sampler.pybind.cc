@@ -31,6 +31,47 @@ CompiledDetectorSampler::CompiledDetectorSampler(Circuit init_circuit, std::mt19
       frame_sim(circuit_stats, FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY, 0, std::move(rng)) {
 }
 
+static pybind11::object detection_tables_to_numpy(
+    const CircuitStats &circuit_stats,
+    const simd_bit_table<MAX_BITWORD_WIDTH> &det_data,
+    const simd_bit_table<MAX_BITWORD_WIDTH> &obs_data,
+    size_t num_shots,
+    bool prepend_observables,
+    bool append_observables,
+    bool separate_observables,
+    bool bit_packed,
+    pybind11::object dets_out,
+    pybind11::object obs_out) {
+    pybind11::object py_obs_data = pybind11::none();
+    if (separate_observables || !obs_out.is_none()) {
+        py_obs_data =
+            simd_bit_table_to_numpy(obs_data, circuit_stats.num_observables, num_shots, bit_packed, true, obs_out);
+    }
+
+    pybind11::object py_det_data;
+    if (append_observables || prepend_observables) {
+        // Export the observables next to the detectors directly, instead of concatenating the tables first.
+        std::vector<SimdBitTableRows> parts;
+        if (prepend_observables) {
+            parts.push_back({obs_data, 0, circuit_stats.num_observables});
+        }
+        parts.push_back({det_data, 0, circuit_stats.num_detectors});
+        if (append_observables) {
+            parts.push_back({obs_data, 0, circuit_stats.num_observables});
+        }
+        py_det_data = transposed_simd_bit_table_rows_to_numpy(parts, num_shots, bit_packed, dets_out);
+    } else {
+        py_det_data =
+            simd_bit_table_to_numpy(det_data, circuit_stats.num_detectors, num_shots, bit_packed, true, dets_out);
+    }
+
+    if (separate_observables) {
+        return pybind11::make_tuple(py_det_data, py_obs_data);
+    } else {
+        return py_det_data;
+    }
+}
+
 pybind11::object CompiledDetectorSampler::sample_to_numpy(
     size_t num_shots,
     bool prepend_observables,
@@ -44,6 +85,7 @@ pybind11::object CompiledDetectorSampler::sample_to_numpy(
             "Can't specify separate_observables=True with append_observables=True or prepend_observables=True");
     }
 
+    auto lock = lock_py_object(this);
     {
         pybind11::gil_scoped_release release;
         frame_sim.configure_for(circuit_stats, FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY, num_shots);
@@ -51,38 +93,63 @@ pybind11::object CompiledDetectorSampler::sample_to_numpy(
         frame_sim.do_circuit(circuit);
     }
 
-    const auto &det_data = frame_sim.det_record.storage;
-    const auto &obs_data = frame_sim.obs_record;
+    return detection_tables_to_numpy(
+        circuit_stats,
+        frame_sim.det_record.storage,
+        frame_sim.obs_record,
+        num_shots,
+        prepend_observables,
+        append_observables,
+        separate_observables,
+        bit_packed,
+        dets_out,
+        obs_out);
+}
 
-    pybind11::object py_obs_data = pybind11::none();
-    if (separate_observables || !obs_out.is_none()) {
-        py_obs_data =
-            simd_bit_table_to_numpy(obs_data, circuit_stats.num_observables, num_shots, bit_packed, true, obs_out);
+static pybind11::object u64_vector_to_numpy_int64(const std::vector<uint64_t> &values) {
+    auto numpy = pybind11::module::import("numpy");
+    pybind11::object result = numpy.attr("empty")(values.size(), numpy.attr("int64"));
+    auto buf = pybind11::cast<pybind11::array_t<int64_t>>(result);
+    if (!values.empty()) {
+        // The values are indices, so they are far too small for the sign bit to matter.
+        memcpy(buf.mutable_data(0), values.data(), values.size() * sizeof(uint64_t));
     }
+    return result;
+}
 
-    pybind11::object py_det_data = pybind11::none();
-    if (append_observables || prepend_observables) {
-        size_t num_concat = circuit_stats.num_detectors;
-        simd_bit_table<MAX_BITWORD_WIDTH> concat_data = det_data;
+pybind11::object CompiledDetectorSampler::sample_sparse_to_numpy(
+    size_t num_shots, bool append_observables, bool separate_observables) {
+    if (separate_observables && append_observables) {
+        throw std::invalid_argument("Can't specify separate_observables=True with append_observables=True");
+    }
+
+    auto lock = lock_py_object(this);
+    std::vector<uint64_t> shot_starts;
+    std::vector<uint64_t> hits;
+    {
+        pybind11::gil_scoped_release release;
+        frame_sim.configure_for(circuit_stats, FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY, num_shots);
+        frame_sim.reset_all();
+        frame_sim.do_circuit(circuit);
         if (append_observables) {
-            concat_data = concat_data.concat_major(obs_data, num_concat, circuit_stats.num_observables);
-            num_concat += circuit_stats.num_observables;
-        }
-        if (prepend_observables) {
-            concat_data = obs_data.concat_major(concat_data, circuit_stats.num_observables, num_concat);
-            num_concat += circuit_stats.num_observables;
+            auto combined = frame_sim.det_record.storage.concat_major(
+                frame_sim.obs_record, circuit_stats.num_detectors, circuit_stats.num_observables);
+            shot_minor_table_to_csr(
+                combined, circuit_stats.num_detectors + circuit_stats.num_observables, num_shots, shot_starts, hits);
+        } else {
+            shot_minor_table_to_csr(
+                frame_sim.det_record.storage, circuit_stats.num_detectors, num_shots, shot_starts, hits);
         }
-        py_det_data = simd_bit_table_to_numpy(concat_data, num_concat, num_shots, bit_packed, true, dets_out);
-    } else {
-        py_det_data =
-            simd_bit_table_to_numpy(det_data, circuit_stats.num_detectors, num_shots, bit_packed, true, dets_out);
     }
 
+    pybind11::object py_indices = u64_vector_to_numpy_int64(hits);
+    pybind11::object py_indptr = u64_vector_to_numpy_int64(shot_starts);
     if (separate_observables) {
-        return pybind11::make_tuple(py_det_data, py_obs_data);
-    } else {
-        return py_det_data;
+        pybind11::object py_obs = simd_bit_table_to_numpy(
+            frame_sim.obs_record, circuit_stats.num_observables, num_shots, false, true, pybind11::none());
+        return pybind11::make_tuple(py_indices, py_indptr, py_obs);
     }
+    return pybind11::make_tuple(py_indices, py_indptr);
 }
 
 void CompiledDetectorSampler::sample_write(
@@ -92,8 +159,12 @@ void CompiledDetectorSampler::sample_write(
     bool prepend_observables,
     bool append_observables,
     pybind11::object obs_out_filepath_obj,
-    std::string_view obs_out_format) {
+    std::string_view obs_out_format,
+    size_t num_threads) {
     auto f = format_to_enum(format);
+    if (num_threads == 0) {
+        throw std::invalid_argument("num_threads must be at least 1.");
+    }
 
     auto py_path = pybind11::module::import("pathlib").attr("Path");
     if (pybind11::isinstance(filepath_obj, py_path)) {
@@ -128,6 +199,9 @@ void CompiledDetectorSampler::sample_write(
     RaiiFile out(filepath, "wb");
     RaiiFile obs_out(obs_out_filepath_view, "wb");
     auto parsed_obs_out_format = format_to_enum(obs_out_format);
+    auto lock = lock_py_object(this);
+    pybind11::gil_scoped_release release;
+    std::mt19937_64 key_rng(frame_sim.rng());
     sample_batch_detection_events_writing_results_to_disk<MAX_BITWORD_WIDTH>(
         circuit,
         num_samples,
@@ -135,9 +209,98 @@ void CompiledDetectorSampler::sample_write(
         append_observables,
         out.f,
         f,
-        frame_sim.rng,
+        key_rng,
         obs_out.f,
-        parsed_obs_out_format);
+        parsed_obs_out_format,
+        num_threads);
+}
+
+DetectionEventBatchIterator CompiledDetectorSampler::iter_batches(
+    size_t num_shots,
+    size_t batch_size,
+    bool prepend_observables,
+    bool append_observables,
+    bool separate_observables,
+    bool bit_packed) {
+    if (separate_observables && (append_observables || prepend_observables)) {
+        throw std::invalid_argument(
+            "Can't specify separate_observables=True with append_observables=True or prepend_observables=True");
+    }
+    if (batch_size == 0) {
+        throw std::invalid_argument("batch_size must be positive.");
+    }
+
+    DetectionEventBatchIterator result{
+        circuit_stats,
+        batch_size,
+        prepend_observables,
+        append_observables,
+        separate_observables,
+        bit_packed,
+        nullptr,
+        pybind11::none(),
+        pybind11::none(),
+    };
+    auto lock = lock_py_object(this);
+    result.stream = std::make_unique<DetectionEventBatchStream<MAX_BITWORD_WIDTH>>(
+        circuit, num_shots, batch_size, std::mt19937_64(frame_sim.rng()));
+    return result;
+}
+
+pybind11::object DetectionEventBatchIterator::next() {
+    auto lock = lock_py_object(this);
+    bool has_batch;
+    {
+        pybind11::gil_scoped_release release;
+        has_batch = stream->next();
+    }
+    if (!has_batch) {
+        throw pybind11::stop_iteration();
+    }
+    size_t n = stream->num_batch_shots;
+
+    if (dets_buffer.is_none()) {
+        // First batch. Keep the arrays it allocates, and write later batches into them.
+        pybind11::object result = detection_tables_to_numpy(
+            circuit_stats,
+            stream->det_data,
+            stream->obs_data,
+            n,
+            prepend_observables,
+            append_observables,
+            separate_observables,
+            bit_packed,
+            pybind11::none(),
+            pybind11::none());
+        if (separate_observables) {
+            dets_buffer = result[pybind11::int_(0)];
+            obs_buffer = result[pybind11::int_(1)];
+        } else {
+            dets_buffer = result;
+        }
+        return result;
+    }
+
+    // Only the last batch can be smaller. It gets written into the leading rows of the arrays.
+    pybind11::object dets_out = dets_buffer;
+    pybind11::object obs_out = obs_buffer;
+    if (n < batch_size) {
+        dets_out = dets_buffer[pybind11::slice(0, n, 1)];
+        if (separate_observables) {
+            obs_out = obs_buffer[pybind11::slice(0, n, 1)];
+        }
+    }
+    return detection_tables_to_numpy(
+        circuit_stats,
+        stream->det_data,
+        stream->obs_data,
+        n,
+        prepend_observables,
+        append_observables,
+        separate_observables,
+        bit_packed,
+        dets_out,
+        obs_out);
 }
 
 std::string CompiledDetectorSampler::repr() const {
@@ -149,7 +312,13 @@ std::string CompiledDetectorSampler::repr() const {
 }
 
 CompiledDetectorSampler stim_pybind::py_init_compiled_detector_sampler(
-    const Circuit &circuit, const pybind11::object &seed) {
+    const Circuit &circuit, const pybind11::object &seed, const pybind11::object &parameters) {
+    if (!parameters.is_none()) {
+        return CompiledDetectorSampler(
+            circuit.with_parameters_bound(
+                py_dict_to_circuit_parameter_binding(pybind11::cast<pybind11::dict>(parameters))),
+            make_py_seeded_rng(seed));
+    }
     return CompiledDetectorSampler(circuit, make_py_seeded_rng(seed));
 }
 
@@ -158,6 +327,62 @@ pybind11::class_<CompiledDetectorSampler> stim_pybind::pybind_compiled_detector_
         m, "CompiledDetectorSampler", "An analyzed stabilizer circuit whose detection events can be sampled quickly.");
 }
 
+pybind11::class_<DetectionEventBatchIterator> stim_pybind::pybind_detection_event_batch_iterator(
+    pybind11::module &m) {
+    return pybind11::class_<DetectionEventBatchIterator>(
+        m,
+        "DetectionEventBatchIterator",
+        clean_doc_string(R"DOC(
+            Iterates over batches of detection event samples from a circuit.
+
+            Created by `stim.CompiledDetectorSampler.iter_batches`. The next batch is
+            simulated on a background thread while the current batch is being used, and
+            every batch is written into the same numpy arrays. Copy a batch if you need
+            to keep it after advancing the iterator.
+
+            Examples:
+                >>> import stim
+                >>> c = stim.Circuit('''
+                ...    X_ERROR(1) 0
+                ...    M 0
+                ...    DETECTOR rec[-1]
+                ... ''')
+                >>> s = c.compile_detector_sampler()
+                >>> for batch in s.iter_batches(5, batch_size=2):
+                ...     print(batch.shape)
+                (2, 1)
+                (2, 1)
+                (1, 1)
+        )DOC")
+            .data());
+}
+
+void stim_pybind::pybind_detection_event_batch_iterator_methods(
+    pybind11::module &m, pybind11::class_<DetectionEventBatchIterator> &c) {
+    c.def(
+        "__iter__",
+        [](pybind11::object self) -> pybind11::object {
+            return self;
+        },
+        clean_doc_string(R"DOC(
+            @signature def __iter__(self) -> stim.DetectionEventBatchIterator:
+            Returns the iterator itself.
+        )DOC")
+            .data());
+
+    c.def(
+        "__next__",
+        &DetectionEventBatchIterator::next,
+        clean_doc_string(R"DOC(
+            @signature def __next__(self) -> Union[np.ndarray, Tuple[np.ndarray, np.ndarray]]:
+            Returns the next batch of samples.
+
+            The returned arrays are reused by later batches, so their contents are
+            overwritten when the iterator advances.
+        )DOC")
+            .data());
+}
+
 void stim_pybind::pybind_compiled_detector_sampler_methods(
     pybind11::module &m, pybind11::class_<CompiledDetectorSampler> &c) {
     c.def(
@@ -165,6 +390,7 @@ void stim_pybind::pybind_compiled_detector_sampler_methods(
         pybind11::arg("circuit"),
         pybind11::kw_only(),
         pybind11::arg("seed") = pybind11::none(),
+        pybind11::arg("parameters") = pybind11::none(),
         clean_doc_string(R"DOC(
             Creates an object that can sample the detection events from a circuit.
 
@@ -194,6 +420,11 @@ void stim_pybind::pybind_compiled_detector_sampler_methods(
                     CAUTION: simulation results *MAY NOT* be consistent if you vary how many
                     shots are taken. For example, taking 10 shots and then 90 shots will
                     give different results from taking 100 shots in one call.
+                parameters: Defaults to None. The values of named parameters used as
+                    noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as
+                    a dictionary from parameter name to value. The values are substituted
+                    into a copy of the circuit when the sampler is compiled. Every named
+                    parameter in the circuit must be given a value.
 
             Returns:
                 An initialized stim.CompiledDetectorSampler.
@@ -237,6 +468,10 @@ void stim_pybind::pybind_compiled_detector_sampler_methods(
             @signature def sample(self, shots: int, *, prepend_observables: bool = False, append_observables: bool = False, separate_observables: bool = False, bit_packed: bool = False, dets_out: Optional[np.ndarray] = None, obs_out: Optional[np.ndarray] = None) -> Union[np.ndarray, Tuple[np.ndarray, np.ndarray]]:
             Returns a numpy array containing a batch of detector samples from the circuit.
 
+            The shots are sampled on the calling thread. Use `sample_write`, which takes
+            a `num_threads` argument, to spread the sampling over several threads.
+            Calls on the same sampler from different python threads run one at a time.
+
             The circuit must define the detectors using DETECTOR instructions. Observables
             defined by OBSERVABLE_INCLUDE instructions can also be included in the results
             as honorary detectors.
@@ -321,6 +556,66 @@ void stim_pybind::pybind_compiled_detector_sampler_methods(
         )DOC")
             .data());
 
+    c.def(
+        "sample_sparse",
+        &CompiledDetectorSampler::sample_sparse_to_numpy,
+        pybind11::arg("shots"),
+        pybind11::kw_only(),
+        pybind11::arg("append_observables") = false,
+        pybind11::arg("separate_observables") = false,
+        clean_doc_string(R"DOC(
+            @signature def sample_sparse(self, shots: int, *, append_observables: bool = False, separate_observables: bool = False) -> Union[Tuple[np.ndarray, np.ndarray], Tuple[np.ndarray, np.ndarray, np.ndarray]]:
+            Samples detection events, returning the fired detectors of each shot.
+
+            The result is in compressed sparse row (CSR) form, which is cheaper to
+            produce than dense data when detection events are rare (e.g. circuits
+            with low noise). The fired detectors are found by skipping over the
+            shots without detection events, instead of transposing the sampled data.
+
+            Args:
+                shots: The number of times to sample every detector in the circuit.
+                append_observables: Defaults to False. When set, observables are treated
+                    as honorary detectors placed after the real detectors. A flipped
+                    observable `k` is listed as index `num_detectors + k`.
+                separate_observables: Defaults to False. When set to True, a dense array
+                    of observable flips is also returned.
+
+            Returns:
+                An (indices, indptr) tuple, or an (indices, indptr, obs) tuple if
+                separate_observables=True.
+
+                indices: A numpy array with dtype=int64 listing the fired detectors
+                    of every shot, shot by shot, in increasing order within each shot.
+                indptr: A numpy array with dtype=int64 and shape=(shots + 1,). The
+                    fired detectors of shot `s` are `indices[indptr[s]:indptr[s+1]]`.
+                obs: A numpy array with dtype=bool_ and shape=(shots, num_observables).
+                    The bit for observable `m` in shot `s` is at `obs[s, m]`.
+
+                The arrays can be given to `scipy.sparse.csr_matrix` as
+                `csr_matrix((np.ones(len(indices), dtype=np.bool_), indices, indptr))`.
+
+            Examples:
+                >>> import stim
+                >>> c = stim.Circuit('''
+                ...    X_ERROR(1) 1
+                ...    M 0 1 2
+                ...    DETECTOR rec[-3]
+                ...    DETECTOR rec[-2]
+                ...    DETECTOR rec[-1]
+                ...    OBSERVABLE_INCLUDE(0) rec[-2]
+                ... ''')
+                >>> s = c.compile_detector_sampler()
+                >>> indices, indptr = s.sample_sparse(shots=2)
+                >>> indices
+                array([1, 1])
+                >>> indptr
+                array([0, 1, 2])
+                >>> indices, indptr = s.sample_sparse(shots=2, append_observables=True)
+                >>> indices
+                array([1, 3, 1, 3])
+        )DOC")
+            .data());
+
     c.def(
         "sample_bit_packed",
         [](CompiledDetectorSampler &self, size_t shots, bool prepend, bool append) {
@@ -365,15 +660,16 @@ void stim_pybind::pybind_compiled_detector_sampler_methods(
         pybind11::arg("append_observables") = false,
         pybind11::arg("obs_out_filepath") = pybind11::none(),
         pybind11::arg("obs_out_format") = "01",
+        pybind11::arg("num_threads") = 1,
         clean_doc_string(R"DOC(
-            @signature def sample_write(self, shots: int, *, filepath: Union[str, pathlib.Path], format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01', obs_out_filepath: Optional[Union[str, pathlib.Path]] = None, obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01', prepend_observables: bool = False, append_observables: bool = False) -> None:
+            @signature def sample_write(self, shots: int, *, filepath: Union[str, pathlib.Path], format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', obs_out_filepath: Optional[Union[str, pathlib.Path]] = None, obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', prepend_observables: bool = False, append_observables: bool = False, num_threads: int = 1) -> None:
             Samples detection events from the circuit and writes them to a file.
 
             Args:
                 shots: The number of times to sample every measurement in the circuit.
                 filepath: The file to write the results to.
                 format: The output format to write the results with.
-                    Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                    Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                     Defaults to "01".
                 obs_out_filepath: Sample observables as part of each shot, and write them to
                     this file. This keeps the observable data separate from the detector
@@ -381,12 +677,15 @@ void stim_pybind::pybind_compiled_detector_sampler_methods(
                 obs_out_format: If writing the observables to a file, this is the format to
                     write them in.
 
-                    Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                    Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                     Defaults to "01".
                 prepend_observables: Sample observables as part of each shot, and put them
                     at the start of the detector data.
                 append_observables: Sample observables as part of each shot, and put them at
                     the end of the detector data.
+                num_threads: Defaults to 1. The number of threads to spread the sampling
+                    over. Batches of shots are simulated concurrently and written in order.
+                    The sampled results don't depend on the number of threads.
 
             Returns:
                 None.
@@ -414,6 +713,64 @@ void stim_pybind::pybind_compiled_detector_sampler_methods(
         )DOC")
             .data());
 
+    c.def(
+        "iter_batches",
+        &CompiledDetectorSampler::iter_batches,
+        pybind11::arg("shots"),
+        pybind11::arg("batch_size"),
+        pybind11::kw_only(),
+        pybind11::arg("prepend_observables") = false,
+        pybind11::arg("append_observables") = false,
+        pybind11::arg("separate_observables") = false,
+        pybind11::arg("bit_packed") = false,
+        clean_doc_string(R"DOC(
+            @signature def iter_batches(self, shots: int, batch_size: int, *, prepend_observables: bool = False, append_observables: bool = False, separate_observables: bool = False, bit_packed: bool = False) -> stim.DetectionEventBatchIterator:
+            Returns an iterator that samples detection events one batch at a time.
+
+            The batches are simulated on a background thread, one batch ahead of the
+            consumer, so the memory used doesn't grow with the number of shots. Each
+            batch is written into the same preallocated numpy arrays, which means a
+            batch's data is overwritten when the iterator advances. Copy it if you
+            need to keep it.
+
+            Args:
+                shots: The total number of shots to sample.
+                batch_size: The number of shots in each batch. The last batch has fewer
+                    shots when `shots` isn't a multiple of `batch_size`.
+                prepend_observables: Defaults to false. When set, observables are included
+                    with the detectors and are placed at the start of the results.
+                append_observables: Defaults to false. When set, observables are included
+                    with the detectors and are placed at the end of the results.
+                separate_observables: Defaults to False. When set to True, each batch is a
+                    (detection_events, observable_flips) tuple instead of a flat
+                    detection_events array.
+                bit_packed: Defaults to False. Produces uint8 numpy arrays with 8 bits per
+                    byte, instead of bool_ numpy arrays with 1 bit per byte. Uses little
+                    endian packing.
+
+            Returns:
+                A stim.DetectionEventBatchIterator. Each batch it yields has the same
+                layout as the result of `sample` called with the same arguments and
+                `shots` set to the number of shots in the batch.
+
+            Examples:
+                >>> import stim
+                >>> c = stim.Circuit('''
+                ...    X_ERROR(1) 0
+                ...    M 0 1
+                ...    DETECTOR rec[-2]
+                ...    DETECTOR rec[-1]
+                ... ''')
+                >>> s = c.compile_detector_sampler()
+                >>> total = 0
+                >>> for batch in s.iter_batches(1000, batch_size=256, bit_packed=True):
+                ...     total += len(batch)
+                ...     assert (batch == 1).all()
+                >>> total
+                1000
+        )DOC")
+            .data());
+
     c.def(
         "__repr__",
         &CompiledDetectorSampler::repr,
@@ -15,16 +15,33 @@
 #ifndef _STIM_PY_COMPILED_DETECTOR_SAMPLER_PYBIND_H
 #define _STIM_PY_COMPILED_DETECTOR_SAMPLER_PYBIND_H
 
+#include <memory>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
 #include "stim/circuit/circuit.h"
 #include "stim/mem/simd_bits.h"
+#include "stim/simulators/detection_event_batch_stream.h"
 #include "stim/simulators/frame_simulator.h"
 
 namespace stim_pybind {
 
+/// Iterates over batches of detection event samples, reusing the same output arrays for each batch.
+struct DetectionEventBatchIterator {
+    stim::CircuitStats circuit_stats;
+    size_t batch_size;
+    bool prepend_observables;
+    bool append_observables;
+    bool separate_observables;
+    bool bit_packed;
+    std::unique_ptr<stim::DetectionEventBatchStream<stim::MAX_BITWORD_WIDTH>> stream;
+    pybind11::object dets_buffer;
+    pybind11::object obs_buffer;
+
+    pybind11::object next();
+};
+
 struct CompiledDetectorSampler {
     stim::CircuitStats circuit_stats;
     stim::Circuit circuit;
@@ -42,6 +59,7 @@ struct CompiledDetectorSampler {
         bool bit_packed,
         pybind11::object dets_out,
         pybind11::object obs_out);
+    pybind11::object sample_sparse_to_numpy(size_t num_shots, bool append_observables, bool separate_observables);
     void sample_write(
         size_t num_samples,
         pybind11::object filepath_obj,
@@ -49,13 +67,25 @@ struct CompiledDetectorSampler {
         bool prepend_observables,
         bool append_observables,
         pybind11::object obs_out_filepath_obj,
-        std::string_view obs_out_format);
+        std::string_view obs_out_format,
+        size_t num_threads);
+    DetectionEventBatchIterator iter_batches(
+        size_t num_shots,
+        size_t batch_size,
+        bool prepend_observables,
+        bool append_observables,
+        bool separate_observables,
+        bool bit_packed);
     std::string repr() const;
 };
 
 pybind11::class_<CompiledDetectorSampler> pybind_compiled_detector_sampler(pybind11::module &m);
 void pybind_compiled_detector_sampler_methods(pybind11::module &m, pybind11::class_<CompiledDetectorSampler> &c);
-CompiledDetectorSampler py_init_compiled_detector_sampler(const stim::Circuit &circuit, const pybind11::object &seed);
+pybind11::class_<DetectionEventBatchIterator> pybind_detection_event_batch_iterator(pybind11::module &m);
+void pybind_detection_event_batch_iterator_methods(
+    pybind11::module &m, pybind11::class_<DetectionEventBatchIterator> &c);
+CompiledDetectorSampler py_init_compiled_detector_sampler(
+    const stim::Circuit &circuit, const pybind11::object &seed, const pybind11::object &parameters);
 
 }  // namespace stim_pybind
 
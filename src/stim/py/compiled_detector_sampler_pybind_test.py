@@ -11,6 +11,7 @@
 # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 # See the License for the specific language governing permissions and
 # limitations under the License.
+import concurrent.futures
 import pathlib
 
 import tempfile
@@ -159,6 +160,32 @@ def test_compiled_detector_sampler_sample():
             assert f.readlines() == ['1101000\n'] * 5
 
 
+def test_observables_next_to_many_detectors():
+    c = stim.Circuit.generated(
+        "repetition_code:memory",
+        rounds=10,
+        distance=9,
+        before_round_data_depolarization=0.1,
+    )
+    c.append("OBSERVABLE_INCLUDE", [stim.target_rec(-2)], 1)
+    c.append("OBSERVABLE_INCLUDE", [stim.target_rec(-3)], 2)
+    num_dets = c.num_detectors
+    assert num_dets > 64
+
+    dets, obs = c.compile_detector_sampler(seed=5).sample(300, separate_observables=True)
+    assert np.any(dets) and np.any(obs)
+    both = c.compile_detector_sampler(seed=5).sample(300, prepend_observables=True, append_observables=True)
+    np.testing.assert_array_equal(both, np.concatenate([obs, dets, obs], axis=1))
+
+    packed = c.compile_detector_sampler(seed=5).sample(
+        300,
+        prepend_observables=True,
+        append_observables=True,
+        bit_packed=True,
+    )
+    np.testing.assert_array_equal(packed, np.packbits(both, axis=1, bitorder='little'))
+
+
 def test_write_obs_file():
     c = stim.Circuit("""
         X_ERROR(1) 1
@@ -312,3 +339,103 @@ def test_manual_output_buffer():
     assert ret is buf
     assert np.array_equal(buf, [[0, 0, 1, 1, 1, 0, 0, 1, 1, 1]] * 17)
     assert np.array_equal(buf2, [[1]] * 17)
+
+
+def test_iter_batches():
+    c = stim.Circuit("""
+        X_ERROR(1) 0
+        M 0 1
+        DETECTOR rec[-2]
+        DETECTOR rec[-1]
+        OBSERVABLE_INCLUDE(0) rec[-2]
+    """)
+    sampler = c.compile_detector_sampler()
+
+    batches = [b.copy() for b in sampler.iter_batches(10, 4)]
+    assert [len(b) for b in batches] == [4, 4, 2]
+    for b in batches:
+        assert b.dtype == np.bool_
+        np.testing.assert_array_equal(b, [[1, 0]] * len(b))
+
+    batches = list(sampler.iter_batches(10, 4, append_observables=True, bit_packed=True))
+    assert [b.shape for b in batches] == [(4, 1), (4, 1), (2, 1)]
+    assert batches[0] is batches[1]
+    np.testing.assert_array_equal(batches[-1], [[0b101]] * 2)
+
+    n = 0
+    for dets, obs in sampler.iter_batches(1000, 300, separate_observables=True):
+        n += len(dets)
+        assert len(obs) == len(dets)
+        assert np.all(obs[:, 0])
+    assert n == 1000
+
+    assert list(sampler.iter_batches(0, 10)) == []
+    with pytest.raises(ValueError, match="batch_size"):
+        sampler.iter_batches(10, 0)
+    with pytest.raises(ValueError, match="separate_observables"):
+        sampler.iter_batches(10, 2, separate_observables=True, append_observables=True)
+
+
+def test_iter_batches_matches_statistics():
+    c = stim.Circuit.generated(
+        "repetition_code:memory",
+        rounds=5,
+        distance=5,
+        before_round_data_depolarization=0.1,
+    )
+    total = np.zeros(c.num_detectors)
+    n = 0
+    it = c.compile_detector_sampler(seed=3).iter_batches(5000, 1024)
+    assert iter(it) is it
+    for batch in it:
+        total += np.sum(batch, axis=0)
+        n += len(batch)
+    assert n == 5000
+    expected = np.mean(c.compile_detector_sampler(seed=4).sample(5000), axis=0)
+    np.testing.assert_allclose(total / n, expected, atol=0.05)
+
+
+def test_sample_sparse():
+    circuit = stim.Circuit.generated(
+        "surface_code:rotated_memory_x",
+        distance=3,
+        rounds=3,
+        after_clifford_depolarization=0.01,
+    )
+    dense, obs = circuit.compile_detector_sampler(seed=5).sample(1000, separate_observables=True)
+    indices, indptr, sparse_obs = circuit.compile_detector_sampler(seed=5).sample_sparse(1000, separate_observables=True)
+    assert indices.dtype == np.int64
+    assert indptr.dtype == np.int64
+    assert indptr.shape == (1001,)
+    np.testing.assert_array_equal(sparse_obs, obs)
+    for s in range(1000):
+        np.testing.assert_array_equal(indices[indptr[s]:indptr[s + 1]], np.flatnonzero(dense[s]))
+
+    dense = circuit.compile_detector_sampler(seed=5).sample(1000, append_observables=True)
+    indices, indptr = circuit.compile_detector_sampler(seed=5).sample_sparse(1000, append_observables=True)
+    for s in range(1000):
+        np.testing.assert_array_equal(indices[indptr[s]:indptr[s + 1]], np.flatnonzero(dense[s]))
+
+    with pytest.raises(ValueError, match="separate_observables"):
+        circuit.compile_detector_sampler().sample_sparse(1, append_observables=True, separate_observables=True)
+
+
+def test_sample_same_sampler_from_several_threads():
+    circuit = stim.Circuit("""
+        X_ERROR(1) 0
+        M 0 1
+        DETECTOR rec[-2]
+        DETECTOR rec[-1]
+    """)
+    sampler = circuit.compile_detector_sampler()
+
+    def work(shots):
+        return sampler.sample(shots)
+
+    shot_counts = [100 * k + 1 for k in range(1, 40)]
+    with concurrent.futures.ThreadPoolExecutor(max_workers=4) as pool:
+        results = list(pool.map(work, shot_counts))
+    for shots, result in zip(shot_counts, results):
+        expected = np.zeros(shape=(shots, 2), dtype=np.bool_)
+        expected[:, 0] = True
+        np.testing.assert_array_equal(result, expected)
@@ -15,6 +15,7 @@
 #include "stim/py/compiled_measurement_sampler.pybind.h"
 
 #include "stim/circuit/circuit.pybind.h"
+#include "stim/io/raii_file.h"
 #include "stim/py/base.pybind.h"
 #include "stim/py/numpy.pybind.h"
 #include "stim/simulators/frame_simulator_util.h"
@@ -29,19 +30,26 @@ CompiledMeasurementSampler::CompiledMeasurementSampler(
 }
 
 pybind11::object CompiledMeasurementSampler::sample_to_numpy(size_t num_shots, bool bit_packed) {
-    simd_bit_table<MAX_BITWORD_WIDTH> sample = sample_batch_measurements(circuit, ref_sample, num_shots, rng, false);
+    auto lock = lock_py_object(this);
+    simd_bit_table<MAX_BITWORD_WIDTH> sample(0, 0);
+    {
+        pybind11::gil_scoped_release release;
+        sample = sample_batch_measurements(circuit, ref_sample, num_shots, rng, false);
+    }
     size_t bits_per_sample = circuit.count_measurements();
     return simd_bit_table_to_numpy(sample, bits_per_sample, num_shots, bit_packed, true, pybind11::none());
 }
 
-void CompiledMeasurementSampler::sample_write(size_t num_samples, std::string_view filepath, std::string_view format) {
+void CompiledMeasurementSampler::sample_write(
+    size_t num_samples, std::string_view filepath, std::string_view format, size_t num_threads) {
     auto f = format_to_enum(format);
-    FILE *out = fopen(std::string(filepath).c_str(), "wb");
-    if (out == nullptr) {
-        throw std::invalid_argument("Failed to open '" + std::string(filepath) + "' to write.");
+    if (num_threads == 0) {
+        throw std::invalid_argument("num_threads must be at least 1.");
     }
-    sample_batch_measurements_writing_results_to_disk(circuit, ref_sample, num_samples, out, f, rng);
-    fclose(out);
+    RaiiFile out(filepath, "wb");
+    auto lock = lock_py_object(this);
+    pybind11::gil_scoped_release release;
+    sample_batch_measurements_writing_results_to_disk(circuit, ref_sample, num_samples, out.f, f, rng, num_threads);
 }
 
 std::string CompiledMeasurementSampler::repr() const {
@@ -64,7 +72,13 @@ CompiledMeasurementSampler stim_pybind::py_init_compiled_sampler(
     const Circuit &circuit,
     bool skip_reference_sample,
     const pybind11::object &seed,
-    const pybind11::object &reference_sample) {
+    const pybind11::object &reference_sample,
+    const pybind11::object &parameters) {
+    if (!parameters.is_none()) {
+        Circuit bound = circuit.with_parameters_bound(
+            py_dict_to_circuit_parameter_binding(pybind11::cast<pybind11::dict>(parameters)));
+        return py_init_compiled_sampler(bound, skip_reference_sample, seed, reference_sample, pybind11::none());
+    }
     if (reference_sample.is_none()) {
         simd_bits<MAX_BITWORD_WIDTH> ref_sample =
             skip_reference_sample ? simd_bits<MAX_BITWORD_WIDTH>(circuit.count_measurements())
@@ -91,6 +105,7 @@ void stim_pybind::pybind_compiled_measurement_sampler_methods(
         pybind11::arg("skip_reference_sample") = false,
         pybind11::arg("seed") = pybind11::none(),
         pybind11::arg("reference_sample") = pybind11::none(),
+        pybind11::arg("parameters") = pybind11::none(),
         clean_doc_string(R"DOC(
             Creates a measurement sampler for the given circuit.
 
@@ -148,6 +163,11 @@ void stim_pybind::pybind_compiled_measurement_sampler_methods(
                     provided, the reference sample will be set to
                     `circuit.reference_sample()`, unless `skip_reference_sample=True`
                     is used, in which case it will be set to all-zeros.
+                parameters: Defaults to None. The values of named parameters used as
+                    noise arguments in the circuit (e.g. the `p` in `X_ERROR(p) 0`), as
+                    a dictionary from parameter name to value. The values are substituted
+                    into a copy of the circuit when the sampler is compiled. Every named
+                    parameter in the circuit must be given a value.
 
             Returns:
                 An initialized stim.CompiledMeasurementSampler.
@@ -176,6 +196,10 @@ void stim_pybind::pybind_compiled_measurement_sampler_methods(
             @signature def sample(self, shots: int, *, bit_packed: bool = False) -> np.ndarray:
             Samples a batch of measurement samples from the circuit.
 
+            The shots are sampled on the calling thread. Use `sample_write`, which takes
+            a `num_threads` argument, to spread the sampling over several threads.
+            Calls on the same sampler from different python threads run one at a time.
+
             Args:
                 shots: The number of times to sample every measurement in the circuit.
                 bit_packed: Returns a uint8 numpy array with 8 bits per byte, instead of
@@ -248,8 +272,9 @@ void stim_pybind::pybind_compiled_measurement_sampler_methods(
         pybind11::kw_only(),
         pybind11::arg("filepath"),
         pybind11::arg("format") = "01",
+        pybind11::arg("num_threads") = 1,
         clean_doc_string(R"DOC(
-            @signature def sample_write(self, shots: int, *, filepath: Union[str, pathlib.Path], format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01') -> None:
+            @signature def sample_write(self, shots: int, *, filepath: Union[str, pathlib.Path], format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', num_threads: int = 1) -> None:
             Samples measurements from the circuit and writes them to a file.
 
             Examples:
@@ -274,8 +299,11 @@ void stim_pybind::pybind_compiled_measurement_sampler_methods(
                 shots: The number of times to sample every measurement in the circuit.
                 filepath: The file to write the results to.
                 format: The output format to write the results with.
-                    Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                    Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                     Defaults to "01".
+                num_threads: Defaults to 1. The number of threads to spread the sampling
+                    over. Batches of shots are simulated concurrently and written in order.
+                    The sampled results don't depend on the number of threads.
 
             Returns:
                 None.
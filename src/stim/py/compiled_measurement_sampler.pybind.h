@@ -38,7 +38,7 @@ struct CompiledMeasurementSampler {
         bool skip_reference_sample,
         std::mt19937_64 &&rng);
     pybind11::object sample_to_numpy(size_t num_shots, bool bit_packed);
-    void sample_write(size_t num_samples, std::string_view filepath, std::string_view format);
+    void sample_write(size_t num_samples, std::string_view filepath, std::string_view format, size_t num_threads);
     std::string repr() const;
 };
 
@@ -48,7 +48,8 @@ CompiledMeasurementSampler py_init_compiled_sampler(
     const stim::Circuit &circuit,
     bool skip_reference_sample,
     const pybind11::object &seed,
-    const pybind11::object &reference_sample);
+    const pybind11::object &reference_sample,
+    const pybind11::object &parameters);
 
 }  // namespace stim_pybind
 
@@ -14,14 +14,59 @@
 
 #include "stim/py/numpy.pybind.h"
 
+#include <array>
+
+#include "stim/mem/simd_util.h"
+
 using namespace stim;
 using namespace stim_pybind;
 
-static pybind11::object transposed_simd_bit_table_to_numpy_uint8(
-    const simd_bit_table<MAX_BITWORD_WIDTH> &table,
-    size_t num_major_in,
-    size_t num_minor_in,
-    pybind11::object out_buffer) {
+/// Transposes the given row runs one block of 64 shots at a time, and passes each shot's bits to `emit`.
+///
+/// `emit` is called as `emit(shot, bits)` where `bits` points to the shot's bits for all of the
+/// runs concatenated together, packed little-endian into 64 bit words.
+template <typename EMIT>
+static void for_each_transposed_shot(
+    std::span<const SimdBitTableRows> parts, size_t num_major, size_t num_minor, const EMIT &emit) {
+    size_t num_words = (num_major + 63) / 64;
+    std::vector<uint64_t> shot_bits(64 * num_words);
+    std::array<uint64_t, 64> block;
+    for (size_t minor_start = 0; minor_start < num_minor; minor_start += 64) {
+        size_t minor_word = minor_start / 64;
+        size_t num_shots_in_block = std::min(size_t{64}, num_minor - minor_start);
+        std::fill(shot_bits.begin(), shot_bits.end(), 0);
+
+        size_t out_major = 0;
+        for (const auto &part : parts) {
+            for (size_t k = 0; k < part.num_major; k += 64) {
+                size_t n = std::min(size_t{64}, part.num_major - k);
+                for (size_t i = 0; i < n; i++) {
+                    block[i] = part.table[part.major_start + k + i].u64[minor_word];
+                }
+                std::fill(block.begin() + n, block.end(), 0);
+                inplace_transpose_64x64(block.data(), 1);
+
+                size_t word = (out_major + k) / 64;
+                size_t shift = (out_major + k) % 64;
+                for (size_t s = 0; s < num_shots_in_block; s++) {
+                    uint64_t *dst = &shot_bits[s * num_words + word];
+                    dst[0] |= block[s] << shift;
+                    if (shift && shift + n > 64) {
+                        dst[1] |= block[s] >> (64 - shift);
+                    }
+                }
+            }
+            out_major += part.num_major;
+        }
+
+        for (size_t s = 0; s < num_shots_in_block; s++) {
+            emit(minor_start + s, &shot_bits[s * num_words]);
+        }
+    }
+}
+
+static pybind11::object transposed_simd_bit_table_rows_to_numpy_uint8(
+    std::span<const SimdBitTableRows> parts, size_t num_major_in, size_t num_minor_in, pybind11::object out_buffer) {
     size_t num_major_bytes_in = (num_major_in + 7) / 8;
 
     if (out_buffer.is_none()) {
@@ -44,29 +89,29 @@ static pybind11::object transposed_simd_bit_table_to_numpy_uint8(
     }
 
     if (num_major_in && num_minor_in) {
+        uint8_t *base = buf.mutable_data(0, 0);
+        auto row_stride = buf.strides(0);
         auto stride = buf.strides(1);
-        for (size_t minor_in = 0; minor_in < num_minor_in; minor_in++) {
-            auto ptr = buf.mutable_data(minor_in, 0);
-            for (size_t major_in = 0; major_in < num_major_in; major_in += 8) {
-                uint8_t v = 0;
-                for (size_t b = 0; b < 8 && major_in + b < num_major_in; b++) {
-                    bool bit = table[major_in + b][minor_in];
-                    v |= bit << b;
+        pybind11::gil_scoped_release release;
+        for_each_transposed_shot(parts, num_major_in, num_minor_in, [&](size_t shot, const uint64_t *bits) {
+            const uint8_t *bytes = (const uint8_t *)bits;
+            uint8_t *ptr = base + shot * row_stride;
+            if (stride == 1) {
+                memcpy(ptr, bytes, num_major_bytes_in);
+            } else {
+                for (size_t k = 0; k < num_major_bytes_in; k++) {
+                    *ptr = bytes[k];
+                    ptr += stride;
                 }
-                *ptr = v;
-                ptr += stride;
             }
-        }
+        });
     }
 
     return out_buffer;
 }
 
-static pybind11::object transposed_simd_bit_table_to_numpy_bool8(
-    const simd_bit_table<MAX_BITWORD_WIDTH> &table,
-    size_t num_major_in,
-    size_t num_minor_in,
-    pybind11::object out_buffer) {
+static pybind11::object transposed_simd_bit_table_rows_to_numpy_bool8(
+    std::span<const SimdBitTableRows> parts, size_t num_major_in, size_t num_minor_in, pybind11::object out_buffer) {
     if (out_buffer.is_none()) {
         auto numpy = pybind11::module::import("numpy");
         out_buffer = numpy.attr("empty")(pybind11::make_tuple(num_minor_in, num_major_in), numpy.attr("bool_"));
@@ -87,20 +132,35 @@ static pybind11::object transposed_simd_bit_table_to_numpy_bool8(
     }
 
     if (num_major_in && num_minor_in) {
-        auto stride = buf.strides(0);
-        for (size_t major = 0; major < num_major_in; major++) {
-            auto row = table[major];
-            auto ptr = buf.mutable_data(0, major);
-            for (size_t minor = 0; minor < num_minor_in; minor++) {
-                *ptr = row[minor];
+        uint8_t *base = (uint8_t *)buf.mutable_data(0, 0);
+        auto row_stride = buf.strides(0);
+        auto stride = buf.strides(1);
+        pybind11::gil_scoped_release release;
+        for_each_transposed_shot(parts, num_major_in, num_minor_in, [&](size_t shot, const uint64_t *bits) {
+            uint8_t *ptr = base + shot * row_stride;
+            for (size_t major = 0; major < num_major_in; major++) {
+                *(bool *)ptr = (bits[major >> 6] >> (major & 63)) & 1;
                 ptr += stride;
             }
-        }
+        });
     }
 
     return out_buffer;
 }
 
+pybind11::object stim_pybind::transposed_simd_bit_table_rows_to_numpy(
+    std::span<const SimdBitTableRows> parts, size_t num_minor, bool bit_pack_result, pybind11::object out_buffer) {
+    size_t num_major = 0;
+    for (const auto &part : parts) {
+        num_major += part.num_major;
+    }
+    if (bit_pack_result) {
+        return transposed_simd_bit_table_rows_to_numpy_uint8(parts, num_major, num_minor, out_buffer);
+    } else {
+        return transposed_simd_bit_table_rows_to_numpy_bool8(parts, num_major, num_minor, out_buffer);
+    }
+}
+
 static pybind11::object simd_bit_table_to_numpy_uint8(
     const simd_bit_table<MAX_BITWORD_WIDTH> &table, size_t num_major, size_t num_minor, pybind11::object out_buffer) {
     size_t num_minor_bytes = (num_minor + 7) / 8;
@@ -195,11 +255,8 @@ pybind11::object stim_pybind::simd_bit_table_to_numpy(
     bool transposed,
     pybind11::object out_buffer) {
     if (transposed) {
-        if (bit_pack_result) {
-            return transposed_simd_bit_table_to_numpy_uint8(table, num_major, num_minor, out_buffer);
-        } else {
-            return transposed_simd_bit_table_to_numpy_bool8(table, num_major, num_minor, out_buffer);
-        }
+        SimdBitTableRows rows{table, 0, num_major};
+        return transposed_simd_bit_table_rows_to_numpy({&rows, 1}, num_minor, bit_pack_result, out_buffer);
     } else {
         if (bit_pack_result) {
             return simd_bit_table_to_numpy_uint8(table, num_major, num_minor, out_buffer);
@@ -1,6 +1,8 @@
 #ifndef _STIM_PY_NUMPY_PYBIND_H
 #define _STIM_PY_NUMPY_PYBIND_H
 
+#include <span>
+
 #include "stim/mem/simd_bit_table.h"
 #include "stim/py/base.pybind.h"
 
@@ -9,6 +11,31 @@ namespace stim_pybind {
 stim::simd_bit_table<stim::MAX_BITWORD_WIDTH> numpy_array_to_transposed_simd_table(
     const pybind11::object &data, size_t expected_bits_per_shot, size_t *num_shots_out);
 
+/// A run of consecutive major rows from a simd_bit_table.
+struct SimdBitTableRows {
+    const stim::simd_bit_table<stim::MAX_BITWORD_WIDTH> &table;
+    size_t major_start;
+    size_t num_major;
+};
+
+/// Exports several row runs as a single array, as if they had been concatenated along the major axis.
+///
+/// The result is the same as concatenating the runs into one table and calling
+/// `simd_bit_table_to_numpy(..., transposed=true, ...)` on it, but the concatenated
+/// table is never built. Each block of shots is transposed once, straight out of the
+/// source tables.
+///
+/// Args:
+///     parts: The row runs to export, in output order.
+///     num_minor: The number of minor bits (shots) to export from each run.
+///     bit_pack_result: Whether to produce a bit packed uint8 array or a bool array.
+///     out_buffer: None, or a preallocated numpy array to write the result into.
+///
+/// Returns:
+///     An array with shape (num_minor, total_num_major) (or the bit packed equivalent).
+pybind11::object transposed_simd_bit_table_rows_to_numpy(
+    std::span<const SimdBitTableRows> parts, size_t num_minor, bool bit_pack_result, pybind11::object out_buffer);
+
 pybind11::object simd_bit_table_to_numpy(
     const stim::simd_bit_table<stim::MAX_BITWORD_WIDTH> &table,
     size_t num_major,
@@ -32,6 +32,7 @@
 #include "stim/py/compiled_measurement_sampler.pybind.h"
 #include "stim/py/march.pybind.h"
 #include "stim/simulators/dem_sampler.pybind.h"
+#include "stim/simulators/dem_template.pybind.h"
 #include "stim/simulators/frame_simulator.pybind.h"
 #include "stim/simulators/matched_error.pybind.h"
 #include "stim/simulators/measurements_to_detection_events.pybind.h"
@@ -586,7 +587,9 @@ PYBIND11_MODULE(STIM_PYBIND11_MODULE_NAME, m) {
 
     /// class definitions
     auto c_dem_sampler = pybind_dem_sampler(m);
+    auto c_dem_template = pybind_dem_template(m);
     auto c_compiled_detector_sampler = pybind_compiled_detector_sampler(m);
+    auto c_detection_event_batch_iterator = pybind_detection_event_batch_iterator(m);
     auto c_compiled_measurement_sampler = pybind_compiled_measurement_sampler(m);
     auto c_compiled_m2d_converter = pybind_compiled_measurements_to_detection_events_converter(m);
     auto c_clifford_string = pybind_clifford_string(m);
@@ -634,6 +637,7 @@ PYBIND11_MODULE(STIM_PYBIND11_MODULE_NAME, m) {
 
     pybind_tableau_iter_methods(m, c_tableau_iter);
     pybind_dem_sampler_methods(m, c_dem_sampler);
+    pybind_dem_template_methods(m, c_dem_template);
 
     pybind_detector_error_model_instruction_methods(m, c_detector_error_model_instruction);
     pybind_detector_error_model_repeat_block_methods(m, c_detector_error_model_repeat_block);
@@ -646,6 +650,7 @@ PYBIND11_MODULE(STIM_PYBIND11_MODULE_NAME, m) {
     pybind_pauli_string_iter_methods(m, c_pauli_string_iter);
 
     pybind_compiled_detector_sampler_methods(m, c_compiled_detector_sampler);
+    pybind_detection_event_batch_iterator_methods(m, c_detection_event_batch_iterator);
     pybind_compiled_measurement_sampler_methods(m, c_compiled_measurement_sampler);
     pybind_compiled_measurements_to_detection_events_converter_methods(m, c_compiled_m2d_converter);
 
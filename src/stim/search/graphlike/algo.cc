@@ -15,14 +15,16 @@
 #include "stim/search/graphlike/algo.h"
 
 #include <algorithm>
-#include <unordered_map>
-#include <queue>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "stim/search/graphlike/edge.h"
 #include "stim/search/graphlike/graph.h"
 #include "stim/search/graphlike/node.h"
 #include "stim/search/graphlike/search_state.h"
+#include "stim/util_bot/parallel_batches.h"
 
 using namespace stim;
 using namespace stim::impl_search_graphlike;
@@ -42,8 +44,11 @@ DetectorErrorModel backtrack_path(const std::unordered_map<SearchState, SearchSt
     return out;
 }
 
+/// The number of frontier states expanded by each task of the parallel search.
+constexpr size_t FRONTIER_BATCH_SIZE = 256;
+
 DetectorErrorModel stim::shortest_graphlike_undetectable_logical_error(
-    const DetectorErrorModel &model, bool ignore_ungraphlike_errors) {
+    const DetectorErrorModel &model, bool ignore_ungraphlike_errors, size_t num_threads) {
     Graph graph = Graph::from_dem(model, ignore_ungraphlike_errors);
 
     SearchState empty_search_state(graph.num_observables);
@@ -54,7 +59,7 @@ DetectorErrorModel stim::shortest_graphlike_undetectable_logical_error(
         return out;
     }
 
-    std::queue<SearchState> queue;
+    std::vector<SearchState> frontier;
     std::unordered_map<SearchState, SearchState, SearchStateHash> back_map;
     // Mark the vacuous dead-end state as already seen.
     back_map.emplace(empty_search_state, empty_search_state);
@@ -65,32 +70,69 @@ DetectorErrorModel stim::shortest_graphlike_undetectable_logical_error(
             uint64_t node2 = e.opposite_node_index;
             if (node1 < node2 && e.crossing_observable_mask.not_zero()) {
                 SearchState start{node1, node2, e.crossing_observable_mask};
-                queue.push(start);
+                frontier.push_back(start);
                 back_map.emplace(start, empty_search_state);
             }
         }
     }
 
-    // Breadth first search for a symptomless state that has a frame change.
-    for (; !queue.empty(); queue.pop()) {
-        SearchState cur = queue.front();
-        assert(cur.det_active != NO_NODE_INDEX);
-        for (const auto &e : graph.nodes[cur.det_active].edges) {
-            SearchState next(e.opposite_node_index, cur.det_held, e.crossing_observable_mask ^ cur.obs_mask);
-            if (!back_map.emplace(next, cur).second) {
-                continue;
-            }
-            if (next.is_undetected()) {
-                assert(next.obs_mask.not_zero());  // Otherwise, it would have already been in back_map.
-                return backtrack_path(back_map, next);
-            } else {
-                if (next.det_active == NO_NODE_INDEX) {
-                    // Just resolved one out of two excitations. Move on to the second excitation.
-                    std::swap(next.det_active, next.det_held);
+    // Breadth first search for a symptomless state that has a frame change, one level at a time.
+    //
+    // Each level is expanded in parallel while the seen states are only being read. The unseen successors are then
+    // recorded serially and in frontier order, so the result is the same as a plain breadth first search regardless
+    // of the number of threads.
+    std::vector<std::vector<std::pair<SearchState, size_t>>> found;
+    std::vector<SearchState> next_frontier;
+    while (!frontier.empty()) {
+        size_t num_batches = (frontier.size() + FRONTIER_BATCH_SIZE - 1) / FRONTIER_BATCH_SIZE;
+        found.resize(num_batches);
+        process_batches_in_parallel_in_order(
+            num_batches,
+            num_threads,
+            []() {
+                return nullptr;
+            },
+            [](std::nullptr_t, size_t) {
+            },
+            [&](std::nullptr_t, size_t batch_index) {
+                auto &out = found[batch_index];
+                out.clear();
+                size_t start = batch_index * FRONTIER_BATCH_SIZE;
+                size_t end = std::min(frontier.size(), start + FRONTIER_BATCH_SIZE);
+                for (size_t k = start; k < end; k++) {
+                    const SearchState &cur = frontier[k];
+                    assert(cur.det_active != NO_NODE_INDEX);
+                    for (const auto &e : graph.nodes[cur.det_active].edges) {
+                        SearchState next(
+                            e.opposite_node_index, cur.det_held, e.crossing_observable_mask ^ cur.obs_mask);
+                        if (back_map.find(next) == back_map.end()) {
+                            out.emplace_back(std::move(next), k);
+                        }
+                    }
+                }
+            },
+            [](std::nullptr_t, size_t) {
+            });
+
+        next_frontier.clear();
+        for (size_t b = 0; b < num_batches; b++) {
+            for (auto &[next, cur_index] : found[b]) {
+                if (!back_map.emplace(next, frontier[cur_index]).second) {
+                    continue;
+                }
+                if (next.is_undetected()) {
+                    assert(next.obs_mask.not_zero());  // Otherwise, it would have already been in back_map.
+                    return backtrack_path(back_map, next);
+                } else {
+                    if (next.det_active == NO_NODE_INDEX) {
+                        // Just resolved one out of two excitations. Move on to the second excitation.
+                        std::swap(next.det_active, next.det_held);
+                    }
+                    next_frontier.push_back(std::move(next));
                 }
-                queue.push(next);
             }
         }
+        std::swap(frontier, next_frontier);
     }
 
     std::stringstream err_msg;
@@ -17,6 +17,8 @@
 #ifndef _STIM_SEARCH_GRAPHLIKE_ALGO_H
 #define _STIM_SEARCH_GRAPHLIKE_ALGO_H
 
+#include <cstddef>
+
 #include "stim/dem/detector_error_model.h"
 
 namespace stim {
@@ -33,12 +35,14 @@ namespace stim {
 ///     model: The detector error model to search for undetectable errors.
 ///     ignore_ungraphlike_errors: Determines whether or not error components with more than 2 symptoms should raise an
 ///         exception, or just be ignored as if they weren't there.
+///     num_threads: The maximum number of threads used to expand each level of the breadth first search. The
+///         returned error doesn't depend on this value.
 ///
 /// Returns:
 ///     A detector error model containing only the error mechanisms that cause the undetectable logical error.
 ///     Note that the error mechanisms will have their probabilities set to 1 (indicating they are necessary).
 DetectorErrorModel shortest_graphlike_undetectable_logical_error(
-    const DetectorErrorModel &model, bool ignore_ungraphlike_errors);
+    const DetectorErrorModel &model, bool ignore_ungraphlike_errors, size_t num_threads = 1);
 
 }  // namespace stim
 
@@ -193,3 +193,32 @@ TEST(shortest_graphlike_undetectable_logical_error, many_observables) {
     auto err = stim::shortest_graphlike_undetectable_logical_error(graphlike_model, false);
     ASSERT_EQ(err.instructions.size(), 5);
 }
+
+TEST(shortest_graphlike_undetectable_logical_error, num_threads_doesnt_change_result) {
+    CircuitGenParameters params(5, 5, "rotated_memory_x");
+    params.after_clifford_depolarization = 0.001;
+    params.before_measure_flip_probability = 0.001;
+    params.after_reset_flip_probability = 0.001;
+    params.before_round_data_depolarization = 0.001;
+    auto circuit = generate_surface_code_circuit(params).circuit;
+    auto model = ErrorAnalyzer::circuit_to_detector_error_model(circuit, true, true, false, 0.0, false, true);
+
+    auto expected = stim::shortest_graphlike_undetectable_logical_error(model, false, 1);
+    ASSERT_EQ(expected.instructions.size(), 5);
+    for (size_t num_threads : {2, 3, 8}) {
+        ASSERT_EQ(stim::shortest_graphlike_undetectable_logical_error(model, false, num_threads), expected);
+    }
+
+    ASSERT_THROW(
+        {
+            stim::shortest_graphlike_undetectable_logical_error(
+                DetectorErrorModel(R"MODEL(
+            error(0.1) D0
+            error(0.1) D0 D1
+            error(0.1) D1
+        )MODEL"),
+                false,
+                4);
+        },
+        std::invalid_argument);
+}
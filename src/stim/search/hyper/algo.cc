@@ -15,28 +15,30 @@
 #include "stim/search/hyper/algo.h"
 
 #include <algorithm>
-#include <map>
-#include <queue>
 #include <sstream>
 
 #include "stim/search/graphlike/algo.h"
 #include "stim/search/hyper/edge.h"
 #include "stim/search/hyper/graph.h"
 #include "stim/search/hyper/search_state.h"
+#include "stim/search/hyper/search_state_table.h"
 
 using namespace stim;
 using namespace stim::impl_search_hyper;
 
-DetectorErrorModel backtrack_path(const std::map<SearchState, SearchState> &back_map, SearchState &&final_state) {
+DetectorErrorModel backtrack_path(const SearchStateTable &table, size_t final_index) {
     DetectorErrorModel out;
-    SearchState cur_state = std::move(final_state);
+    size_t cur_index = final_index;
+    SearchState cur_state = table.state(cur_index);
     while (true) {
-        auto prev_state = back_map.at(cur_state);
+        size_t prev_index = table.entries[cur_index].predecessor;
+        SearchState prev_state = table.state(prev_index);
         cur_state.append_transition_as_error_instruction_to(prev_state, out);
         if (prev_state.dets.empty()) {
             break;
         }
-        cur_state = prev_state;
+        cur_index = prev_index;
+        cur_state = std::move(prev_state);
     }
     std::sort(out.instructions.begin(), out.instructions.end());
 
@@ -56,7 +58,8 @@ DetectorErrorModel stim::find_undetectable_logical_error(
     const DetectorErrorModel &model,
     size_t dont_explore_detection_event_sets_with_size_above,
     size_t dont_explore_edges_with_degree_above,
-    bool dont_explore_edges_increasing_symptom_degree) {
+    bool dont_explore_edges_increasing_symptom_degree,
+    size_t max_search_memory_bytes) {
     if (dont_explore_edges_with_degree_above == 2 && dont_explore_detection_event_sets_with_size_above == 2) {
         return stim::shortest_graphlike_undetectable_logical_error(model, true);
     }
@@ -72,45 +75,61 @@ DetectorErrorModel stim::find_undetectable_logical_error(
         return out;
     }
 
-    std::queue<SearchState> queue;
-    std::map<SearchState, SearchState> back_map;
+    // Visited states are interned into the table in the order they are found, so the table doubles as the
+    // breadth first search queue. States that shouldn't be explored are skipped when their turn comes.
+    SearchStateTable table(graph.num_observables);
     // Mark the vacuous dead-end state as already seen.
-    back_map.emplace(empty_search_state, empty_search_state);
+    simd_bits<64> zero_obs(graph.num_observables);
+    SpanRef<const uint64_t> zero_obs_words{zero_obs.u64, zero_obs.u64 + table.num_obs_words};
+    table.insert({}, zero_obs_words, SearchStateTable::NO_PREDECESSOR);
 
     // Search starts from any and all edges crossing an observable.
     for (size_t node = 0; node < graph.nodes.size(); node++) {
         for (const auto &e : graph.nodes[node].edges) {
             if (e.crossing_observable_mask.not_zero() && e.nodes.sorted_items[0] == node) {
-                SearchState start{e.nodes, e.crossing_observable_mask};
-                if (start.dets.size() <= dont_explore_detection_event_sets_with_size_above) {
-                    queue.push(start);
-                }
-                back_map.emplace(start, empty_search_state);
+                const uint64_t *obs = e.crossing_observable_mask.u64;
+                table.insert(e.nodes.range(), {obs, obs + table.num_obs_words}, 0);
             }
         }
     }
 
     // Breadth first search for a symptomless state that has a frame change.
-    for (; !queue.empty(); queue.pop()) {
-        SearchState cur = queue.front();
+    std::vector<uint64_t> next_dets;
+    simd_bits<64> next_obs(graph.num_observables);
+    SpanRef<const uint64_t> next_obs_words{next_obs.u64, next_obs.u64 + table.num_obs_words};
+    bool hit_memory_limit = false;
+    for (size_t cur_index = 1; cur_index < table.entries.size(); cur_index++) {
+        // Copy the entry, because inserting states can reallocate the entries (but not the interned data).
+        SearchStateTable::Entry cur = table.entries[cur_index];
+        if (cur.dets.size() > dont_explore_detection_event_sets_with_size_above) {
+            continue;
+        }
         assert(!cur.dets.empty());
-        size_t active_node = cur.dets.sorted_items[0];
+        size_t active_node = cur.dets[0];
         for (const auto &e : graph.nodes[active_node].edges) {
-            SearchState next{e.nodes ^ cur.dets, e.crossing_observable_mask ^ cur.obs_mask};
-            if (next.dets.size() > dont_explore_detection_event_sets_with_size_above) {
+            next_dets.resize(e.nodes.size() + cur.dets.size());
+            next_dets.resize(xor_merge_sort(e.nodes.range(), cur.dets, next_dets.data()) - next_dets.data());
+            if (next_dets.size() > dont_explore_detection_event_sets_with_size_above) {
                 continue;
             }
-            if (dont_explore_edges_increasing_symptom_degree && next.dets.size() > cur.dets.size()) {
+            if (dont_explore_edges_increasing_symptom_degree && next_dets.size() > cur.dets.size()) {
                 continue;
             }
-            if (!back_map.emplace(next, cur).second) {
+            for (size_t w = 0; w < table.num_obs_words; w++) {
+                next_obs.u64[w] = e.crossing_observable_mask.u64[w] ^ cur.obs[w];
+            }
+            // Once the table is over budget, stop recording intermediate states but keep looking for an answer.
+            if (!next_dets.empty() && table.memory_usage_bytes() > max_search_memory_bytes) {
+                hit_memory_limit = true;
                 continue;
             }
-            if (next.dets.empty()) {
-                assert(next.obs_mask.not_zero());  // Otherwise, it would have already been in back_map.
-                return backtrack_path(back_map, std::move(next));
+            if (!table.insert(next_dets, next_obs_words, cur_index)) {
+                continue;
+            }
+            if (next_dets.empty()) {
+                assert(next_obs.not_zero());  // Otherwise, it would have already been in the table.
+                return backtrack_path(table, table.entries.size() - 1);
             }
-            queue.push(std::move(next));
         }
     }
 
@@ -123,6 +142,10 @@ DetectorErrorModel stim::find_undetectable_logical_error(
     if (graph.nodes.size() == 0) {
         err_msg << "\n    WARNING: NO DETECTORS. The circuit or detector error model didn't define any detectors.";
     }
+    if (hit_memory_limit) {
+        err_msg << "\n    WARNING: MEMORY LIMIT REACHED. The search stopped recording new states after using "
+                << max_search_memory_bytes << " bytes, so it may have missed logical errors.";
+    }
     if (model.count_errors() == 0) {
         err_msg << "\n    WARNING: NO ERRORS. The circuit or detector error model didn't include any errors, making it "
                    "vacuously impossible to find a logical error.";
@@ -17,6 +17,7 @@
 #ifndef _STIM_SEARCH_HYPER_ALGO_H
 #define _STIM_SEARCH_HYPER_ALGO_H
 
+#include <cstddef>
 #include <cstdint>
 
 #include "stim/dem/detector_error_model.h"
@@ -66,7 +67,8 @@ DetectorErrorModel find_undetectable_logical_error(
     const DetectorErrorModel &model,
     size_t dont_explore_detection_event_sets_with_size_above,
     size_t dont_explore_edges_with_degree_above,
-    bool dont_explore_edges_increasing_symptom_degree);
+    bool dont_explore_edges_increasing_symptom_degree,
+    size_t max_search_memory_bytes = SIZE_MAX);
 
 }  // namespace stim
 
@@ -231,3 +231,19 @@ TEST(find_undetectable_logical_error, many_observables) {
     auto err = stim::find_undetectable_logical_error(graphlike_model, 4, 4, false);
     ASSERT_EQ(err.instructions.size(), 5);
 }
+
+TEST(find_undetectable_logical_error, memory_limit) {
+    CircuitGenParameters params(5, 5, "rotated_memory_x");
+    params.after_clifford_depolarization = 0.001;
+    auto circuit = generate_surface_code_circuit(params).circuit;
+    auto model = ErrorAnalyzer::circuit_to_detector_error_model(circuit, false, true, false, false, false, true);
+
+    ASSERT_EQ(stim::find_undetectable_logical_error(model, 4, 4, true, 1 << 30).instructions.size(), 5);
+
+    try {
+        stim::find_undetectable_logical_error(model, 4, 4, true, 1000);
+        FAIL() << "Expected the search to fail.";
+    } catch (const std::invalid_argument &ex) {
+        ASSERT_NE(std::string(ex.what()).find("MEMORY LIMIT REACHED"), std::string::npos) << ex.what();
+    }
+}
@@ -0,0 +1,121 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/search/hyper/search_state_table.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace stim;
+using namespace stim::impl_search_hyper;
+
+static uint64_t mix_bits(uint64_t x) {
+    // The finalizer of the splitmix64 generator. Every input bit affects every output bit.
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static void fingerprint(
+    SpanRef<const uint64_t> dets, SpanRef<const uint64_t> obs, uint64_t &out_lo, uint64_t &out_hi) {
+    // Two differently seeded lanes. The detector count separates the detectors from the observable words.
+    uint64_t lo = 0x243F6A8885A308D3ULL ^ dets.size();
+    uint64_t hi = 0x13198A2E03707344ULL ^ dets.size();
+    for (uint64_t v : dets) {
+        lo = mix_bits(lo + v);
+        hi = mix_bits(hi ^ (v * 0x9E3779B97F4A7C15ULL));
+    }
+    for (uint64_t v : obs) {
+        lo = mix_bits(lo + v);
+        hi = mix_bits(hi ^ (v * 0x9E3779B97F4A7C15ULL));
+    }
+    out_lo = lo;
+    out_hi = hi;
+}
+
+SearchStateTable::SearchStateTable(size_t num_observables)
+    : num_observables(num_observables),
+      num_obs_words(simd_bits<64>(num_observables).num_u64_padded()),
+      arena(),
+      entries(),
+      slots() {
+}
+
+void SearchStateTable::grow() {
+    std::vector<Slot> old_slots = std::move(slots);
+    slots.clear();
+    slots.resize(std::max(size_t{16}, old_slots.size() << 1), Slot{0, 0, 0});
+    size_t mask = slots.size() - 1;
+    for (const auto &slot : old_slots) {
+        if (slot.entry_plus_one) {
+            size_t k = slot.fingerprint_lo & mask;
+            while (slots[k].entry_plus_one) {
+                k = (k + 1) & mask;
+            }
+            slots[k] = slot;
+        }
+    }
+}
+
+bool SearchStateTable::insert(SpanRef<const uint64_t> dets, SpanRef<const uint64_t> obs, size_t predecessor) {
+    assert(obs.size() == num_obs_words);
+    // Keep the table at most half full, so that probe sequences stay short.
+    if ((entries.size() + 1) * 2 > slots.size()) {
+        grow();
+    }
+
+    uint64_t lo;
+    uint64_t hi;
+    fingerprint(dets, obs, lo, hi);
+    size_t mask = slots.size() - 1;
+    for (size_t k = lo & mask;; k = (k + 1) & mask) {
+        Slot &slot = slots[k];
+        if (slot.entry_plus_one == 0) {
+            arena.append_tail(dets);
+            arena.append_tail(obs);
+            SpanRef<const uint64_t> data = arena.commit_tail();
+            entries.push_back(Entry{
+                {data.ptr_start, data.ptr_start + dets.size()},
+                {data.ptr_start + dets.size(), data.ptr_end},
+                predecessor,
+            });
+            slot = Slot{lo, hi, entries.size()};
+            return true;
+        }
+        if (slot.fingerprint_lo == lo && slot.fingerprint_hi == hi) {
+            const Entry &e = entries[slot.entry_plus_one - 1];
+            if (e.dets == dets && e.obs == obs) {
+                return false;
+            }
+        }
+    }
+}
+
+size_t SearchStateTable::memory_usage_bytes() const {
+    return arena.total_allocated() * sizeof(uint64_t) + entries.capacity() * sizeof(Entry) +
+           slots.capacity() * sizeof(Slot);
+}
+
+SearchState SearchStateTable::state(size_t index) const {
+    const Entry &e = entries[index];
+    SearchState result{
+        SparseXorVec<uint64_t>(std::vector<uint64_t>(e.dets.begin(), e.dets.end())),
+        simd_bits<64>(num_observables),
+    };
+    std::copy(e.obs.begin(), e.obs.end(), result.obs_mask.u64);
+    return result;
+}
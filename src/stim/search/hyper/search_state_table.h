@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_SEARCH_HYPER_SEARCH_STATE_TABLE_H
+#define _STIM_SEARCH_HYPER_SEARCH_STATE_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "stim/mem/monotonic_buffer.h"
+#include "stim/mem/span_ref.h"
+#include "stim/search/hyper/search_state.h"
+
+namespace stim {
+
+namespace impl_search_hyper {
+
+/// Stores the states visited by the hypergraph search, each one exactly once.
+///
+/// The detectors and observable words of each state are interned into a monotonic buffer, and states refer to
+/// their predecessor by index, so that a visited state costs a few words instead of several heap allocations.
+/// Duplicates are found using an open addressing hash table keyed by 128 bit fingerprints of the states. A
+/// matching fingerprint is double checked against the interned data, so collisions can't cause wrong answers.
+struct SearchStateTable {
+    /// An interned state.
+    struct Entry {
+        /// The sorted detectors of the state.
+        SpanRef<const uint64_t> dets;
+        /// The observable mask of the state, as whole words.
+        SpanRef<const uint64_t> obs;
+        /// The index of the state the search came from, or NO_PREDECESSOR.
+        size_t predecessor;
+    };
+    /// A slot of the hash table.
+    struct Slot {
+        uint64_t fingerprint_lo;
+        uint64_t fingerprint_hi;
+        /// One more than the index of the entry in the slot, or 0 for an empty slot.
+        size_t entry_plus_one;
+    };
+    static constexpr size_t NO_PREDECESSOR = SIZE_MAX;
+
+    size_t num_observables;
+    /// The number of words used to store each observable mask.
+    size_t num_obs_words;
+    MonotonicBuffer<uint64_t> arena;
+    std::vector<Entry> entries;
+    std::vector<Slot> slots;
+
+    explicit SearchStateTable(size_t num_observables);
+
+    /// Adds a state to the table, unless an equal state is already present.
+    ///
+    /// Args:
+    ///     dets: The sorted detectors of the state.
+    ///     obs: The observable mask of the state. Must have exactly num_obs_words words.
+    ///     predecessor: The index of the state the search came from, or NO_PREDECESSOR.
+    ///
+    /// Returns:
+    ///     True if the state was added, false if it was already present.
+    bool insert(SpanRef<const uint64_t> dets, SpanRef<const uint64_t> obs, size_t predecessor);
+
+    /// Returns the number of heap bytes held by the table.
+    size_t memory_usage_bytes() const;
+
+    /// Copies an interned state back out of the table.
+    SearchState state(size_t index) const;
+
+   private:
+    void grow();
+};
+
+}  // namespace impl_search_hyper
+}  // namespace stim
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/search/hyper/search_state_table.h"
+
+#include "gtest/gtest.h"
+
+using namespace stim;
+using namespace stim::impl_search_hyper;
+
+TEST(search_hyper_search_state_table, insert) {
+    SearchStateTable table(70);
+    ASSERT_EQ(table.num_obs_words, 2);
+    std::vector<uint64_t> obs1{0, 0};
+    std::vector<uint64_t> obs2{1, 0};
+    std::vector<uint64_t> obs3{0, 1};
+    std::vector<uint64_t> dets1{};
+    std::vector<uint64_t> dets2{1, 5};
+    std::vector<uint64_t> dets3{1, 5, 6};
+
+    ASSERT_TRUE(table.insert(dets1, obs1, SearchStateTable::NO_PREDECESSOR));
+    ASSERT_FALSE(table.insert(dets1, obs1, 0));
+    ASSERT_TRUE(table.insert(dets2, obs1, 0));
+    ASSERT_TRUE(table.insert(dets2, obs2, 1));
+    ASSERT_TRUE(table.insert(dets2, obs3, 1));
+    ASSERT_TRUE(table.insert(dets3, obs1, 3));
+    ASSERT_FALSE(table.insert(dets2, obs2, 4));
+    ASSERT_FALSE(table.insert(dets3, obs1, 0));
+    ASSERT_TRUE(table.insert(dets1, obs3, 2));
+
+    ASSERT_EQ(table.entries.size(), 6);
+    ASSERT_EQ(table.entries[0].predecessor, SearchStateTable::NO_PREDECESSOR);
+    ASSERT_EQ(table.entries[2].predecessor, 1);
+    ASSERT_EQ(table.entries[4].predecessor, 3);
+    ASSERT_EQ(table.entries[4].dets, (SpanRef<const uint64_t>(dets3)));
+    ASSERT_EQ(table.entries[4].obs, (SpanRef<const uint64_t>(obs1)));
+
+    simd_bits<64> expected_obs(70);
+    expected_obs[64] = true;
+    ASSERT_EQ(table.state(3), (SearchState{SparseXorVec<uint64_t>({1, 5}), expected_obs}));
+    ASSERT_EQ(table.state(5), (SearchState{SparseXorVec<uint64_t>(), expected_obs}));
+}
+
+TEST(search_hyper_search_state_table, many_states) {
+    SearchStateTable table(3);
+    std::vector<uint64_t> obs{0};
+    std::vector<uint64_t> dets;
+    for (size_t k = 0; k < 10000; k++) {
+        dets = {k % 100, 100 + k / 100};
+        obs[0] = k & 7;
+        ASSERT_TRUE(table.insert(dets, obs, k));
+    }
+    size_t used = table.memory_usage_bytes();
+    ASSERT_GT(used, 10000 * (3 * sizeof(uint64_t) + sizeof(SearchStateTable::Entry)));
+    for (size_t k = 0; k < 10000; k++) {
+        dets = {k % 100, 100 + k / 100};
+        obs[0] = k & 7;
+        ASSERT_FALSE(table.insert(dets, obs, 0));
+        obs[0] ^= 8;
+        ASSERT_TRUE(table.insert(dets, obs, 0)) << k;
+    }
+    ASSERT_EQ(table.entries.size(), 20000);
+    ASSERT_EQ(table.state(1234).dets, SparseXorVec<uint64_t>({34, 112}));
+    ASSERT_EQ(table.state(1234).obs_mask.u64[0], 1234 & 7);
+    ASSERT_EQ(table.entries[1234].predecessor, 1234);
+}
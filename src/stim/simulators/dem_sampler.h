@@ -18,6 +18,7 @@
 #define _STIM_SIMULATORS_DEM_SAMPLER_H
 
 #include <random>
+#include <vector>
 
 #include "stim/dem/detector_error_model.h"
 #include "stim/io/stim_data_formats.h"
@@ -34,19 +35,57 @@ struct DemSampler {
     uint64_t num_detectors;
     uint64_t num_observables;
     uint64_t num_errors;
-    std::mt19937_64 rng;
+    PhiloxRng rng;
     // TODO: allow these buffers to be streamed instead of entirely stored in memory.
     simd_bit_table<W> det_buffer;
     simd_bit_table<W> obs_buffer;
     simd_bit_table<W> err_buffer;
     size_t num_stripes;
 
-    /// Compiles a sampler for the given detector error model.
+    // The model's flattened error mechanisms, compiled for sampling.
+    //
+    // The symptoms of the k'th error are the entries of `error_targets` from
+    // `error_target_offsets[k]` up to `error_target_offsets[k + 1]`. Entries below
+    // `num_detectors` are detector indices, and the rest are observable indices
+    // offset by `num_detectors`.
+    std::vector<double> error_probabilities;
+    std::vector<uint64_t> error_target_offsets;
+    std::vector<uint64_t> error_targets;
+    // Errors likely enough that they're cheapest to sample one row of shots at a time.
+    std::vector<uint64_t> dense_errors;
+    // Errors unlikely enough that they're cheapest to sample by skipping over the gaps
+    // between hits. They're grouped by probability, so one pass covers a whole group.
+    std::vector<std::pair<double, std::vector<uint64_t>>> sparse_error_classes;
+
+    /// Compiles a sampler for the given detector error model, pulling noise from the given counter-based generator.
+    DemSampler(DetectorErrorModel model, PhiloxRng rng, size_t min_stripes);
+    /// Same as above, but keys the noise generator with one draw from the given generator.
     DemSampler(DetectorErrorModel model, std::mt19937_64 &&rng, size_t min_stripes);
 
     /// Clears the buffers and refills them with sampled shot data.
     void resample(bool replay_errors);
 
+    /// Clears the given buffers and refills them with sampled shot data.
+    ///
+    /// This doesn't touch the sampler's own buffers or generator, so it's safe to call
+    /// concurrently from several threads as long as each has its own buffers and generator.
+    ///
+    /// Args:
+    ///     det_data: Where to write detection event data. Must have a row per detector.
+    ///     obs_data: Where to write observable data. Must have a row per observable.
+    ///     err_data: Where to write the sampled errors (or where to read them from, when
+    ///         replaying). If it has a row per error, the errors are kept. If it only has one
+    ///         row, that row is used as scratch space and the errors are discarded. Replaying
+    ///         requires a row per error.
+    ///     replay_errors: When set, err_data is used as is instead of being resampled.
+    ///     sample_rng: The generator to use when sampling errors.
+    void resample_into(
+        simd_bit_table<W> &det_data,
+        simd_bit_table<W> &obs_data,
+        simd_bit_table<W> &err_data,
+        bool replay_errors,
+        PhiloxRng &sample_rng) const;
+
     /// Ensures the internal buffers are sized for a given number of shots.
     void set_min_stripes(size_t min_stripes);
 
@@ -63,6 +102,11 @@ struct DemSampler {
     ///     replay_err_in: If this argument is given a non-null file, error data will be read from that file
     ///         and replayed (instead of generating new errors randomly).
     ///     replay_err_in_format: The format to read recorded error data to replay in.
+    ///     num_threads: How many threads to spread the batches of shots over. Each thread has
+    ///         its own buffers, and batches are written to the outputs in order. Each batch
+    ///         draws from its own stream of a counter-based generator keyed by `rng`, so the
+    ///         results depend on the seed of `rng` but not on the number of threads. Defaults
+    ///         to 1 (sample on the calling thread).
     void sample_write(
         size_t num_shots,
         FILE *det_out,
@@ -72,7 +116,8 @@ struct DemSampler {
         FILE *err_out,
         SampleFormat err_out_format,
         FILE *replay_err_in,
-        SampleFormat replay_err_in_format);
+        SampleFormat replay_err_in_format,
+        size_t num_threads = 1);
 };
 
 }  // namespace stim
@@ -15,16 +15,24 @@
  */
 
 #include <algorithm>
+#include <map>
 
 #include "stim/io/measure_record_reader.h"
 #include "stim/io/measure_record_writer.h"
 #include "stim/simulators/dem_sampler.h"
+#include "stim/util_bot/parallel_batches.h"
+#include "stim/util_bot/philox_rng.h"
 #include "stim/util_bot/probability_util.h"
 
 namespace stim {
 
 template <size_t W>
 DemSampler<W>::DemSampler(DetectorErrorModel init_model, std::mt19937_64 &&rng, size_t min_stripes)
+    : DemSampler(std::move(init_model), PhiloxRng(rng()), min_stripes) {
+}
+
+template <size_t W>
+DemSampler<W>::DemSampler(DetectorErrorModel init_model, PhiloxRng rng, size_t min_stripes)
     : model(std::move(init_model)),
       num_detectors(model.count_detectors()),
       num_observables(model.count_observables()),
@@ -34,6 +42,35 @@ DemSampler<W>::DemSampler(DetectorErrorModel init_model, std::mt19937_64 &&rng,
       obs_buffer((size_t)num_observables, min_stripes),
       err_buffer((size_t)num_errors, min_stripes),
       num_stripes(det_buffer.num_minor_bits_padded()) {
+    // Errors below this probability are sampled by skipping over the gaps between hits.
+    // It matches the point where biased_randomize_bits switches to gap sampling.
+    constexpr double SPARSE_PROBABILITY_THRESHOLD = 0.02;
+
+    std::map<double, std::vector<uint64_t>> sparse_classes;
+    error_target_offsets.push_back(0);
+    model.iter_flatten_error_instructions([&](const DemInstruction &op) {
+        uint64_t error_index = error_probabilities.size();
+        double p = op.arg_data[0];
+        error_probabilities.push_back(p);
+        for (const auto &t : op.target_data) {
+            if (t.is_relative_detector_id()) {
+                error_targets.push_back(t.raw_id());
+            } else if (t.is_observable_id()) {
+                error_targets.push_back(num_detectors + t.raw_id());
+            }
+        }
+        error_target_offsets.push_back(error_targets.size());
+        if (p < SPARSE_PROBABILITY_THRESHOLD) {
+            if (p > 0) {
+                sparse_classes[p].push_back(error_index);
+            }
+        } else {
+            dense_errors.push_back(error_index);
+        }
+    });
+    for (auto &[p, errors] : sparse_classes) {
+        sparse_error_classes.push_back({p, std::move(errors)});
+    }
 }
 
 template <size_t W>
@@ -49,26 +86,68 @@ void DemSampler<W>::set_min_stripes(size_t min_stripes) {
 
 template <size_t W>
 void DemSampler<W>::resample(bool replay_errors) {
-    det_buffer.clear();
-    obs_buffer.clear();
+    resample_into(det_buffer, obs_buffer, err_buffer, replay_errors, rng);
+}
+
+template <size_t W>
+void DemSampler<W>::resample_into(
+    simd_bit_table<W> &det_data,
+    simd_bit_table<W> &obs_data,
+    simd_bit_table<W> &err_data,
+    bool replay_errors,
+    PhiloxRng &sample_rng) const {
+    det_data.clear();
+    obs_data.clear();
     if (!replay_errors) {
-        err_buffer.clear();
+        err_data.clear();
     }
-    size_t error_index = 0;
-    model.iter_flatten_error_instructions([&](const DemInstruction &op) {
-        simd_bits_range_ref<W> err_row = err_buffer[error_index];
-        if (!replay_errors) {
-            biased_randomize_bits((float)op.arg_data[0], err_row.u64, err_row.u64 + err_row.num_u64_padded(), rng);
-        }
-        for (const auto &t : op.target_data) {
-            if (t.is_relative_detector_id()) {
-                det_buffer[(size_t)t.raw_id()] ^= err_row;
-            } else if (t.is_observable_id()) {
-                obs_buffer[(size_t)t.raw_id()] ^= err_row;
+    bool keep_errors = err_data.num_major_bits_padded() >= num_errors;
+    auto xor_into_symptoms = [&](uint64_t error_index, simd_bits_range_ref<W> row) {
+        for (uint64_t k = error_target_offsets[error_index]; k < error_target_offsets[error_index + 1]; k++) {
+            uint64_t t = error_targets[k];
+            if (t < num_detectors) {
+                det_data[t] ^= row;
+            } else {
+                obs_data[t - num_detectors] ^= row;
             }
         }
-        error_index++;
-    });
+    };
+
+    if (replay_errors) {
+        for (uint64_t e = 0; e < num_errors; e++) {
+            xor_into_symptoms(e, err_data[e]);
+        }
+        return;
+    }
+
+    for (uint64_t e : dense_errors) {
+        simd_bits_range_ref<W> err_row = err_data[keep_errors ? e : 0];
+        biased_randomize_bits(
+            (float)error_probabilities[e], err_row.u64, err_row.u64 + err_row.num_u64_padded(), sample_rng);
+        xor_into_symptoms(e, err_row);
+    }
+
+    // For rare errors, sample which (error, shot) cells of the whole probability class were hit.
+    size_t shots = det_data.num_minor_bits_padded();
+    for (const auto &[p, errors] : sparse_error_classes) {
+        RareErrorIterator::for_samples(p, errors.size() * shots, sample_rng, [&](size_t cell) {
+            uint64_t e = errors[cell / shots];
+            size_t s = cell % shots;
+            uint64_t bit = uint64_t{1} << (s & 63);
+            size_t word = s >> 6;
+            if (keep_errors) {
+                err_data[e].u64[word] ^= bit;
+            }
+            for (uint64_t k = error_target_offsets[e]; k < error_target_offsets[e + 1]; k++) {
+                uint64_t t = error_targets[k];
+                if (t < num_detectors) {
+                    det_data[t].u64[word] ^= bit;
+                } else {
+                    obs_data[t - num_detectors].u64[word] ^= bit;
+                }
+            }
+        });
+    }
 }
 
 template <size_t W>
@@ -81,50 +160,97 @@ void DemSampler<W>::sample_write(
     FILE *err_out,
     SampleFormat err_out_format,
     FILE *err_in,
-    SampleFormat err_in_format) {
-    for (size_t k = 0; k < num_shots; k += num_stripes) {
-        size_t shots_left = std::min(num_stripes, num_shots - k);
-
-        if (err_in != nullptr) {
-            size_t errors_read = read_file_data_into_shot_table(
-                err_in, shots_left, (size_t)num_errors, err_in_format, 'M', err_buffer, false);
-            if (errors_read != shots_left) {
-                throw std::invalid_argument("Expected more error data for the requested number of shots.");
-            }
-        }
-        resample(err_in != nullptr);
+    SampleFormat err_in_format,
+    size_t num_threads) {
+    struct Stripes {
+        simd_bit_table<W> det_data;
+        simd_bit_table<W> obs_data;
+        simd_bit_table<W> err_data;
+        PhiloxRng rng;
+    };
 
-        if (err_out != nullptr) {
-            write_table_data(
-                err_out, shots_left, (size_t)num_errors, simd_bits<W>(0), err_buffer, err_out_format, 'M', 'M', false);
-        }
+    // The k'th batch is sampled from the k'th stream of a counter-based generator keyed by a single
+    // value drawn from `rng`. This makes the output depend on the seed but not on the number of threads.
+    uint64_t key = rng();
+    size_t num_batches = (num_shots + num_stripes - 1) / num_stripes;
+    auto shots_in_batch = [&](size_t batch_index) {
+        return std::min(num_stripes, num_shots - batch_index * num_stripes);
+    };
 
-        if (obs_out != nullptr) {
-            write_table_data(
-                obs_out,
-                shots_left,
-                (size_t)num_observables,
-                simd_bits<W>(0),
-                obs_buffer,
-                obs_out_format,
-                'L',
-                'L',
-                false);
-        }
+    // The errors only need to be kept around if they are being written or replayed.
+    bool keep_errors = err_out != nullptr || err_in != nullptr;
 
-        if (det_out != nullptr) {
-            write_table_data(
-                det_out,
-                shots_left,
-                (size_t)num_detectors,
-                simd_bits<W>(0),
-                det_buffer,
-                det_out_format,
-                'D',
-                'D',
-                false);
-        }
+    // A single reader consumes all the replayed errors, since readers buffer ahead of what they return.
+    std::unique_ptr<MeasureRecordReader<W>> err_reader;
+    if (err_in != nullptr) {
+        err_reader = MeasureRecordReader<W>::make(err_in, err_in_format, (size_t)num_errors);
     }
+
+    process_batches_in_parallel_in_order(
+        num_batches,
+        num_threads,
+        [&]() {
+            return Stripes{
+                simd_bit_table<W>((size_t)num_detectors, num_stripes),
+                simd_bit_table<W>((size_t)num_observables, num_stripes),
+                simd_bit_table<W>(keep_errors ? (size_t)num_errors : 1, num_stripes),
+                PhiloxRng(key),
+            };
+        },
+        [&](Stripes &stripes, size_t batch_index) {
+            if (err_in != nullptr) {
+                size_t shots_left = shots_in_batch(batch_index);
+                size_t errors_read = err_reader->read_into_table_with_minor_shot_index(stripes.err_data, shots_left);
+                if (errors_read != shots_left) {
+                    throw std::invalid_argument("Expected more error data for the requested number of shots.");
+                }
+            }
+        },
+        [&](Stripes &stripes, size_t batch_index) {
+            stripes.rng = PhiloxRng(key, batch_index);
+            resample_into(stripes.det_data, stripes.obs_data, stripes.err_data, err_in != nullptr, stripes.rng);
+        },
+        [&](Stripes &stripes, size_t batch_index) {
+            size_t shots_left = shots_in_batch(batch_index);
+            if (err_out != nullptr) {
+                write_table_data(
+                    err_out,
+                    shots_left,
+                    (size_t)num_errors,
+                    simd_bits<W>(0),
+                    stripes.err_data,
+                    err_out_format,
+                    'M',
+                    'M',
+                    false);
+            }
+
+            if (obs_out != nullptr) {
+                write_table_data(
+                    obs_out,
+                    shots_left,
+                    (size_t)num_observables,
+                    simd_bits<W>(0),
+                    stripes.obs_data,
+                    obs_out_format,
+                    'L',
+                    'L',
+                    false);
+            }
+
+            if (det_out != nullptr) {
+                write_table_data(
+                    det_out,
+                    shots_left,
+                    (size_t)num_detectors,
+                    simd_bits<W>(0),
+                    stripes.det_data,
+                    det_out_format,
+                    'D',
+                    'D',
+                    false);
+            }
+        });
 }
 
 }  // namespace stim
@@ -38,7 +38,7 @@ RaiiFile optional_py_path_to_raii_file(const pybind11::object &obj, const char *
     return RaiiFile(nullptr);
 }
 
-pybind11::object dem_sampler_py_sample(
+static pybind11::object dem_sampler_py_sample_while_locked(
     DemSampler<MAX_BITWORD_WIDTH> &self,
     size_t shots,
     bool bit_packed,
@@ -48,9 +48,10 @@ pybind11::object dem_sampler_py_sample(
 
     bool replay = !recorded_errors_to_replay.is_none();
     if (replay && min_bits_to_num_bits_padded<MAX_BITWORD_WIDTH>(shots) != self.num_stripes) {
-        DemSampler<MAX_BITWORD_WIDTH> perfect_size(self.model, std::move(self.rng), shots);
-        auto result = dem_sampler_py_sample(perfect_size, shots, bit_packed, return_errors, recorded_errors_to_replay);
-        self.rng = std::move(perfect_size.rng);
+        DemSampler<MAX_BITWORD_WIDTH> perfect_size(self.model, self.rng, shots);
+        auto result =
+            dem_sampler_py_sample_while_locked(perfect_size, shots, bit_packed, return_errors, recorded_errors_to_replay);
+        self.rng = perfect_size.rng;
         return result;
     }
 
@@ -66,7 +67,10 @@ pybind11::object dem_sampler_py_sample(
         self.err_buffer = std::move(converted);
     }
 
-    self.resample(replay);
+    {
+        pybind11::gil_scoped_release release;
+        self.resample(replay);
+    }
 
     pybind11::object err_out = pybind11::none();
     if (return_errors) {
@@ -79,6 +83,16 @@ pybind11::object dem_sampler_py_sample(
     return pybind11::make_tuple(det_out, obs_out, err_out);
 }
 
+pybind11::object dem_sampler_py_sample(
+    DemSampler<MAX_BITWORD_WIDTH> &self,
+    size_t shots,
+    bool bit_packed,
+    bool return_errors,
+    pybind11::object &recorded_errors_to_replay) {
+    auto lock = lock_py_object(&self);
+    return dem_sampler_py_sample_while_locked(self, shots, bit_packed, return_errors, recorded_errors_to_replay);
+}
+
 pybind11::class_<DemSampler<MAX_BITWORD_WIDTH>> stim_pybind::pybind_dem_sampler(pybind11::module &m) {
     return pybind11::class_<DemSampler<MAX_BITWORD_WIDTH>>(
         m,
@@ -128,6 +142,10 @@ void stim_pybind::pybind_dem_sampler_methods(pybind11::module &m, pybind11::clas
             @signature def sample(self, shots: int, *, bit_packed: bool = False, return_errors: bool = False, recorded_errors_to_replay: Optional[np.ndarray] = None) -> Tuple[np.ndarray, np.ndarray, Optional[np.ndarray]]:
             Samples the detector error model's error mechanisms to produce sample data.
 
+            The shots are sampled on the calling thread. Use `sample_write`, which takes
+            a `num_threads` argument, to spread the sampling over several threads.
+            Calls on the same sampler from different python threads run one at a time.
+
             Args:
                 shots: The number of times to sample from the model.
                 bit_packed: Defaults to false.
@@ -281,21 +299,22 @@ void stim_pybind::pybind_dem_sampler_methods(pybind11::module &m, pybind11::clas
            pybind11::object &err_out_file,
            std::string_view err_out_format,
            pybind11::object &replay_err_in_file,
-           std::string_view replay_err_in_format) {
+           std::string_view replay_err_in_format,
+           size_t num_threads) {
             RaiiFile fd = optional_py_path_to_raii_file(det_out_file, "wb");
             RaiiFile fo = optional_py_path_to_raii_file(obs_out_file, "wb");
             RaiiFile feo = optional_py_path_to_raii_file(err_out_file, "wb");
             RaiiFile fei = optional_py_path_to_raii_file(replay_err_in_file, "rb");
-            self.sample_write(
-                shots,
-                fd.f,
-                format_to_enum(det_out_format),
-                fo.f,
-                format_to_enum(obs_out_format),
-                feo.f,
-                format_to_enum(err_out_format),
-                fei.f,
-                format_to_enum(replay_err_in_format));
+            auto f_det = format_to_enum(det_out_format);
+            auto f_obs = format_to_enum(obs_out_format);
+            auto f_err = format_to_enum(err_out_format);
+            auto f_replay = format_to_enum(replay_err_in_format);
+            if (num_threads == 0) {
+                throw std::invalid_argument("num_threads must be at least 1.");
+            }
+            auto lock = lock_py_object(&self);
+            pybind11::gil_scoped_release release;
+            self.sample_write(shots, fd.f, f_det, fo.f, f_obs, feo.f, f_err, fei.f, f_replay, num_threads);
         },
         pybind11::arg("shots"),
         pybind11::kw_only(),
@@ -307,8 +326,9 @@ void stim_pybind::pybind_dem_sampler_methods(pybind11::module &m, pybind11::clas
         pybind11::arg("err_out_format") = "01",
         pybind11::arg("replay_err_in_file") = pybind11::none(),
         pybind11::arg("replay_err_in_format") = "01",
+        pybind11::arg("num_threads") = 1,
         clean_doc_string(R"DOC(
-            @signature def sample_write(self, shots: int, *, det_out_file: Union[None, str, pathlib.Path], det_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01', obs_out_file: Union[None, str, pathlib.Path], obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01', err_out_file: Union[None, str, pathlib.Path] = None, err_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01', replay_err_in_file: Union[None, str, pathlib.Path] = None, replay_err_in_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01') -> None:
+            @signature def sample_write(self, shots: int, *, det_out_file: Union[None, str, pathlib.Path], det_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', obs_out_file: Union[None, str, pathlib.Path], obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', err_out_file: Union[None, str, pathlib.Path] = None, err_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', replay_err_in_file: Union[None, str, pathlib.Path] = None, replay_err_in_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', num_threads: int = 1) -> None:
             Samples the detector error model and writes the results to disk.
 
             Args:
@@ -340,6 +360,9 @@ void stim_pybind::pybind_dem_sampler_methods(pybind11::module &m, pybind11::clas
                     - io.IOBase: NOT IMPLEMENTED
                 replay_err_in_format: The format to write the errors-that-occurred data in
                     (e.g. "01" or "b8").
+                num_threads: Defaults to 1. The number of threads to spread the sampling
+                    over. Batches of shots are sampled concurrently and written in order.
+                    The sampled results don't depend on the number of threads.
 
             Returns:
                 Nothing. Results are written to disk.
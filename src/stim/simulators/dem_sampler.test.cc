@@ -98,3 +98,142 @@ TEST_EACH_WORD_SIZE_W(DemSampler, resample_combinations, {
         ASSERT_FALSE(total.not_zero());
     }
 })
+
+TEST_EACH_WORD_SIZE_W(DemSampler, compiled_error_classes, {
+    DemSampler<W> sampler(
+        DetectorErrorModel(R"DEM(
+            error(0.001) D0 D1
+            error(0.5) D1 L0
+            error(0.001) D2 L1
+            error(0) D3
+            error(0.01) D3 ^ D4
+         )DEM"),
+        INDEPENDENT_TEST_RNG(),
+        100);
+    ASSERT_EQ(sampler.error_probabilities, (std::vector<double>{0.001, 0.5, 0.001, 0, 0.01}));
+    ASSERT_EQ(sampler.error_target_offsets, (std::vector<uint64_t>{0, 2, 4, 6, 7, 9}));
+    ASSERT_EQ(sampler.error_targets, (std::vector<uint64_t>{0, 1, 1, 5, 2, 6, 3, 3, 4}));
+    ASSERT_EQ(sampler.dense_errors, (std::vector<uint64_t>{1}));
+    ASSERT_EQ(
+        sampler.sparse_error_classes,
+        (std::vector<std::pair<double, std::vector<uint64_t>>>{{0.001, {0, 2}}, {0.01, {4}}}));
+})
+
+TEST_EACH_WORD_SIZE_W(DemSampler, resample_sparse_errors, {
+    DemSampler<W> sampler(
+        DetectorErrorModel(R"DEM(
+            error(0.01) D0 L0
+            error(0.01) D1
+            error(0.005) D1 D2
+         )DEM"),
+        INDEPENDENT_TEST_RNG(),
+        20000);
+    for (size_t k = 0; k < 2; k++) {
+        sampler.resample(false);
+        size_t n = sampler.num_stripes;
+        ASSERT_GT(sampler.err_buffer[0].popcnt(), n / 100 / 2);
+        ASSERT_LT(sampler.err_buffer[0].popcnt(), n / 100 * 2);
+        ASSERT_GT(sampler.err_buffer[2].popcnt(), n / 200 / 2);
+        ASSERT_LT(sampler.err_buffer[2].popcnt(), n / 200 * 2);
+        ASSERT_EQ(sampler.det_buffer[0], sampler.err_buffer[0]);
+        ASSERT_EQ(sampler.obs_buffer[0], sampler.err_buffer[0]);
+        simd_bits<W> d1 = sampler.err_buffer[1];
+        d1 ^= sampler.err_buffer[2];
+        ASSERT_EQ(sampler.det_buffer[1], d1);
+        ASSERT_EQ(sampler.det_buffer[2], sampler.err_buffer[2]);
+
+        // Replaying the sampled errors reproduces the same symptoms.
+        simd_bit_table<W> dets = sampler.det_buffer;
+        sampler.resample(true);
+        ASSERT_EQ(sampler.det_buffer, dets);
+    }
+})
+
+TEST_EACH_WORD_SIZE_W(DemSampler, sample_write_threaded_matches_single_threaded, {
+    DetectorErrorModel dem(R"DEM(
+        error(0.1) D0 D1
+        error(0.2) D1 D2 L0
+        error(1) D3
+    )DEM");
+
+    auto sample_with_threads = [&](size_t num_threads) {
+        DemSampler<W> sampler(dem, std::mt19937_64(5), 100);
+        FILE *det_tmp = tmpfile();
+        FILE *obs_tmp = tmpfile();
+        FILE *err_tmp = tmpfile();
+        sampler.sample_write(
+            1001,
+            det_tmp,
+            SampleFormat::SAMPLE_FORMAT_01,
+            obs_tmp,
+            SampleFormat::SAMPLE_FORMAT_01,
+            err_tmp,
+            SampleFormat::SAMPLE_FORMAT_01,
+            nullptr,
+            SampleFormat::SAMPLE_FORMAT_01,
+            num_threads);
+        return std::vector<std::string>{
+            rewind_read_close(det_tmp), rewind_read_close(obs_tmp), rewind_read_close(err_tmp)};
+    };
+
+    auto result1 = sample_with_threads(1);
+    auto result2 = sample_with_threads(2);
+    auto result7 = sample_with_threads(7);
+    ASSERT_EQ(result1, result2);
+    ASSERT_EQ(result2, result7);
+    ASSERT_EQ(result2[0].size(), 1001 * 5);
+    ASSERT_EQ(result2[1].size(), 1001 * 2);
+    ASSERT_EQ(result2[2].size(), 1001 * 4);
+    size_t hits = 0;
+    for (size_t k = 0; k < 1001; k++) {
+        ASSERT_EQ(result2[0][k * 5 + 3], '1');
+        ASSERT_EQ(result2[2][k * 4 + 2], '1');
+        hits += result2[2][k * 4] == '1';
+    }
+    ASSERT_GT(hits, 50);
+    ASSERT_LT(hits, 150);
+
+    // Replaying the recorded errors reproduces the same detection events, regardless of threads.
+    for (size_t num_threads : {1, 3}) {
+        DemSampler<W> sampler(dem, std::mt19937_64(6), 100);
+        FILE *err_in = tmpfile();
+        fwrite(result2[2].data(), 1, result2[2].size(), err_in);
+        rewind(err_in);
+        FILE *det_tmp = tmpfile();
+        sampler.sample_write(
+            1001,
+            det_tmp,
+            SampleFormat::SAMPLE_FORMAT_01,
+            nullptr,
+            SampleFormat::SAMPLE_FORMAT_01,
+            nullptr,
+            SampleFormat::SAMPLE_FORMAT_01,
+            err_in,
+            SampleFormat::SAMPLE_FORMAT_01,
+            num_threads);
+        fclose(err_in);
+        ASSERT_EQ(rewind_read_close(det_tmp), result2[0]);
+    }
+
+    // Running out of replay data is reported.
+    DemSampler<W> sampler(dem, std::mt19937_64(6), 100);
+    FILE *err_in = tmpfile();
+    fwrite(result2[2].data(), 1, 500 * 4, err_in);
+    rewind(err_in);
+    ASSERT_THROW(
+        {
+            sampler.sample_write(
+                1001,
+                nullptr,
+                SampleFormat::SAMPLE_FORMAT_01,
+                nullptr,
+                SampleFormat::SAMPLE_FORMAT_01,
+                nullptr,
+                SampleFormat::SAMPLE_FORMAT_01,
+                err_in,
+                SampleFormat::SAMPLE_FORMAT_01,
+                3);
+        },
+        std::invalid_argument);
+    fclose(err_in);
+})
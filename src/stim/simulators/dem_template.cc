@@ -0,0 +1,328 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/dem_template.h"
+
+#include <set>
+
+#include "stim/util_bot/error_decomp.h"
+
+using namespace stim;
+
+static void collect_noise_params(
+    const Circuit &circuit, std::vector<double> &params, std::map<const double *, size_t> &offsets) {
+    for (const auto &op : circuit.operations) {
+        if (op.gate_type == GateType::REPEAT) {
+            collect_noise_params(op.repeat_block_body(circuit), params, offsets);
+        } else if (DemTemplate::has_noise_params(op) && !offsets.contains(op.args.ptr_start)) {
+            offsets.emplace(op.args.ptr_start, params.size());
+            params.insert(params.end(), op.args.begin(), op.args.end());
+        }
+    }
+}
+
+bool DemTemplate::has_noise_params(const CircuitInstruction &inst) {
+    const Gate &gate = GATE_DATA[inst.gate_type];
+    return (gate.flags & (GATE_IS_NOISY | GATE_PRODUCES_RESULTS)) && !inst.args.empty();
+}
+
+/// Determines if every error added by the given instructions has the same probability, which can be computed using
+/// `uniform_error_probability`.
+static bool has_uniform_error_probability(SpanRef<const CircuitInstruction> instructions) {
+    if (instructions.size() != 1) {
+        return false;
+    }
+    switch (instructions[0].gate_type) {
+        case GateType::X_ERROR:
+        case GateType::Y_ERROR:
+        case GateType::Z_ERROR:
+        case GateType::DEPOLARIZE1:
+        case GateType::DEPOLARIZE2:
+        case GateType::E:
+        case GateType::I_ERROR:
+        case GateType::II_ERROR:
+            return true;
+        case GateType::HERALDED_ERASE:
+        case GateType::HERALDED_PAULI_CHANNEL_1:
+            return false;
+        default:
+            // Measurements add their flip probability to the sensitivities of their results.
+            return GATE_DATA[instructions[0].gate_type].flags & GATE_PRODUCES_RESULTS;
+    }
+}
+
+static double uniform_error_probability(GateType gate_type, SpanRef<const double> args) {
+    switch (gate_type) {
+        case GateType::I_ERROR:
+        case GateType::II_ERROR:
+            return 0;
+        case GateType::DEPOLARIZE1:
+            if (args[0] > 0.75) {
+                throw std::invalid_argument("Can't analyze over-mixing DEPOLARIZE1 errors (probability > 3/4).");
+            }
+            return depolarize1_probability_to_independent_per_channel_probability(args[0]);
+        case GateType::DEPOLARIZE2:
+            if (args[0] > 15.0 / 16.0) {
+                throw std::invalid_argument("Can't analyze over-mixing DEPOLARIZE2 errors (probability > 15/16).");
+            }
+            return depolarize2_probability_to_independent_per_channel_probability(args[0]);
+        default:
+            return args[0];
+    }
+}
+
+DemTemplate::DemTemplate(
+    const Circuit &circuit,
+    bool decompose_errors,
+    double approximate_disjoint_errors_threshold,
+    bool ignore_decomposition_failures,
+    bool block_decomposition_from_introducing_remnant_edges)
+    : circuit(circuit),
+      decompose_errors(decompose_errors),
+      approximate_disjoint_errors_threshold(approximate_disjoint_errors_threshold),
+      ignore_decomposition_failures(ignore_decomposition_failures),
+      block_decomposition_from_introducing_remnant_edges(block_decomposition_from_introducing_remnant_edges),
+      num_qubits(circuit.count_qubits()),
+      num_measurements(circuit.count_measurements()),
+      num_detectors(circuit.count_detectors()),
+      num_ticks(circuit.count_ticks()) {
+    collect_noise_params(this->circuit, default_params, param_offsets);
+
+    // Named parameters are analyzed as if they were 0. That still records every error class they can contribute to.
+    CircuitParameterBinding zeros;
+    for (double p : default_params) {
+        if (is_circuit_parameter_arg(p)) {
+            zeros.set(circuit_parameter_name(p), 0);
+        }
+    }
+
+    ErrorAnalyzer analyzer(
+        num_measurements,
+        num_detectors,
+        num_qubits,
+        num_ticks,
+        decompose_errors,
+        false,
+        false,
+        approximate_disjoint_errors_threshold,
+        ignore_decomposition_failures,
+        block_decomposition_from_introducing_remnant_edges);
+    analyzer.current_circuit_being_analyzed = &this->circuit;
+    analyzer.noise_recorder = this;
+    analyzer.parameter_binding = &zeros;
+    analyzer.undo_circuit(this->circuit);
+    analyzer.post_check_initialization();
+
+    // Nothing has been flushed yet, so the partial model only contains the annotations.
+    reversed_annotations = std::move(analyzer.flushed_reversed_model);
+
+    // Number the classes in sorted order, so that instantiating can insert them in order.
+    std::vector<uint32_t> sorted_index(error_classes.size());
+    uint32_t k = 0;
+    for (auto &kv : error_class_indices) {
+        error_classes[k] = kv.first;
+        sorted_index[kv.second] = k;
+        k++;
+    }
+    for (auto &c : event_error_classes) {
+        c = sorted_index[c];
+    }
+    error_class_indices.clear();
+}
+
+void DemTemplate::record_noise(
+    const SparseUnsignedRevFrameTracker &tracker, SpanRef<const CircuitInstruction> instructions) {
+    NoiseEvent event{
+        .instruction_start = event_instructions.size(),
+        .instruction_end = event_instructions.size() + instructions.size(),
+        .replay = !has_uniform_error_probability(instructions),
+        .error_start = event_error_classes.size(),
+        .error_end = event_error_classes.size(),
+        .qubit_start = event_qubits.size(),
+        .qubit_end = event_qubits.size(),
+        .sensitivity_start = event_sensitivities.size(),
+        .sensitivity_end = event_sensitivities.size(),
+        .num_measurements_in_past = tracker.num_measurements_in_past,
+    };
+    for (const auto &inst : instructions) {
+        event_instructions.push_back(inst);
+        event_instruction_param_offsets.push_back(param_offsets.at(inst.args.ptr_start));
+    }
+
+    if (event.replay) {
+        uint64_t num_results = 0;
+        std::set<uint32_t> qubits;
+        for (const auto &inst : instructions) {
+            num_results += inst.count_measurement_results();
+            for (const auto &t : inst.targets) {
+                if (t.has_qubit_value()) {
+                    qubits.insert(t.qubit_value());
+                }
+            }
+        }
+
+        auto store = [&](SpanRef<const DemTarget> sensitivity) {
+            sensitivity_buf.append_tail(sensitivity);
+            event_sensitivities.push_back(sensitivity_buf.commit_tail());
+        };
+        for (uint32_t q : qubits) {
+            event_qubits.push_back(q);
+            store(tracker.xs[q].range());
+            store(tracker.zs[q].range());
+        }
+        for (uint64_t m = tracker.num_measurements_in_past - num_results; m < tracker.num_measurements_in_past; m++) {
+            auto p = tracker.rec_bits.find(m);
+            if (p == tracker.rec_bits.end()) {
+                store({});
+            } else {
+                store(p->second.range());
+            }
+        }
+        event.qubit_end = event_qubits.size();
+        event.sensitivity_end = event_sensitivities.size();
+    }
+
+    events.push_back(event);
+}
+
+void DemTemplate::record_error(const ErrorEquivalenceClass &error_class) {
+    if (events.empty() || events.back().replay) {
+        return;
+    }
+    NoiseEvent &event = events.back();
+    auto p = error_class_indices.find(error_class);
+    uint32_t index;
+    if (p == error_class_indices.end()) {
+        index = (uint32_t)error_classes.size();
+        error_class_buf.append_tail(error_class.targets);
+        ErrorEquivalenceClass stored{error_class_buf.commit_tail(), error_class.tag};
+        error_classes.push_back(stored);
+        error_class_indices.emplace(stored, index);
+    } else {
+        index = p->second;
+    }
+    event_error_classes.push_back(index);
+    event.error_end = event_error_classes.size();
+}
+
+size_t DemTemplate::num_params() const {
+    return default_params.size();
+}
+
+DetectorErrorModel DemTemplate::instantiate(const CircuitParameterBinding &binding) const {
+    std::vector<double> params;
+    params.reserve(default_params.size());
+    for (double p : default_params) {
+        params.push_back(binding.resolve(p));
+    }
+    return instantiate(params);
+}
+
+DetectorErrorModel DemTemplate::instantiate(SpanRef<const double> params) const {
+    if (params.size() != default_params.size()) {
+        throw std::invalid_argument(
+            "Expected " + std::to_string(default_params.size()) + " parameters but got " +
+            std::to_string(params.size()) + ".");
+    }
+    for (double p : params) {
+        if (!(p >= 0 && p <= 1)) {
+            throw std::invalid_argument("Parameter " + std::to_string(p) + " isn't a probability between 0 and 1.");
+        }
+    }
+
+    ErrorAnalyzer analyzer(
+        num_measurements,
+        num_detectors,
+        num_qubits,
+        num_ticks,
+        decompose_errors,
+        false,
+        false,
+        approximate_disjoint_errors_threshold,
+        ignore_decomposition_failures,
+        block_decomposition_from_introducing_remnant_edges);
+    auto &tracker = analyzer.tracker;
+    std::vector<double> class_probabilities(error_classes.size(), 0);
+    std::vector<CircuitInstruction> replayed;
+    for (const auto &event : events) {
+        if (!event.replay) {
+            const CircuitInstruction &inst = event_instructions[event.instruction_start];
+            const double *args = params.ptr_start + event_instruction_param_offsets[event.instruction_start];
+            double p = uniform_error_probability(inst.gate_type, {args, args + inst.args.size()});
+            for (size_t k = event.error_start; k < event.error_end; k++) {
+                double &old_p = class_probabilities[event_error_classes[k]];
+                old_p = old_p * (1 - p) + (1 - old_p) * p;
+            }
+            continue;
+        }
+
+        // Put the tracker back into the state the instructions saw during the analysis.
+        tracker.num_measurements_in_past = event.num_measurements_in_past;
+        const SpanRef<const DemTarget> *sensitivity = event_sensitivities.data() + event.sensitivity_start;
+        const SpanRef<const DemTarget> *sensitivity_end = event_sensitivities.data() + event.sensitivity_end;
+        for (size_t k = event.qubit_start; k < event.qubit_end; k++) {
+            uint32_t q = event_qubits[k];
+            tracker.xs[q].sorted_items.assign(sensitivity[0].begin(), sensitivity[0].end());
+            tracker.zs[q].sorted_items.assign(sensitivity[1].begin(), sensitivity[1].end());
+            sensitivity += 2;
+        }
+        uint64_t m = event.num_measurements_in_past - (sensitivity_end - sensitivity);
+        for (; sensitivity != sensitivity_end; sensitivity++, m++) {
+            if (!sensitivity->empty()) {
+                tracker.rec_bits[m].sorted_items.assign(sensitivity->begin(), sensitivity->end());
+            }
+        }
+
+        replayed.clear();
+        for (size_t k = event.instruction_start; k < event.instruction_end; k++) {
+            const CircuitInstruction &inst = event_instructions[k];
+            const double *args = params.ptr_start + event_instruction_param_offsets[k];
+            replayed.push_back(
+                CircuitInstruction(inst.gate_type, {args, args + inst.args.size()}, inst.targets, inst.tag));
+        }
+        GateType first_gate = replayed.front().gate_type;
+        if (first_gate == GateType::E || first_gate == GateType::ELSE_CORRELATED_ERROR) {
+            analyzer.correlated_error_block(replayed);
+        } else {
+            analyzer.undo_gate(replayed.front());
+        }
+
+        for (size_t k = event.qubit_start; k < event.qubit_end; k++) {
+            tracker.xs[event_qubits[k]].clear();
+            tracker.zs[event_qubits[k]].clear();
+        }
+        tracker.rec_bits.clear();
+    }
+
+    // Merge the uniform errors into the replayed errors. The classes are sorted, so when nothing was replayed they
+    // can be appended to the end of the map without searching it.
+    auto &accumulated = analyzer.error_class_probabilities;
+    for (size_t k = 0; k < error_classes.size(); k++) {
+        double p = class_probabilities[k];
+        if (p == 0) {
+            continue;
+        }
+        if (accumulated.empty() || accumulated.crbegin()->first < error_classes[k]) {
+            accumulated.emplace_hint(accumulated.end(), error_classes[k], p);
+        } else {
+            analyzer.add_error(p, error_classes[k].targets, error_classes[k].tag);
+        }
+    }
+
+    analyzer.flushed_reversed_model = reversed_annotations;
+    analyzer.flush();
+    uint64_t t = 0;
+    std::set<DemTarget> seen;
+    return unreversed(analyzer.flushed_reversed_model, t, seen);
+}
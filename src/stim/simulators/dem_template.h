@@ -0,0 +1,172 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_SIMULATORS_DEM_TEMPLATE_H
+#define _STIM_SIMULATORS_DEM_TEMPLATE_H
+
+#include <map>
+#include <vector>
+
+#include "stim/circuit/circuit.h"
+#include "stim/dem/detector_error_model.h"
+#include "stim/mem/monotonic_buffer.h"
+#include "stim/simulators/error_analyzer.h"
+#include "stim/simulators/sparse_rev_frame_tracker.h"
+
+namespace stim {
+
+/// A detector error model whose error probabilities can be cheaply recomputed for new noise strengths.
+///
+/// Creating the template performs the usual reverse sweep over the circuit once, but along the way it records
+/// which error classes (sets of flipped detectors and observables) each noisy instruction contributed to. For
+/// the common noise channels (e.g. X_ERROR, DEPOLARIZE2, or a measurement flip probability) every contribution
+/// of an instruction has the same probability, so instantiating the template only has to compute that
+/// probability and fold it into the recorded classes. The remaining channels (e.g. PAULI_CHANNEL_2) are replayed
+/// through an analyzer loaded with the sensitivities they saw, which skips the frame tracking done for all of
+/// the other instructions in the circuit.
+///
+/// The noise arguments of the circuit are numbered in the order they appear in the circuit's text. For example,
+/// in `X_ERROR(0.1) 0 REPEAT 5 { PAULI_CHANNEL_1(0.1, 0.2, 0.3) 0 } M(0.01) 0` the parameters are
+/// `[0.1, 0.1, 0.2, 0.3, 0.01]`. Instructions inside a loop body share their parameters across iterations.
+///
+/// Noise arguments that are named parameters (e.g. the `p` in `DEPOLARIZE1(p) 0`) appear in the default parameters
+/// as the values returned by `circuit_parameter_arg`, and are given values by instantiating with a binding.
+///
+/// Loops are always flattened, and gauge detectors aren't supported, because both of those features change
+/// the error model in ways that depend on the error probabilities.
+struct DemTemplate {
+    /// A noisy instruction, or a CORRELATED_ERROR block, along with what the analysis saw of it.
+    struct NoiseEvent {
+        /// The range of `event_instructions` covered by the event. Contains several instructions when replaying
+        /// a CORRELATED_ERROR block, stored in reverse order (like the analyzer stacks them).
+        size_t instruction_start;
+        size_t instruction_end;
+        /// When false, the event contributes the same probability to each class in the range of
+        /// `event_error_classes`. When true, the event is replayed using its recorded sensitivities.
+        bool replay;
+        size_t error_start;
+        size_t error_end;
+        /// The range of `event_qubits` touched by a replayed event.
+        size_t qubit_start;
+        size_t qubit_end;
+        /// The range of `event_sensitivities` holding the X and Z sensitivities of each touched qubit
+        /// (interleaved), followed by the sensitivities of each measurement result produced by the instructions.
+        size_t sensitivity_start;
+        size_t sensitivity_end;
+        /// The number of measurements before the instructions.
+        uint64_t num_measurements_in_past;
+    };
+
+    /// A private copy of the circuit, which the recorded instructions point into.
+    Circuit circuit;
+    bool decompose_errors;
+    double approximate_disjoint_errors_threshold;
+    bool ignore_decomposition_failures;
+    bool block_decomposition_from_introducing_remnant_edges;
+
+    /// The noise arguments of the circuit, which instantiate to the circuit's own error model when they don't
+    /// include named parameters.
+    std::vector<double> default_params;
+    /// Maps the argument data of each noisy instruction to where its arguments start in the parameter list.
+    std::map<const double *, size_t> param_offsets;
+
+    /// The recorded noise, in the order it was encountered (from the end of the circuit to the start).
+    std::vector<NoiseEvent> events;
+    std::vector<CircuitInstruction> event_instructions;
+    std::vector<size_t> event_instruction_param_offsets;
+    std::vector<uint32_t> event_error_classes;
+    std::vector<uint32_t> event_qubits;
+    std::vector<SpanRef<const DemTarget>> event_sensitivities;
+    MonotonicBuffer<DemTarget> sensitivity_buf;
+
+    /// The distinct error classes contributed to by events that aren't replayed, in sorted order.
+    std::vector<ErrorEquivalenceClass> error_classes;
+    MonotonicBuffer<DemTarget> error_class_buf;
+
+    /// The non-error instructions (e.g. detector coordinates) of the reversed error model.
+    DetectorErrorModel reversed_annotations;
+    uint64_t num_qubits;
+    uint64_t num_measurements;
+    uint64_t num_detectors;
+    uint64_t num_ticks;
+
+    /// Analyzes a circuit, recording the sensitivities of its noise.
+    ///
+    /// Args:
+    ///     circuit: The circuit to analyze.
+    ///     decompose_errors: When true, complex errors must be split into graphlike components.
+    ///     approximate_disjoint_errors_threshold: When larger than 0, allows disjoint errors like PAULI_CHANNEL_2 to
+    ///         be present in the circuit, as long as their probabilities are not larger than this. The threshold is
+    ///         checked again against the parameters given to each instantiation.
+    ///     ignore_decomposition_failures: Determines whether errors that that fail to decompose are inserted into the
+    ///         output, or cause the conversion to fail and raise an exception.
+    ///     block_decomposition_from_introducing_remnant_edges: When true, it is not permitted to decompose A B C D
+    ///         into A B ^ C D unless both A B and C D appear elsewhere in the error model.
+    DemTemplate(
+        const Circuit &circuit,
+        bool decompose_errors,
+        double approximate_disjoint_errors_threshold,
+        bool ignore_decomposition_failures,
+        bool block_decomposition_from_introducing_remnant_edges);
+
+    /// The recorded instructions point into the template's own circuit, so copying would leave them dangling.
+    DemTemplate(const DemTemplate &other) = delete;
+    DemTemplate(DemTemplate &&other) noexcept = default;
+    DemTemplate &operator=(const DemTemplate &other) = delete;
+    DemTemplate &operator=(DemTemplate &&other) noexcept = default;
+
+    /// Returns the number of noise arguments that can be set when instantiating.
+    size_t num_params() const;
+
+    /// Returns the detector error model for the given noise arguments.
+    ///
+    /// The result is the same as analyzing a copy of the circuit with its noise arguments replaced by the given
+    /// parameters (with loop folding disabled), up to floating point rounding in the probabilities of errors
+    /// that several instructions contribute to.
+    ///
+    /// Args:
+    ///     params: The noise arguments to use, in the order they appear in the circuit. Must have `num_params()`
+    ///         entries, each a probability between 0 and 1.
+    ///
+    /// Returns:
+    ///     The detector error model.
+    DetectorErrorModel instantiate(SpanRef<const double> params) const;
+
+    /// Returns the detector error model for the circuit's noise arguments, with its named parameters taking their
+    /// values from the given binding.
+    DetectorErrorModel instantiate(const CircuitParameterBinding &binding) const;
+
+    /// Called by the analyzer before it undoes noisy instructions, to record the sensitivities they see.
+    ///
+    /// Args:
+    ///     tracker: The analyzer's sensitivity tracker, in the state just after the instructions.
+    ///     instructions: The instruction to record, or the stacked instructions of a CORRELATED_ERROR block.
+    void record_noise(const SparseUnsignedRevFrameTracker &tracker, SpanRef<const CircuitInstruction> instructions);
+
+    /// Called by the analyzer each time the recorded instructions add an error.
+    void record_error(const ErrorEquivalenceClass &error_class);
+
+    /// Determines if the analyzer must report an instruction to `record_noise`.
+    static bool has_noise_params(const CircuitInstruction &inst);
+
+   private:
+    /// Assigns indices to the classes in `error_classes` during recording.
+    std::map<ErrorEquivalenceClass, uint32_t> error_class_indices;
+};
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,54 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/dem_template.h"
+
+#include "stim/gen/gen_surface_code.h"
+#include "stim/perf.perf.h"
+#include "stim/simulators/error_analyzer.h"
+
+using namespace stim;
+
+BENCHMARK(DemTemplate_instantiate_surface_code_rotated_memory_z_d11_r100) {
+    auto params = CircuitGenParameters(100, 11, "rotated_memory_z");
+    params.before_measure_flip_probability = 0.001;
+    params.after_reset_flip_probability = 0.001;
+    params.after_clifford_depolarization = 0.001;
+    auto circuit = generate_surface_code_circuit(params).circuit;
+    DemTemplate dem_template(circuit, false, 0.0, false, false);
+    std::vector<double> noise = dem_template.default_params;
+    for (auto &p : noise) {
+        p *= 2;
+    }
+    benchmark_go([&]() {
+        auto dem = dem_template.instantiate(noise);
+        if (dem.instructions.empty()) {
+            std::cerr << "data dependence";
+        }
+    }).goal_millis(60);
+}
+
+BENCHMARK(DemTemplate_reanalyze_surface_code_rotated_memory_z_d11_r100) {
+    auto params = CircuitGenParameters(100, 11, "rotated_memory_z");
+    params.before_measure_flip_probability = 0.001;
+    params.after_reset_flip_probability = 0.001;
+    params.after_clifford_depolarization = 0.001;
+    auto circuit = generate_surface_code_circuit(params).circuit;
+    benchmark_go([&]() {
+        auto dem = ErrorAnalyzer::circuit_to_detector_error_model(circuit, false, false, false, 0.0, false, false);
+        if (dem.instructions.empty()) {
+            std::cerr << "data dependence";
+        }
+    }).goal_millis(350);
+}
@@ -0,0 +1,238 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/dem_template.pybind.h"
+
+#include "stim/circuit/circuit.pybind.h"
+#include "stim/py/base.pybind.h"
+
+using namespace stim;
+using namespace stim_pybind;
+
+pybind11::class_<DemTemplate> stim_pybind::pybind_dem_template(pybind11::module &m) {
+    return pybind11::class_<DemTemplate>(
+        m,
+        "DemTemplate",
+        clean_doc_string(R"DOC(
+            A circuit's detector error model, ready to be recomputed for new noise strengths.
+
+            Creating a template analyzes the circuit once, recording which detectors and
+            observables each noisy instruction can flip. Instantiating the template with
+            new noise arguments then produces the circuit's detector error model without
+            analyzing the circuit again, which is much faster than calling
+            `stim.Circuit.detector_error_model` on an edited copy of the circuit.
+
+            The noise arguments are numbered in the order they appear in the circuit's
+            text. Instructions inside of a loop body share their arguments across the
+            iterations of the loop. Noise arguments can also be named parameters (e.g.
+            the `p` in `X_ERROR(p) 0`), which are given values by instantiating with a
+            dictionary.
+
+            Examples:
+                >>> import stim
+                >>> circuit = stim.Circuit('''
+                ...     X_ERROR(0.125) 0
+                ...     M(0.25) 0
+                ...     DETECTOR rec[-1]
+                ... ''')
+                >>> template = stim.DemTemplate(circuit)
+                >>> template.default_params
+                [0.125, 0.25]
+                >>> template.instantiate([0.25, 0])
+                stim.DetectorErrorModel('''
+                    error(0.25) D0
+                ''')
+        )DOC")
+            .data());
+}
+
+void stim_pybind::pybind_dem_template_methods(pybind11::module &m, pybind11::class_<DemTemplate> &c) {
+    c.def(
+        pybind11::init([](const Circuit &circuit,
+                          bool decompose_errors,
+                          double approximate_disjoint_errors,
+                          bool ignore_decomposition_failures,
+                          bool block_decomposition_from_introducing_remnant_edges) -> DemTemplate {
+            pybind11::gil_scoped_release release;
+            return DemTemplate(
+                circuit,
+                decompose_errors,
+                approximate_disjoint_errors,
+                ignore_decomposition_failures,
+                block_decomposition_from_introducing_remnant_edges);
+        }),
+        pybind11::arg("circuit"),
+        pybind11::kw_only(),
+        pybind11::arg("decompose_errors") = false,
+        pybind11::arg("approximate_disjoint_errors") = false,
+        pybind11::arg("ignore_decomposition_failures") = false,
+        pybind11::arg("block_decomposition_from_introducing_remnant_edges") = false,
+        clean_doc_string(R"DOC(
+            Analyzes a circuit's noise, so its error model can be recomputed quickly.
+
+            The options have the same meaning as the options of
+            `stim.Circuit.detector_error_model`. Loops are always flattened, and gauge
+            detectors aren't allowed, because both of those features produce error
+            models whose structure depends on the noise strengths.
+
+            Args:
+                circuit: The circuit to analyze.
+                decompose_errors: Defaults to false. When set to true, the error analysis
+                    attempts to decompose the components of composite error mechanisms
+                    into graphlike errors.
+                approximate_disjoint_errors: Defaults to false. When set to true, the
+                    probabilities of disjoint error mechanisms (like PAULI_CHANNEL_1) are
+                    approximated as being independent. Can also be set to a probability
+                    threshold, above which the approximation isn't allowed. The threshold
+                    is checked against the arguments given to each instantiation.
+                ignore_decomposition_failures: Defaults to False. When set to True,
+                    errors that fail to decompose are inserted into the output
+                    undecomposed instead of raising an exception.
+                block_decomposition_from_introducing_remnant_edges: Defaults to False.
+                    Requires that both A B and C D be present elsewhere in the detector
+                    error model in order to decompose A B C D into A B ^ C D.
+
+            Examples:
+                >>> import stim
+                >>> template = stim.DemTemplate(stim.Circuit('''
+                ...     DEPOLARIZE1(0.1) 0
+                ...     M 0
+                ...     DETECTOR rec[-1]
+                ... '''))
+                >>> template.num_params
+                1
+        )DOC")
+            .data());
+
+    c.def_property_readonly(
+        "num_params",
+        &DemTemplate::num_params,
+        clean_doc_string(R"DOC(
+            Returns the number of noise arguments that instantiating the template takes.
+
+            Examples:
+                >>> import stim
+                >>> template = stim.DemTemplate(stim.Circuit('''
+                ...     X_ERROR(0.1) 0
+                ...     PAULI_CHANNEL_1(0.01, 0.02, 0.03) 1
+                ...     M 0 1
+                ... '''), approximate_disjoint_errors=True)
+                >>> template.num_params
+                4
+        )DOC")
+            .data());
+
+    c.def_property_readonly(
+        "default_params",
+        [](const DemTemplate &self) -> pybind11::list {
+            pybind11::list result;
+            for (double p : self.default_params) {
+                if (is_circuit_parameter_arg(p)) {
+                    result.append(pybind11::str(std::string(circuit_parameter_name(p))));
+                } else {
+                    result.append(p);
+                }
+            }
+            return result;
+        },
+        clean_doc_string(R"DOC(
+            @signature def default_params(self) -> List[Union[float, str]]:
+            Returns the noise arguments of the circuit the template was made from.
+
+            Instantiating the template with these parameters reproduces the circuit's
+            own detector error model. Noise arguments that are named parameters are
+            returned as their names.
+
+            Examples:
+                >>> import stim
+                >>> template = stim.DemTemplate(stim.Circuit('''
+                ...     X_ERROR(0.1) 0
+                ...     REPEAT 5 {
+                ...         DEPOLARIZE1(0.2) 0
+                ...     }
+                ...     M(0.3) 0
+                ... '''))
+                >>> template.default_params
+                [0.1, 0.2, 0.3]
+
+                >>> stim.DemTemplate(stim.Circuit('''
+                ...     PAULI_CHANNEL_1(px, 0, pz) 0
+                ...     M 0
+                ... '''), approximate_disjoint_errors=True).default_params
+                ['px', 0.0, 'pz']
+        )DOC")
+            .data());
+
+    c.def(
+        "instantiate",
+        [](const DemTemplate &self, const pybind11::object &params) -> DetectorErrorModel {
+            if (pybind11::isinstance<pybind11::dict>(params)) {
+                auto binding = py_dict_to_circuit_parameter_binding(pybind11::cast<pybind11::dict>(params));
+                pybind11::gil_scoped_release release;
+                return self.instantiate(binding);
+            }
+            auto values = pybind11::cast<std::vector<double>>(params);
+            pybind11::gil_scoped_release release;
+            return self.instantiate(values);
+        },
+        pybind11::arg("params"),
+        clean_doc_string(R"DOC(
+            @signature def instantiate(self, params: Union[Iterable[float], Dict[str, float]]) -> stim.DetectorErrorModel:
+            Returns the detector error model for the given noise arguments.
+
+            The result is the same as the detector error model of a copy of the circuit
+            with its noise arguments replaced by the given parameters (computed with
+            `flatten_loops=True`), up to floating point rounding.
+
+            Args:
+                params: Either the noise arguments to use, in the same order as
+                    `default_params`, or a dictionary giving a value to each named
+                    parameter in the circuit (with the circuit's numeric noise arguments
+                    kept as they are). Each value must be a probability.
+
+            Returns:
+                The detector error model.
+
+            Raises:
+                ValueError:
+                    The wrong number of parameters was given, a named parameter wasn't
+                    given a value, or a value isn't a valid probability for its noise
+                    channel.
+
+            Examples:
+                >>> import stim
+                >>> template = stim.DemTemplate(stim.Circuit('''
+                ...     X_ERROR(0.1) 0
+                ...     CX 0 1
+                ...     M(0.2) 0 1
+                ...     DETECTOR rec[-1]
+                ...     DETECTOR rec[-2]
+                ... '''))
+                >>> template.instantiate([0.125, 0])
+                stim.DetectorErrorModel('''
+                    error(0.125) D0 D1
+                ''')
+
+                >>> template = stim.DemTemplate(stim.Circuit('''
+                ...     X_ERROR(p) 0
+                ...     M(0.25) 0
+                ...     DETECTOR rec[-1]
+                ... '''))
+                >>> template.instantiate({'p': 0.5})
+                stim.DetectorErrorModel('''
+                    error(0.5) D0
+                ''')
+        )DOC")
+            .data());
+}
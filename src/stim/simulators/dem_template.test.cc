@@ -0,0 +1,198 @@
+#include "stim/simulators/dem_template.h"
+
+#include "gtest/gtest.h"
+
+#include "stim/circuit/circuit.test.h"
+#include "stim/gen/gen_surface_code.h"
+#include "stim/simulators/error_analyzer.h"
+
+using namespace stim;
+
+static Circuit with_noise_params(const Circuit &circuit, SpanRef<const double> params, size_t &next_param) {
+    Circuit result;
+    for (const auto &op : circuit.operations) {
+        if (op.gate_type == GateType::REPEAT) {
+            auto body = with_noise_params(op.repeat_block_body(circuit), params, next_param);
+            result.append_repeat_block(op.repeat_block_rep_count(), std::move(body), op.tag);
+        } else if (DemTemplate::has_noise_params(op)) {
+            const double *args = params.ptr_start + next_param;
+            next_param += op.args.size();
+            result.safe_append(
+                CircuitInstruction(op.gate_type, {args, args + op.args.size()}, op.targets, op.tag), true);
+        } else {
+            result.safe_append(op, true);
+        }
+    }
+    return result;
+}
+
+static void expect_instantiates_like_edited_circuit(const DemTemplate &t, const std::vector<double> &params) {
+    size_t next_param = 0;
+    Circuit edited = with_noise_params(t.circuit, params, next_param);
+    auto expected = ErrorAnalyzer::circuit_to_detector_error_model(
+        edited,
+        t.decompose_errors,
+        false,
+        false,
+        t.approximate_disjoint_errors_threshold,
+        t.ignore_decomposition_failures,
+        t.block_decomposition_from_introducing_remnant_edges);
+    auto actual = t.instantiate(params);
+    EXPECT_TRUE(actual.approx_equals(expected, 1e-12)) << actual << "\n---\n" << expected;
+}
+
+TEST(DemTemplate, params_are_in_circuit_order) {
+    DemTemplate t(
+        Circuit(R"CIRCUIT(
+            X_ERROR(0.125) 0
+            REPEAT 5 {
+                PAULI_CHANNEL_1(0.25, 0, 0.5) 0
+                DETECTOR(1, 2)
+            }
+            M(0.0625) 0
+            MPAD 0
+            E(0.375) X0
+            DETECTOR rec[-2]
+        )CIRCUIT"),
+        false,
+        1,
+        false,
+        false);
+    ASSERT_EQ(t.num_params(), 6);
+    ASSERT_EQ(t.default_params, (std::vector<double>{0.125, 0.25, 0, 0.5, 0.0625, 0.375}));
+}
+
+TEST(DemTemplate, instantiate_matches_analysis) {
+    CircuitGenParameters params(5, 3, "rotated_memory_x");
+    params.after_clifford_depolarization = 0.001;
+    params.before_measure_flip_probability = 0.002;
+    params.after_reset_flip_probability = 0.003;
+    params.before_round_data_depolarization = 0.004;
+    auto circuit = generate_surface_code_circuit(params).circuit;
+
+    for (bool decompose_errors : {false, true}) {
+        DemTemplate t(circuit, decompose_errors, 0, false, false);
+        expect_instantiates_like_edited_circuit(t, t.default_params);
+        std::vector<double> noise = t.default_params;
+        for (size_t k = 0; k < noise.size(); k++) {
+            noise[k] = 0.001 * (k % 7);
+        }
+        expect_instantiates_like_edited_circuit(t, noise);
+    }
+
+    DemTemplate t(generate_test_circuit_with_all_operations(), false, 1, false, false);
+    expect_instantiates_like_edited_circuit(t, t.default_params);
+}
+
+TEST(DemTemplate, instantiate_new_params_matches_edited_circuit) {
+    Circuit circuit(R"CIRCUIT(
+        QUBIT_COORDS(1, 2) 0
+        R 0 1 2
+        RX 3
+        X_ERROR(0.01) 0
+        DEPOLARIZE2(0.02) 0 1
+        REPEAT 3 {
+            CX 0 1 2 1
+            HERALDED_ERASE(0.03) 0
+            PAULI_CHANNEL_2(0.001, 0.002, 0.003, 0.004, 0.005, 0.006, 0.007, 0.008, 0.009, 0.01, 0.011, 0.012, 0.013, 0.014, 0.015) 0 1
+            E(0.04) X0 Z2
+            ELSE_CORRELATED_ERROR(0.05) Y1
+            MR(0.06) 1
+            MPP(0.07) Z2*Z0
+            MX(0.075) 3
+            DETECTOR(3, 4) rec[-4]
+            DETECTOR rec[-3]
+            DETECTOR rec[-2]
+            DETECTOR rec[-1]
+            SHIFT_COORDS(0, 1)
+        }
+        MZZ(0.08) 0 2
+        M(0.09) 0
+        MPAD(0.1) 1
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+        DETECTOR rec[-3]
+        OBSERVABLE_INCLUDE(0) rec[-2]
+    )CIRCUIT");
+    DemTemplate t(circuit, false, 0.5, false, false);
+    expect_instantiates_like_edited_circuit(t, t.default_params);
+
+    std::vector<double> scaled = t.default_params;
+    for (auto &p : scaled) {
+        p *= 2;
+    }
+    expect_instantiates_like_edited_circuit(t, scaled);
+
+    std::vector<double> zeros(t.num_params(), 0);
+    expect_instantiates_like_edited_circuit(t, zeros);
+
+    std::vector<double> varied = t.default_params;
+    varied[0] = 0.25;
+    varied[3] = 0;
+    varied.back() = 0.125;
+    expect_instantiates_like_edited_circuit(t, varied);
+}
+
+TEST(DemTemplate, zero_probabilities_still_record_sensitivities) {
+    DemTemplate t(
+        Circuit(R"CIRCUIT(
+            X_ERROR(0) 0
+            M(0) 0
+            DETECTOR rec[-1]
+        )CIRCUIT"),
+        false,
+        0,
+        false,
+        false);
+    ASSERT_EQ(t.instantiate(t.default_params), DetectorErrorModel("detector D0"));
+    std::vector<double> params{0.25, 0.125};
+    ASSERT_EQ(t.instantiate(params), DetectorErrorModel("error(0.3125) D0"));
+}
+
+TEST(DemTemplate, instantiate_checks_params) {
+    DemTemplate t(Circuit("PAULI_CHANNEL_1(0.01, 0.02, 0.03) 0\nM 0\nDETECTOR rec[-1]"), false, 0.1, false, false);
+    ASSERT_THROW({ t.instantiate(std::vector<double>{0.1, 0.2}); }, std::invalid_argument);
+    ASSERT_THROW({ t.instantiate(std::vector<double>{0.1, 0.2, 0.3}); }, std::invalid_argument);
+    ASSERT_THROW({ t.instantiate(std::vector<double>{0.01, 0.02, -0.5}); }, std::invalid_argument);
+    auto dem = t.instantiate(std::vector<double>{0.1, 0, 0});
+    ASSERT_TRUE(dem.approx_equals(DetectorErrorModel("error(0.1) D0"), 1e-9));
+}
+
+TEST(DemTemplate, rejects_gauge_detectors) {
+    ASSERT_THROW(
+        { DemTemplate(Circuit("X_ERROR(0.1) 0\nMX 0\nDETECTOR rec[-1]"), false, 0, false, false); },
+        std::invalid_argument);
+}
+
+TEST(DemTemplate, instantiate_parameter_binding) {
+    DemTemplate t(
+        Circuit(R"CIRCUIT(
+            R 0 1
+            X_ERROR(p) 0
+            DEPOLARIZE2(p2) 0 1
+            PAULI_CHANNEL_1(p, 0, 0.125) 1
+            E(p2) X0
+            ELSE_CORRELATED_ERROR(p) X1
+            M(m) 0 1
+            DETECTOR rec[-1]
+            DETECTOR rec[-2]
+        )CIRCUIT"),
+        false,
+        1,
+        false,
+        false);
+    ASSERT_EQ(t.num_params(), 8);
+    ASSERT_TRUE(is_circuit_parameter_arg(t.default_params[0]));
+
+    CircuitParameterBinding binding;
+    binding.set("p", 0.125);
+    binding.set("p2", 0.25);
+    binding.set("m", 0.0625);
+    std::vector<double> params{0.125, 0.25, 0.125, 0, 0.125, 0.25, 0.125, 0.0625};
+    ASSERT_TRUE(t.instantiate(binding).approx_equals(t.instantiate(params), 1e-12));
+    expect_instantiates_like_edited_circuit(t, params);
+
+    CircuitParameterBinding partial;
+    partial.set("p", 0.125);
+    ASSERT_THROW({ t.instantiate(partial); }, std::invalid_argument);
+}
@@ -0,0 +1,91 @@
+import numpy as np
+import pytest
+import stim
+
+
+def test_dem_template_default_params_reproduce_circuit_model():
+    circuit = stim.Circuit.generated(
+        "surface_code:rotated_memory_x",
+        distance=3,
+        rounds=4,
+        after_clifford_depolarization=0.001,
+        before_measure_flip_probability=0.002,
+        after_reset_flip_probability=0.003,
+    )
+    template = stim.DemTemplate(circuit, decompose_errors=True)
+    assert template.num_params == len(template.default_params)
+    expected = circuit.detector_error_model(decompose_errors=True, flatten_loops=True)
+    assert template.instantiate(template.default_params).approx_equals(expected, atol=1e-12)
+
+
+def test_dem_template_instantiate_matches_edited_circuit():
+    template = stim.DemTemplate(stim.Circuit("""
+        R 0 1
+        X_ERROR(0.125) 0
+        DEPOLARIZE2(0.01) 0 1
+        CX 0 1
+        M(0.25) 0 1
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+    """))
+    assert template.default_params == [0.125, 0.01, 0.25]
+
+    expected = stim.Circuit("""
+        R 0 1
+        X_ERROR(0.0625) 0
+        DEPOLARIZE2(0.02) 0 1
+        CX 0 1
+        M(0) 0 1
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+    """).detector_error_model(flatten_loops=True)
+    assert template.instantiate([0.0625, 0.02, 0]).approx_equals(expected, atol=1e-12)
+    assert template.instantiate(np.array([0.0625, 0.02, 0])).approx_equals(expected, atol=1e-12)
+
+
+def test_dem_template_bad_params():
+    template = stim.DemTemplate(stim.Circuit("""
+        DEPOLARIZE1(0.1) 0
+        M 0
+        DETECTOR rec[-1]
+    """))
+    with pytest.raises(ValueError, match="Expected 1 parameters"):
+        template.instantiate([0.1, 0.2])
+    with pytest.raises(ValueError, match="over-mixing"):
+        template.instantiate([0.9])
+    with pytest.raises(ValueError, match="probability"):
+        template.instantiate([-0.5])
+
+
+def test_dem_template_rejects_gauge_detectors():
+    with pytest.raises(ValueError, match="non-deterministic"):
+        stim.DemTemplate(stim.Circuit("""
+            MX 0
+            DETECTOR rec[-1]
+        """))
+
+
+def test_dem_template_named_parameters():
+    template = stim.DemTemplate(stim.Circuit("""
+        R 0 1
+        X_ERROR(p) 0
+        DEPOLARIZE2(p2) 0 1
+        CX 0 1
+        M(0.25) 0 1
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+    """))
+    assert template.default_params == ['p', 'p2', 0.25]
+
+    expected = stim.Circuit("""
+        R 0 1
+        X_ERROR(0.0625) 0
+        DEPOLARIZE2(0.02) 0 1
+        CX 0 1
+        M(0.25) 0 1
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+    """).detector_error_model(flatten_loops=True)
+    assert template.instantiate({'p': 0.0625, 'p2': 0.02}).approx_equals(expected, atol=1e-12)
+    with pytest.raises(ValueError, match="'p2'"):
+        template.instantiate({'p': 0.0625})
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_SIMULATORS_DETECTION_EVENT_BATCH_STREAM_H
+#define _STIM_SIMULATORS_DETECTION_EVENT_BATCH_STREAM_H
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "stim/circuit/circuit.h"
+#include "stim/mem/simd_bit_table.h"
+
+namespace stim {
+
+/// Samples detection events one batch at a time, simulating ahead on a background thread.
+///
+/// While the consumer is working on the batch returned by `next`, a background thread is
+/// already simulating the following batch. At most one finished batch waits on the consumer,
+/// so the memory used stays fixed no matter how many shots are requested.
+///
+/// The methods of this class must not be called concurrently with each other.
+template <size_t W>
+struct DetectionEventBatchStream {
+    /// The detection event data of the current batch.
+    /// Major axis is the detector index, minor axis is the shot index.
+    simd_bit_table<W> det_data;
+    /// The observable flip data of the current batch.
+    /// Major axis is the observable index, minor axis is the shot index.
+    simd_bit_table<W> obs_data;
+    /// The number of shots in the current batch.
+    size_t num_batch_shots;
+
+    /// Starts simulating the first batch in the background.
+    ///
+    /// Args:
+    ///     circuit: The circuit to sample.
+    ///     num_shots: The total number of shots to sample.
+    ///     batch_size: The number of shots per batch. The last batch may be smaller.
+    ///     rng: The random number generator to simulate with.
+    DetectionEventBatchStream(const Circuit &circuit, size_t num_shots, size_t batch_size, std::mt19937_64 &&rng);
+    /// Stops the background thread, after it finishes the batch it is working on.
+    ~DetectionEventBatchStream();
+    DetectionEventBatchStream(const DetectionEventBatchStream &) = delete;
+    DetectionEventBatchStream &operator=(const DetectionEventBatchStream &) = delete;
+
+    /// Waits for the next batch and moves it into `det_data`, `obs_data` and `num_batch_shots`.
+    ///
+    /// Returns:
+    ///     True if a batch was produced. False if all shots have already been produced.
+    ///
+    /// Throws:
+    ///     Rethrows anything that the background thread threw while simulating.
+    bool next();
+
+   private:
+    void run(Circuit circuit, size_t num_shots, size_t batch_size, std::mt19937_64 rng);
+
+    std::mutex mut;
+    std::condition_variable changed;
+    simd_bit_table<W> ready_det_data;
+    simd_bit_table<W> ready_obs_data;
+    size_t ready_batch_shots;
+    bool has_ready_batch;
+    bool finished;
+    bool stopping;
+    std::exception_ptr failure;
+    std::thread worker;
+};
+
+}  // namespace stim
+
+#include "stim/simulators/detection_event_batch_stream.inl"
+
+#endif
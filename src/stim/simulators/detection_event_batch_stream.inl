@@ -0,0 +1,119 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/detection_event_batch_stream.h"
+#include "stim/simulators/frame_simulator.h"
+#include "stim/simulators/frame_simulator_program.h"
+
+namespace stim {
+
+template <size_t W>
+DetectionEventBatchStream<W>::DetectionEventBatchStream(
+    const Circuit &circuit, size_t num_shots, size_t batch_size, std::mt19937_64 &&rng)
+    : det_data(0, 0),
+      obs_data(0, 0),
+      num_batch_shots(0),
+      ready_det_data(0, 0),
+      ready_obs_data(0, 0),
+      ready_batch_shots(0),
+      has_ready_batch(false),
+      finished(false),
+      stopping(false),
+      failure(nullptr) {
+    if (batch_size == 0 && num_shots > 0) {
+        throw std::invalid_argument("batch_size must be positive.");
+    }
+    worker = std::thread(
+        &DetectionEventBatchStream<W>::run, this, frame_simulator_program(circuit), num_shots, batch_size, std::move(rng));
+}
+
+template <size_t W>
+DetectionEventBatchStream<W>::~DetectionEventBatchStream() {
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+}
+
+template <size_t W>
+void DetectionEventBatchStream<W>::run(Circuit circuit, size_t num_shots, size_t batch_size, std::mt19937_64 rng) {
+    try {
+        CircuitStats stats = circuit.compute_stats();
+        FrameSimulator<W> sim(
+            stats, FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY, std::min(num_shots, batch_size), std::move(rng));
+        size_t shots_left = num_shots;
+        while (shots_left > 0) {
+            size_t n = std::min(shots_left, batch_size);
+            sim.configure_for(stats, FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY, n);
+            sim.reset_all();
+            sim.do_circuit(circuit);
+            shots_left -= n;
+
+            std::unique_lock<std::mutex> lock(mut);
+            changed.wait(lock, [&]() {
+                return !has_ready_batch || stopping;
+            });
+            if (stopping) {
+                return;
+            }
+            // Hand over the results by swapping buffers, so that nothing is copied.
+            std::swap(ready_det_data, sim.det_record.storage);
+            std::swap(ready_obs_data, sim.obs_record);
+            // The detection record only resizes its storage when the shot count changes, so the
+            // buffer it got back has to already have the right shape.
+            sim.det_record.storage.destructive_resize(
+                ready_det_data.num_major_bits_padded(), ready_det_data.num_minor_bits_padded());
+            ready_batch_shots = n;
+            has_ready_batch = true;
+            lock.unlock();
+            changed.notify_all();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mut);
+        failure = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        finished = true;
+    }
+    changed.notify_all();
+}
+
+template <size_t W>
+bool DetectionEventBatchStream<W>::next() {
+    std::unique_lock<std::mutex> lock(mut);
+    changed.wait(lock, [&]() {
+        return has_ready_batch || finished;
+    });
+    if (!has_ready_batch) {
+        if (failure != nullptr) {
+            std::exception_ptr f = failure;
+            failure = nullptr;
+            std::rethrow_exception(f);
+        }
+        num_batch_shots = 0;
+        return false;
+    }
+    std::swap(det_data, ready_det_data);
+    std::swap(obs_data, ready_obs_data);
+    num_batch_shots = ready_batch_shots;
+    has_ready_batch = false;
+    lock.unlock();
+    changed.notify_all();
+    return true;
+}
+
+}  // namespace stim
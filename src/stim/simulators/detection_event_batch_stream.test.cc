@@ -0,0 +1,90 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/detection_event_batch_stream.h"
+
+#include "gtest/gtest.h"
+
+#include "stim/mem/simd_word.test.h"
+#include "stim/util_bot/test_util.test.h"
+
+using namespace stim;
+
+TEST_EACH_WORD_SIZE_W(DetectionEventBatchStream, batch_sizes_and_contents, {
+    Circuit circuit(R"CIRCUIT(
+        X_ERROR(1) 0
+        M 0 1
+        DETECTOR rec[-2]
+        DETECTOR rec[-1]
+        OBSERVABLE_INCLUDE(0) rec[-2]
+    )CIRCUIT");
+    DetectionEventBatchStream<W> stream(circuit, 1000, 256, INDEPENDENT_TEST_RNG());
+    std::vector<size_t> sizes;
+    while (stream.next()) {
+        sizes.push_back(stream.num_batch_shots);
+        ASSERT_EQ(stream.det_data[0].popcnt(), stream.num_batch_shots);
+        ASSERT_EQ(stream.det_data[1].popcnt(), 0);
+        ASSERT_EQ(stream.obs_data[0].popcnt(), stream.num_batch_shots);
+    }
+    ASSERT_EQ(sizes, (std::vector<size_t>{256, 256, 256, 232}));
+    ASSERT_EQ(stream.num_batch_shots, 0);
+    ASSERT_FALSE(stream.next());
+})
+
+TEST_EACH_WORD_SIZE_W(DetectionEventBatchStream, deterministic_given_rng, {
+    Circuit circuit(R"CIRCUIT(
+        X_ERROR(0.5) 0 1 2
+        CX 0 1 1 2
+        M 0 1 2
+        DETECTOR rec[-1]
+        DETECTOR rec[-2] rec[-3]
+        OBSERVABLE_INCLUDE(0) rec[-1]
+    )CIRCUIT");
+    DetectionEventBatchStream<W> stream1(circuit, 700, 300, std::mt19937_64(5));
+    DetectionEventBatchStream<W> stream2(circuit, 700, 300, std::mt19937_64(5));
+    size_t total_hits = 0;
+    while (stream1.next()) {
+        ASSERT_TRUE(stream2.next());
+        ASSERT_EQ(stream1.num_batch_shots, stream2.num_batch_shots);
+        ASSERT_EQ(stream1.det_data, stream2.det_data);
+        ASSERT_EQ(stream1.obs_data, stream2.obs_data);
+        total_hits += stream1.det_data[0].popcnt();
+    }
+    ASSERT_FALSE(stream2.next());
+    ASSERT_GT(total_hits, 250);
+    ASSERT_LT(total_hits, 450);
+})
+
+TEST_EACH_WORD_SIZE_W(DetectionEventBatchStream, stop_early_and_empty, {
+    Circuit circuit(R"CIRCUIT(
+        X_ERROR(0.5) 0
+        M 0
+        DETECTOR rec[-1]
+    )CIRCUIT");
+    {
+        DetectionEventBatchStream<W> stream(circuit, 100000, 100, INDEPENDENT_TEST_RNG());
+        ASSERT_TRUE(stream.next());
+        ASSERT_EQ(stream.num_batch_shots, 100);
+    }
+
+    DetectionEventBatchStream<W> empty(circuit, 0, 100, INDEPENDENT_TEST_RNG());
+    ASSERT_FALSE(empty.next());
+})
+
+TEST_EACH_WORD_SIZE_W(DetectionEventBatchStream, failures_are_rethrown, {
+    DetectionEventBatchStream<W> stream(Circuit("DETECTOR rec[-1]"), 10, 5, INDEPENDENT_TEST_RNG());
+    ASSERT_THROW({ stream.next(); }, std::out_of_range);
+    ASSERT_FALSE(stream.next());
+    ASSERT_THROW({ DetectionEventBatchStream<W>(Circuit(), 10, 0, INDEPENDENT_TEST_RNG()); }, std::invalid_argument);
+})
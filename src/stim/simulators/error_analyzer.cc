@@ -19,8 +19,10 @@
 #include <sstream>
 
 #include "stim/circuit/gate_decomposition.h"
+#include "stim/simulators/dem_template.h"
 #include "stim/stabilizers/pauli_string.h"
 #include "stim/util_bot/error_decomp.h"
+#include "stim/util_bot/parallel_batches.h"
 
 using namespace stim;
 
@@ -524,8 +526,8 @@ PauliString<MAX_BITWORD_WIDTH> ErrorAnalyzer::current_error_sensitivity_for(DemT
 }
 
 void ErrorAnalyzer::xor_sorted_measurement_error(SpanRef<const DemTarget> targets, const CircuitInstruction &inst) {
-    // Measurement error.
-    if (!inst.args.empty() && inst.args[0] > 0) {
+    // Measurement error. A recorded template needs to know where the error goes even when it currently can't happen.
+    if (accumulate_errors && !inst.args.empty() && (inst.args[0] > 0 || noise_recorder != nullptr)) {
         add_error(inst.args[0], targets, inst.tag);
     }
 }
@@ -669,15 +671,184 @@ ErrorAnalyzer::ErrorAnalyzer(
       num_ticks_in_past(num_ticks) {
 }
 
+static const CircuitParameterBinding NO_PARAMETERS;
+
+/// Binds the named parameters of a CORRELATED_ERROR block in place, storing all of their arguments in one buffer.
+static void bind_block(
+    const CircuitParameterBinding &binding, std::vector<CircuitInstruction> &block, std::vector<double> &arg_buf) {
+    arg_buf.clear();
+    for (const auto &inst : block) {
+        if (has_circuit_parameter_args(inst.args)) {
+            for (double arg : inst.args) {
+                arg_buf.push_back(binding.resolve(arg));
+            }
+        }
+    }
+    // The buffer is done growing, so the arguments can now point into it.
+    const double *next = arg_buf.data();
+    for (auto &inst : block) {
+        if (has_circuit_parameter_args(inst.args)) {
+            inst.args = {next, next + inst.args.size()};
+            next += inst.args.size();
+            inst.validate();
+        }
+    }
+}
+
 void ErrorAnalyzer::undo_circuit(const Circuit &circuit) {
+    size_t end = circuit.operations.size();
+    if (num_threads <= 1) {
+        undo_operations(circuit, 0, end);
+        return;
+    }
+
+    // An ELSE_CORRELATED_ERROR right after a loop is an error that's reported at the loop, which
+    // requires walking over the loop boundary sequentially.
+    for (size_t k = 1; k < end; k++) {
+        if (circuit.operations[k].gate_type == GateType::ELSE_CORRELATED_ERROR &&
+            circuit.operations[k - 1].gate_type == GateType::REPEAT) {
+            undo_operations(circuit, 0, end);
+            return;
+        }
+    }
+
+    while (end > 0) {
+        size_t start = end;
+        while (start > 0 && circuit.operations[start - 1].gate_type != GateType::REPEAT) {
+            start--;
+        }
+        undo_operations_in_time_slices(circuit, start, end);
+        if (start > 0) {
+            start--;
+            undo_operations(circuit, start, start + 1);
+        }
+        end = start;
+    }
+}
+
+void ErrorAnalyzer::undo_operations_in_time_slices(const Circuit &circuit, size_t start, size_t end) {
+    std::vector<size_t> slice_starts{start};
+    for (size_t k = start + 1; k < end; k++) {
+        if (circuit.operations[k].gate_type == GateType::TICK) {
+            slice_starts.push_back(k);
+        }
+    }
+    size_t num_slices = slice_starts.size();
+    if (num_slices < 2) {
+        undo_operations(circuit, start, end);
+        return;
+    }
+    // Slices are numbered in the order they are analyzed, which is from the end of the circuit to the start.
+    auto slice_start = [&](size_t slice_index) {
+        return slice_starts[num_slices - 1 - slice_index];
+    };
+    auto slice_end = [&](size_t slice_index) {
+        return slice_index == 0 ? end : slice_starts[num_slices - slice_index];
+    };
+
+    ErrorAnalyzer frames(
+        tracker.num_measurements_in_past,
+        tracker.num_detectors_in_past,
+        tracker.xs.size(),
+        num_ticks_in_past,
+        false,
+        false,
+        allow_gauge_detectors,
+        approximate_disjoint_errors_threshold,
+        false,
+        false);
+    frames.tracker = tracker;
+    frames.accumulate_errors = false;
+    frames.current_circuit_being_analyzed = current_circuit_being_analyzed;
+    frames.parameter_binding = parameter_binding;
+    std::exception_ptr frames_failure = nullptr;
+
+    struct Slice {
+        std::unique_ptr<ErrorAnalyzer> analyzer;
+        std::exception_ptr failure;
+    };
+    std::vector<Slice> slices(num_slices);
+
+    process_batches_in_parallel_in_order(
+        num_slices,
+        num_threads,
+        []() {
+            return nullptr;
+        },
+        [&](std::nullptr_t, size_t slice_index) {
+            // Slices after a failed one are never written, because the failed slice's own analysis fails first.
+            if (frames_failure != nullptr) {
+                return;
+            }
+            auto analyzer = std::make_unique<ErrorAnalyzer>(
+                frames.tracker.num_measurements_in_past,
+                frames.tracker.num_detectors_in_past,
+                frames.tracker.xs.size(),
+                frames.num_ticks_in_past,
+                decompose_errors,
+                fold_loops,
+                allow_gauge_detectors,
+                approximate_disjoint_errors_threshold,
+                ignore_decomposition_failures,
+                block_decomposition_from_introducing_remnant_edges);
+            analyzer->tracker = frames.tracker;
+            analyzer->current_circuit_being_analyzed = current_circuit_being_analyzed;
+            analyzer->parameter_binding = parameter_binding;
+            slices[slice_index].analyzer = std::move(analyzer);
+            try {
+                frames.undo_operations(circuit, slice_start(slice_index), slice_end(slice_index));
+            } catch (const std::invalid_argument &) {
+                frames_failure = std::current_exception();
+            }
+        },
+        [&](std::nullptr_t, size_t slice_index) {
+            auto &slice = slices[slice_index];
+            if (slice.analyzer == nullptr) {
+                return;
+            }
+            try {
+                slice.analyzer->undo_operations(circuit, slice_start(slice_index), slice_end(slice_index));
+            } catch (const std::invalid_argument &) {
+                slice.failure = std::current_exception();
+            }
+        },
+        [&](std::nullptr_t, size_t slice_index) {
+            auto &slice = slices[slice_index];
+            if (slice.failure != nullptr) {
+                std::rethrow_exception(slice.failure);
+            }
+            if (slice.analyzer == nullptr) {
+                std::rethrow_exception(frames_failure);
+            }
+            for (const auto &instruction : slice.analyzer->flushed_reversed_model.instructions) {
+                flushed_reversed_model.append_dem_instruction(instruction);
+            }
+            for (const auto &[error_class, probability] : slice.analyzer->error_class_probabilities) {
+                add_error(probability, error_class.targets, error_class.tag);
+            }
+            slice.analyzer.reset();
+        });
+
+    tracker = std::move(frames.tracker);
+    num_ticks_in_past = frames.num_ticks_in_past;
+}
+
+void ErrorAnalyzer::undo_operations(const Circuit &circuit, size_t start, size_t end) {
+    const CircuitParameterBinding &binding = parameter_binding == nullptr ? NO_PARAMETERS : *parameter_binding;
+    std::vector<double> arg_buf;
     std::vector<CircuitInstruction> stacked_else_correlated_errors;
-    for (size_t k = circuit.operations.size(); k--;) {
+    for (size_t k = end; k-- > start;) {
         const auto &op = circuit.operations[k];
         try {
             if (op.gate_type == GateType::ELSE_CORRELATED_ERROR) {
                 stacked_else_correlated_errors.push_back(op);
             } else if (op.gate_type == GateType::E) {
                 stacked_else_correlated_errors.push_back(op);
+                if (noise_recorder != nullptr) {
+                    const CircuitInstruction *block = stacked_else_correlated_errors.data();
+                    noise_recorder->record_noise(tracker, {block, block + stacked_else_correlated_errors.size()});
+                }
+                bind_block(binding, stacked_else_correlated_errors, arg_buf);
                 correlated_error_block(stacked_else_correlated_errors);
                 stacked_else_correlated_errors.clear();
             } else if (!stacked_else_correlated_errors.empty()) {
@@ -688,7 +859,10 @@ void ErrorAnalyzer::undo_circuit(const Circuit &circuit) {
                 uint64_t repeats = op.repeat_block_rep_count();
                 run_loop(loop_body, repeats, op.tag);
             } else {
-                undo_gate(op);
+                if (noise_recorder != nullptr && DemTemplate::has_noise_params(op)) {
+                    noise_recorder->record_noise(tracker, {&op, &op + 1});
+                }
+                undo_gate(binding.bind(op, arg_buf));
             }
         } catch (std::invalid_argument &ex) {
             std::stringstream error_msg;
@@ -955,7 +1129,8 @@ void ErrorAnalyzer::undo_PAULI_CHANNEL_2(const CircuitInstruction &inst) {
     }
 }
 
-DetectorErrorModel unreversed(const DetectorErrorModel &rev, uint64_t &base_detector_id, std::set<DemTarget> &seen) {
+DetectorErrorModel stim::unreversed(
+    const DetectorErrorModel &rev, uint64_t &base_detector_id, std::set<DemTarget> &seen) {
     DetectorErrorModel out;
     auto conv_append = [&](const DemInstruction &e) {
         auto stored_targets = out.target_buf.take_copy(e.target_data);
@@ -1018,7 +1193,9 @@ DetectorErrorModel ErrorAnalyzer::circuit_to_detector_error_model(
     bool allow_gauge_detectors,
     double approximate_disjoint_errors_threshold,
     bool ignore_decomposition_failures,
-    bool block_decomposition_from_introducing_remnant_edges) {
+    bool block_decomposition_from_introducing_remnant_edges,
+    size_t num_threads,
+    const CircuitParameterBinding *parameter_binding) {
     ErrorAnalyzer analyzer(
         circuit.count_measurements(),
         circuit.count_detectors(),
@@ -1031,6 +1208,8 @@ DetectorErrorModel ErrorAnalyzer::circuit_to_detector_error_model(
         ignore_decomposition_failures,
         block_decomposition_from_introducing_remnant_edges);
     analyzer.current_circuit_being_analyzed = &circuit;
+    analyzer.num_threads = num_threads;
+    analyzer.parameter_binding = parameter_binding;
     analyzer.undo_circuit(circuit);
     analyzer.post_check_initialization();
     analyzer.flush();
@@ -1086,6 +1265,9 @@ ErrorEquivalenceClass ErrorAnalyzer::add_error(
     auto key = mono_dedupe_store(ErrorEquivalenceClass{flipped_sorted, tag});
     auto &old_p = error_class_probabilities[key];
     old_p = old_p * (1 - probability) + (1 - old_p) * probability;
+    if (noise_recorder != nullptr) {
+        noise_recorder->record_error(key);
+    }
     return key;
 }
 
@@ -1093,6 +1275,9 @@ ErrorEquivalenceClass ErrorAnalyzer::add_error_in_sorted_jagged_tail(double prob
     auto key = mono_dedupe_store_tail(tag);
     auto &old_p = error_class_probabilities[key];
     old_p = old_p * (1 - probability) + (1 - old_p) * probability;
+    if (noise_recorder != nullptr) {
+        noise_recorder->record_error(key);
+    }
     return key;
 }
 
@@ -1120,6 +1305,7 @@ void ErrorAnalyzer::run_loop(const Circuit &loop, uint64_t iterations, std::stri
         false);
     hare.tracker = tracker;
     hare.accumulate_errors = false;
+    hare.parameter_binding = parameter_binding;
 
     // Perform tortoise-and-hare cycle finding.
     while (hare_iter < iterations) {
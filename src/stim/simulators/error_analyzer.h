@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "sparse_rev_frame_tracker.h"
@@ -32,6 +33,8 @@
 
 namespace stim {
 
+struct DemTemplate;
+
 struct ErrorEquivalenceClass {
     SpanRef<const DemTarget> targets;
     std::string_view tag;
@@ -136,6 +139,21 @@ struct ErrorAnalyzer {
     /// Used for producing debug information when errors occur.
     const Circuit *current_circuit_being_analyzed = nullptr;
 
+    /// The number of threads used to collect errors. When larger than 1, the runs of instructions
+    /// between loops are cut at TICKs into time slices, and the errors in each slice are collected
+    /// concurrently (see `undo_operations_in_time_slices`). A serial pass over the slices still has
+    /// to propagate the tracker, so the speedup is at most (propagation + collection) / propagation,
+    /// which is about 2x unless collecting the errors (e.g. decomposing them) dominates.
+    size_t num_threads = 1;
+
+    /// When not null, each noisy instruction (and each CORRELATED_ERROR block) is reported to this template just
+    /// before it is undone, so that it can later be replayed with different arguments. Requires unfolded loops and
+    /// a single thread.
+    DemTemplate *noise_recorder = nullptr;
+
+    /// The values of named parameters in the circuit's arguments. When null, named parameters are an error.
+    const CircuitParameterBinding *parameter_binding = nullptr;
+
     /// Creates an instance ready to start processing instructions from a circuit of known size.
     ErrorAnalyzer(
         uint64_t num_measurements,
@@ -164,6 +182,12 @@ struct ErrorAnalyzer {
     ///     block_decomposition_from_introducing_remnant_edges: When true, it is not permitted to decompose A B C D
     ///         into A B ^ C D unless both A B and C D appear elsewhere in the error model. When false, only one has
     ///         to appear elsewhere.
+    ///     num_threads: The number of threads to use when collecting errors. The result is the same for any
+    ///         number of threads, except for floating point rounding in the probabilities of errors that occur
+    ///         in several time slices. The sensitivities are still propagated serially, which limits the
+    ///         speedup to about 2x.
+    ///     parameter_binding: The values of named parameters in the circuit's arguments. The values are substituted
+    ///         as instructions are analyzed, so the circuit isn't copied.
     ///
     /// Returns:
     ///     The detector error model.
@@ -174,7 +198,9 @@ struct ErrorAnalyzer {
         bool allow_gauge_detectors,
         double approximate_disjoint_errors_threshold,
         bool ignore_decomposition_failures,
-        bool block_decomposition_from_introducing_remnant_edges);
+        bool block_decomposition_from_introducing_remnant_edges,
+        size_t num_threads = 1,
+        const CircuitParameterBinding *parameter_binding = nullptr);
 
     /// Copying is unsafe because `error_class_probabilities` has overlapping pointers to `monobuf`'s internals.
     ErrorAnalyzer(const ErrorAnalyzer &analyzer) = delete;
@@ -245,6 +271,8 @@ struct ErrorAnalyzer {
 
     /// Processes each of the instructions in the circuit, in reverse order.
     void undo_circuit(const Circuit &circuit);
+    /// Processes the instructions at indices [start, end) of the circuit, in reverse order.
+    void undo_operations(const Circuit &circuit, size_t start, size_t end);
     /// This is used at the end of the analysis to check that any remaining sensitivities commute
     /// with the implicit Z basis initialization at the start of a circuit.
     void post_check_initialization();
@@ -261,7 +289,28 @@ struct ErrorAnalyzer {
     /// If loop folding is enabled, also uses a tortoise-and-hare algorithm to attempt to solve the loop's period.
     void run_loop(const Circuit &loop, uint64_t iterations, std::string_view tag);
 
+    /// Empties error_class_probabilities into flushed_reversed_model.
+    void flush();
+    /// Adds (or folds) an error mechanism into error_class_probabilities.
+    ErrorEquivalenceClass add_error(double probability, SpanRef<const DemTarget> flipped_sorted, std::string_view tag);
+    /// Adds the errors of a CORRELATED_ERROR block, given its E and ELSE_CORRELATED_ERROR instructions in reverse
+    /// order (the order they are stacked in while iterating backwards).
+    void correlated_error_block(const std::vector<CircuitInstruction> &dats);
+
    private:
+    /// Processes the instructions at indices [start, end) of the circuit, which must not contain loops,
+    /// using `num_threads` threads.
+    ///
+    /// The instructions are cut at TICKs into time slices. A sensitivity-only pass (no errors recorded)
+    /// walks backwards over the slices, snapshotting the tracker at the end of each slice. Each snapshot
+    /// fully determines the symptoms of the errors inside its slice, so the slices' errors are collected
+    /// concurrently by separate analyzers and then folded into this one in the same order a sequential
+    /// pass would have seen them.
+    ///
+    /// Each analyzer re-propagates its slice from the snapshot, so every instruction is walked twice, and
+    /// the snapshot pass is serial. The last slice can't start before the snapshot pass ends, so the
+    /// speedup over a sequential pass is bounded by (propagation + collection) / propagation.
+    void undo_operations_in_time_slices(const Circuit &circuit, size_t start, size_t end);
     /// When detectors anti-commute with a reset, that set of detectors becomes a degree of freedom.
     /// Use that degree of freedom to delete the largest detector in the set from the system.
     void remove_gauge(SpanRef<const DemTarget> sorted);
@@ -285,10 +334,6 @@ struct ErrorAnalyzer {
         uint64_t context_qubit,
         std::string_view tag);
 
-    /// Empties error_class_probabilities into flushed_reversed_model.
-    void flush();
-    /// Adds (or folds) an error mechanism into error_class_probabilities.
-    ErrorEquivalenceClass add_error(double probability, SpanRef<const DemTarget> flipped_sorted, std::string_view tag);
     /// Adds (or folds) an error mechanism equal into error_class_probabilities.
     /// The error is defined as the xor of two sparse vectors, because this is a common situation.
     /// Deals with the details of efficiently computing the xor of the vectors with minimal allocations.
@@ -357,9 +402,12 @@ struct ErrorAnalyzer {
     void check_can_approximate_disjoint(
         const char *op_name, SpanRef<const double> probabilities, bool allow_single_component) const;
     void add_composite_error(double probability, SpanRef<const GateTarget> targets, std::string_view tag);
-    void correlated_error_block(const std::vector<CircuitInstruction> &dats);
 };
 
+/// Reverses the order of a reversed detector error model, shifting detector ids back to their absolute values and
+/// dropping detector declarations that are implied by errors.
+DetectorErrorModel unreversed(const DetectorErrorModel &rev, uint64_t &base_detector_id, std::set<DemTarget> &seen);
+
 /// Determines if an error's targets are graphlike.
 ///
 /// An error is graphlike if it has at most two symptoms (two detectors) per component.
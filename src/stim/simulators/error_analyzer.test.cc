@@ -6,6 +6,7 @@
 
 #include "stim/circuit/circuit.test.h"
 #include "stim/gen/gen_rep_code.h"
+#include "stim/gen/gen_surface_code.h"
 #include "stim/mem/simd_word.test.h"
 #include "stim/simulators/frame_simulator.h"
 #include "stim/util_bot/test_util.test.h"
@@ -3781,3 +3782,170 @@ TEST(ErrorAnalyzer, tagged_noise) {
         logical_observable[test-tag-4] L0
     )DEM"));
 }
+
+TEST(ErrorAnalyzer, num_threads_matches_single_thread) {
+    CircuitGenParameters params(5, 3, "rotated_memory_x");
+    params.after_clifford_depolarization = 0.001;
+    params.before_measure_flip_probability = 0.002;
+    params.after_reset_flip_probability = 0.003;
+    params.before_round_data_depolarization = 0.004;
+    auto circuit = generate_surface_code_circuit(params).circuit;
+
+    for (bool flatten_loops : {false, true}) {
+        for (bool decompose_errors : {false, true}) {
+            DemOptions options{.decompose_errors = decompose_errors, .flatten_loops = flatten_loops};
+            auto expected = circuit_to_dem(circuit, options);
+            for (size_t num_threads : {2, 3, 8}) {
+                options.num_threads = num_threads;
+                auto actual = circuit_to_dem(circuit, options);
+                ASSERT_TRUE(actual.approx_equals(expected, 1e-12)) << actual;
+            }
+        }
+    }
+}
+
+TEST(ErrorAnalyzer, num_threads_folds_errors_across_time_slices) {
+    Circuit circuit(R"CIRCUIT(
+        R 0 1
+        X_ERROR(0.125) 0
+        TICK
+        CX 0 1
+        X_ERROR(0.125) 0
+        TICK
+        H 1
+        TICK
+        H 1
+        MPAD 0
+        M(0.25) 0 1
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+        DETECTOR(2) rec[-3]
+    )CIRCUIT");
+    auto expected = DetectorErrorModel(R"DEM(
+        error(0.25) D0
+        error(0.125) D0 D1
+        error(0.3125) D1
+        detector(2) D2
+    )DEM");
+    ASSERT_EQ(circuit_to_dem(circuit), expected);
+    ASSERT_EQ(circuit_to_dem(circuit, {.num_threads = 4}), expected);
+
+    auto all_ops = generate_test_circuit_with_all_operations();
+    ASSERT_EQ(
+        circuit_to_dem(all_ops, {.approximate_disjoint_errors_threshold = 1, .num_threads = 4}),
+        circuit_to_dem(all_ops, {.approximate_disjoint_errors_threshold = 1}));
+}
+
+TEST(ErrorAnalyzer, num_threads_reports_same_failures) {
+    auto expect_same_failure = [](const char *text) {
+        Circuit circuit(text);
+        std::string expected;
+        try {
+            circuit_to_dem(circuit);
+        } catch (const std::invalid_argument &ex) {
+            expected = ex.what();
+        }
+        ASSERT_NE(expected, "");
+        for (size_t num_threads : {2, 4}) {
+            std::string actual;
+            try {
+                circuit_to_dem(circuit, {.num_threads = num_threads});
+            } catch (const std::invalid_argument &ex) {
+                actual = ex.what();
+            }
+            ASSERT_EQ(actual, expected);
+        }
+    };
+
+    expect_same_failure(R"CIRCUIT(
+        R 0
+        TICK
+        H 0
+        TICK
+        X_ERROR(0.1) 0
+        TICK
+        M 0
+        DETECTOR rec[-1]
+        TICK
+        X_ERROR(0.1) 0
+    )CIRCUIT");
+    expect_same_failure(R"CIRCUIT(
+        TICK
+        M 0
+        TICK
+        H 0
+        TICK
+        M 0
+        DETECTOR rec[-1]
+        TICK
+        RX 0
+        TICK
+        M 0
+        DETECTOR rec[-1]
+    )CIRCUIT");
+    expect_same_failure(R"CIRCUIT(
+        E(0.1) X0
+        TICK
+        ELSE_CORRELATED_ERROR(0.1) X0
+    )CIRCUIT");
+    expect_same_failure(R"CIRCUIT(
+        REPEAT 2 {
+            TICK
+        }
+        ELSE_CORRELATED_ERROR(0.1) X0
+        TICK
+    )CIRCUIT");
+}
+
+TEST(ErrorAnalyzer, parameter_binding) {
+    Circuit circuit(R"CIRCUIT(
+        R 0 1
+        TICK
+        X_ERROR(p) 0
+        REPEAT 3 {
+            DEPOLARIZE2(p2) 0 1
+            TICK
+            E(p) X0
+            ELSE_CORRELATED_ERROR(0.125) X1
+            M(m) 0 1
+            DETECTOR rec[-1]
+            DETECTOR rec[-2]
+        }
+    )CIRCUIT");
+    Circuit literal(R"CIRCUIT(
+        R 0 1
+        TICK
+        X_ERROR(0.25) 0
+        REPEAT 3 {
+            DEPOLARIZE2(0.01) 0 1
+            TICK
+            E(0.25) X0
+            ELSE_CORRELATED_ERROR(0.125) X1
+            M(0.0625) 0 1
+            DETECTOR rec[-1]
+            DETECTOR rec[-2]
+        }
+    )CIRCUIT");
+    CircuitParameterBinding binding;
+    binding.set("p", 0.25);
+    binding.set("p2", 0.01);
+    binding.set("m", 0.0625);
+
+    for (bool flatten_loops : {false, true}) {
+        for (size_t num_threads : {1, 2}) {
+            DemOptions options{
+                .flatten_loops = flatten_loops,
+                .approximate_disjoint_errors_threshold = 1,
+                .num_threads = num_threads,
+            };
+            auto expected = circuit_to_dem(literal, options);
+            options.parameter_binding = &binding;
+            ASSERT_EQ(circuit_to_dem(circuit, options), expected);
+        }
+    }
+
+    ASSERT_THROW({ circuit_to_dem(circuit); }, std::invalid_argument);
+    CircuitParameterBinding partial;
+    partial.set("p", 0.25);
+    ASSERT_THROW({ circuit_to_dem(circuit, {.parameter_binding = &partial}); }, std::invalid_argument);
+}
@@ -56,7 +56,7 @@ struct FrameSimulator {
     simd_bits<W> tmp_storage;          // Workspace used when sampling compound error processes.
     simd_bits<W> last_correlated_error_occurred;  // correlated error flag for each instance.
     simd_bit_table<W> sweep_table;                // Shot-to-shot configuration data.
-    std::mt19937_64 rng;                          // Random number generator used for generating entropy.
+    PhiloxRng rng;                                // Counter-based generator used for generating entropy.
 
     // Determines whether e.g. 50% Z errors are multiplied into the frame when measuring in the Z basis.
     // This is necessary for correct sampling.
@@ -72,7 +72,9 @@ struct FrameSimulator {
     ///     mode: Describes the intended usage of the simulator, which affects the sizing
     ///         of buffers.
     ///     batch_size: How many shots to simulate simultaneously.
-    ///     rng: The random number generator to pull noise from.
+    ///     rng: The counter-based generator to pull noise from.
+    FrameSimulator(CircuitStats circuit_stats, FrameSimulatorMode mode, size_t batch_size, PhiloxRng rng);
+    /// Same as above, but keys the noise generator with one draw from the given generator.
     FrameSimulator(CircuitStats circuit_stats, FrameSimulatorMode mode, size_t batch_size, std::mt19937_64 &&rng);
     FrameSimulator() = delete;
 
@@ -83,8 +85,14 @@ struct FrameSimulator {
 
     void safe_do_instruction(const CircuitInstruction &instruction);
     void safe_do_circuit(const Circuit &circuit, uint64_t repetitions = 1);
+    /// Same as `safe_do_circuit`, but named parameters in the circuit's arguments take their values from the binding.
+    void safe_do_circuit(const Circuit &circuit, const CircuitParameterBinding &binding, uint64_t repetitions = 1);
 
     void do_circuit(const Circuit &circuit);
+    /// Same as `do_circuit`, but named parameters in the circuit's arguments take their values from the binding.
+    ///
+    /// The values are substituted as each instruction is reached, so the circuit isn't copied.
+    void do_circuit(const Circuit &circuit, const CircuitParameterBinding &binding);
     void reset_all();
 
     void do_gate(const CircuitInstruction &inst);
@@ -39,6 +39,11 @@ inline void for_each_target_pair(FrameSimulator<W> &sim, const CircuitInstructio
 template <size_t W>
 FrameSimulator<W>::FrameSimulator(
     CircuitStats circuit_stats, FrameSimulatorMode mode, size_t batch_size, std::mt19937_64 &&rng)
+    : FrameSimulator(circuit_stats, mode, batch_size, PhiloxRng(rng())) {
+}
+
+template <size_t W>
+FrameSimulator<W>::FrameSimulator(CircuitStats circuit_stats, FrameSimulatorMode mode, size_t batch_size, PhiloxRng rng)
     : num_qubits(0),
       num_observables(0),
       keeping_detection_data(false),
@@ -124,9 +129,15 @@ void FrameSimulator<W>::ensure_safe_to_do_circuit_with_stats(const CircuitStats
 
 template <size_t W>
 void FrameSimulator<W>::safe_do_circuit(const Circuit &circuit, uint64_t repetitions) {
+    safe_do_circuit(circuit, CircuitParameterBinding{}, repetitions);
+}
+
+template <size_t W>
+void FrameSimulator<W>::safe_do_circuit(
+    const Circuit &circuit, const CircuitParameterBinding &binding, uint64_t repetitions) {
     ensure_safe_to_do_circuit_with_stats(circuit.compute_stats().repeated(repetitions));
     for (size_t rep = 0; rep < repetitions; rep++) {
-        do_circuit(circuit);
+        do_circuit(circuit, binding);
     }
 }
 
@@ -164,8 +175,21 @@ void FrameSimulator<W>::reset_all() {
 
 template <size_t W>
 void FrameSimulator<W>::do_circuit(const Circuit &circuit) {
+    // Binding nothing makes named parameters fail loudly, instead of being simulated as NaN probabilities.
+    do_circuit(circuit, CircuitParameterBinding{});
+}
+
+template <size_t W>
+void FrameSimulator<W>::do_circuit(const Circuit &circuit, const CircuitParameterBinding &binding) {
+    if (!circuit.has_parameter_args()) {
+        circuit.for_each_operation([&](const CircuitInstruction &op) {
+            do_gate(op);
+        });
+        return;
+    }
+    std::vector<double> arg_buf;
     circuit.for_each_operation([&](const CircuitInstruction &op) {
-        do_gate(op);
+        do_gate(binding.bind(op, arg_buf));
     });
 }
 
@@ -123,3 +123,32 @@ BENCHMARK(FrameSimulator_surface_code_rotated_memory_z_d11_r100_batch1024) {
         std::cerr << "data dependence";
     }
 }
+
+BENCHMARK(FrameSimulator_surface_code_rotated_memory_z_d11_r100_batch1024_bound_params) {
+    auto params = CircuitGenParameters(100, 11, "rotated_memory_z");
+    params.before_measure_flip_probability = 0.001;
+    params.after_reset_flip_probability = 0.001;
+    params.after_clifford_depolarization = 0.001;
+    auto text = generate_surface_code_circuit(params).circuit.str();
+    for (size_t k = text.find("(0.001)"); k != std::string::npos; k = text.find("(0.001)", k)) {
+        text.replace(k, 7, "(p)");
+    }
+    Circuit circuit(text);
+    CircuitParameterBinding binding;
+    binding.set("p", 0.001);
+
+    FrameSimulator<MAX_BITWORD_WIDTH> sim(
+        circuit.compute_stats(), FrameSimulatorMode::STORE_MEASUREMENTS_TO_MEMORY, 1024, std::mt19937_64(0));
+
+    benchmark_go([&]() {
+        sim.reset_all();
+        sim.do_circuit(circuit, binding);
+    })
+        .goal_millis(5.1)
+        .show_rate("Shots", 1024)
+        .show_rate("Dets", circuit.count_detectors() * 1024);
+    sim.reset_all();
+    if (!sim.obs_record[0].not_zero()) {
+        std::cerr << "data dependence";
+    }
+}
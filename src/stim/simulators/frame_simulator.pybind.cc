@@ -1,5 +1,6 @@
 #include "stim/simulators/frame_simulator.pybind.h"
 
+#include "stim/circuit/circuit.pybind.h"
 #include "stim/circuit/circuit_instruction.pybind.h"
 #include "stim/circuit/circuit_repeat_block.pybind.h"
 #include "stim/py/base.pybind.h"
@@ -34,7 +35,7 @@ std::optional<size_t> py_index_to_optional_size_t(
 }
 
 static void generate_biased_samples_bit_packed_contiguous(
-    uint8_t *out, size_t num_bytes, float p, std::mt19937_64 &rng) {
+    uint8_t *out, size_t num_bytes, float p, PhiloxRng &rng) {
     uintptr_t start = (uintptr_t)out;
     uintptr_t end = start + num_bytes;
     uintptr_t aligned64_start = start & ~0b111ULL;
@@ -63,7 +64,7 @@ static void generate_biased_samples_bit_packed_contiguous(
 }
 
 static void generate_biased_samples_bit_packed_with_stride(
-    uint8_t *out, pybind11::ssize_t stride, size_t num_bytes, float p, std::mt19937_64 &rng) {
+    uint8_t *out, pybind11::ssize_t stride, size_t num_bytes, float p, PhiloxRng &rng) {
     uint64_t stack[64];
     uint64_t *stack_ptr = &stack[0];
     for (size_t k1 = 0; k1 < num_bytes; k1 += 64 * 8) {
@@ -79,7 +80,7 @@ static void generate_biased_samples_bit_packed_with_stride(
 }
 
 static void generate_biased_samples_bool(
-    uint8_t *out, pybind11::ssize_t stride, size_t num_samples, float p, std::mt19937_64 &rng) {
+    uint8_t *out, pybind11::ssize_t stride, size_t num_samples, float p, PhiloxRng &rng) {
     uint64_t stack[64];
     uint64_t *stack_ptr = &stack[0];
     for (size_t k1 = 0; k1 < num_samples; k1 += 64 * 64) {
@@ -95,6 +96,7 @@ static void generate_biased_samples_bool(
 template <size_t W>
 pybind11::object generate_bernoulli_samples(
     FrameSimulator<W> &self, size_t num_samples, float p, bool bit_packed, pybind11::object out) {
+    auto lock = lock_py_object(&self);
     if (bit_packed) {
         size_t num_bytes = (num_samples + 7) / 8;
         if (out.is_none()) {
@@ -203,6 +205,7 @@ pybind11::class_<FrameSimulator<MAX_BITWORD_WIDTH>> stim_pybind::pybind_frame_si
 
 template <size_t W>
 pybind11::object peek_pauli_flips(const FrameSimulator<W> &self, const pybind11::object &py_instance_index) {
+    auto lock = lock_py_object(&self);
     std::optional<size_t> instance_index =
         py_index_to_optional_size_t(py_instance_index, self.batch_size, "instance_index", "batch_size");
 
@@ -259,6 +262,7 @@ pybind11::object to_numpy(
     pybind11::object output_measure_flips,
     pybind11::object output_detector_flips,
     pybind11::object output_observable_flips) {
+    auto lock = lock_py_object(&self);
     output_xs =
         pick_output_numpy_array(output_xs, bit_packed, transpose, self.num_qubits, self.batch_size, "output_xs");
     output_zs =
@@ -362,6 +366,7 @@ pybind11::object get_measurement_flips(
     const pybind11::object &py_record_index,
     const pybind11::object &py_instance_index,
     bool bit_packed) {
+    auto lock = lock_py_object(&self);
     size_t num_measurements = self.m_record.stored;
 
     std::optional<size_t> instance_index =
@@ -380,6 +385,7 @@ pybind11::object get_detector_flips(
     const pybind11::object &py_detector_index,
     const pybind11::object &py_instance_index,
     bool bit_packed) {
+    auto lock = lock_py_object(&self);
     size_t num_detectors = self.det_record.stored;
 
     std::optional<size_t> instance_index =
@@ -398,6 +404,7 @@ pybind11::object get_obs_flips(
     const pybind11::object &py_observable_index,
     const pybind11::object &py_instance_index,
     bool bit_packed) {
+    auto lock = lock_py_object(&self);
     std::optional<size_t> instance_index =
         py_index_to_optional_size_t(py_instance_index, self.batch_size, "instance_index", "batch_size");
 
@@ -506,6 +513,7 @@ void stim_pybind::pybind_frame_simulator_methods(
     c.def_property_readonly(
         "batch_size",
         [](FrameSimulator<MAX_BITWORD_WIDTH> &self) -> size_t {
+            auto lock = lock_py_object(&self);
             return self.batch_size;
         },
         clean_doc_string(R"DOC(
@@ -525,6 +533,7 @@ void stim_pybind::pybind_frame_simulator_methods(
     c.def_property_readonly(
         "num_qubits",
         [](FrameSimulator<MAX_BITWORD_WIDTH> &self) -> size_t {
+            auto lock = lock_py_object(&self);
             return self.num_qubits;
         },
         clean_doc_string(R"DOC(
@@ -547,6 +556,7 @@ void stim_pybind::pybind_frame_simulator_methods(
     c.def_property_readonly(
         "num_observables",
         [](FrameSimulator<MAX_BITWORD_WIDTH> &self) -> size_t {
+            auto lock = lock_py_object(&self);
             return self.num_observables;
         },
         clean_doc_string(R"DOC(
@@ -569,6 +579,7 @@ void stim_pybind::pybind_frame_simulator_methods(
     c.def_property_readonly(
         "num_measurements",
         [](FrameSimulator<MAX_BITWORD_WIDTH> &self) -> size_t {
+            auto lock = lock_py_object(&self);
             return self.m_record.stored;
         },
         clean_doc_string(R"DOC(
@@ -588,6 +599,7 @@ void stim_pybind::pybind_frame_simulator_methods(
     c.def_property_readonly(
         "num_detectors",
         [](FrameSimulator<MAX_BITWORD_WIDTH> &self) -> size_t {
+            auto lock = lock_py_object(&self);
             return self.det_record.stored;
         },
         clean_doc_string(R"DOC(
@@ -613,6 +625,7 @@ void stim_pybind::pybind_frame_simulator_methods(
            const pybind11::object &pauli,
            int64_t qubit_index,
            int64_t instance_index) {
+            auto lock = lock_py_object(&self);
             uint8_t p = pybind11_object_to_pauli_ixyz(pauli);
             if (instance_index < 0) {
                 instance_index += self.batch_size;
@@ -946,6 +959,7 @@ void stim_pybind::pybind_frame_simulator_methods(
     c.def(
         "append_measurement_flips",
         [](FrameSimulator<MAX_BITWORD_WIDTH> &self, const pybind11::object &measurement_flip_data) {
+            auto lock = lock_py_object(&self);
             if (pybind11::isinstance<pybind11::array_t<bool>>(measurement_flip_data)) {
                 const pybind11::array_t<bool> &arr = pybind11::cast<pybind11::array_t<bool>>(measurement_flip_data);
                 if (arr.ndim() == 1) {
@@ -1308,14 +1322,26 @@ void stim_pybind::pybind_frame_simulator_methods(
 
     c.def(
         "do",
-        [](FrameSimulator<MAX_BITWORD_WIDTH> &self, const pybind11::object &obj) {
+        [](FrameSimulator<MAX_BITWORD_WIDTH> &self, const pybind11::object &obj, const pybind11::object &parameters) {
+            CircuitParameterBinding binding;
+            if (!parameters.is_none()) {
+                binding = py_dict_to_circuit_parameter_binding(pybind11::cast<pybind11::dict>(parameters));
+            }
+            auto lock = lock_py_object(&self);
             if (pybind11::isinstance<Circuit>(obj)) {
-                self.safe_do_circuit(pybind11::cast<const Circuit &>(obj));
+                const Circuit &circuit = pybind11::cast<const Circuit &>(obj);
+                pybind11::gil_scoped_release release;
+                self.safe_do_circuit(circuit, binding);
             } else if (pybind11::isinstance<PyCircuitInstruction>(obj)) {
-                self.safe_do_instruction(pybind11::cast<const PyCircuitInstruction &>(obj));
+                CircuitInstruction instruction = pybind11::cast<const PyCircuitInstruction &>(obj);
+                std::vector<double> arg_buf;
+                CircuitInstruction bound = binding.bind(instruction, arg_buf);
+                pybind11::gil_scoped_release release;
+                self.safe_do_instruction(bound);
             } else if (pybind11::isinstance<CircuitRepeatBlock>(obj)) {
                 const CircuitRepeatBlock &block = pybind11::cast<const CircuitRepeatBlock &>(obj);
-                self.safe_do_circuit(block.body, block.repeat_count);
+                pybind11::gil_scoped_release release;
+                self.safe_do_circuit(block.body, binding, block.repeat_count);
             } else {
                 std::stringstream ss;
                 ss << "Don't know how to do a '";
@@ -1325,8 +1351,10 @@ void stim_pybind::pybind_frame_simulator_methods(
             }
         },
         pybind11::arg("obj"),
+        pybind11::kw_only(),
+        pybind11::arg("parameters") = pybind11::none(),
         clean_doc_string(R"DOC(
-            @signature def do(self, obj: Union[stim.Circuit, stim.CircuitInstruction, stim.CircuitRepeatBlock]) -> None:
+            @signature def do(self, obj: Union[stim.Circuit, stim.CircuitInstruction, stim.CircuitRepeatBlock], *, parameters: Optional[Dict[str, float]] = None) -> None:
             Applies a circuit or circuit instruction to the simulator's state.
 
             The results of any measurements performed can be retrieved using the
@@ -1334,6 +1362,11 @@ void stim_pybind::pybind_frame_simulator_methods(
 
             Args:
                 obj: The circuit or instruction to apply to the simulator's state.
+                parameters: Defaults to None. The values of named parameters used as
+                    noise arguments (e.g. the `p` in `X_ERROR(p) 0`), as a dictionary
+                    from parameter name to value. The values are substituted as the
+                    instructions are applied, without copying the circuit. Every named
+                    parameter that is reached must be given a value.
 
             Examples:
                 >>> import stim
@@ -1368,6 +1401,7 @@ void stim_pybind::pybind_frame_simulator_methods(
            const pybind11::object &pauli,
            const pybind11::object &mask,
            float p) {
+            auto lock = lock_py_object(&self);
             uint8_t pb = pybind11_object_to_pauli_ixyz(pauli);
 
             if (!pybind11::isinstance<pybind11::array_t<bool>>(mask)) {
@@ -1476,13 +1510,14 @@ void stim_pybind::pybind_frame_simulator_methods(
     c.def(
         "copy",
         [](const FrameSimulator<MAX_BITWORD_WIDTH> &self, bool copy_rng, pybind11::object &seed) {
+            auto lock = lock_py_object(&self);
             if (copy_rng && !seed.is_none()) {
                 throw std::invalid_argument("seed and copy_rng are incompatible");
             }
 
             FrameSimulator<MAX_BITWORD_WIDTH> copy = self;
             if (!copy_rng || !seed.is_none()) {
-                copy.rng = make_py_seeded_rng(seed);
+                copy.rng = PhiloxRng(make_py_seeded_rng(seed)());
             }
             return copy;
         },
@@ -1560,6 +1595,7 @@ void stim_pybind::pybind_frame_simulator_methods(
     c.def(
         "clear",
         [](FrameSimulator<MAX_BITWORD_WIDTH> &self) {
+            auto lock = lock_py_object(&self);
             self.reset_all();
         },
         clean_doc_string(R"DOC(
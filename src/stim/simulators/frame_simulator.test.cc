@@ -1741,3 +1741,33 @@ TEST_EACH_WORD_SIZE_W(FrameSimulator, observable_include_paulis_rx, {
     ASSERT_LT(y0, 700);
     ASSERT_EQ(x0, 0);
 })
+
+TEST_EACH_WORD_SIZE_W(FrameSimulator, do_circuit_with_parameter_binding, {
+    auto circuit = Circuit(R"CIRCUIT(
+        X_ERROR(p) 0
+        M(q) 0 1
+    )CIRCUIT");
+    FrameSimulator<W> sim(
+        circuit.compute_stats(), FrameSimulatorMode::STORE_MEASUREMENTS_TO_MEMORY, 1024, INDEPENDENT_TEST_RNG());
+
+    CircuitParameterBinding binding;
+    binding.set("p", 1);
+    binding.set("q", 0);
+    sim.reset_all();
+    sim.do_circuit(circuit, binding);
+    ASSERT_EQ(sim.m_record.storage[0].popcnt(), 1024);
+    ASSERT_EQ(sim.m_record.storage[1].popcnt(), 0);
+
+    binding.set("p", 0);
+    binding.set("q", 1);
+    sim.reset_all();
+    sim.safe_do_circuit(circuit, binding);
+    ASSERT_EQ(sim.m_record.storage[0].popcnt(), 1024);
+    ASSERT_EQ(sim.m_record.storage[1].popcnt(), 1024);
+
+    sim.reset_all();
+    ASSERT_THROW({ sim.do_circuit(circuit); }, std::invalid_argument);
+    binding.set("q", 2);
+    sim.reset_all();
+    ASSERT_THROW({ sim.do_circuit(circuit, binding); }, std::invalid_argument);
+})
@@ -0,0 +1,230 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/frame_simulator_program.h"
+
+#include <algorithm>
+
+#include "stim/circuit/gate_decomposition.h"
+
+using namespace stim;
+
+/// The action of a single qubit Clifford on a Pauli frame, ignoring signs.
+///
+/// The frame (x, z) is mapped to (xx*x ^ xz*z, zx*x ^ zz*z).
+struct FrameAction {
+    bool xx;
+    bool xz;
+    bool zx;
+    bool zz;
+
+    bool operator==(const FrameAction &other) const = default;
+
+    /// Returns the action of applying `this` and then `next`.
+    FrameAction then(FrameAction next) const {
+        return {
+            (next.xx && xx) != (next.xz && zx),
+            (next.xx && xz) != (next.xz && zz),
+            (next.zx && xx) != (next.zz && zx),
+            (next.zx && xz) != (next.zz && zz),
+        };
+    }
+};
+
+constexpr FrameAction FRAME_I{1, 0, 0, 1};
+constexpr FrameAction FRAME_H_XZ{0, 1, 1, 0};
+constexpr FrameAction FRAME_H_XY{1, 0, 1, 1};
+constexpr FrameAction FRAME_H_YZ{1, 1, 0, 1};
+constexpr FrameAction FRAME_C_XYZ{1, 1, 1, 0};
+constexpr FrameAction FRAME_C_ZYX{0, 1, 1, 1};
+
+/// Mirrors the single qubit cases of FrameSimulator<W>::do_gate.
+static bool try_get_frame_action(GateType gate_type, FrameAction *out) {
+    switch (gate_type) {
+        case GateType::X:
+        case GateType::Y:
+        case GateType::Z:
+        case GateType::I:
+            *out = FRAME_I;
+            return true;
+        case GateType::SQRT_Y:
+        case GateType::SQRT_Y_DAG:
+        case GateType::H:
+        case GateType::H_NXZ:
+            *out = FRAME_H_XZ;
+            return true;
+        case GateType::S:
+        case GateType::S_DAG:
+        case GateType::H_XY:
+        case GateType::H_NXY:
+            *out = FRAME_H_XY;
+            return true;
+        case GateType::SQRT_X:
+        case GateType::SQRT_X_DAG:
+        case GateType::H_YZ:
+        case GateType::H_NYZ:
+            *out = FRAME_H_YZ;
+            return true;
+        case GateType::C_XYZ:
+        case GateType::C_NXYZ:
+        case GateType::C_XNYZ:
+        case GateType::C_XYNZ:
+            *out = FRAME_C_XYZ;
+            return true;
+        case GateType::C_ZYX:
+        case GateType::C_NZYX:
+        case GateType::C_ZNYX:
+        case GateType::C_ZYNX:
+            *out = FRAME_C_ZYX;
+            return true;
+        default:
+            return false;
+    }
+}
+
+struct FrameProgramBuilder {
+    size_t num_qubits;
+    Circuit &output;
+    std::vector<FrameAction> pending;
+    std::vector<uint32_t> pending_qubits;
+    std::vector<GateTarget> target_buf;
+
+    FrameProgramBuilder(size_t num_qubits, Circuit &output)
+        : num_qubits(num_qubits), output(output), pending(num_qubits, FRAME_I) {
+    }
+
+    void flush_single_qubit_cliffords() {
+        constexpr std::pair<GateType, FrameAction> emitted[]{
+            {GateType::H, FRAME_H_XZ},
+            {GateType::H_XY, FRAME_H_XY},
+            {GateType::H_YZ, FRAME_H_YZ},
+            {GateType::C_XYZ, FRAME_C_XYZ},
+            {GateType::C_ZYX, FRAME_C_ZYX},
+        };
+        std::sort(pending_qubits.begin(), pending_qubits.end());
+        pending_qubits.erase(std::unique(pending_qubits.begin(), pending_qubits.end()), pending_qubits.end());
+        for (const auto &[gate_type, action] : emitted) {
+            target_buf.clear();
+            for (auto q : pending_qubits) {
+                if (pending[q] == action) {
+                    target_buf.push_back(GateTarget::qubit(q));
+                }
+            }
+            if (!target_buf.empty()) {
+                output.safe_append(CircuitInstruction{gate_type, {}, target_buf, ""});
+            }
+        }
+        for (auto q : pending_qubits) {
+            pending[q] = FRAME_I;
+        }
+        pending_qubits.clear();
+    }
+
+    void append(const CircuitInstruction &inst) {
+        output.safe_append(CircuitInstruction{inst.gate_type, inst.args, inst.targets, ""});
+    }
+
+    void compile_instruction(const CircuitInstruction &inst) {
+        FrameAction action;
+        if (try_get_frame_action(inst.gate_type, &action)) {
+            for (auto t : inst.targets) {
+                auto q = t.qubit_value();
+                pending_qubits.push_back(q);
+                pending[q] = pending[q].then(action);
+            }
+            return;
+        }
+
+        switch (inst.gate_type) {
+            case GateType::TICK:
+            case GateType::QUBIT_COORDS:
+            case GateType::SHIFT_COORDS:
+            case GateType::II:
+            case GateType::I_ERROR:
+            case GateType::II_ERROR:
+                return;
+            case GateType::MPP:
+                decompose_mpp_operation(inst, num_qubits, [&](const CircuitInstruction &sub) {
+                    compile_instruction(sub);
+                });
+                return;
+            case GateType::SPP:
+            case GateType::SPP_DAG:
+                decompose_spp_or_spp_dag_operation(inst, num_qubits, false, [&](const CircuitInstruction &sub) {
+                    compile_instruction(sub);
+                });
+                return;
+            case GateType::MXX:
+            case GateType::MYY:
+            case GateType::MZZ:
+                compile_pair_measurement(inst);
+                return;
+            default:
+                flush_single_qubit_cliffords();
+                append(inst);
+                return;
+        }
+    }
+
+    /// Mirrors FrameSimulator<W>::do_MXX_disjoint_controls_segment and its Y and Z variants.
+    void compile_pair_measurement(const CircuitInstruction &inst) {
+        GateType basis_change;
+        GateType measurement;
+        if (inst.gate_type == GateType::MXX) {
+            basis_change = GateType::CX;
+            measurement = GateType::MX;
+        } else if (inst.gate_type == GateType::MYY) {
+            basis_change = GateType::CY;
+            measurement = GateType::MY;
+        } else {
+            basis_change = GateType::XCZ;
+            measurement = GateType::M;
+        }
+        decompose_pair_instruction_into_disjoint_segments(inst, num_qubits, [&](CircuitInstruction segment) {
+            // Inversions don't affect the frame, and the basis change gates can't take them.
+            flush_single_qubit_cliffords();
+            target_buf.clear();
+            for (auto t : segment.targets) {
+                target_buf.push_back(GateTarget::qubit(t.qubit_value()));
+            }
+            append(CircuitInstruction{basis_change, {}, target_buf, ""});
+            for (size_t k = 0; k < target_buf.size(); k += 2) {
+                append(CircuitInstruction{measurement, segment.args, {&target_buf[k], &target_buf[k] + 1}, ""});
+            }
+            append(CircuitInstruction{basis_change, {}, target_buf, ""});
+        });
+    }
+};
+
+static Circuit frame_simulator_program_helper(const Circuit &circuit, size_t num_qubits) {
+    Circuit output;
+    FrameProgramBuilder builder(num_qubits, output);
+    for (const auto &inst : circuit.operations) {
+        if (inst.gate_type == GateType::REPEAT) {
+            builder.flush_single_qubit_cliffords();
+            output.append_repeat_block(
+                inst.repeat_block_rep_count(),
+                frame_simulator_program_helper(inst.repeat_block_body(circuit), num_qubits),
+                "");
+        } else {
+            builder.compile_instruction(inst);
+        }
+    }
+    builder.flush_single_qubit_cliffords();
+    return output;
+}
+
+Circuit stim::frame_simulator_program(const Circuit &circuit) {
+    return frame_simulator_program_helper(circuit, circuit.count_qubits());
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_SIMULATORS_FRAME_SIMULATOR_PROGRAM_H
+#define _STIM_SIMULATORS_FRAME_SIMULATOR_PROGRAM_H
+
+#include "stim/circuit/circuit.h"
+
+namespace stim {
+
+/// Lowers a circuit into an equivalent circuit that's cheaper for a FrameSimulator to run.
+///
+/// This is a one-time compile step for when the same circuit is going to be simulated
+/// many times (e.g. once per batch of shots). The returned circuit has the same
+/// measurements, detectors, observables, and noise as the given circuit, so a
+/// FrameSimulator samples the same distribution from it. It differs in that:
+///
+/// - Instructions that don't affect Pauli frames (Pauli gates, identity gates, TICK,
+///     QUBIT_COORDS, SHIFT_COORDS) are removed, and tags are stripped. This lets the
+///     surrounding instructions fuse into larger instructions.
+/// - Runs of single qubit Clifford instructions are fused, per qubit, into a single
+///     instruction implementing their combined action on Pauli frames (one of H,
+///     H_XY, H_YZ, C_XYZ, or C_ZYX, or nothing at all).
+/// - MPP, SPP, SPP_DAG, MXX, MYY, and MZZ instructions are decomposed into the
+///     simpler instructions the FrameSimulator would otherwise have to derive every
+///     time it executed them, with pair measurements already split into segments
+///     whose targets don't collide.
+///
+/// REPEAT blocks are kept as REPEAT blocks (with compiled bodies), so the size of the
+/// returned circuit is proportional to the size of the given circuit.
+///
+/// Args:
+///     circuit: The circuit to compile.
+///
+/// Returns:
+///     The compiled circuit. Simulators for it should still be sized using the stats
+///     of the original circuit, because removed instructions may have been the only
+///     ones touching some qubits.
+Circuit frame_simulator_program(const Circuit &circuit);
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,160 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/simulators/frame_simulator_program.h"
+
+#include "gtest/gtest.h"
+
+#include "stim/mem/simd_word.test.h"
+#include "stim/simulators/frame_simulator.h"
+#include "stim/util_bot/test_util.test.h"
+
+using namespace stim;
+
+TEST(frame_simulator_program, removes_frame_no_ops) {
+    ASSERT_EQ(
+        frame_simulator_program(Circuit(R"CIRCUIT(
+            QUBIT_COORDS(1, 2) 0
+            X_ERROR[test](0.25) 0
+            TICK
+            X 0 1
+            Y 1
+            Z 2
+            I 0
+            SHIFT_COORDS(5)
+            X_ERROR(0.25) 1 2
+            M 0
+            DETECTOR(1, 2) rec[-1]
+        )CIRCUIT")),
+        Circuit(R"CIRCUIT(
+            X_ERROR(0.25) 0 1 2
+            M 0
+            DETECTOR(1, 2) rec[-1]
+        )CIRCUIT"));
+}
+
+TEST(frame_simulator_program, fuses_single_qubit_cliffords) {
+    ASSERT_EQ(
+        frame_simulator_program(Circuit(R"CIRCUIT(
+            H 0 1 2 3 4
+            TICK
+            H 0
+            S 1
+            SQRT_X 2
+            S 3
+            SQRT_X 3
+            SQRT_X 4
+            S 4
+            H 5
+            SQRT_Y 5
+            M 0 1 2 3 4 5
+        )CIRCUIT")),
+        Circuit(R"CIRCUIT(
+            H_XY 3
+            H_YZ 4
+            C_XYZ 2
+            C_ZYX 1
+            M 0 1 2 3 4 5
+        )CIRCUIT"));
+
+    ASSERT_EQ(
+        frame_simulator_program(Circuit(R"CIRCUIT(
+            H 0
+            CX 0 1
+            H 0
+            REPEAT 2 {
+                H 1
+                S 1
+            }
+        )CIRCUIT")),
+        Circuit(R"CIRCUIT(
+            H 0
+            CX 0 1
+            H 0
+            REPEAT 2 {
+                C_ZYX 1
+            }
+        )CIRCUIT"));
+}
+
+TEST(frame_simulator_program, decomposes_products) {
+    ASSERT_EQ(
+        frame_simulator_program(Circuit(R"CIRCUIT(
+            MXX 0 !1 1 2
+            MZZ(0.125) 3 4
+        )CIRCUIT")),
+        Circuit(R"CIRCUIT(
+            CX 0 1
+            MX 0
+            CX 0 1 1 2
+            MX 1
+            CX 1 2
+            XCZ 3 4
+            M(0.125) 3
+            XCZ 3 4
+        )CIRCUIT"));
+
+    ASSERT_EQ(
+        frame_simulator_program(Circuit(R"CIRCUIT(
+            MPP X0*Z1
+        )CIRCUIT")),
+        Circuit(R"CIRCUIT(
+            H 0
+            CX 1 0
+            M 0
+            CX 1 0
+            H 0
+        )CIRCUIT"));
+}
+
+TEST_EACH_WORD_SIZE_W(frame_simulator_program, noiseless_samples_match_original_circuit, {
+    Circuit circuit(R"CIRCUIT(
+        QUBIT_COORDS(0, 0) 0
+        RX 0 1 2
+        TICK
+        H 0
+        S 1
+        SQRT_X_DAG 2
+        CX 0 1
+        MPP X0*Y1*Z2 Z0*Z1
+        C_XYZ 0 1
+        H_YZ 2
+        MYY 0 1
+        MXX 1 2 0 1
+        REPEAT 3 {
+            SPP X0*X1
+            S 0
+            SQRT_Y 1 2
+            MR 0
+            M 1 2
+            DETECTOR rec[-1] rec[-2]
+        }
+        MX 0 1 2
+    )CIRCUIT");
+    Circuit program = frame_simulator_program(circuit);
+    auto stats = circuit.compute_stats();
+
+    auto rng = INDEPENDENT_TEST_RNG();
+    FrameSimulator<W> sim1(stats, FrameSimulatorMode::STORE_MEASUREMENTS_TO_MEMORY, 256, std::mt19937_64(rng));
+    FrameSimulator<W> sim2(stats, FrameSimulatorMode::STORE_MEASUREMENTS_TO_MEMORY, 256, std::mt19937_64(rng));
+    sim1.reset_all();
+    sim2.reset_all();
+    sim1.do_circuit(circuit);
+    sim2.do_circuit(program);
+    ASSERT_EQ(sim1.m_record.stored, stats.num_measurements);
+    ASSERT_EQ(sim2.m_record.stored, stats.num_measurements);
+    ASSERT_EQ(sim1.m_record.storage, sim2.m_record.storage);
+    ASSERT_EQ(sim1.x_table, sim2.x_table);
+    ASSERT_EQ(sim1.z_table, sim2.z_table);
+})
@@ -20,6 +20,7 @@
 #include <random>
 
 #include "stim/circuit/circuit.h"
+#include "stim/io/sparse_shot.h"
 #include "stim/io/stim_data_formats.h"
 #include "stim/mem/simd_bit_table.h"
 
@@ -38,7 +39,7 @@ namespace stim {
 /// Args:
 ///     circuit: The circuit to sample.
 ///     num_shots: The number of samples to take.
-///     rng: Random number generator to use.
+///     rng: Advanced by one draw, which keys the counter-based generator that noise is pulled from.
 ///
 /// Returns:
 ///     A pair of simd_bit_tables. The first is the detection event data. The second is the
@@ -49,6 +50,25 @@ template <size_t W>
 std::pair<simd_bit_table<W>, simd_bit_table<W>> sample_batch_detection_events(
     const Circuit &circuit, size_t num_shots, std::mt19937_64 &rng);
 
+/// Batch samples detection events from a circuit, returning them as lists of fired detectors.
+///
+/// Uses the frame simulator. Like `sample_batch_detection_events`, this stores all of the
+/// samples in memory simultaneously. The fired detectors are found by scanning the
+/// simulator's shot-minor detection event table for non-zero words, instead of transposing
+/// it, which is much cheaper when detection events are rare.
+///
+/// Args:
+///     circuit: The circuit to sample.
+///     num_shots: The number of samples to take.
+///     rng: Advanced by one draw, which keys the counter-based generator that noise is pulled from.
+///
+/// Returns:
+///     One SparseShot per sample. The hits are the indices of the detectors that fired, in
+///     increasing order, and the obs_mask holds the observable flips.
+template <size_t W>
+std::vector<SparseShot> sample_batch_detection_events_sparse(
+    const Circuit &circuit, size_t num_shots, std::mt19937_64 &rng);
+
 /// Samples detection events from a circuit and writes them to a file.
 ///
 /// Uses the frame simulator.
@@ -60,10 +80,15 @@ std::pair<simd_bit_table<W>, simd_bit_table<W>> sample_batch_detection_events(
 ///     append_observables: Include the observables in the output, after the detectors.
 ///     out: The file to write the result data to.
 ///     format: The format to use when encoding the data into the file.
-///     rng: Random number generator to use.
+///     rng: Advanced by one draw, which keys the counter-based generator that noise is pulled from.
 ///     obs_out: An optional secondary file to write observable data to. Set to nullptr to
 ///         not use.
 ///     obs_out_format: The format to use when writing to the secondary file.
+///     num_threads: How many threads to spread the shot batches over. Each thread gets its
+///         own frame simulator, and batches are written to the output in order. Each batch
+///         draws from its own stream of a counter-based generator keyed by `rng`, so the
+///         results depend on the seed of `rng` but not on the number of threads. Defaults
+///         to 1 (sample on the calling thread).
 template <size_t W>
 void sample_batch_detection_events_writing_results_to_disk(
     const Circuit &circuit,
@@ -74,7 +99,8 @@ void sample_batch_detection_events_writing_results_to_disk(
     SampleFormat format,
     std::mt19937_64 &rng,
     FILE *obs_out,
-    SampleFormat obs_out_format);
+    SampleFormat obs_out_format,
+    size_t num_threads = 1);
 
 /// A convenience method for batch sampling measurements from a circuit.
 ///
@@ -89,7 +115,7 @@ void sample_batch_detection_events_writing_results_to_disk(
 /// Args:
 ///     circuit: The circuit to sample.
 ///     num_shots: The number of samples to take.
-///     rng: Random number generator to use.
+///     rng: Advanced by one draw, which keys the counter-based generator that noise is pulled from.
 ///     transposed: Whether or not to exchange the axes of the resulting table.
 ///
 /// Returns:
@@ -119,7 +145,12 @@ simd_bit_table<W> sample_batch_measurements(
 ///         (for example, via TableauSimulator::reference_sample_circuit).
 ///     out: The file to write the result data to.
 ///     format: The format to use when encoding the data into the file.
-///     rng: Random number generator to use.
+///     rng: Advanced by one draw, which keys the counter-based generator that noise is pulled from.
+///     num_threads: How many threads to spread the shot batches over. Each thread gets its
+///         own frame simulator, and batches are written to the output in order. Each batch
+///         draws from its own stream of a counter-based generator keyed by `rng`, so the
+///         results depend on the seed of `rng` but not on the number of threads. Defaults
+///         to 1 (sample on the calling thread).
 template <size_t W>
 void sample_batch_measurements_writing_results_to_disk(
     const Circuit &circuit,
@@ -127,7 +158,28 @@ void sample_batch_measurements_writing_results_to_disk(
     uint64_t num_shots,
     FILE *out,
     SampleFormat format,
-    std::mt19937_64 &rng);
+    std::mt19937_64 &rng,
+    size_t num_threads = 1);
+
+/// Picks how many shots each frame simulator batch should cover when sampling to disk.
+///
+/// The shot dimension is tiled so that the simulator's x and z frame tables (one row per
+/// qubit) stay resident in cache while the instructions of the circuit are applied to
+/// them, instead of every instruction streaming the whole table through memory. Batches
+/// are still at least 256 shots wide (or W, if larger) so that the per-instruction
+/// overhead stays amortized, and are shrunk further if their results wouldn't fit in
+/// memory.
+///
+/// Args:
+///     num_shots: The total number of shots that will be taken.
+///     num_qubits: The number of qubits in the circuit.
+///     bits_per_shot: How many bits of simulator and result state are stored per shot.
+///
+/// Returns:
+///     A positive multiple of W, or 0 if even a batch of W shots is too large to store and
+///     the results have to be streamed instead.
+template <size_t W>
+size_t pick_frame_simulator_batch_size(uint64_t num_shots, uint64_t num_qubits, uint64_t bits_per_shot);
 
 }  // namespace stim
 
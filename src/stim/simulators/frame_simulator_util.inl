@@ -14,7 +14,10 @@
 
 #include "stim/simulators/force_streaming.h"
 #include "stim/simulators/frame_simulator.h"
+#include "stim/simulators/frame_simulator_program.h"
 #include "stim/simulators/frame_simulator_util.h"
+#include "stim/util_bot/parallel_batches.h"
+#include "stim/util_bot/philox_rng.h"
 
 namespace stim {
 
@@ -25,8 +28,6 @@ std::pair<simd_bit_table<W>, simd_bit_table<W>> sample_batch_detection_events(
         circuit.compute_stats(), FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY, num_shots, std::move(rng));
     sim.reset_all();
     sim.do_circuit(circuit);
-    rng = std::move(
-        sim.rng);  // Update input rng as if it was used directly, by moving the updated state out of the simulator.
 
     return std::pair<simd_bit_table<W>, simd_bit_table<W>>{
         std::move(sim.det_record.storage),
@@ -34,6 +35,15 @@ std::pair<simd_bit_table<W>, simd_bit_table<W>> sample_batch_detection_events(
     };
 }
 
+template <size_t W>
+std::vector<SparseShot> sample_batch_detection_events_sparse(
+    const Circuit &circuit, size_t num_shots, std::mt19937_64 &rng) {
+    auto stats = circuit.compute_stats();
+    auto tables = sample_batch_detection_events<W>(circuit, num_shots, rng);
+    return shot_minor_tables_to_sparse_shots(
+        tables.first, stats.num_detectors, tables.second, stats.num_observables, num_shots);
+}
+
 template <size_t W>
 void rerun_frame_sim_while_streaming_dets_to_disk(
     const Circuit &circuit,
@@ -112,10 +122,9 @@ void rerun_frame_sim_while_streaming_measurements_to_disk(
 }
 
 template <size_t W>
-void rerun_frame_sim_in_memory_and_write_dets_to_disk(
-    const Circuit &circuit,
+void write_in_memory_frame_sim_dets_to_disk(
     const CircuitStats &circuit_stats,
-    FrameSimulator<W> &frame_sim,
+    const FrameSimulator<W> &frame_sim,
     simd_bit_table<W> &out_concat_buf,
     size_t num_shots,
     bool prepend_observables,
@@ -128,9 +137,6 @@ void rerun_frame_sim_in_memory_and_write_dets_to_disk(
         throw std::out_of_range("Can't combine --prepend_observables, --append_observables, or --obs_out");
     }
 
-    frame_sim.reset_all();
-    frame_sim.do_circuit(circuit);
-
     const auto &obs_data = frame_sim.obs_record;
     const auto &det_data = frame_sim.det_record.storage;
     if (obs_out != nullptr) {
@@ -186,21 +192,57 @@ void rerun_frame_sim_in_memory_and_write_dets_to_disk(
     }
 }
 
-template <size_t W>
-void rerun_frame_sim_in_memory_and_write_measurements_to_disk(
+template <size_t W, typename WRITE_BATCH>
+void sample_batches_in_parallel_writing_in_order(
     const Circuit &circuit,
-    CircuitStats circuit_stats,
-    FrameSimulator<W> &frame_sim,
-    const simd_bits<W> &reference_sample,
+    const CircuitStats &circuit_stats,
+    FrameSimulatorMode mode,
+    size_t batch_size,
     size_t num_shots,
-    FILE *out,
-    SampleFormat format) {
-    frame_sim.reset_all();
-    frame_sim.do_circuit(circuit);
-    const auto &measure_data = frame_sim.m_record.storage;
+    size_t num_threads,
+    std::mt19937_64 &rng,
+    const WRITE_BATCH &write_batch) {
+    // The k'th batch is simulated using the k'th stream of a counter-based generator keyed by a
+    // single value drawn from `rng`. This makes the output depend on the seed but not on the number
+    // of threads or on how the operating system happened to schedule them.
+    uint64_t key = rng();
+    size_t num_batches = (num_shots + batch_size - 1) / batch_size;
+    process_batches_in_parallel_in_order(
+        num_batches,
+        num_threads,
+        [&]() {
+            return FrameSimulator<W>(circuit_stats, mode, batch_size, PhiloxRng(key));
+        },
+        [](FrameSimulator<W> &, size_t) {
+        },
+        [&](FrameSimulator<W> &sim, size_t batch_index) {
+            sim.rng = PhiloxRng(key, batch_index);
+            sim.reset_all();
+            sim.do_circuit(circuit);
+        },
+        [&](FrameSimulator<W> &sim, size_t batch_index) {
+            write_batch(sim, std::min(batch_size, num_shots - batch_index * batch_size));
+        });
+}
+
+template <size_t W>
+size_t pick_frame_simulator_batch_size(uint64_t num_shots, uint64_t num_qubits, uint64_t bits_per_shot) {
+    // Roughly the size of a core's L2 cache. The x and z tables get all of it because the
+    // measurement record is only appended to, so only its tail needs to be cached.
+    constexpr uint64_t FRAME_TABLE_CACHE_BUDGET_BITS = uint64_t{1} << 21;
+    constexpr size_t MIN_CACHE_TILED_BATCH_SIZE = W < 256 ? 256 : W;
 
-    write_table_data(
-        out, num_shots, circuit_stats.num_measurements, reference_sample, measure_data, format, 'M', 'M', 0);
+    size_t batch_size = 0;
+    while (batch_size < 1024 && batch_size < num_shots) {
+        batch_size += W;
+    }
+    while (batch_size > MIN_CACHE_TILED_BATCH_SIZE && 2 * num_qubits * batch_size > FRAME_TABLE_CACHE_BUDGET_BITS) {
+        batch_size -= W;
+    }
+    while (batch_size > 0 && should_use_streaming_because_bit_count_is_too_large_to_store(bits_per_shot * batch_size)) {
+        batch_size -= W;
+    }
+    return batch_size;
 }
 
 template <size_t W>
@@ -213,7 +255,8 @@ void sample_batch_detection_events_writing_results_to_disk(
     SampleFormat format,
     std::mt19937_64 &rng,
     FILE *obs_out,
-    SampleFormat obs_out_format) {
+    SampleFormat obs_out_format,
+    size_t num_threads) {
     if (num_shots == 0) {
         // Vacuously complete.
         return;
@@ -221,17 +264,13 @@ void sample_batch_detection_events_writing_results_to_disk(
 
     auto stats = circuit.compute_stats();
 
-    // Pick a batch size that's not so large that it would cause memory issues.
-    size_t batch_size = 0;
-    while (batch_size < 1024 && batch_size < num_shots) {
-        batch_size += W;
-    }
+    // Strip out work that doesn't affect the frames once, instead of redoing it for every batch.
+    Circuit program = frame_simulator_program(circuit);
+
+    // Pick a batch size that's cache friendly and not so large that it would cause memory issues.
     uint64_t memory_per_full_shot =
         2 * stats.num_qubits + 2 * stats.max_lookback + stats.num_observables + stats.num_detectors;
-    while (batch_size > 0 &&
-           should_use_streaming_because_bit_count_is_too_large_to_store(memory_per_full_shot * batch_size)) {
-        batch_size -= W;
-    }
+    size_t batch_size = pick_frame_simulator_batch_size<W>(num_shots, stats.num_qubits, memory_per_full_shot);
 
     // If the batch size ended up at 0, the results won't fit in memory. Need to stream.
     bool streaming = batch_size == 0;
@@ -239,52 +278,61 @@ void sample_batch_detection_events_writing_results_to_disk(
         batch_size = W;
     }
 
-    // Create a correctly sized frame simulator.
-    FrameSimulator<W> frame_sim(
-        stats,
-        streaming ? FrameSimulatorMode::STREAM_DETECTIONS_TO_DISK : FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY,
-        batch_size,
-        std::move(rng));  // Will copy rng state back out later.
-
-    // Run the frame simulator until as many shots as requested have been written.
     simd_bit_table<W> out_concat_buf(0, 0);
     if (append_observables || prepend_observables) {
         out_concat_buf = simd_bit_table<W>(stats.num_detectors + stats.num_observables, batch_size);
     }
+
+    // Batches that fit in memory are independent, and can be spread over multiple threads.
+    if (!streaming) {
+        sample_batches_in_parallel_writing_in_order<W>(
+            program,
+            stats,
+            FrameSimulatorMode::STORE_DETECTIONS_TO_MEMORY,
+            batch_size,
+            num_shots,
+            num_threads,
+            rng,
+            [&](const FrameSimulator<W> &frame_sim, size_t shots_performed) {
+                // Batches are written one at a time, so the concatenation buffer can be shared.
+                write_in_memory_frame_sim_dets_to_disk(
+                    stats,
+                    frame_sim,
+                    out_concat_buf,
+                    shots_performed,
+                    prepend_observables,
+                    append_observables,
+                    out,
+                    format,
+                    obs_out,
+                    obs_out_format);
+            });
+        return;
+    }
+
+    // Create a correctly sized frame simulator. Like the in-memory batches, each streamed batch
+    // draws from its own stream of a generator keyed by `rng`.
+    uint64_t key = rng();
+    FrameSimulator<W> frame_sim(stats, FrameSimulatorMode::STREAM_DETECTIONS_TO_DISK, batch_size, PhiloxRng(key));
+
+    // Run the frame simulator until as many shots as requested have been written.
     size_t shots_left = num_shots;
-    while (shots_left) {
+    for (size_t batch_index = 0; shots_left; batch_index++) {
+        frame_sim.rng = PhiloxRng(key, batch_index);
         size_t shots_performed = std::min(shots_left, batch_size);
-        if (streaming) {
-            rerun_frame_sim_while_streaming_dets_to_disk(
-                circuit,
-                stats,
-                frame_sim,
-                shots_performed,
-                prepend_observables,
-                append_observables,
-                out,
-                format,
-                obs_out,
-                obs_out_format);
-        } else {
-            rerun_frame_sim_in_memory_and_write_dets_to_disk(
-                circuit,
-                stats,
-                frame_sim,
-                out_concat_buf,
-                shots_performed,
-                prepend_observables,
-                append_observables,
-                out,
-                format,
-                obs_out,
-                obs_out_format);
-        }
+        rerun_frame_sim_while_streaming_dets_to_disk(
+            program,
+            stats,
+            frame_sim,
+            shots_performed,
+            prepend_observables,
+            append_observables,
+            out,
+            format,
+            obs_out,
+            obs_out_format);
         shots_left -= shots_performed;
     }
-
-    // Update input rng as if it was used directly, by moving the updated state out of the simulator.
-    rng = std::move(frame_sim.rng);
 }
 
 template <size_t W>
@@ -299,8 +347,6 @@ simd_bit_table<W> sample_batch_measurements(
     sim.reset_all();
     sim.do_circuit(circuit);
     simd_bit_table<W> result = std::move(sim.m_record.storage);
-    rng = std::move(
-        sim.rng);  // Update input rng as if it was used directly, by moving the updated state out of the simulator.
 
     if (reference_sample.not_zero()) {
         result = transposed_vs_ref(num_samples, result, reference_sample);
@@ -321,7 +367,8 @@ void sample_batch_measurements_writing_results_to_disk(
     uint64_t num_shots,
     FILE *out,
     SampleFormat format,
-    std::mt19937_64 &rng) {
+    std::mt19937_64 &rng,
+    size_t num_threads) {
     if (num_shots == 0) {
         // Vacuously complete.
         return;
@@ -329,16 +376,12 @@ void sample_batch_measurements_writing_results_to_disk(
 
     auto stats = circuit.compute_stats();
 
-    // Pick a batch size that's not so large that it would cause memory issues.
-    size_t batch_size = 0;
-    while (batch_size < 1024 && batch_size < num_shots) {
-        batch_size += W;
-    }
+    // Strip out work that doesn't affect the frames once, instead of redoing it for every batch.
+    Circuit program = frame_simulator_program(circuit);
+
+    // Pick a batch size that's cache friendly and not so large that it would cause memory issues.
     uint64_t memory_per_full_shot = 2 * stats.num_qubits + stats.num_measurements;
-    while (batch_size > 0 &&
-           should_use_streaming_because_bit_count_is_too_large_to_store(memory_per_full_shot * batch_size)) {
-        batch_size -= W;
-    }
+    size_t batch_size = pick_frame_simulator_batch_size<W>(num_shots, stats.num_qubits, memory_per_full_shot);
 
     // If the batch size ended up at 0, the results won't fit in memory. Need to stream.
     bool streaming = batch_size == 0;
@@ -346,29 +389,45 @@ void sample_batch_measurements_writing_results_to_disk(
         batch_size = W;
     }
 
-    // Create a correctly sized frame simulator.
-    FrameSimulator<W> frame_sim(
-        circuit.compute_stats(),
-        streaming ? FrameSimulatorMode::STREAM_MEASUREMENTS_TO_DISK : FrameSimulatorMode::STORE_MEASUREMENTS_TO_MEMORY,
-        batch_size,
-        std::move(rng));  // Temporarily move rng into simulator.
+    // Batches that fit in memory are independent, and can be spread over multiple threads.
+    if (!streaming) {
+        sample_batches_in_parallel_writing_in_order<W>(
+            program,
+            stats,
+            FrameSimulatorMode::STORE_MEASUREMENTS_TO_MEMORY,
+            batch_size,
+            num_shots,
+            num_threads,
+            rng,
+            [&](const FrameSimulator<W> &frame_sim, size_t shots_performed) {
+                write_table_data(
+                    out,
+                    shots_performed,
+                    stats.num_measurements,
+                    reference_sample,
+                    frame_sim.m_record.storage,
+                    format,
+                    'M',
+                    'M',
+                    0);
+            });
+        return;
+    }
+
+    // Create a correctly sized frame simulator. Like the in-memory batches, each streamed batch
+    // draws from its own stream of a generator keyed by `rng`.
+    uint64_t key = rng();
+    FrameSimulator<W> frame_sim(stats, FrameSimulatorMode::STREAM_MEASUREMENTS_TO_DISK, batch_size, PhiloxRng(key));
 
     // Run the frame simulator until as many shots as requested have been written.
     size_t shots_left = num_shots;
-    while (shots_left) {
+    for (size_t batch_index = 0; shots_left; batch_index++) {
+        frame_sim.rng = PhiloxRng(key, batch_index);
         size_t shots_performed = std::min(shots_left, batch_size);
-        if (streaming) {
-            rerun_frame_sim_while_streaming_measurements_to_disk(
-                circuit, frame_sim, reference_sample, shots_performed, out, format);
-        } else {
-            rerun_frame_sim_in_memory_and_write_measurements_to_disk(
-                circuit, stats, frame_sim, reference_sample, shots_performed, out, format);
-        }
+        rerun_frame_sim_while_streaming_measurements_to_disk(
+            program, frame_sim, reference_sample, shots_performed, out, format);
         shots_left -= shots_performed;
     }
-
-    // Update input rng as if it was used directly, by moving the updated state out of the simulator.
-    rng = std::move(frame_sim.rng);
 }
 
 }  // namespace stim
@@ -18,6 +18,7 @@
 
 #include "stim/mem/simd_word.test.h"
 #include "stim/simulators/frame_simulator.h"
+#include "stim/simulators/tableau_simulator.h"
 #include "stim/util_bot/test_util.test.h"
 
 using namespace stim;
@@ -47,6 +48,39 @@ TEST_EACH_WORD_SIZE_W(DetectionSimulator, bad_detector, {
     ASSERT_THROW({ sample_test_detection_events<W>(Circuit("rec[-1]"), 5); }, std::invalid_argument);
 })
 
+TEST_EACH_WORD_SIZE_W(DetectionSimulator, sample_batch_detection_events_sparse, {
+    auto circuit = Circuit(R"circuit(
+        X_ERROR(0.1) 0 1 2
+        M 0 1 2
+        DETECTOR rec[-3]
+        DETECTOR rec[-2]
+        DETECTOR rec[-1]
+        OBSERVABLE_INCLUDE(0) rec[-1]
+        OBSERVABLE_INCLUDE(3) rec[-2]
+    )circuit");
+    auto rng1 = INDEPENDENT_TEST_RNG();
+    auto rng2 = rng1;
+    auto dense = sample_batch_detection_events<W>(circuit, 1000, rng1);
+    auto sparse = sample_batch_detection_events_sparse<W>(circuit, 1000, rng2);
+
+    ASSERT_EQ(sparse.size(), 1000);
+    size_t total_hits = 0;
+    for (size_t s = 0; s < 1000; s++) {
+        std::vector<uint64_t> expected_hits;
+        for (size_t d = 0; d < 3; d++) {
+            if (dense.first[d][s]) {
+                expected_hits.push_back(d);
+            }
+        }
+        ASSERT_EQ(sparse[s].hits, expected_hits);
+        ASSERT_EQ(sparse[s].obs_mask.num_bits_padded(), 64);
+        ASSERT_EQ(sparse[s].obs_mask_as_u64(), (uint64_t)dense.second[0][s] | ((uint64_t)dense.second[3][s] << 3));
+        total_hits += expected_hits.size();
+    }
+    ASSERT_GT(total_hits, 100);
+    ASSERT_LT(total_hits, 500);
+})
+
 TEST_EACH_WORD_SIZE_W(DetectionSimulator, sample_batch_detection_events_writing_results_to_disk, {
     auto rng = INDEPENDENT_TEST_RNG();
     auto circuit = Circuit(R"circuit(
@@ -189,6 +223,30 @@ TEST_EACH_WORD_SIZE_W(DetectionSimulator, stream_results, {
     ASSERT_EQ(result[30000], '\n');
 })
 
+TEST_EACH_WORD_SIZE_W(DetectionSimulator, stream_results_ptb64, {
+    auto rng = INDEPENDENT_TEST_RNG();
+    DebugForceResultStreamingRaii force_streaming;
+    auto circuit = Circuit(R"circuit(
+        REPEAT 1000 {
+            M 0
+            X 0
+        }
+    )circuit");
+    auto ref = TableauSimulator<W>::reference_sample_circuit(circuit);
+
+    RaiiTempNamedFile tmp;
+    FILE *f = fopen(tmp.path.c_str(), "wb");
+    sample_batch_measurements_writing_results_to_disk<W>(circuit, ref, 128, f, SampleFormat::SAMPLE_FORMAT_PTB64, rng);
+    fclose(f);
+
+    auto result = tmp.read_contents();
+    ASSERT_EQ(result.size(), 1000 * 16);
+    for (size_t k = 0; k < result.size(); k++) {
+        size_t m = (k % 8000) / 8;
+        ASSERT_EQ((uint8_t)result[k], m % 2 ? 0xFF : 0x00) << k;
+    }
+})
+
 TEST_EACH_WORD_SIZE_W(DetectionSimulator, stream_results_triple_shot, {
     auto rng = INDEPENDENT_TEST_RNG();
     DebugForceResultStreamingRaii force_streaming;
@@ -472,3 +530,120 @@ TEST_EACH_WORD_SIZE_W(DetectionSimulator, obs_data, {
         ASSERT_EQ(obs_saved[k], 0x3);
     }
 })
+
+TEST_EACH_WORD_SIZE_W(DetectionSimulator, threaded_sampling_matches_single_threaded_sampling, {
+    auto circuit = Circuit(R"circuit(
+        X_ERROR(1) 1
+        X_ERROR(0.1) 2
+        M 0 1 2
+        DETECTOR rec[-1]
+        DETECTOR rec[-2]
+        OBSERVABLE_INCLUDE(0) rec[-3]
+    )circuit");
+
+    auto sample_with_threads = [&](size_t num_threads) {
+        std::mt19937_64 rng(5);
+        FILE *det_tmp = tmpfile();
+        FILE *obs_tmp = tmpfile();
+        sample_batch_detection_events_writing_results_to_disk<W>(
+            circuit,
+            5001,
+            false,
+            false,
+            det_tmp,
+            SampleFormat::SAMPLE_FORMAT_01,
+            rng,
+            obs_tmp,
+            SampleFormat::SAMPLE_FORMAT_01,
+            num_threads);
+        return std::pair<std::string, std::string>{rewind_read_close(det_tmp), rewind_read_close(obs_tmp)};
+    };
+
+    auto result1 = sample_with_threads(1);
+    auto result2 = sample_with_threads(2);
+    auto result5 = sample_with_threads(5);
+    ASSERT_EQ(result1, result2);
+    ASSERT_EQ(result2, result5);
+    ASSERT_EQ(result2.first.size(), 5001 * 3);
+    size_t hits = 0;
+    for (size_t k = 0; k < 5001 * 3; k += 3) {
+        ASSERT_EQ(result2.first[k + 1], '1') << k;
+        ASSERT_EQ(result2.first[k + 2], '\n') << k;
+        hits += result2.first[k] == '1';
+    }
+    ASSERT_TRUE(350 < hits && hits < 650) << hits;
+    for (size_t k = 0; k < 5001 * 2; k += 2) {
+        ASSERT_EQ(result2.second[k], '0') << k;
+        ASSERT_EQ(result2.second[k + 1], '\n') << k;
+    }
+
+    std::mt19937_64 rng(5);
+    FILE *tmp = tmpfile();
+    ASSERT_THROW(
+        {
+            sample_batch_detection_events_writing_results_to_disk<W>(
+                circuit,
+                5001,
+                true,
+                true,
+                tmp,
+                SampleFormat::SAMPLE_FORMAT_01,
+                rng,
+                nullptr,
+                SampleFormat::SAMPLE_FORMAT_01,
+                3);
+        },
+        std::out_of_range);
+    fclose(tmp);
+})
+
+TEST_EACH_WORD_SIZE_W(MeasurementSimulator, threaded_sampling_matches_single_threaded_sampling, {
+    auto circuit = Circuit(R"circuit(
+        X 1
+        X_ERROR(0.1) 0
+        M 0 1
+    )circuit");
+    simd_bits<W> ref(2);
+    ref[1] = true;
+
+    auto sample_with_threads = [&](size_t num_threads) {
+        std::mt19937_64 rng(5);
+        FILE *tmp = tmpfile();
+        sample_batch_measurements_writing_results_to_disk<W>(
+            circuit, ref, 5001, tmp, SampleFormat::SAMPLE_FORMAT_01, rng, num_threads);
+        return rewind_read_close(tmp);
+    };
+
+    auto result1 = sample_with_threads(1);
+    auto result2 = sample_with_threads(2);
+    auto result3 = sample_with_threads(3);
+    ASSERT_EQ(result1, result2);
+    ASSERT_EQ(result2, result3);
+    ASSERT_EQ(result2.size(), 5001 * 3);
+    size_t hits = 0;
+    for (size_t k = 0; k < 5001 * 3; k += 3) {
+        ASSERT_EQ(result2[k + 1], '1') << k;
+        ASSERT_EQ(result2[k + 2], '\n') << k;
+        hits += result2[k] == '1';
+    }
+    ASSERT_TRUE(350 < hits && hits < 650) << hits;
+})
+
+TEST_EACH_WORD_SIZE_W(FrameSimulatorUtil, pick_frame_simulator_batch_size, {
+    constexpr size_t min_tile = W < 256 ? 256 : W;
+
+    // Small circuits use the full batch size.
+    ASSERT_EQ(pick_frame_simulator_batch_size<W>(1, 10, 100), W);
+    ASSERT_EQ(pick_frame_simulator_batch_size<W>(W + 1, 10, 100), 2 * W);
+    ASSERT_EQ(pick_frame_simulator_batch_size<W>(100000, 10, 100), 1024);
+
+    // Wide circuits tile the shots so the frame tables fit in cache.
+    ASSERT_EQ(pick_frame_simulator_batch_size<W>(100000, 2000, 5000), 512);
+    ASSERT_EQ(pick_frame_simulator_batch_size<W>(100000, 100000, 300000), min_tile);
+    ASSERT_EQ(pick_frame_simulator_batch_size<W>(W, 100000, 300000), W);
+
+    // Results that don't fit in memory have to be streamed.
+    ASSERT_EQ(pick_frame_simulator_batch_size<W>(100000, 10, uint64_t{1} << 40), 0);
+    DebugForceResultStreamingRaii force_streaming;
+    ASSERT_EQ(pick_frame_simulator_batch_size<W>(100000, 10, 100), 0);
+})
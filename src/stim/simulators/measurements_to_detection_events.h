@@ -47,6 +47,11 @@ namespace stim {
 ///         all-zeroes instead of being collected from the circuit. This should probably only be done if you know the
 ///         all-zero sample is a valid sample, or if you know that the measurements were generated by a frame simulator
 ///         that was also incorrectly assuming an all-zero reference sample.
+///     obs_out: An optional secondary file to write observable flip data to. Set to nullptr to not use.
+///     obs_out_format: The format to use when writing to the secondary file.
+///     num_threads: How many threads to spread the conversion over. Batches of shots are still read and written
+///         one at a time and in order, so the output doesn't depend on the number of threads. Each thread holds one
+///         batch at a time. Defaults to 1 (convert on the calling thread).
 template <size_t W>
 void stream_measurements_to_detection_events(
     FILE *measurements_in,
@@ -59,7 +64,8 @@ void stream_measurements_to_detection_events(
     bool append_observables,
     bool skip_reference_sample,
     FILE *obs_out,
-    SampleFormat obs_out_format);
+    SampleFormat obs_out_format,
+    size_t num_threads = 1);
 
 /// A variant of `stim::stream_measurements_to_detection_events` with derived values passed in, not recomputed.
 template <size_t W>
@@ -75,7 +81,8 @@ void stream_measurements_to_detection_events_helper(
     bool append_observables,
     simd_bits_range_ref<W> reference_sample,
     FILE *obs_out,
-    SampleFormat obs_out_format);
+    SampleFormat obs_out_format,
+    size_t num_threads = 1);
 
 /// Converts measurement data into detection event data based on a circuit.
 ///
@@ -109,6 +116,9 @@ simd_bit_table<W> measurements_to_detection_events(
     bool skip_reference_sample);
 
 /// A variant of `stim::measurements_to_detection_events` with derived values passed in, not recomputed.
+///
+/// The detection event data is xor'd into `out_detection_results__minor_shot_index`. When `num_threads` is more than
+/// 1, large inputs are split into ranges of shots that are converted concurrently.
 template <size_t W>
 void measurements_to_detection_events_helper(
     const simd_bit_table<W> &measurements__minor_shot_index,
@@ -117,7 +127,8 @@ void measurements_to_detection_events_helper(
     const Circuit &noiseless_circuit,
     CircuitStats circuit_stats,
     const simd_bits<W> &reference_sample,
-    bool append_observables);
+    bool append_observables,
+    size_t num_threads = 1);
 
 }  // namespace stim
 
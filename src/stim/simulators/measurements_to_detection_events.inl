@@ -23,6 +23,7 @@
 #include "stim/simulators/measurements_to_detection_events.h"
 #include "stim/simulators/tableau_simulator.h"
 #include "stim/stabilizers/pauli_string.h"
+#include "stim/util_bot/parallel_batches.h"
 
 namespace stim {
 
@@ -34,7 +35,8 @@ void measurements_to_detection_events_helper(
     const Circuit &noiseless_circuit,
     CircuitStats circuit_stats,
     const simd_bits<W> &reference_sample,
-    bool append_observables) {
+    bool append_observables,
+    size_t num_threads) {
     // Tables should agree on the batch size.
     size_t batch_size = out_detection_results__minor_shot_index.num_minor_bits_padded();
     if (measurements__minor_shot_index.num_minor_bits_padded() != batch_size) {
@@ -54,11 +56,69 @@ void measurements_to_detection_events_helper(
         throw std::invalid_argument("measurements__minor_shot_index.num_major_bits_padded() < num_measurements");
     }
 
+    // Large inputs are split into word aligned ranges of shots, which are converted independently on several threads.
+    constexpr size_t PARALLEL_SHOT_RANGE_SIZE = 1024;
+    if (num_threads > 1 && batch_size > PARALLEL_SHOT_RANGE_SIZE) {
+        struct ShotRange {
+            simd_bit_table<W> measurements;
+            simd_bit_table<W> sweep_bits;
+            simd_bit_table<W> out;
+        };
+        auto copy_words = [](const simd_bit_table<W> &src,
+                             size_t src_word,
+                             simd_bit_table<W> &dst,
+                             size_t dst_word,
+                             size_t num_words) {
+            for (size_t k = 0; k < dst.num_major_bits_padded(); k++) {
+                dst[k].word_range_ref(dst_word, num_words) = src[k].word_range_ref(src_word, num_words);
+            }
+        };
+        size_t num_ranges = (batch_size + PARALLEL_SHOT_RANGE_SIZE - 1) / PARALLEL_SHOT_RANGE_SIZE;
+        process_batches_in_parallel_in_order(
+            num_ranges,
+            num_threads,
+            []() {
+                return ShotRange{simd_bit_table<W>(0, 0), simd_bit_table<W>(0, 0), simd_bit_table<W>(0, 0)};
+            },
+            [](ShotRange &, size_t) {
+            },
+            [&](ShotRange &range, size_t range_index) {
+                size_t start_shot = range_index * PARALLEL_SHOT_RANGE_SIZE;
+                size_t num_shots = std::min(PARALLEL_SHOT_RANGE_SIZE, batch_size - start_shot);
+                if (range.out.num_minor_bits_padded() != num_shots) {
+                    range.measurements =
+                        simd_bit_table<W>(measurements__minor_shot_index.num_major_bits_padded(), num_shots);
+                    range.sweep_bits =
+                        simd_bit_table<W>(sweep_bits__minor_shot_index.num_major_bits_padded(), num_shots);
+                    range.out =
+                        simd_bit_table<W>(out_detection_results__minor_shot_index.num_major_bits_padded(), num_shots);
+                }
+                size_t start_word = start_shot / W;
+                size_t num_words = num_shots / W;
+                copy_words(measurements__minor_shot_index, start_word, range.measurements, 0, num_words);
+                copy_words(sweep_bits__minor_shot_index, start_word, range.sweep_bits, 0, num_words);
+                copy_words(out_detection_results__minor_shot_index, start_word, range.out, 0, num_words);
+                measurements_to_detection_events_helper<W>(
+                    range.measurements,
+                    range.sweep_bits,
+                    range.out,
+                    noiseless_circuit,
+                    circuit_stats,
+                    reference_sample,
+                    append_observables);
+                // The ranges cover disjoint words of the output, so they can be copied back concurrently.
+                copy_words(range.out, 0, out_detection_results__minor_shot_index, start_word, num_words);
+            },
+            [](ShotRange &, size_t) {
+            });
+        return;
+    }
+
     // The frame simulator is used to account for flips in the measurement results that originate from the sweep data.
     // Eg. a `CNOT sweep[5] 0` can bit flip qubit 0, which can invert later measurement results, which will invert the
     // expected parity of detectors involving that measurement. This can vary from shot to shot.
     FrameSimulator<W> frame_sim(
-        circuit_stats, FrameSimulatorMode::STREAM_DETECTIONS_TO_DISK, batch_size, std::mt19937_64(0));
+        circuit_stats, FrameSimulatorMode::STREAM_DETECTIONS_TO_DISK, batch_size, PhiloxRng(0));
     frame_sim.sweep_table = sweep_bits__minor_shot_index;
     frame_sim.guarantee_anticommutation_via_frame_randomization = false;
 
@@ -124,8 +184,7 @@ void measurements_to_detection_events_helper(
     }
 
     // Safety check verifying no randomness was used by the frame simulator.
-    std::mt19937_64 fresh_rng(0);
-    if (frame_sim.rng() != fresh_rng() || frame_sim.rng() != fresh_rng() || frame_sim.rng() != fresh_rng()) {
+    if (frame_sim.rng.position != 0) {
         throw std::invalid_argument("Something is wrong. Converting measurements consumed entropy, but it shouldn't.");
     }
 }
@@ -168,7 +227,8 @@ void stream_measurements_to_detection_events(
     bool append_observables,
     bool skip_reference_sample,
     FILE *obs_out,
-    SampleFormat obs_out_format) {
+    SampleFormat obs_out_format,
+    size_t num_threads) {
     // Circuit metadata.
     CircuitStats circuit_stats = circuit.compute_stats();
     simd_bits<W> reference_sample(circuit_stats.num_measurements);
@@ -189,7 +249,8 @@ void stream_measurements_to_detection_events(
         append_observables,
         reference_sample,
         obs_out,
-        obs_out_format);
+        obs_out_format,
+        num_threads);
 }
 
 template <size_t W>
@@ -205,7 +266,8 @@ void stream_measurements_to_detection_events_helper(
     bool append_observables,
     simd_bits_range_ref<W> reference_sample,
     FILE *obs_out,
-    SampleFormat obs_out_format) {
+    SampleFormat obs_out_format,
+    size_t num_threads) {
     bool internally_append_observables = append_observables || obs_out != nullptr;
     size_t num_out_bits_including_any_obs =
         circuit_stats.num_detectors + circuit_stats.num_observables * internally_append_observables;
@@ -225,75 +287,94 @@ void stream_measurements_to_detection_events_helper(
             MeasureRecordReader<W>::make(optional_sweep_bits_in, sweep_bits_in_format, circuit_stats.num_sweep_bits);
     }
 
-    // Buffers and transposed buffers.
-    simd_bit_table<W> measurements__minor_shot_index(circuit_stats.num_measurements, num_buffered_shots);
-    simd_bit_table<W> out__minor_shot_index(num_out_bits_including_any_obs, num_buffered_shots);
-    simd_bit_table<W> out__major_shot_index(num_buffered_shots, num_out_bits_including_any_obs);
-    simd_bit_table<W> sweep_bits__minor_shot_index(num_sweep_bits_available, num_buffered_shots);
     if (reader->expects_empty_serialized_data_for_each_shot()) {
         throw std::invalid_argument(
             "Can't tell how many shots are in the measurement data.\n"
             "The circuit has no measurements and the measurement format encodes empty shots into no bytes.");
     }
 
-    // Data streaming loop.
+    // Each thread owns one batch of buffers. Reading and writing are serialized and ordered, and only the conversion
+    // runs concurrently, so there are at most `num_threads` batches in flight at any time.
+    struct Batch {
+        simd_bit_table<W> measurements__minor_shot_index;
+        simd_bit_table<W> sweep_bits__minor_shot_index;
+        simd_bit_table<W> out__minor_shot_index;
+        simd_bit_table<W> out__major_shot_index;
+        size_t record_count;
+    };
+
     size_t total_read = 0;
-    while (true) {
-        // Read measurement data and sweep data for a batch of shots.
-        size_t record_count = reader->read_records_into(measurements__minor_shot_index, false);
-        if (sweep_data_reader != nullptr) {
-            size_t sweep_data_count = sweep_data_reader->read_records_into(sweep_bits__minor_shot_index, false);
-            if (sweep_data_count != record_count && !sweep_data_reader->expects_empty_serialized_data_for_each_shot()) {
-                std::stringstream ss;
-                ss << "The sweep data contained a different number of shots than the measurement data.\n";
-                ss << "There was " << (record_count + total_read) << " shot records total.\n";
-                if (sweep_data_count < record_count) {
-                    ss << "But there was " << (record_count + sweep_data_count) << " sweep records total.";
-                } else {
-                    ss << "But there was at least " << (record_count + sweep_data_count) << " sweep records.";
+    process_batches_in_parallel_in_order(
+        SIZE_MAX,
+        num_threads,
+        [&]() {
+            return Batch{
+                simd_bit_table<W>(circuit_stats.num_measurements, num_buffered_shots),
+                simd_bit_table<W>(num_sweep_bits_available, num_buffered_shots),
+                simd_bit_table<W>(num_out_bits_including_any_obs, num_buffered_shots),
+                simd_bit_table<W>(num_buffered_shots, num_out_bits_including_any_obs),
+                0,
+            };
+        },
+        [&](Batch &batch, size_t) {
+            // Read measurement data and sweep data for a batch of shots.
+            batch.record_count = reader->read_records_into(batch.measurements__minor_shot_index, false);
+            if (sweep_data_reader != nullptr) {
+                size_t sweep_data_count =
+                    sweep_data_reader->read_records_into(batch.sweep_bits__minor_shot_index, false);
+                if (sweep_data_count != batch.record_count &&
+                    !sweep_data_reader->expects_empty_serialized_data_for_each_shot()) {
+                    std::stringstream ss;
+                    ss << "The sweep data contained a different number of shots than the measurement data.\n";
+                    ss << "There was " << (batch.record_count + total_read) << " shot records total.\n";
+                    if (sweep_data_count < batch.record_count) {
+                        ss << "But there was " << (batch.record_count + sweep_data_count) << " sweep records total.";
+                    } else {
+                        ss << "But there was at least " << (batch.record_count + sweep_data_count)
+                           << " sweep records.";
+                    }
+                    throw std::invalid_argument(ss.str());
                 }
-                throw std::invalid_argument(ss.str());
             }
-        }
-        if (record_count == 0) {
-            break;
-        }
-        total_read += record_count;
-
-        // Convert measurement data into detection event data.
-        out__minor_shot_index.clear();
-        measurements_to_detection_events_helper<W>(
-            measurements__minor_shot_index,
-            sweep_bits__minor_shot_index,
-            out__minor_shot_index,
-            noiseless_circuit,
-            circuit_stats,
-            reference_sample,
-            internally_append_observables);
-        out__minor_shot_index.transpose_into(out__major_shot_index);
-
-        // Write detection event data.
-        for (size_t k = 0; k < record_count; k++) {
-            simd_bits_range_ref<W> record = out__major_shot_index[k];
-            writer->begin_result_type('D');
-            writer->write_bits(record.u8, circuit_stats.num_detectors);
-            if (append_observables) {
-                writer->begin_result_type('L');
-                for (size_t k2 = 0; k2 < circuit_stats.num_observables; k2++) {
-                    writer->write_bit(record[circuit_stats.num_detectors + k2]);
+            total_read += batch.record_count;
+            return batch.record_count > 0;
+        },
+        [&](Batch &batch, size_t) {
+            // Convert measurement data into detection event data.
+            batch.out__minor_shot_index.clear();
+            measurements_to_detection_events_helper<W>(
+                batch.measurements__minor_shot_index,
+                batch.sweep_bits__minor_shot_index,
+                batch.out__minor_shot_index,
+                noiseless_circuit,
+                circuit_stats,
+                reference_sample,
+                internally_append_observables);
+            batch.out__minor_shot_index.transpose_into(batch.out__major_shot_index);
+        },
+        [&](Batch &batch, size_t) {
+            // Write detection event data.
+            for (size_t k = 0; k < batch.record_count; k++) {
+                simd_bits_range_ref<W> record = batch.out__major_shot_index[k];
+                writer->begin_result_type('D');
+                writer->write_bits(record.u8, circuit_stats.num_detectors);
+                if (append_observables) {
+                    writer->begin_result_type('L');
+                    for (size_t k2 = 0; k2 < circuit_stats.num_observables; k2++) {
+                        writer->write_bit(record[circuit_stats.num_detectors + k2]);
+                    }
                 }
-            }
-            writer->write_end();
+                writer->write_end();
 
-            if (obs_out != nullptr) {
-                obs_writer->begin_result_type('L');
-                for (size_t k2 = 0; k2 < circuit_stats.num_observables; k2++) {
-                    obs_writer->write_bit(record[circuit_stats.num_detectors + k2]);
+                if (obs_out != nullptr) {
+                    obs_writer->begin_result_type('L');
+                    for (size_t k2 = 0; k2 < circuit_stats.num_observables; k2++) {
+                        obs_writer->write_bit(record[circuit_stats.num_detectors + k2]);
+                    }
+                    obs_writer->write_end();
                 }
-                obs_writer->write_end();
             }
-        }
-    }
+        });
 }
 
 }  // namespace stim
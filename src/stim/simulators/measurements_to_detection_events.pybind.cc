@@ -51,7 +51,11 @@ void CompiledMeasurementsToDetectionEventsConverter::convert_file(
     std::string_view detection_events_format,
     bool append_observables,
     const char *obs_out_filepath,
-    std::string_view obs_out_format) {
+    std::string_view obs_out_format,
+    size_t num_threads) {
+    if (num_threads == 0) {
+        throw std::invalid_argument("num_threads must be at least 1.");
+    }
     auto format_in = format_to_enum(measurements_format);
     auto format_sweep_bits = format_to_enum(sweep_bits_format);
     auto format_out = format_to_enum(detection_events_format);
@@ -61,6 +65,9 @@ void CompiledMeasurementsToDetectionEventsConverter::convert_file(
     RaiiFile detections_out(detection_events_filepath, "wb");
     auto parsed_obs_out_format = format_to_enum(obs_out_format);
 
+    // The converter's members are const, and each conversion makes its own simulator, so concurrent
+    // calls from other python threads can't interfere with this one.
+    pybind11::gil_scoped_release release;
     stream_measurements_to_detection_events_helper<MAX_BITWORD_WIDTH>(
         file_in.f,
         format_in,
@@ -73,7 +80,8 @@ void CompiledMeasurementsToDetectionEventsConverter::convert_file(
         append_observables,
         ref_sample,
         obs_out.f,
-        parsed_obs_out_format);
+        parsed_obs_out_format,
+        num_threads);
 }
 
 pybind11::object CompiledMeasurementsToDetectionEventsConverter::convert(
@@ -82,8 +90,12 @@ pybind11::object CompiledMeasurementsToDetectionEventsConverter::convert(
     const pybind11::object &separate_observables_obj,
     const pybind11::object &append_observables_obj,
     bool bit_pack_result_old_compat,
-    bool bit_pack_result) {
+    bool bit_pack_result,
+    size_t num_threads) {
     bit_pack_result |= bit_pack_result_old_compat;
+    if (num_threads == 0) {
+        throw std::invalid_argument("num_threads must be at least 1.");
+    }
 
     if (separate_observables_obj.is_none() && append_observables_obj.is_none()) {
         throw std::invalid_argument(
@@ -109,31 +121,26 @@ pybind11::object CompiledMeasurementsToDetectionEventsConverter::convert(
     size_t num_intermediate_bits =
         circuit_stats.num_detectors + circuit_stats.num_observables * (append_observables || separate_observables);
     simd_bit_table<MAX_BITWORD_WIDTH> out_detection_results_minor_shot_index(num_intermediate_bits, num_shots);
-    stim::measurements_to_detection_events_helper(
-        measurements_minor_shot_index,
-        sweep_bits_minor_shot_index,
-        out_detection_results_minor_shot_index,
-        circuit.aliased_noiseless_circuit(),
-        circuit_stats,
-        ref_sample,
-        append_observables || separate_observables);
+    {
+        pybind11::gil_scoped_release release;
+        stim::measurements_to_detection_events_helper(
+            measurements_minor_shot_index,
+            sweep_bits_minor_shot_index,
+            out_detection_results_minor_shot_index,
+            circuit.aliased_noiseless_circuit(),
+            circuit_stats,
+            ref_sample,
+            append_observables || separate_observables,
+            num_threads);
+    }
 
     size_t num_output_bits = circuit_stats.num_detectors + circuit_stats.num_observables * append_observables;
     pybind11::object obs_data = pybind11::none();
     if (separate_observables) {
-        simd_bit_table<MAX_BITWORD_WIDTH> obs_table(circuit_stats.num_observables, num_shots);
-        for (size_t obs = 0; obs < circuit_stats.num_observables; obs++) {
-            auto obs_slice = out_detection_results_minor_shot_index[circuit_stats.num_detectors + obs];
-            obs_table[obs] = obs_slice;
-            if (!append_observables) {
-                obs_slice.clear();
-            }
-        }
-        obs_data = simd_bit_table_to_numpy(
-            obs_table, circuit_stats.num_observables, num_shots, bit_pack_result, true, pybind11::none());
+        SimdBitTableRows obs_rows{
+            out_detection_results_minor_shot_index, circuit_stats.num_detectors, circuit_stats.num_observables};
+        obs_data = transposed_simd_bit_table_rows_to_numpy({&obs_rows, 1}, num_shots, bit_pack_result, pybind11::none());
     }
-
-    // Caution: only do this after extracting the observable data, lest it leak into the packed bytes.
     pybind11::object det_data = simd_bit_table_to_numpy(
         out_detection_results_minor_shot_index, num_output_bits, num_shots, bit_pack_result, true, pybind11::none());
 
@@ -220,18 +227,19 @@ void stim_pybind::pybind_compiled_measurements_to_detection_events_converter_met
         pybind11::arg("append_observables") = false,
         pybind11::arg("obs_out_filepath") = nullptr,
         pybind11::arg("obs_out_format") = "01",
+        pybind11::arg("num_threads") = 1,
         clean_doc_string(R"DOC(
-            @signature def convert_file(self, *, measurements_filepath: Union[str, pathlib.Path], measurements_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01', sweep_bits_filepath: Optional[Union[str, pathlib.Path]] = None, sweep_bits_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01', detection_events_filepath: Union[str, pathlib.Path], detection_events_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01', append_observables: bool = False, obs_out_filepath: Optional[Union[str, pathlib.Path]] = None, obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets"] = '01') -> None:
+            @signature def convert_file(self, *, measurements_filepath: Union[str, pathlib.Path], measurements_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', sweep_bits_filepath: Optional[Union[str, pathlib.Path]] = None, sweep_bits_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', detection_events_filepath: Union[str, pathlib.Path], detection_events_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', append_observables: bool = False, obs_out_filepath: Optional[Union[str, pathlib.Path]] = None, obs_out_format: Literal["01", "b8", "r8", "ptb64", "hits", "dets", "stbc"] = '01', num_threads: int = 1) -> None:
             Reads measurement data from a file and writes detection events to another file.
 
             Args:
                 measurements_filepath: A file containing measurement data to be converted.
                 measurements_format: The format the measurement data is stored in.
-                    Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                    Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                     Defaults to "01".
                 detection_events_filepath: Where to save detection event data to.
                 detection_events_format: The format to save the detection event data in.
-                    Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                    Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                     Defaults to "01".
                 sweep_bits_filepath: Defaults to None. A file containing sweep data, or
                     None. When specified, sweep data (used for `sweep[k]` controls in the
@@ -239,19 +247,23 @@ void stim_pybind::pybind_compiled_measurements_to_detection_events_converter_met
                     file. When not specified, all sweep bits default to False and no
                     sweep-controlled operations occur.
                 sweep_bits_format: The format the sweep data is stored in.
-                    Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                    Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                     Defaults to "01".
                 obs_out_filepath: Sample observables as part of each shot, and write them to
                     this file. This keeps the observable data separate from the detector
                     data.
                 obs_out_format: If writing the observables to a file, this is the format to
                     write them in.
-                    Valid values are "01", "b8", "r8", "hits", "dets", and "ptb64".
+                    Valid values are "01", "b8", "r8", "hits", "dets", "ptb64", and "stbc".
                     Defaults to "01".
                 append_observables: When True, the observables in the circuit are included
                     as part of the detection event data. Specifically, they are treated as
                     if they were additional detectors at the end of the circuit. When False,
                     observable data is not output.
+                num_threads: Defaults to 1. The number of threads to spread the conversion
+                    over. Batches of shots are converted concurrently, while the files are
+                    still read and written in order. The output doesn't depend on the number
+                    of threads.
 
             Examples:
                 >>> import stim
@@ -287,11 +299,12 @@ void stim_pybind::pybind_compiled_measurements_to_detection_events_converter_met
         pybind11::arg("append_observables") = pybind11::none(),
         pybind11::arg("bit_packed") = false,
         pybind11::arg("bit_pack_result") = false,  // deprecated variant
+        pybind11::arg("num_threads") = 1,
         clean_doc_string(R"DOC(
             Converts measurement data into detection event data.
-            @overload def convert(self, *, measurements: np.ndarray, sweep_bits: Optional[np.ndarray] = None, append_observables: bool = False, bit_packed: bool = False) -> np.ndarray:
-            @overload def convert(self, *, measurements: np.ndarray, sweep_bits: Optional[np.ndarray] = None, separate_observables: Literal[True], append_observables: bool = False, bit_packed: bool = False) -> Tuple[np.ndarray, np.ndarray]:
-            @signature def convert(self, *, measurements: np.ndarray, sweep_bits: Optional[np.ndarray] = None, separate_observables: bool = False, append_observables: bool = False, bit_packed: bool = False) -> Union[np.ndarray, Tuple[np.ndarray, np.ndarray]]:
+            @overload def convert(self, *, measurements: np.ndarray, sweep_bits: Optional[np.ndarray] = None, append_observables: bool = False, bit_packed: bool = False, num_threads: int = 1) -> np.ndarray:
+            @overload def convert(self, *, measurements: np.ndarray, sweep_bits: Optional[np.ndarray] = None, separate_observables: Literal[True], append_observables: bool = False, bit_packed: bool = False, num_threads: int = 1) -> Tuple[np.ndarray, np.ndarray]:
+            @signature def convert(self, *, measurements: np.ndarray, sweep_bits: Optional[np.ndarray] = None, separate_observables: bool = False, append_observables: bool = False, bit_packed: bool = False, num_threads: int = 1) -> Union[np.ndarray, Tuple[np.ndarray, np.ndarray]]:
 
             Args:
                 measurements: A numpy array containing measurement data.
@@ -318,6 +331,9 @@ void stim_pybind::pybind_compiled_measurements_to_detection_events_converter_met
                 bit_packed: Defaults to False. When set to True, the returned numpy
                     array contains bit packed data (dtype=np.uint8 with 8 bits per item)
                     instead of unpacked data (dtype=np.bool_).
+                num_threads: Defaults to 1. The number of threads to spread the conversion
+                    over. Large inputs are split into ranges of shots that are converted
+                    concurrently. The result doesn't depend on the number of threads.
 
             Returns:
                 The detection event data and (optionally) observable data. The result is a
@@ -43,7 +43,8 @@ struct CompiledMeasurementsToDetectionEventsConverter {
         const pybind11::object &separate_observables,
         const pybind11::object &append_observables,
         bool bit_pack_result_old_compat,
-        bool bit_pack_result);
+        bool bit_pack_result,
+        size_t num_threads);
     void convert_file(
         std::string_view measurements_filepath,
         std::string_view measurements_format,
@@ -53,7 +54,8 @@ struct CompiledMeasurementsToDetectionEventsConverter {
         std::string_view detection_events_format,
         bool append_observables,
         const char *obs_out_filepath,
-        std::string_view obs_out_format);
+        std::string_view obs_out_format,
+        size_t num_threads);
 
     std::string repr() const;
 };
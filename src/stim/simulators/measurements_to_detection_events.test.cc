@@ -215,6 +215,8 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, sweep_data, {
 })
 
 TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, empty_cases, {
+    // Tables round their shot count up to a whole number of words.
+    size_t num_shots_padded = std::max(W, size_t{256});
     simd_bit_table<W> measurement_data(256, 256);
     simd_bit_table<W> converted(256, 256);
     simd_bit_table<W> sweep_data(0, 256);
@@ -227,7 +229,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, empty_cases, {
         false,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), 0);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), num_shots_padded);
 
     converted = measurements_to_detection_events(
         measurement_data,
@@ -239,7 +241,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, empty_cases, {
         false,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), 0);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), num_shots_padded);
 })
 
 TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, big_shots, {
@@ -270,6 +272,8 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, big_shots, {
 })
 
 TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, big_data, {
+    // Tables round their shot count up to a whole number of words.
+    size_t num_shots_padded = std::max(W, size_t{256});
     simd_bit_table<W> measurement_data(512, 256);
     simd_bit_table<W> converted(512, 256);
     simd_bit_table<W> sweep_data(0, 256);
@@ -287,16 +291,18 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, big_data, {
         false,
         false);
     ASSERT_EQ(converted[0].popcnt(), 0);
-    ASSERT_EQ(converted[1].popcnt(), 256);
+    ASSERT_EQ(converted[1].popcnt(), num_shots_padded);
     ASSERT_EQ(converted[2].popcnt(), 0);
-    ASSERT_EQ(converted[3].popcnt(), 256);
+    ASSERT_EQ(converted[3].popcnt(), num_shots_padded);
     ASSERT_EQ(converted[398].popcnt(), 0);
-    ASSERT_EQ(converted[399].popcnt(), 256);
+    ASSERT_EQ(converted[399].popcnt(), num_shots_padded);
     ASSERT_EQ(converted[400].popcnt(), 0);
     ASSERT_EQ(converted[401].popcnt(), 0);
 })
 
 TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, append_observables, {
+    // Tables round their shot count up to a whole number of words.
+    size_t num_shots_padded = std::max(W, size_t{256});
     simd_bit_table<W> measurement_data(256, 256);
     simd_bit_table<W> sweep_data(0, 256);
     simd_bit_table<W> converted(256, 256);
@@ -314,7 +320,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, append_observables, {
         true,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), min_bits);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), num_shots_padded);
     ASSERT_EQ(converted[0][0], 0);
     ASSERT_EQ(converted[1][0], 0);
     ASSERT_EQ(converted[9][0], 1);
@@ -332,7 +338,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, append_observables, {
         true,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), min_bits);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), num_shots_padded);
     ASSERT_EQ(converted[0][0], 1);
     ASSERT_EQ(converted[1][0], 1);
     ASSERT_EQ(converted[9][0], 0);
@@ -350,7 +356,7 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, append_observables, {
         false,
         false);
     ASSERT_EQ(converted.num_major_bits_padded(), 0);
-    ASSERT_EQ(converted.num_minor_bits_padded(), 256);
+    ASSERT_EQ(converted.num_minor_bits_padded(), num_shots_padded);
     converted = measurements_to_detection_events(
         measurement_data,
         sweep_data,
@@ -670,3 +676,86 @@ TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, empty_input_b8_empty_swe
     fclose(sweep);
     ASSERT_EQ(rewind_read_close(out), "");
 })
+
+TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, num_threads_doesnt_change_converted_data, {
+    Circuit circuit(R"CIRCUIT(
+        REPEAT 20 {
+            CX sweep[0] 0 sweep[1] 1
+            M 0 1 2
+            DETECTOR rec[-1] rec[-2]
+            DETECTOR rec[-3]
+        }
+        OBSERVABLE_INCLUDE(0) rec[-1]
+    )CIRCUIT");
+    auto stats = circuit.compute_stats();
+    size_t num_shots = 5000;
+    auto rng = INDEPENDENT_TEST_RNG();
+    auto measurements = simd_bit_table<W>::random(stats.num_measurements, num_shots, rng);
+    auto sweep_bits = simd_bit_table<W>::random(stats.num_sweep_bits, num_shots, rng);
+    auto reference_sample = simd_bits<W>::random(stats.num_measurements, rng);
+
+    simd_bit_table<W> expected(stats.num_detectors + stats.num_observables, num_shots);
+    measurements_to_detection_events_helper<W>(
+        measurements, sweep_bits, expected, circuit, stats, reference_sample, true, 1);
+    for (size_t num_threads : {2, 3, 7}) {
+        simd_bit_table<W> actual(stats.num_detectors + stats.num_observables, num_shots);
+        measurements_to_detection_events_helper<W>(
+            measurements, sweep_bits, actual, circuit, stats, reference_sample, true, num_threads);
+        ASSERT_EQ(actual, expected) << num_threads;
+    }
+})
+
+TEST_EACH_WORD_SIZE_W(measurements_to_detection_events, num_threads_doesnt_change_streamed_data, {
+    Circuit circuit(R"CIRCUIT(
+        X_ERROR(0.25) 0 1
+        REPEAT 5 {
+            CX sweep[0] 0
+            M 0 1
+            DETECTOR rec[-1] rec[-2]
+        }
+        OBSERVABLE_INCLUDE(0) rec[-1]
+    )CIRCUIT");
+    std::string measurements;
+    std::string sweeps;
+    auto rng = INDEPENDENT_TEST_RNG();
+    for (size_t k = 0; k < 5000; k++) {
+        for (size_t m = 0; m < 10; m++) {
+            measurements.push_back('0' + (rng() & 1));
+        }
+        measurements.push_back('\n');
+        sweeps.push_back('0' + (rng() & 1));
+        sweeps.push_back('\n');
+    }
+
+    auto convert = [&](size_t num_threads) {
+        FILE *in = tmpfile();
+        FILE *sweep = tmpfile();
+        FILE *out = tmpfile();
+        FILE *obs = tmpfile();
+        fprintf(in, "%s", measurements.c_str());
+        fprintf(sweep, "%s", sweeps.c_str());
+        rewind(in);
+        rewind(sweep);
+        stream_measurements_to_detection_events<W>(
+            in,
+            SampleFormat::SAMPLE_FORMAT_01,
+            sweep,
+            SampleFormat::SAMPLE_FORMAT_01,
+            out,
+            SampleFormat::SAMPLE_FORMAT_DETS,
+            circuit,
+            false,
+            false,
+            obs,
+            SampleFormat::SAMPLE_FORMAT_01,
+            num_threads);
+        fclose(in);
+        fclose(sweep);
+        return rewind_read_close(out) + "|" + rewind_read_close(obs);
+    };
+
+    std::string expected = convert(1);
+    ASSERT_EQ(std::count(expected.begin(), expected.end(), '\n'), 10000);
+    ASSERT_EQ(convert(2), expected);
+    ASSERT_EQ(convert(3), expected);
+})
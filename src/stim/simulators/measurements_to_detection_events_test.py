@@ -337,3 +337,44 @@ def test_converter_pickle():
     assert result.dtype == np.bool_
     assert result.shape == (4, 2)
     np.testing.assert_array_equal(result, [[1, 1], [0, 0], [0, 0], [1, 1]])
+
+
+def test_convert_num_threads():
+    circuit = stim.Circuit.generated(
+        "surface_code:rotated_memory_x",
+        distance=3,
+        rounds=5,
+        after_clifford_depolarization=0.01,
+    )
+    converter = circuit.compile_m2d_converter()
+    measurements = circuit.compile_sampler().sample(shots=5000)
+    expected = converter.convert(measurements=measurements, append_observables=True)
+    with pytest.raises(ValueError, match="num_threads"):
+        converter.convert(measurements=measurements, append_observables=True, num_threads=0)
+    for num_threads in [2, 3]:
+        actual = converter.convert(measurements=measurements, append_observables=True, num_threads=num_threads)
+        np.testing.assert_array_equal(actual, expected)
+
+
+def test_convert_file_num_threads():
+    circuit = stim.Circuit.generated(
+        "repetition_code:memory",
+        distance=5,
+        rounds=5,
+        before_measure_flip_probability=0.05,
+    )
+    converter = circuit.compile_m2d_converter()
+    with tempfile.TemporaryDirectory() as d:
+        circuit.compile_sampler().sample_write(shots=5000, filepath=f"{d}/measurements.b8", format="b8")
+        results = []
+        for num_threads in [1, 3]:
+            converter.convert_file(
+                measurements_filepath=f"{d}/measurements.b8",
+                measurements_format="b8",
+                detection_events_filepath=f"{d}/detections.01",
+                obs_out_filepath=f"{d}/obs.01",
+                num_threads=num_threads,
+            )
+            with open(f"{d}/detections.01") as f1, open(f"{d}/obs.01") as f2:
+                results.append((f1.read(), f2.read()))
+        assert results[0] == results[1]
@@ -1424,9 +1424,12 @@ void TableauSimulator<W>::collapse_isolate_qubit_z(size_t target, TableauTranspo
 template <size_t W>
 void TableauSimulator<W>::safe_do_circuit(const Circuit &circuit, uint64_t reps) {
     ensure_large_enough_for_qubits(circuit.count_qubits());
+    // There are no values for named parameters, so binding them fails with a message naming the parameter.
+    CircuitParameterBinding no_parameters;
+    std::vector<double> arg_buf;
     for (uint64_t k = 0; k < reps; k++) {
         circuit.for_each_operation([&](const CircuitInstruction &op) {
-            do_gate(op);
+            do_gate(no_parameters.bind(op, arg_buf));
         });
     }
 }
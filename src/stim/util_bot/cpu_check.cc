@@ -0,0 +1,51 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file is compiled WITHOUT the architecture flags used for the rest of stim (see
+// CMakeLists.txt), so that the check itself can run on machines that lack the instructions.
+// It must not include headers that define inline code shared with the rest of the library.
+
+#include "stim/util_bot/cpu_check.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "stim/util_bot/cpu_features.h"
+
+void stim::check_cpu_supports_compiled_bitword_width() {
+    size_t supported_width = detect_max_supported_bitword_width();
+    if (supported_width < COMPILED_MAX_BITWORD_WIDTH) {
+        fprintf(
+            stderr,
+            "This copy of stim was compiled to use %s instructions, but this machine only supports %s.\n"
+            "Rebuild stim with `cmake -DSIMD_WIDTH=%zu` to run it here.\n",
+            bitword_width_instruction_set_name(COMPILED_MAX_BITWORD_WIDTH),
+            bitword_width_instruction_set_name(supported_width),
+            supported_width);
+        exit(EXIT_FAILURE);
+    }
+}
+
+#if defined(__GNUC__) && defined(__ELF__)
+// Priority 101 is the earliest available to user code, so this runs before the static
+// initializers of the other translation units (which are where wide instructions could
+// first be executed).
+__attribute__((constructor(101))) static void check_cpu_before_static_initialization() {
+    stim::check_cpu_supports_compiled_bitword_width();
+}
+#elif defined(__GNUC__)
+__attribute__((constructor)) static void check_cpu_before_static_initialization() {
+    stim::check_cpu_supports_compiled_bitword_width();
+}
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_UTIL_BOT_CPU_CHECK_H
+#define _STIM_UTIL_BOT_CPU_CHECK_H
+
+#include <cstddef>
+
+namespace stim {
+
+/// The MAX_BITWORD_WIDTH that the library's simd code was compiled with.
+///
+/// This is defined in a translation unit compiled with the library's architecture flags,
+/// so that cpu_check.cc (which is compiled without them) can see what width the rest of
+/// the library needs. It's constant initialized, so reading it never runs wide code.
+extern const size_t COMPILED_MAX_BITWORD_WIDTH;
+
+/// Exits the process with an explanation if the CPU can't run the compiled bitword width.
+///
+/// This runs automatically, before other static initializers, when cpu_check.cc is linked
+/// in. It's exposed so that programs linking the static library (which drops the unreferenced
+/// object file) can call it first thing; but by then static initializers have already run.
+void check_cpu_supports_compiled_bitword_width();
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,30 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/util_bot/cpu_check.h"
+
+#include "gtest/gtest.h"
+
+#include "stim/mem/simd_word.h"
+
+using namespace stim;
+
+TEST(cpu_check, compiled_max_bitword_width) {
+    ASSERT_EQ(COMPILED_MAX_BITWORD_WIDTH, MAX_BITWORD_WIDTH);
+}
+
+TEST(cpu_check, check_cpu_supports_compiled_bitword_width) {
+    // The tests are running, so the check must pass (instead of exiting).
+    check_cpu_supports_compiled_bitword_width();
+}
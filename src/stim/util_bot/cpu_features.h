@@ -0,0 +1,137 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_UTIL_BOT_CPU_FEATURES_H
+#define _STIM_UTIL_BOT_CPU_FEATURES_H
+
+#include <cstddef>
+#include <cstdint>
+
+// This header is intentionally self contained (no .cc file), because the python package's
+// architecture detection module is compiled from a single source file that includes it.
+//
+// The functions have internal linkage (static). They're called from a translation unit compiled
+// without wide instruction flags (cpu_check.cc), and must not be merged by the linker with
+// copies emitted by translation units that were compiled with those flags.
+
+#if defined(_WIN32)
+#include <immintrin.h>
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace stim {
+
+namespace internal {
+
+static inline void cpuid(int info[4], int info_type) {
+#if defined(_WIN32)
+    __cpuidex(info, info_type, 0);
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned int a, b, c, d;
+    __cpuid_count(info_type, 0, a, b, c, d);
+    info[0] = (int)a;
+    info[1] = (int)b;
+    info[2] = (int)c;
+    info[3] = (int)d;
+#else
+    // Not an x86 machine (e.g. ARM64 or PowerPC). Report no features.
+    (void)info_type;
+    info[0] = 0;
+    info[1] = 0;
+    info[2] = 0;
+    info[3] = 0;
+#endif
+}
+
+/// Returns which register states the operating system saves on context switches (XCR0).
+static inline uint64_t os_saved_register_states() {
+#if defined(_WIN32)
+    return _xgetbv(0);
+#elif defined(__x86_64__) || defined(__i386__)
+    uint32_t eax, edx;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#else
+    return 0;
+#endif
+}
+
+}  // namespace internal
+
+/// Returns the widest bitword (in bits) that the current CPU and OS can execute.
+///
+/// This is 512 for AVX-512F, 256 for AVX2, 128 for SSE2, and 64 otherwise. Wide
+/// registers only count if the operating system also saves them on context switches.
+static inline size_t detect_max_supported_bitword_width() {
+    // From: https://en.wikipedia.org/wiki/CPUID
+    constexpr int EAX = 0;
+    constexpr int EBX = 1;
+    constexpr int ECX = 2;
+    constexpr int EDX = 3;
+    constexpr int INFO_HIGHEST_FUNCTION_PARAMETER = 0;
+    constexpr int INFO_PROCESSOR_FEATURE_BITS = 1;
+    constexpr int INFO_EXTENDED_FEATURES = 7;
+    constexpr int sse2_bit_in_edx = 1 << 26;
+    constexpr int osxsave_bit_in_ecx = 1 << 27;
+    constexpr int avx2_bit_in_ebx = 1 << 5;
+    constexpr int avx512f_bit_in_ebx = 1 << 16;
+    constexpr uint64_t xcr0_sse_and_avx_state = 0x6;
+    constexpr uint64_t xcr0_avx512_state = 0xE0;
+
+    int regs[4];
+    internal::cpuid(regs, INFO_HIGHEST_FUNCTION_PARAMETER);
+    auto max_info_param = regs[EAX];
+    if (max_info_param < INFO_PROCESSOR_FEATURE_BITS) {
+        return 64;
+    }
+
+    internal::cpuid(regs, INFO_PROCESSOR_FEATURE_BITS);
+    bool has_sse2 = regs[EDX] & sse2_bit_in_edx;
+    uint64_t xcr0 = (regs[ECX] & osxsave_bit_in_ecx) ? internal::os_saved_register_states() : 0;
+    bool os_saves_avx = (xcr0 & xcr0_sse_and_avx_state) == xcr0_sse_and_avx_state;
+    bool os_saves_avx512 = os_saves_avx && (xcr0 & xcr0_avx512_state) == xcr0_avx512_state;
+
+    if (max_info_param >= INFO_EXTENDED_FEATURES) {
+        internal::cpuid(regs, INFO_EXTENDED_FEATURES);
+        if (os_saves_avx512 && (regs[EBX] & avx512f_bit_in_ebx)) {
+            return 512;
+        }
+        if (os_saves_avx && (regs[EBX] & avx2_bit_in_ebx)) {
+            return 256;
+        }
+    }
+    return has_sse2 ? 128 : 64;
+}
+
+/// Returns the name of the instruction set extension used for the given bitword width.
+static inline const char *bitword_width_instruction_set_name(size_t width) {
+    switch (width) {
+        case 512:
+            return "avx512";
+        case 256:
+            return "avx2";
+        case 128:
+            return "sse2";
+        default:
+            return "polyfill";
+    }
+}
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,36 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/util_bot/cpu_features.h"
+
+#include "gtest/gtest.h"
+
+#include "stim/mem/simd_word.h"
+
+using namespace stim;
+
+TEST(cpu_features, detect_max_supported_bitword_width) {
+    size_t width = detect_max_supported_bitword_width();
+    ASSERT_TRUE(width == 64 || width == 128 || width == 256 || width == 512) << width;
+
+    // The tests are running, so the machine supports what they were compiled for.
+    ASSERT_GE(width, MAX_BITWORD_WIDTH);
+}
+
+TEST(cpu_features, bitword_width_instruction_set_name) {
+    ASSERT_STREQ(bitword_width_instruction_set_name(512), "avx512");
+    ASSERT_STREQ(bitword_width_instruction_set_name(256), "avx2");
+    ASSERT_STREQ(bitword_width_instruction_set_name(128), "sse2");
+    ASSERT_STREQ(bitword_width_instruction_set_name(64), "polyfill");
+}
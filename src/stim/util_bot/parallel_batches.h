@@ -0,0 +1,139 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_UTIL_BOT_PARALLEL_BATCHES_H
+#define _STIM_UTIL_BOT_PARALLEL_BATCHES_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace stim {
+
+/// Processes a sequence of independent batches on several threads, while still
+/// consuming their results one at a time and in order.
+///
+/// Each thread (including the calling thread) creates its own state using `make_state`,
+/// then repeatedly claims the next unclaimed batch, computes it, waits until all earlier
+/// batches have been written, and writes it. Because the writes are serialized and
+/// ordered, `write` can append to a shared output without any locking of its own.
+///
+/// If any callback throws, the remaining work is abandoned and the first exception is
+/// rethrown on the calling thread after all threads have stopped.
+///
+/// Args:
+///     num_batches: The number of batches to process.
+///     num_threads: The maximum number of threads to use. At most one thread per batch is
+///         used, and a value of 1 runs everything on the calling thread.
+///     make_state: Called once per thread, as `make_state()`, to create the per-thread state.
+///     claim: Called as `claim(state, batch_index)` while the claim is exclusive, which means
+///         calls happen one at a time and in batch order. Use this for reading inputs that
+///         must be consumed sequentially. If `claim` returns a bool, returning false means
+///         there are no more batches (e.g. the input ran out), so the batch is dropped and
+///         no later batches are claimed. This allows `num_batches` to be SIZE_MAX when the
+///         number of batches isn't known ahead of time.
+///     compute: Called as `compute(state, batch_index)` concurrently with other batches.
+///     write: Called as `write(state, batch_index)` one at a time and in batch order.
+template <typename MAKE_STATE, typename CLAIM, typename COMPUTE, typename WRITE>
+void process_batches_in_parallel_in_order(
+    size_t num_batches,
+    size_t num_threads,
+    const MAKE_STATE &make_state,
+    const CLAIM &claim,
+    const COMPUTE &compute,
+    const WRITE &write) {
+    size_t next_batch_to_claim = 0;
+    size_t next_batch_to_write = 0;
+    std::exception_ptr failure = nullptr;
+    std::mutex mut;
+    std::condition_variable batch_written;
+
+    auto worker = [&]() {
+        try {
+            auto state = make_state();
+            while (true) {
+                size_t batch_index;
+                {
+                    std::lock_guard<std::mutex> lock(mut);
+                    if (failure != nullptr || next_batch_to_claim == num_batches) {
+                        return;
+                    }
+                    batch_index = next_batch_to_claim++;
+                    if constexpr (std::is_same_v<decltype(claim(state, batch_index)), bool>) {
+                        if (!claim(state, batch_index)) {
+                            num_batches = batch_index;
+                            next_batch_to_claim = batch_index;
+                            return;
+                        }
+                    } else {
+                        claim(state, batch_index);
+                    }
+                }
+
+                compute(state, batch_index);
+
+                {
+                    std::unique_lock<std::mutex> lock(mut);
+                    batch_written.wait(lock, [&]() {
+                        return next_batch_to_write == batch_index || failure != nullptr;
+                    });
+                    if (failure != nullptr) {
+                        return;
+                    }
+                }
+
+                // Only the thread holding the next batch to write can get here, so it's safe to write unlocked.
+                write(state, batch_index);
+
+                {
+                    std::lock_guard<std::mutex> lock(mut);
+                    next_batch_to_write++;
+                }
+                batch_written.notify_all();
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(mut);
+                if (failure == nullptr) {
+                    failure = std::current_exception();
+                }
+            }
+            batch_written.notify_all();
+        }
+    };
+
+    size_t num_workers = std::min(num_threads, num_batches);
+    std::vector<std::thread> threads;
+    for (size_t k = 1; k < num_workers; k++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : threads) {
+        t.join();
+    }
+    if (failure != nullptr) {
+        std::rethrow_exception(failure);
+    }
+}
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,134 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/util_bot/parallel_batches.h"
+
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+using namespace stim;
+
+TEST(parallel_batches, process_batches_in_parallel_in_order) {
+    for (size_t num_threads : {1, 2, 5, 100}) {
+        std::vector<size_t> claimed;
+        std::vector<size_t> written;
+        std::vector<size_t> computed(50, 0);
+        process_batches_in_parallel_in_order(
+            50,
+            num_threads,
+            []() {
+                return std::vector<size_t>{};
+            },
+            [&](std::vector<size_t> &state, size_t batch_index) {
+                claimed.push_back(batch_index);
+                state.push_back(batch_index);
+            },
+            [&](std::vector<size_t> &state, size_t batch_index) {
+                ASSERT_EQ(state.back(), batch_index);
+                computed[batch_index] = batch_index * batch_index;
+            },
+            [&](std::vector<size_t> &state, size_t batch_index) {
+                ASSERT_EQ(state.back(), batch_index);
+                ASSERT_EQ(computed[batch_index], batch_index * batch_index);
+                written.push_back(batch_index);
+            });
+        std::vector<size_t> expected;
+        for (size_t k = 0; k < 50; k++) {
+            expected.push_back(k);
+        }
+        ASSERT_EQ(claimed, expected) << num_threads;
+        ASSERT_EQ(written, expected) << num_threads;
+    }
+
+    size_t calls = 0;
+    process_batches_in_parallel_in_order(
+        0,
+        4,
+        [&]() {
+            calls++;
+            return 0;
+        },
+        [&](int &, size_t) {
+            calls++;
+        },
+        [&](int &, size_t) {
+            calls++;
+        },
+        [&](int &, size_t) {
+            calls++;
+        });
+    ASSERT_EQ(calls, 1);
+}
+
+TEST(parallel_batches, process_batches_in_parallel_in_order_rethrows) {
+    for (size_t num_threads : {1, 3}) {
+        std::vector<size_t> written;
+        ASSERT_THROW(
+            {
+                process_batches_in_parallel_in_order(
+                    50,
+                    num_threads,
+                    []() {
+                        return 0;
+                    },
+                    [](int &, size_t) {
+                    },
+                    [](int &, size_t batch_index) {
+                        if (batch_index == 10) {
+                            throw std::invalid_argument("batch 10");
+                        }
+                    },
+                    [&](int &, size_t batch_index) {
+                        written.push_back(batch_index);
+                    });
+            },
+            std::invalid_argument);
+        ASSERT_LE(written.size(), 10);
+        for (size_t k = 0; k < written.size(); k++) {
+            ASSERT_EQ(written[k], k);
+        }
+    }
+}
+
+TEST(parallel_batches, process_batches_in_parallel_in_order_until_claim_fails) {
+    for (size_t num_threads : {1, 2, 7}) {
+        size_t remaining_input = 23;
+        std::vector<size_t> written;
+        process_batches_in_parallel_in_order(
+            SIZE_MAX,
+            num_threads,
+            []() {
+                return size_t{0};
+            },
+            [&](size_t &state, size_t batch_index) {
+                if (remaining_input == 0) {
+                    return false;
+                }
+                remaining_input--;
+                state = batch_index;
+                return true;
+            },
+            [](size_t &state, size_t batch_index) {
+                ASSERT_EQ(state, batch_index);
+            },
+            [&](size_t &state, size_t batch_index) {
+                written.push_back(batch_index);
+            });
+        ASSERT_EQ(written.size(), 23) << num_threads;
+        for (size_t k = 0; k < written.size(); k++) {
+            ASSERT_EQ(written[k], k);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/util_bot/philox_rng.h"
+
+using namespace stim;
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr size_t PHILOX_ROUNDS = 10;
+
+/// Runs the Philox4x32 rounds on N independent counters at once.
+///
+/// The counters are stored as structure-of-arrays so that each step of a round is a
+/// simple loop over N lanes, which compilers turn into SIMD instructions.
+template <size_t N>
+static inline void philox_rounds(uint32_t (&c0)[N], uint32_t (&c1)[N], uint32_t (&c2)[N], uint32_t (&c3)[N], uint64_t key) {
+    uint32_t k0 = (uint32_t)key;
+    uint32_t k1 = (uint32_t)(key >> 32);
+    for (size_t r = 0; r < PHILOX_ROUNDS; r++) {
+        for (size_t k = 0; k < N; k++) {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0[k];
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2[k];
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[k] ^ k0;
+            uint32_t n1 = (uint32_t)p1;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[k] ^ k1;
+            uint32_t n3 = (uint32_t)p0;
+            c0[k] = n0;
+            c1[k] = n1;
+            c2[k] = n2;
+            c3[k] = n3;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+PhiloxRng::PhiloxRng(uint64_t key, uint64_t stream)
+    : key(key), stream(stream), position(0), cached_block({0, 0}), cached_block_index(UINT64_MAX) {
+}
+
+std::array<uint64_t, 2> PhiloxRng::block(uint64_t block_index) const {
+    uint32_t c0[1]{(uint32_t)block_index};
+    uint32_t c1[1]{(uint32_t)(block_index >> 32)};
+    uint32_t c2[1]{(uint32_t)stream};
+    uint32_t c3[1]{(uint32_t)(stream >> 32)};
+    philox_rounds<1>(c0, c1, c2, c3, key);
+    return {(uint64_t)c0[0] | ((uint64_t)c1[0] << 32), (uint64_t)c2[0] | ((uint64_t)c3[0] << 32)};
+}
+
+void PhiloxRng::fill(uint64_t *out, size_t n) {
+    // Get block aligned.
+    while (n > 0 && (position & 1)) {
+        *out++ = (*this)();
+        n--;
+    }
+
+    // Bulk generate whole blocks.
+    constexpr size_t LANES = 16;
+    uint32_t c0[LANES];
+    uint32_t c1[LANES];
+    uint32_t c2[LANES];
+    uint32_t c3[LANES];
+    while (n >= 2 * LANES) {
+        uint64_t block_index = position >> 1;
+        for (size_t k = 0; k < LANES; k++) {
+            c0[k] = (uint32_t)(block_index + k);
+            c1[k] = (uint32_t)((block_index + k) >> 32);
+            c2[k] = (uint32_t)stream;
+            c3[k] = (uint32_t)(stream >> 32);
+        }
+        philox_rounds<LANES>(c0, c1, c2, c3, key);
+        for (size_t k = 0; k < LANES; k++) {
+            out[2 * k] = (uint64_t)c0[k] | ((uint64_t)c1[k] << 32);
+            out[2 * k + 1] = (uint64_t)c2[k] | ((uint64_t)c3[k] << 32);
+        }
+        out += 2 * LANES;
+        n -= 2 * LANES;
+        position += 2 * LANES;
+    }
+
+    // Finish the leftovers.
+    while (n > 0) {
+        *out++ = (*this)();
+        n--;
+    }
+}
+
+void PhiloxRng::seek(uint64_t new_position) {
+    position = new_position;
+}
+
+void PhiloxRng::discard(uint64_t n) {
+    position += n;
+}
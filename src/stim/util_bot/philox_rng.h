@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STIM_UTIL_BOT_PHILOX_RNG_H
+#define _STIM_UTIL_BOT_PHILOX_RNG_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace stim {
+
+/// A counter-based random number generator (Philox4x32-10).
+///
+/// Unlike std::mt19937_64, the output at any position is a pure function of the key, the
+/// stream index, and the position. Jumping to a position is free, seeding is free, and
+/// independent streams (e.g. one per batch of shots) can be handed to different threads
+/// without any coordination.
+///
+/// Satisfies the requirements of UniformRandomBitGenerator, so it can be used with the
+/// distributions from <random>.
+struct PhiloxRng {
+    using result_type = uint64_t;
+
+    uint64_t key;       // Selects the family of streams. Typically derived from a seed.
+    uint64_t stream;    // Selects the stream within the family.
+    uint64_t position;  // Index of the next 64 bit word that will be produced.
+
+    explicit PhiloxRng(uint64_t key, uint64_t stream = 0);
+
+    static constexpr result_type min() {
+        return 0;
+    }
+    static constexpr result_type max() {
+        return UINT64_MAX;
+    }
+
+    /// Returns the next 64 bit word of the stream.
+    inline result_type operator()() {
+        uint64_t block_index = position >> 1;
+        if (block_index != cached_block_index) {
+            cached_block = block(block_index);
+            cached_block_index = block_index;
+        }
+        return cached_block[position++ & 1];
+    }
+
+    /// Writes the next `n` words of the stream into `out`.
+    ///
+    /// Produces the same words as calling the generator `n` times, but works on several
+    /// counter blocks at once so the compiler can vectorize the rounds.
+    void fill(uint64_t *out, size_t n);
+
+    /// Moves to the given word position in the current stream.
+    void seek(uint64_t new_position);
+
+    /// Skips the next `n` words of the stream.
+    void discard(uint64_t n);
+
+    /// Returns the two words at positions 2*block_index and 2*block_index+1 of the current stream.
+    std::array<uint64_t, 2> block(uint64_t block_index) const;
+
+   private:
+    std::array<uint64_t, 2> cached_block;
+    uint64_t cached_block_index;
+};
+
+}  // namespace stim
+
+#endif
@@ -0,0 +1,95 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stim/util_bot/philox_rng.h"
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+using namespace stim;
+
+TEST(philox_rng, known_answers) {
+    // Known answer vectors from the Random123 reference implementation of philox4x32_10.
+    ASSERT_EQ(PhiloxRng(0, 0).block(0), (std::array<uint64_t, 2>{0xe169c58d6627e8d5ULL, 0x9b00dbd8bc57ac4cULL}));
+    ASSERT_EQ(
+        PhiloxRng(UINT64_MAX, UINT64_MAX).block(UINT64_MAX),
+        (std::array<uint64_t, 2>{0x41c83b0e408f276dULL, 0x6d5451fda20bc7c6ULL}));
+    ASSERT_EQ(
+        PhiloxRng(0x299f31d0a4093822ULL, 0x0370734413198a2eULL).block(0x85a308d3243f6a88ULL),
+        (std::array<uint64_t, 2>{0x94fdccebd16cfe09ULL, 0x24126ea15001e420ULL}));
+}
+
+TEST(philox_rng, sequential_matches_blocks) {
+    PhiloxRng rng(5, 7);
+    for (uint64_t k = 0; k < 10; k++) {
+        auto b = rng.block(k);
+        ASSERT_EQ(rng(), b[0]);
+        ASSERT_EQ(rng(), b[1]);
+    }
+    ASSERT_EQ(rng.position, 20);
+}
+
+TEST(philox_rng, fill_matches_sequential) {
+    for (size_t offset = 0; offset < 3; offset++) {
+        std::vector<uint64_t> filled(101);
+        PhiloxRng a(5, 7);
+        a.seek(offset);
+        a.fill(filled.data(), filled.size());
+
+        PhiloxRng b(5, 7);
+        b.discard(offset);
+        for (size_t k = 0; k < filled.size(); k++) {
+            ASSERT_EQ(filled[k], b()) << offset << ", " << k;
+        }
+        ASSERT_EQ(a.position, b.position);
+        ASSERT_EQ(a(), b());
+    }
+}
+
+TEST(philox_rng, seek) {
+    PhiloxRng a(3, 4);
+    std::vector<uint64_t> expected;
+    for (size_t k = 0; k < 50; k++) {
+        expected.push_back(a());
+    }
+    PhiloxRng b(3, 4);
+    b.seek(37);
+    ASSERT_EQ(b(), expected[37]);
+    b.seek(2);
+    ASSERT_EQ(b(), expected[2]);
+    ASSERT_EQ(b(), expected[3]);
+}
+
+TEST(philox_rng, streams_and_keys_differ) {
+    ASSERT_NE(PhiloxRng(1, 0)(), PhiloxRng(1, 1)());
+    ASSERT_NE(PhiloxRng(1, 0)(), PhiloxRng(2, 0)());
+    ASSERT_EQ(PhiloxRng(1, 0)(), PhiloxRng(1, 0)());
+}
+
+TEST(philox_rng, works_with_distributions) {
+    PhiloxRng rng(11);
+    std::bernoulli_distribution coin(0.25);
+    size_t hits = 0;
+    for (size_t k = 0; k < 100000; k++) {
+        hits += coin(rng);
+    }
+    ASSERT_TRUE(24000 < hits && hits < 26000) << hits;
+
+    size_t bits = 0;
+    for (size_t k = 0; k < 1000; k++) {
+        bits += std::popcount(rng());
+    }
+    ASSERT_TRUE(31000 < bits && bits < 33000) << bits;
+}
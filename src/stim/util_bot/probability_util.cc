@@ -14,6 +14,7 @@
 
 #include "stim/util_bot/probability_util.h"
 
+#include <bit>
 #include <cstring>
 
 #include "stim/util_bot/arg_parse.h"
@@ -30,7 +31,8 @@ RareErrorIterator::RareErrorIterator(float probability)
     }
 }
 
-size_t RareErrorIterator::next(std::mt19937_64 &rng) {
+template <typename RNG>
+size_t RareErrorIterator::next(RNG &rng) {
     if (probability == 0) {
         return SIZE_MAX;
     } else if (probability == 1) {
@@ -42,7 +44,59 @@ size_t RareErrorIterator::next(std::mt19937_64 &rng) {
     }
 }
 
-std::vector<size_t> stim::sample_hit_indices(float probability, size_t attempts, std::mt19937_64 &rng) {
+static size_t exact_rare_error_sampling_count = 0;
+ExactRareErrorSamplingRaii::ExactRareErrorSamplingRaii() {
+    exact_rare_error_sampling_count++;
+}
+ExactRareErrorSamplingRaii::~ExactRareErrorSamplingRaii() {
+    exact_rare_error_sampling_count--;
+}
+bool stim::should_use_exact_rare_error_sampling() {
+    return exact_rare_error_sampling_count > 0;
+}
+
+template <typename RNG>
+void stim::sample_geometric_gaps(double inv_log_1_minus_p, uint64_t *out, size_t count, RNG &rng) {
+    // Draw the entropy first, so that the arithmetic below is a simple loop over arrays.
+    fill_random_words(rng, out, count);
+
+    // For u uniform in (0, 1], floor(ln(u) / ln(1-p)) is geometrically distributed.
+    //
+    // ln(u) is computed without branches or library calls: u = m * 2^e with m in [sqrt(1/2), sqrt(2)),
+    // and ln(m) = 2 atanh(s) where s = (m-1)/(m+1) is small enough that a short odd series converges
+    // to double precision.
+    constexpr double LN2 = 0.6931471805599453094;
+    constexpr double SQRT2 = 1.4142135623730950488;
+    constexpr uint64_t MANTISSA_MASK = (uint64_t{1} << 52) - 1;
+    constexpr uint64_t EXPONENT_ONE = uint64_t{1023} << 52;
+    constexpr double MAX_GAP = (double)(uint64_t{1} << 62);
+    for (size_t k = 0; k < count; k++) {
+        double u = (double)((out[k] >> 11) + 1) * (1.0 / (double)(uint64_t{1} << 53));
+        uint64_t bits = std::bit_cast<uint64_t>(u);
+        double e = (double)((int64_t)(bits >> 52) - 1023);
+        double m = std::bit_cast<double>((bits & MANTISSA_MASK) | EXPONENT_ONE);
+        bool big = m > SQRT2;
+        m = big ? m * 0.5 : m;
+        e = big ? e + 1 : e;
+        double s = (m - 1) / (m + 1);
+        double z = s * s;
+        double series = 1.0 / 17;
+        series = series * z + 1.0 / 15;
+        series = series * z + 1.0 / 13;
+        series = series * z + 1.0 / 11;
+        series = series * z + 1.0 / 9;
+        series = series * z + 1.0 / 7;
+        series = series * z + 1.0 / 5;
+        series = series * z + 1.0 / 3;
+        series = series * z + 1.0;
+        double ln_u = e * LN2 + 2 * s * series;
+        double gap = ln_u * inv_log_1_minus_p;
+        out[k] = (uint64_t)(gap < MAX_GAP ? gap : MAX_GAP);
+    }
+}
+
+template <typename RNG>
+std::vector<size_t> stim::sample_hit_indices(float probability, size_t attempts, RNG &rng) {
     std::vector<size_t> result;
     RareErrorIterator::for_samples(probability, attempts, rng, [&](size_t s) {
         result.push_back(s);
@@ -71,7 +125,8 @@ std::mt19937_64 stim::optionally_seeded_rng(int argc, const char **argv) {
     return std::mt19937_64(seed ^ INTENTIONAL_VERSION_SEED_INCOMPATIBILITY);
 }
 
-void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, std::mt19937_64 &rng) {
+template <typename RNG>
+void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, RNG &rng) {
     if (probability > 0.5) {
         // Recurse and invert for probabilities larger than 0.5.
         biased_randomize_bits(1 - probability, start, end, rng);
@@ -81,10 +136,7 @@ void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *e
         }
     } else if (probability == 0.5) {
         // For the 50/50 case, just copy the bits directly into the buffer.
-        while (start != end) {
-            *start = rng();
-            start++;
-        }
+        fill_random_words(rng, start, end - start);
     } else if (probability < 0.02) {
         // For small probabilities, sample gaps using a geometric distribution.
         size_t n = (end - start) << 6;
@@ -112,15 +164,24 @@ void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *e
 
         // Flip coins, using the position of the first HEADS result to
         // select a bit from the probability's binary representation.
-        for (uint64_t *cur = start; cur != end; cur++) {
-            uint64_t alive = rng();
-            uint64_t result = 0;
-            for (size_t k_bit = COIN_FLIPS - 1; k_bit--;) {
-                uint64_t shoot = rng();
-                result ^= shoot & alive & -((p_top_bits >> k_bit) & 1);
-                alive &= ~shoot;
+        // The coins for several words are drawn at once, in the order they're used.
+        constexpr size_t WORDS_PER_CHUNK = 32;
+        uint64_t coins[WORDS_PER_CHUNK * COIN_FLIPS];
+        for (uint64_t *chunk = start; chunk != end;) {
+            size_t n = std::min((size_t)(end - chunk), WORDS_PER_CHUNK);
+            fill_random_words(rng, coins, n * COIN_FLIPS);
+            const uint64_t *coin = coins;
+            for (size_t w = 0; w < n; w++) {
+                uint64_t alive = *coin++;
+                uint64_t result = 0;
+                for (size_t k_bit = COIN_FLIPS - 1; k_bit--;) {
+                    uint64_t shoot = *coin++;
+                    result ^= shoot & alive & -((p_top_bits >> k_bit) & 1);
+                    alive &= ~shoot;
+                }
+                chunk[w] = result;
             }
-            *cur = result;
+            chunk += n;
         }
 
         // Correct distortion from truncation.
@@ -130,3 +191,12 @@ void stim::biased_randomize_bits(float probability, uint64_t *start, uint64_t *e
         });
     }
 }
+
+template size_t RareErrorIterator::next(std::mt19937_64 &rng);
+template size_t RareErrorIterator::next(PhiloxRng &rng);
+template void stim::sample_geometric_gaps(double, uint64_t *, size_t, std::mt19937_64 &);
+template void stim::sample_geometric_gaps(double, uint64_t *, size_t, PhiloxRng &);
+template std::vector<size_t> stim::sample_hit_indices(float, size_t, std::mt19937_64 &);
+template std::vector<size_t> stim::sample_hit_indices(float, size_t, PhiloxRng &);
+template void stim::biased_randomize_bits(float, uint64_t *, uint64_t *, std::mt19937_64 &);
+template void stim::biased_randomize_bits(float, uint64_t *, uint64_t *, PhiloxRng &);
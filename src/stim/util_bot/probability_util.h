@@ -17,17 +17,58 @@
 #ifndef _STIM_UTIL_BOT_PROBABILITY_UTIL_H
 #define _STIM_UTIL_BOT_PROBABILITY_UTIL_H
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 #include <stdexcept>
 #include <vector>
 
 #include "stim/mem/span_ref.h"
+#include "stim/util_bot/philox_rng.h"
 
 namespace stim {
 
 // Change this number from time to time to ensure people don't rely on seeds across versions.
 constexpr uint64_t INTENTIONAL_VERSION_SEED_INCOMPATIBILITY = 0xDEADBEEF124CULL;
 
+/// While an instance of this class exists, RareErrorIterator::for_samples draws each gap
+/// one at a time using std::geometric_distribution, instead of drawing gaps in batches.
+///
+/// This reproduces the exact sequence of samples produced by the scalar method for a given
+/// rng state, which is useful when comparing against results from earlier versions.
+struct ExactRareErrorSamplingRaii {
+    ExactRareErrorSamplingRaii();
+    ~ExactRareErrorSamplingRaii();
+};
+bool should_use_exact_rare_error_sampling();
+
+/// Overwrites `out` with the next `count` words from the generator.
+inline void fill_random_words(std::mt19937_64 &rng, uint64_t *out, size_t count) {
+    for (size_t k = 0; k < count; k++) {
+        out[k] = rng();
+    }
+}
+
+/// Overwrites `out` with the next `count` words from the generator, many counter blocks at a time.
+inline void fill_random_words(PhiloxRng &rng, uint64_t *out, size_t count) {
+    rng.fill(out, count);
+}
+
+/// Overwrites `out` with `count` samples from a geometric distribution.
+///
+/// Each sample is the number of failures before the first success, when each trial succeeds with
+/// probability `p`. The samples are produced by inverting the cumulative distribution of uniform
+/// samples, using a branch-free natural log that the compiler can vectorize, so that many gaps
+/// can be computed at once instead of paying for a scalar log per gap.
+///
+/// Args:
+///     inv_log_1_minus_p: The value 1/ln(1-p). Must be negative.
+///     out: Where to write the samples. Samples are clamped to at most 2^62.
+///     count: The number of samples to write.
+///     rng: Source of entropy. Advanced by exactly `count` draws. Either std::mt19937_64 or PhiloxRng.
+template <typename RNG>
+void sample_geometric_gaps(double inv_log_1_minus_p, uint64_t *out, size_t count, RNG &rng);
+
 /// Yields the indices of hits sampled from a Bernoulli distribution.
 /// Gets more efficient as the hit probability drops.
 struct RareErrorIterator {
@@ -37,40 +78,60 @@ struct RareErrorIterator {
     RareErrorIterator() = delete;
     RareErrorIterator(const RareErrorIterator &) = delete;
     RareErrorIterator(float probability);
-    size_t next(std::mt19937_64 &rng);
+    template <typename RNG>
+    size_t next(RNG &rng);
 
-    template <typename BODY>
-    inline static void for_samples(double p, size_t n, std::mt19937_64 &rng, BODY body) {
+    /// Calls `body(s)` for each index `s` in [0, n) that was hit by a Bernoulli trial with probability p.
+    ///
+    /// Gaps between hits are sampled in batches (see sample_geometric_gaps). The batch size starts
+    /// near the expected number of hits and grows when more are needed, so few samples are wasted.
+    template <typename BODY, typename RNG>
+    inline static void for_samples(double p, size_t n, RNG &rng, BODY body) {
         if (p == 0) {
             return;
         }
-        RareErrorIterator skipper((float)p);
-        while (true) {
-            size_t s = skipper.next(rng);
-            if (s >= n) {
-                break;
+        if (!(p > 0 && p < 1) || should_use_exact_rare_error_sampling()) {
+            RareErrorIterator skipper((float)p);
+            while (true) {
+                size_t s = skipper.next(rng);
+                if (s >= n) {
+                    break;
+                }
+                body(s);
             }
-            body(s);
-        }
-    }
-
-    template <typename BODY, typename T>
-    inline static void for_samples(double p, const SpanRef<const T> &vals, std::mt19937_64 &rng, BODY body) {
-        if (p == 0) {
             return;
         }
-        RareErrorIterator skipper((float)p);
+
+        constexpr size_t MAX_BATCH = 256;
+        uint64_t gaps[MAX_BATCH];
+        double expected_hits = p * (double)n;
+        size_t batch = expected_hits >= MAX_BATCH ? MAX_BATCH : (size_t)expected_hits + 4;
+        double inv_log_1_minus_p = 1.0 / std::log1p(-p);
+        size_t s = 0;
         while (true) {
-            size_t s = skipper.next(rng);
-            if (s >= vals.size()) {
-                break;
+            sample_geometric_gaps(inv_log_1_minus_p, gaps, batch, rng);
+            for (size_t k = 0; k < batch; k++) {
+                s += gaps[k];
+                if (s >= n) {
+                    return;
+                }
+                body(s);
+                s++;
             }
-            body(vals[s]);
+            batch = std::min(batch * 2, MAX_BATCH);
         }
     }
+
+    template <typename BODY, typename T, typename RNG>
+    inline static void for_samples(double p, const SpanRef<const T> &vals, RNG &rng, BODY body) {
+        for_samples(p, vals.size(), rng, [&](size_t s) {
+            body(vals[s]);
+        });
+    }
 };
 
-std::vector<size_t> sample_hit_indices(float probability, size_t attempts, std::mt19937_64 &rng);
+template <typename RNG>
+std::vector<size_t> sample_hit_indices(float probability, size_t attempts, RNG &rng);
 
 /// Create a fresh random number generator seeded by entropy from the operating system.
 std::mt19937_64 externally_seeded_rng();
@@ -84,8 +145,9 @@ std::mt19937_64 optionally_seeded_rng(int argc, const char **argv);
 ///     probability: The chance that each bit will be on.
 ///     start: Inclusive start of the memory span to overwrite.
 ///     end: Exclusive end of the memory span to overwrite.
-///     rng: The random number generator to use to generate entropy.
-void biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, std::mt19937_64 &rng);
+///     rng: The random number generator to use to generate entropy. Either std::mt19937_64 or PhiloxRng.
+template <typename RNG>
+void biased_randomize_bits(float probability, uint64_t *start, uint64_t *end, RNG &rng);
 
 }  // namespace stim
 
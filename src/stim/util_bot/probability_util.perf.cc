@@ -16,6 +16,7 @@
 
 #include "stim/mem/simd_bits.h"
 #include "stim/perf.perf.h"
+#include "stim/util_bot/philox_rng.h"
 
 using namespace stim;
 
@@ -102,3 +103,47 @@ BENCHMARK(biased_random_1024_99percent) {
         .goal_nanos(260)
         .show_rate("bits", n);
 }
+
+BENCHMARK(biased_random_1024_0point1percent_philox) {
+    PhiloxRng rng(0);
+    float p = 0.001;
+    size_t n = 1024;
+    simd_bits<MAX_BITWORD_WIDTH> data(n);
+    benchmark_go([&]() {
+        biased_randomize_bits(p, data.u64, data.u64 + data.num_u64_padded(), rng);
+    })
+        .goal_nanos(70)
+        .show_rate("bits", n);
+}
+
+BENCHMARK(biased_random_1024_40percent_philox) {
+    PhiloxRng rng(0);
+    float p = 0.4;
+    size_t n = 1024;
+    simd_bits<MAX_BITWORD_WIDTH> data(n);
+    benchmark_go([&]() {
+        biased_randomize_bits(p, data.u64, data.u64 + data.num_u64_padded(), rng);
+    })
+        .goal_nanos(420)
+        .show_rate("bits", n);
+}
+
+BENCHMARK(philox_rng_fill_1024) {
+    PhiloxRng rng(0);
+    simd_bits<MAX_BITWORD_WIDTH> data(1024);
+    benchmark_go([&]() {
+        rng.fill(data.u64, data.num_u64_padded());
+    })
+        .goal_nanos(150)
+        .show_rate("bits", 1024);
+}
+
+BENCHMARK(mt19937_64_fill_1024) {
+    std::mt19937_64 rng(0);
+    simd_bits<MAX_BITWORD_WIDTH> data(1024);
+    benchmark_go([&]() {
+        data.randomize(1024, rng);
+    })
+        .goal_nanos(150)
+        .show_rate("bits", 1024);
+}
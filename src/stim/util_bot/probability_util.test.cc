@@ -49,6 +49,63 @@ TEST(probability_util, sample_hit_indices) {
     }
 }
 
+TEST(probability_util, sample_geometric_gaps) {
+    auto rng = INDEPENDENT_TEST_RNG();
+    for (double p : {0.5, 0.1, 0.001}) {
+        std::vector<uint64_t> gaps(100000);
+        sample_geometric_gaps(1 / std::log1p(-p), gaps.data(), gaps.size(), rng);
+        double mean = 0;
+        size_t zeros = 0;
+        for (auto g : gaps) {
+            mean += g;
+            zeros += g == 0;
+        }
+        mean /= gaps.size();
+        double expected_mean = (1 - p) / p;
+        double dev = sqrt(1 - p) / p / sqrt(gaps.size());
+        EXPECT_TRUE(abs(mean - expected_mean) < dev * 5) << p << ", " << mean;
+        double zero_dev = sqrt(p * (1 - p) * gaps.size());
+        EXPECT_TRUE(abs(zeros - p * gaps.size()) < zero_dev * 5) << p << ", " << zeros;
+    }
+
+    // Consumes exactly one rng draw per gap.
+    std::mt19937_64 a(5);
+    std::mt19937_64 b(5);
+    uint64_t gaps[10];
+    sample_geometric_gaps(1 / std::log1p(-0.25), gaps, 10, a);
+    b.discard(10);
+    ASSERT_EQ(a(), b());
+}
+
+TEST(probability_util, exact_rare_error_sampling_raii) {
+    std::vector<size_t> expected;
+    std::mt19937_64 rng_a(5);
+    RareErrorIterator skipper(0.01f);
+    while (true) {
+        size_t s = skipper.next(rng_a);
+        if (s >= 10000) {
+            break;
+        }
+        expected.push_back(s);
+    }
+
+    std::mt19937_64 rng_b(5);
+    {
+        ExactRareErrorSamplingRaii exact;
+        ASSERT_TRUE(should_use_exact_rare_error_sampling());
+        ASSERT_EQ(sample_hit_indices(0.01f, 10000, rng_b), expected);
+    }
+    ASSERT_FALSE(should_use_exact_rare_error_sampling());
+
+    std::mt19937_64 rng_c(5);
+    auto batched = sample_hit_indices(0.01f, 10000, rng_c);
+    ASSERT_NE(batched, expected);
+    ASSERT_TRUE(50 < batched.size() && batched.size() < 150) << batched.size();
+    for (size_t k = 1; k < batched.size(); k++) {
+        ASSERT_LT(batched[k - 1], batched[k]);
+    }
+}
+
 TEST_EACH_WORD_SIZE_W(probability_util, biased_random, {
     auto rng = INDEPENDENT_TEST_RNG();
     std::vector<float> probs{0, 0.01, 0.03, 0.1, 0.4, 0.49, 0.5, 0.6, 0.9, 0.99, 0.999, 1};
@@ -68,3 +125,40 @@ TEST_EACH_WORD_SIZE_W(probability_util, biased_random, {
             << min_expected / n << " < " << t / (float)n << " < " << max_expected / n << " for p=" << p;
     }
 })
+
+TEST_EACH_WORD_SIZE_W(probability_util, biased_random_philox, {
+    PhiloxRng rng(INDEPENDENT_TEST_RNG()());
+    std::vector<float> probs{0, 0.01, 0.03, 0.1, 0.4, 0.5, 0.9, 0.999, 1};
+    simd_bits<W> data(1000000);
+    size_t n = data.num_bits_padded();
+    for (auto p : probs) {
+        biased_randomize_bits(p, data.u64, data.u64 + data.num_u64_padded(), rng);
+        size_t t = data.popcnt();
+        float dev = sqrtf(p * (1 - p) * n);
+        EXPECT_TRUE(n * p - dev * 5 <= t && t <= n * p + dev * 5) << t / (float)n << " for p=" << p;
+    }
+})
+
+TEST(probability_util, biased_random_philox_is_keyed_by_stream) {
+    std::vector<uint64_t> a(100), b(100), c(100);
+    for (float p : {0.001f, 0.1f, 0.5f}) {
+        PhiloxRng rng_a(5, 7);
+        PhiloxRng rng_b(5, 7);
+        PhiloxRng rng_c(5, 8);
+        biased_randomize_bits(p, a.data(), a.data() + a.size(), rng_a);
+        biased_randomize_bits(p, b.data(), b.data() + b.size(), rng_b);
+        biased_randomize_bits(p, c.data(), c.data() + c.size(), rng_c);
+        ASSERT_EQ(a, b);
+        ASSERT_NE(a, c);
+        ASSERT_EQ(rng_a.position, rng_b.position);
+    }
+
+    // Filling in bulk consumes the same words as drawing them one at a time.
+    PhiloxRng bulk(3, 4);
+    PhiloxRng single(3, 4);
+    biased_randomize_bits(0.5, a.data(), a.data() + a.size(), bulk);
+    for (size_t k = 0; k < a.size(); k++) {
+        ASSERT_EQ(a[k], single());
+    }
+    ASSERT_EQ(bulk(), single());
+}
@@ -12,6 +12,8 @@ struct DemOptions {
     double approximate_disjoint_errors_threshold = 0;
     bool ignore_decomposition_failures = false;
     bool block_decomposition_from_introducing_remnant_edges = false;
+    size_t num_threads = 1;
+    const CircuitParameterBinding *parameter_binding = nullptr;
 };
 
 inline DetectorErrorModel circuit_to_dem(const Circuit &circuit, DemOptions options = {}) {
@@ -22,7 +24,9 @@ inline DetectorErrorModel circuit_to_dem(const Circuit &circuit, DemOptions opti
         options.allow_gauge_detectors,
         options.approximate_disjoint_errors_threshold,
         options.ignore_decomposition_failures,
-        options.block_decomposition_from_introducing_remnant_edges);
+        options.block_decomposition_from_introducing_remnant_edges,
+        options.num_threads,
+        options.parameter_binding);
 }
 
 }  // namespace stim
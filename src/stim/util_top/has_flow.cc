@@ -4,14 +4,27 @@ using namespace stim;
 
 Circuit stim::flow_test_block_for_circuit(
     const Circuit &circuit, GateTarget ancilla_qubit, const std::set<uint32_t> &obs_indices) {
+    std::map<uint32_t, GateTarget> obs_ancillas;
+    for (uint32_t obs_index : obs_indices) {
+        obs_ancillas.emplace(obs_index, ancilla_qubit);
+    }
+    return flow_test_block_for_circuit(circuit, obs_ancillas);
+}
+
+Circuit stim::flow_test_block_for_circuit(const Circuit &circuit, const std::map<uint32_t, GateTarget> &obs_ancillas) {
     Circuit result;
 
     for (CircuitInstruction inst : circuit.operations) {
+        auto obs_ancilla = obs_ancillas.end();
+        if (inst.gate_type == GateType::OBSERVABLE_INCLUDE) {
+            obs_ancilla = obs_ancillas.find((uint32_t)inst.args[0]);
+        }
         if (inst.gate_type == GateType::REPEAT) {
             const Circuit &body = inst.repeat_block_body(circuit);
-            Circuit new_body = flow_test_block_for_circuit(body, ancilla_qubit, obs_indices);
+            Circuit new_body = flow_test_block_for_circuit(body, obs_ancillas);
             result.append_repeat_block(inst.repeat_block_rep_count(), std::move(new_body), inst.tag);
-        } else if (inst.gate_type == GateType::OBSERVABLE_INCLUDE && obs_indices.contains((uint32_t)inst.args[0])) {
+        } else if (obs_ancilla != obs_ancillas.end()) {
+            GateTarget ancilla_qubit = obs_ancilla->second;
             for (GateTarget t : inst.targets) {
                 if (t.is_inverted_result_target()) {
                     result.safe_append(CircuitInstruction{GateType::X, {}, &ancilla_qubit, inst.tag});
@@ -18,6 +18,7 @@
 #define _STIM_UTIL_TOP_HAS_FLOW_H
 
 #include <iostream>
+#include <map>
 #include <span>
 
 #include "stim/circuit/circuit.h"
@@ -45,6 +46,25 @@ template <size_t W>
 std::vector<bool> check_if_circuit_has_unsigned_stabilizer_flows(
     const Circuit &circuit, std::span<const Flow<W>> flows);
 
+/// Deterministically verifies that the given circuit has the specified flows, including their signs.
+///
+/// Unlike sample_if_circuit_has_stabilizer_flows, which simulates the circuit again for every flow, this method
+/// checks all of the flows together. It finds the flows that are correct up to sign with a single reverse pass over
+/// the circuit, and then determines their signs with a single stabilizer simulation of the circuit. The simulation
+/// entangles each qubit with a reference qubit, so that the input of every flow can be checked at the end alongside
+/// its output, without the flows disturbing each other. Flows that include observables with Pauli targets are
+/// grouped by those observables, and each group gets its own simulation.
+///
+/// Args:
+///     circuit: The circuit that should have the given flows. Noise is ignored.
+///     flows: The flows that the circuit should have.
+///
+/// Returns:
+///     A vector containing one boolean for each flow. The k'th boolean is true if the
+///     circuit has the k'th flow.
+template <size_t W>
+std::vector<bool> check_if_circuit_has_stabilizer_flows(const Circuit &circuit, std::span<const Flow<W>> flows);
+
 template <size_t W>
 std::ostream &operator<<(std::ostream &out, const Flow<W> &flow);
 
@@ -52,6 +72,9 @@ std::ostream &operator<<(std::ostream &out, const Flow<W> &flow);
 Circuit flow_test_block_for_circuit(
     const Circuit &circuit, GateTarget ancilla_qubit, const std::set<uint32_t> &obs_indices);
 
+/// Internal helper method. Kicks each listed observable onto its own ancilla qubit.
+Circuit flow_test_block_for_circuit(const Circuit &circuit, const std::map<uint32_t, GateTarget> &obs_ancillas);
+
 }  // namespace stim
 
 #include "stim/util_top/has_flow.inl"
@@ -209,4 +209,109 @@ std::vector<bool> check_if_circuit_has_unsigned_stabilizer_flows(
     return result;
 }
 
+inline void _collect_observables_with_pauli_targets(const Circuit &circuit, std::set<uint32_t> &out) {
+    for (const auto &inst : circuit.operations) {
+        if (inst.gate_type == GateType::REPEAT) {
+            _collect_observables_with_pauli_targets(inst.repeat_block_body(circuit), out);
+        } else if (inst.gate_type == GateType::OBSERVABLE_INCLUDE) {
+            for (const auto &t : inst.targets) {
+                if (t.is_pauli_target()) {
+                    out.insert((uint32_t)inst.args[0]);
+                }
+            }
+        }
+    }
+}
+
+template <size_t W>
+std::vector<bool> check_if_circuit_has_stabilizer_flows(const Circuit &circuit, std::span<const Flow<W>> flows) {
+    const auto &noiseless = circuit.aliased_noiseless_circuit();
+
+    // Only flows that are correct up to sign need their sign checked.
+    std::vector<bool> result = check_if_circuit_has_unsigned_stabilizer_flows<W>(noiseless, flows);
+
+    uint32_t num_qubits = (uint32_t)noiseless.count_qubits();
+    for (const auto &flow : flows) {
+        num_qubits = std::max(num_qubits, (uint32_t)flow.input.num_qubits);
+        num_qubits = std::max(num_qubits, (uint32_t)flow.output.num_qubits);
+    }
+
+    // Kicking an observable's Pauli targets onto an ancilla disturbs flows that don't include that observable, so
+    // flows are simulated in groups that agree on which of those observables they include.
+    std::set<uint32_t> pauli_observables;
+    _collect_observables_with_pauli_targets(noiseless, pauli_observables);
+    std::map<std::vector<uint32_t>, std::vector<size_t>> groups;
+    for (size_t f = 0; f < flows.size(); f++) {
+        if (result[f]) {
+            std::vector<uint32_t> key;
+            for (uint32_t obs_index : flows[f].observables) {
+                if (pauli_observables.contains(obs_index)) {
+                    key.push_back(obs_index);
+                }
+            }
+            groups[key].push_back(f);
+        }
+    }
+
+    for (const auto &[key, group] : groups) {
+        // Each observable mentioned by the group is accumulated onto its own ancilla.
+        std::map<uint32_t, GateTarget> obs_ancillas;
+        for (size_t f : group) {
+            for (uint32_t obs_index : flows[f].observables) {
+                if (!obs_ancillas.contains(obs_index)) {
+                    uint32_t ancilla = 2 * num_qubits + (uint32_t)obs_ancillas.size();
+                    obs_ancillas.emplace(obs_index, GateTarget::qubit(ancilla));
+                }
+            }
+        }
+        size_t num_sim_qubits = 2 * num_qubits + obs_ancillas.size();
+
+        // Bell pair each qubit with a reference qubit, so that the input of every flow is mirrored onto the reference
+        // qubits where the circuit can't touch it.
+        Circuit augmented_circuit;
+        std::vector<uint32_t> bell_targets;
+        for (uint32_t q = 0; q < num_qubits; q++) {
+            bell_targets.push_back(num_qubits + q);
+            bell_targets.push_back(q);
+        }
+        for (uint32_t q = 0; q < num_qubits; q++) {
+            augmented_circuit.safe_append_u("H", {num_qubits + q});
+        }
+        augmented_circuit.safe_append_u("CX", bell_targets);
+        augmented_circuit += flow_test_block_for_circuit(noiseless, obs_ancillas);
+
+        TableauSimulator<W> sim(std::mt19937_64(0), num_sim_qubits, +1);
+        sim.safe_do_circuit(augmented_circuit);
+        // Take the measurement record, so that it isn't copied when peeking at observables.
+        std::vector<bool> record = std::move(sim.measurement_record.storage);
+        sim.measurement_record.storage.clear();
+
+        for (size_t f : group) {
+            const auto &flow = flows[f];
+            PauliString<W> observable(num_sim_qubits);
+            bool sign = flow.input.sign ^ flow.output.sign;
+            for (size_t q = 0; q < flow.output.num_qubits; q++) {
+                observable.xs[q] = flow.output.xs[q];
+                observable.zs[q] = flow.output.zs[q];
+            }
+            for (size_t q = 0; q < flow.input.num_qubits; q++) {
+                // The bell pair is stabilized by XX, ZZ, and -YY, so mirroring a Y flips the sign.
+                observable.xs[num_qubits + q] = flow.input.xs[q];
+                observable.zs[num_qubits + q] = flow.input.zs[q];
+                sign ^= flow.input.xs[q] & flow.input.zs[q];
+            }
+            for (int32_t m : flow.measurements) {
+                sign ^= record[m < 0 ? (int64_t)record.size() + m : m];
+            }
+            for (uint32_t obs_index : flow.observables) {
+                observable.zs[obs_ancillas.at(obs_index).qubit_value()] = true;
+            }
+            observable.sign = sign;
+            result[f] = sim.peek_observable_expectation(observable) == +1;
+        }
+    }
+
+    return result;
+}
+
 }  // namespace stim
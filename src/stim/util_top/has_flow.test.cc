@@ -17,8 +17,10 @@
 #include "gtest/gtest.h"
 
 #include "stim/circuit/circuit.h"
+#include "stim/circuit/circuit.test.h"
 #include "stim/mem/simd_word.test.h"
 #include "stim/util_bot/test_util.test.h"
+#include "stim/util_top/circuit_flow_generators.h"
 
 using namespace stim;
 
@@ -278,3 +280,119 @@ TEST_EACH_WORD_SIZE_W(stabilizer_flow, has_flow_observable, {
         });
     ASSERT_EQ(results, (std::vector<bool>{1, 1, 0, 1}));
 })
+
+TEST_EACH_WORD_SIZE_W(stabilizer_flow, check_if_circuit_has_stabilizer_flows, {
+    auto results = check_if_circuit_has_stabilizer_flows<W>(
+        Circuit(R"CIRCUIT(
+            R 4
+            CX 0 4 1 4 2 4 3 4
+            M 4
+        )CIRCUIT"),
+        std::vector<Flow<W>>{
+            Flow<W>::from_str("Z___ -> Z____"),
+            Flow<W>::from_str("_Z__ -> _Z__"),
+            Flow<W>::from_str("__Z_ -> __Z_"),
+            Flow<W>::from_str("___Z -> ___Z"),
+            Flow<W>::from_str("XX__ -> XX__"),
+            Flow<W>::from_str("XXXX -> XXXX"),
+            Flow<W>::from_str("XYZ_ -> XYZ_"),
+            Flow<W>::from_str("XXX_ -> XXX_"),
+            Flow<W>::from_str("ZZZZ -> ____ xor rec[-1]"),
+            Flow<W>::from_str("+___Z -> -___Z"),
+            Flow<W>::from_str("-___Z -> -___Z"),
+            Flow<W>::from_str("-___Z -> +___Z"),
+        });
+    ASSERT_EQ(results, (std::vector<bool>{1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1, 0}));
+})
+
+TEST_EACH_WORD_SIZE_W(stabilizer_flow, check_if_circuit_has_stabilizer_flows_anticommuting_flows, {
+    // Flows with anticommuting inputs or outputs must not disturb each other.
+    auto results = check_if_circuit_has_stabilizer_flows<W>(
+        Circuit(R"CIRCUIT(
+            H 0
+            S 1
+        )CIRCUIT"),
+        std::vector<Flow<W>>{
+            Flow<W>::from_str("X0 -> Z0"),
+            Flow<W>::from_str("Z0 -> X0"),
+            Flow<W>::from_str("Y0 -> -Y0"),
+            Flow<W>::from_str("Y0 -> Y0"),
+            Flow<W>::from_str("X1 -> Y1"),
+            Flow<W>::from_str("Y1 -> -X1"),
+            Flow<W>::from_str("Y1 -> X1"),
+            Flow<W>::from_str("Z1 -> Z1"),
+            Flow<W>::from_str("X0*X1 -> Z0*Y1"),
+            Flow<W>::from_str("Y0*Y1 -> Y0*X1"),
+            Flow<W>::from_str("Y0*Y1 -> -Y0*X1"),
+        });
+    ASSERT_EQ(results, (std::vector<bool>{1, 1, 1, 0, 1, 1, 0, 1, 1, 1, 0}));
+})
+
+TEST_EACH_WORD_SIZE_W(stabilizer_flow, check_if_circuit_has_stabilizer_flows_measurements_and_obs, {
+    auto results = check_if_circuit_has_stabilizer_flows<W>(
+        Circuit(R"CIRCUIT(
+            X 1
+            M 0 1 2
+            X 2
+            OBSERVABLE_INCLUDE(0) rec[-3]
+            OBSERVABLE_INCLUDE(1) rec[-2]
+            OBSERVABLE_INCLUDE(2) rec[-1]
+        )CIRCUIT"),
+        std::vector<Flow<W>>{
+            Flow<W>::from_str("Z0 -> Z0"),
+            Flow<W>::from_str("Z1 -> -Z1"),
+            Flow<W>::from_str("-Z1 -> rec[-2]"),
+            Flow<W>::from_str("1 -> -Z2 xor rec[-1]"),
+            Flow<W>::from_str("Z0 -> obs[0]"),
+            Flow<W>::from_str("-Z1 -> obs[1]"),
+            Flow<W>::from_str("1 -> -Z2 xor obs[2]"),
+
+            Flow<W>::from_str("Z1 -> rec[-2]"),
+            Flow<W>::from_str("1 -> Z2 xor rec[-1]"),
+            Flow<W>::from_str("-Z0 -> obs[0]"),
+            Flow<W>::from_str("Z1 -> obs[1]"),
+            Flow<W>::from_str("1 -> Z2 xor obs[2]"),
+        });
+    ASSERT_EQ(results, (std::vector<bool>{1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0}));
+})
+
+TEST_EACH_WORD_SIZE_W(stabilizer_flow, check_if_circuit_has_stabilizer_flows_pauli_obs, {
+    Circuit circuit(R"CIRCUIT(
+        OBSERVABLE_INCLUDE(3) X0
+        OBSERVABLE_INCLUDE(2) !X0
+        OBSERVABLE_INCLUDE(4) Y0
+    )CIRCUIT");
+    std::vector<Flow<W>> flows{
+        Flow<W>::from_str("X0 -> obs[3]"),
+        Flow<W>::from_str("-X0 -> obs[2]"),
+        Flow<W>::from_str("Y0 -> obs[4]"),
+        Flow<W>::from_str("Z0 -> Z0"),
+        Flow<W>::from_str("-X0 -> obs[3]"),
+        Flow<W>::from_str("X0 -> obs[2]"),
+        Flow<W>::from_str("-Y0 -> obs[4]"),
+        Flow<W>::from_str("Z0 -> -Z0"),
+        Flow<W>::from_str("1 -> obs[2] xor obs[3]"),
+    };
+    auto results = check_if_circuit_has_stabilizer_flows<W>(circuit, flows);
+    ASSERT_EQ(results, (std::vector<bool>{1, 1, 1, 1, 0, 0, 0, 0, 0}));
+
+    auto rng = INDEPENDENT_TEST_RNG();
+    ASSERT_EQ(results, sample_if_circuit_has_stabilizer_flows<W>(256, rng, circuit, flows));
+})
+
+TEST_EACH_WORD_SIZE_W(stabilizer_flow, check_if_circuit_has_stabilizer_flows_all_operations, {
+    auto circuit = generate_test_circuit_with_all_operations();
+    auto generators = circuit_flow_generators<W>(circuit);
+    auto passes = check_if_circuit_has_stabilizer_flows<W>(circuit, generators);
+    for (size_t k = 0; k < passes.size(); k++) {
+        EXPECT_TRUE(passes[k]) << k << ": " << generators[k];
+    }
+
+    for (auto &flow : generators) {
+        flow.output.sign ^= true;
+    }
+    passes = check_if_circuit_has_stabilizer_flows<W>(circuit, generators);
+    for (size_t k = 0; k < passes.size(); k++) {
+        EXPECT_FALSE(passes[k]) << k << ": " << generators[k];
+    }
+})